@@ -0,0 +1,131 @@
+// Clustered point and spot lights, binned on the CPU every frame. Included by the forward fragment
+// shaders, which must declare inPosition and inNormal in world space.
+
+struct Light
+{
+    vec3  position;
+    float intensity;
+    vec3  color;
+    float radius;
+    vec3  direction;
+    // -1 for point lights.
+    float cos_cone;
+    // First view in the shadow atlas, point lights use six. -1 without shadows.
+    int   shadow_index;
+};
+
+layout (binding = 1, set = 0) readonly buffer LightBuffer {
+    Light lights[];
+} u_lights;
+
+// Offset and count into the light index list, per cluster.
+layout (binding = 2, set = 0) readonly buffer ClusterBuffer {
+    uvec2 clusters[];
+} u_clusters;
+
+layout (binding = 3, set = 0) readonly buffer LightIndexBuffer {
+    uint indices[];
+} u_light_indices;
+
+layout (binding = 4, set = 0) uniform ClusterInfo {
+    mat4  view;
+    uvec4 grid_size;
+    // Viewport width and height, near and far planes.
+    vec4  viewport_depth;
+} u_cluster_info;
+
+layout (binding = 5, set = 0) uniform sampler2D u_shadow_atlas;
+
+struct ShadowView
+{
+    mat4 view_projection;
+    // Offset and scale of the tile in atlas uvs.
+    vec4 atlas_rect;
+};
+
+layout (binding = 6, set = 0) readonly buffer ShadowViewBuffer {
+    ShadowView views[];
+} u_shadow_views;
+
+// Depth is compared by hand, the atlas is sampled like any other depth texture.
+const float SHADOW_BIAS = 0.0002f;
+
+// Same face order as the atlas: +X, -X, +Y, -Y, +Z, -Z.
+uint get_point_shadow_face(vec3 light_to_position)
+{
+    vec3 axis = abs(light_to_position);
+    if (axis.x >= axis.y && axis.x >= axis.z)
+        return light_to_position.x > 0.0f ? 0u : 1u;
+    if (axis.y >= axis.z)
+        return light_to_position.y > 0.0f ? 2u : 3u;
+    return light_to_position.z > 0.0f ? 4u : 5u;
+}
+
+float get_shadow(Light l, vec3 world_position)
+{
+    if (l.shadow_index < 0)
+        return 1.0f;
+
+    uint view = uint(l.shadow_index);
+    if (l.cos_cone <= -1.0f)
+        view += get_point_shadow_face(world_position - l.position);
+
+    ShadowView shadow_view = u_shadow_views.views[view];
+    vec4 clip = shadow_view.view_projection * vec4(world_position, 1.0f);
+    vec3 ndc  = clip.xyz / clip.w;
+
+    if (clip.w <= 0.0f || any(greaterThan(abs(ndc.xy), vec2(1.0f))) || ndc.z > 1.0f)
+        return 1.0f;
+
+    // The shadow projections flip y already, like the camera one.
+    vec2 uv = shadow_view.atlas_rect.xy + (ndc.xy * 0.5f + 0.5f) * shadow_view.atlas_rect.zw;
+    return ndc.z - SHADOW_BIAS > texture(u_shadow_atlas, uv).r ? 0.0f : 1.0f;
+}
+
+uint get_cluster_index(vec3 world_position)
+{
+    float near  = u_cluster_info.viewport_depth.z;
+    float far   = u_cluster_info.viewport_depth.w;
+    float depth = -(u_cluster_info.view * vec4(world_position, 1.0f)).z;
+
+    uvec3 grid  = u_cluster_info.grid_size.xyz;
+    uvec2 tile  = uvec2(gl_FragCoord.xy / u_cluster_info.viewport_depth.xy * vec2(grid.xy));
+    uint  slice = uint(max(log(depth / near) / log(far / near) * float(grid.z), 0.0f));
+
+    tile  = min(tile, grid.xy - 1);
+    slice = min(slice, grid.z - 1);
+    return (slice * grid.y + tile.y) * grid.x + tile.x;
+}
+
+vec4 get_clustered_lighting(vec3 world_position, vec3 N)
+{
+    vec4  light = vec4(0.0f);
+    uvec2 range = u_clusters.clusters[get_cluster_index(world_position)];
+
+    for (uint i = 0; i < range.y; i++)
+    {
+        Light l = u_lights.lights[u_light_indices.indices[range.x + i]];
+
+        vec3 L = l.position - world_position;
+        float distance_to_light = length(L);
+
+        if (distance_to_light > l.radius)
+            continue;
+
+        L = normalize(L);
+        if (dot(-L, l.direction) < l.cos_cone)
+            continue;
+
+        float dotNL = normalize(dot(N, L));
+
+        float attenuation = 0.0f;
+        attenuation += l.radius / distance_to_light;
+
+        if (dotNL > 0.0f) { // Pixel visible by light.
+            light += attenuation * vec4(l.color, 1) * l.intensity * dotNL *
+                     get_shadow(l, world_position);
+        }
+    }
+
+    return light;
+}
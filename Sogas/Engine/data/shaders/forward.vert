@@ -20,6 +20,8 @@ layout (push_constant) uniform push_constant
     mat4 model;
 } u_push_constant;
 
+invariant gl_Position;
+
 void main()
 {
     mat4 view_projection = ubo.proj * ubo.view;
@@ -0,0 +1,49 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout (location = 0) in vec3 inPosition;
+layout (location = 1) in vec3 inNormal;
+layout (location = 2) in vec3 inColor;
+layout (location = 3) in vec2 inUv;
+
+layout (location = 0) out vec4 outFragmentColor;
+
+#include "clustered_lighting.glsl"
+
+// Textures and buffers are indexed by their handle id.
+layout (binding = 0, set = 1) uniform sampler2D global_textures[];
+
+struct Material
+{
+    vec4 color;
+    uint albedo_texture;
+    uint normal_texture;
+    uint padding[2];
+};
+
+layout (binding = 1, set = 1) readonly buffer MaterialTable {
+    Material materials[];
+} global_buffers[];
+
+layout (push_constant) uniform push_constant
+{
+    mat4 model;
+    uint material_buffer;
+    uint material_index;
+} u_push_constant;
+
+void main()
+{
+    Material material =
+        global_buffers[nonuniformEXT(u_push_constant.material_buffer)].materials[u_push_constant.material_index];
+
+    vec3 N      = normalize(inNormal);
+    vec4 light  = get_clustered_lighting(inPosition, N);
+    vec4 albedo = vec4(inColor, 1.0f) * texture(global_textures[nonuniformEXT(material.albedo_texture)], inUv);
+    vec3 normal = texture(global_textures[nonuniformEXT(material.normal_texture)], inUv).xyz;
+
+    vec4 material_color = albedo * material.color;
+
+    outFragmentColor = light * material_color;
+}
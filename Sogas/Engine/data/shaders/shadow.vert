@@ -0,0 +1,16 @@
+#version 450
+
+// Only the position of the interleaved vertex is fetched.
+layout (location = 0) in vec3 position;
+
+// The view of the light is pushed for every atlas tile, no descriptor set is needed.
+layout (push_constant) uniform push_constant
+{
+    mat4 view_projection;
+    mat4 model;
+} u_push_constant;
+
+void main()
+{
+    gl_Position = u_push_constant.view_projection * u_push_constant.model * vec4(position, 1.0f);
+}
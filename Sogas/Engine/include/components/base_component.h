@@ -11,6 +11,7 @@ class BaseComponent
 {
   public:
     void update(f32 /*delta_time*/){};
+    void fixed_update(f32 /*step*/){};
     void on_entity_created(){};
     void render_debug(pinut::resources::CommandBuffer* /*cmd*/){};
     void render_debug_menu(){};
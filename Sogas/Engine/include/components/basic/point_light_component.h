@@ -18,10 +18,11 @@ class PointLightComponent : public BaseComponent
     void render_debug(pinut::resources::CommandBuffer* cmd);
     void render_debug_menu();
 
-    glm::vec4 color     = glm::vec4(1.0f);
-    f32       intensity = 1.0f;
-    f32       radius    = 1.0f;
-    bool      enabled   = true;
-    glm::vec3 position  = glm::vec3(0.0f); // TODO For when activating through function.
+    glm::vec4 color         = glm::vec4(1.0f);
+    f32       intensity     = 1.0f;
+    f32       radius        = 1.0f;
+    bool      enabled       = true;
+    bool      casts_shadows = false;
+    glm::vec3 position      = glm::vec3(0.0f); // TODO For when activating through function.
 };
 } // namespace sogas
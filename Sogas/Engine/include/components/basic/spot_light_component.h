@@ -0,0 +1,30 @@
+#pragma once
+
+#include <components/base_component.h>
+#include <entity/entity.h>
+
+namespace pinut::resources
+{
+class CommandBuffer;
+}
+namespace sogas
+{
+// Lights along the forward axis of the transform, inside a cone of the given full angle.
+class SpotLightComponent : public BaseComponent
+{
+    DECLARE_SIBILING_ACCESS();
+
+  public:
+    void load(const json& j, EntityParser& context);
+    void render_debug(pinut::resources::CommandBuffer* cmd);
+    void render_debug_menu();
+
+    glm::vec4 color         = glm::vec4(1.0f);
+    f32       intensity     = 1.0f;
+    f32       radius        = 10.0f;
+    // Degrees.
+    f32       angle         = 45.0f;
+    bool      enabled       = true;
+    bool      casts_shadows = false;
+};
+} // namespace sogas
@@ -2,6 +2,7 @@
 
 namespace sogas
 {
+// Seconds from std::chrono::steady_clock.
 struct Clock
 {
     f64 start_time{0};
@@ -11,4 +12,33 @@ struct Clock
 void start_clock(Clock* clock);
 void update_clock(Clock* clock);
 void stop_clock(Clock* clock);
+
+// Splits variable frame times into steps of a fixed size. Time not consumed by a whole step stays
+// in the accumulator for the next frame.
+struct FixedTimestep
+{
+    f64 step{1.0 / 60.0};
+    f64 accumulator{0};
+    // Longer frames are clamped, so a stall does not end up in a spiral of catch up steps.
+    f64 max_frame_time{0.25};
+};
+
+// Adds the frame time and returns how many steps to run this frame.
+u32 advance_fixed_timestep(FixedTimestep* timestep, f64 frame_time);
+// How far the frame is between the last step and the next one, to interpolate simulated state.
+f32 get_fixed_timestep_alpha(const FixedTimestep* timestep);
+
+// The last frame times, in seconds, overwriting the oldest one.
+struct FrameTimeStats
+{
+    static constexpr u32 HISTORY_SIZE = 256;
+
+    f64 frame_times[HISTORY_SIZE]{};
+    u32 count{0};
+    u32 next{0};
+};
+
+void add_frame_time(FrameTimeStats* stats, f64 frame_time);
+// Percentile between 0 and 1 of the recorded frame times, 0 when there are none.
+f64  get_frame_time_percentile(const FrameTimeStats* stats, f64 percentile);
 } // namespace sogas
@@ -1,11 +1,11 @@
 #pragma once
 
 #include <engine/camera.h>
+#include <engine/clock.h>
 #include <modules/module_manager.h>
 
 namespace sogas
 {
-struct Clock;
 class Mesh;
 namespace modules
 {
@@ -35,6 +35,16 @@ class Engine
         return &module_manager;
     }
 
+    // How far rendering is between the last two fixed steps.
+    f32 get_fixed_timestep_alpha() const
+    {
+        return sogas::get_fixed_timestep_alpha(&fixed_timestep);
+    }
+    const FrameTimeStats& get_frame_time_stats() const
+    {
+        return frame_time_stats;
+    }
+
     // TODO Same as below. Temporal.
     std::map<std::string, Mesh*>* get_meshes()
     {
@@ -50,8 +60,10 @@ class Engine
     modules::ModuleManager       module_manager;
     std::map<std::string, Mesh*> meshes;
 
-    Clock* clock = nullptr;
-    f64    delta_time{0};
-    f64    last_time{0};
+    Clock*         clock = nullptr;
+    f64            delta_time{0};
+    f64            last_time{0};
+    FixedTimestep  fixed_timestep;
+    FrameTimeStats frame_time_stats;
 };
 } // namespace sogas
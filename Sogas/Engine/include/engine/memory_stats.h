@@ -0,0 +1,14 @@
+#pragma once
+
+namespace sogas
+{
+// Current, peak and budget of every memory tag, keyed by tag name.
+json get_memory_stats_json();
+bool dump_memory_stats(const std::string& filename);
+
+// Budgets in bytes keyed by tag name, as in the "memory_budgets" object of boot.json.
+void load_memory_budgets(const json& j);
+
+// Tree node listing every tag and the occupancy of the object manager pools.
+void render_memory_stats_menu();
+} // namespace sogas
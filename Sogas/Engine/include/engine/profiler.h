@@ -0,0 +1,77 @@
+#pragma once
+
+namespace sogas
+{
+namespace profiler
+{
+// A finished zone, times are nanoseconds from get_time.
+struct Zone
+{
+    const char* name;
+    u64         start;
+    u64         end;
+    // Zones open on the same thread when it started.
+    u32         depth;
+    // Index of the thread that recorded it, see get_thread_name.
+    u32         thread;
+};
+
+// Every zone that finished on any thread between two end_frame calls.
+struct Frame
+{
+    u64               start = 0;
+    u64               end   = 0;
+    std::vector<Zone> zones;
+};
+
+// Records a zone from construction to destruction. The name is only referenced, it must outlive
+// the frame the zone ends in.
+struct ScopedZone
+{
+    ScopedZone(const char* new_name);
+    ~ScopedZone();
+
+    ScopedZone(const ScopedZone&)            = delete;
+    ScopedZone& operator=(const ScopedZone&) = delete;
+
+    const char* name;
+    u64         start;
+};
+
+// Nanoseconds of std::chrono::steady_clock, the clock GPU zones are converted to.
+u64 get_time();
+
+// Shown for the calling thread in the flame view and the exported trace.
+void        set_thread_name(const char* name);
+std::string get_thread_name(u32 thread);
+
+// Lanes show next to the threads, for zones measured elsewhere like GPU timings read back from
+// the device. Main thread only.
+u32  create_lane(const char* name);
+void add_zone(u32 lane, const char* name, u64 start, u64 end, u32 depth);
+
+// Collects the zones of every thread into the last frame. Main thread only, once per frame.
+void         end_frame();
+const Frame& get_last_frame();
+
+// Keeps the next frames and writes them as a Chrome trace once the last one ends.
+void start_capture(u32 frame_count, const std::string& filename);
+bool is_capturing();
+
+// Chrome trace_event format, load it in chrome://tracing or Perfetto.
+json get_chrome_trace_json(const std::vector<Frame>& frames);
+bool export_chrome_trace(const std::string& filename, const std::vector<Frame>& frames);
+
+// Tree node with a flame view of the last frame, one lane per thread.
+void render_profiler_menu();
+} // namespace profiler
+} // namespace sogas
+
+#ifndef SOGAS_DISABLE_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b)       PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name)                                                                        \
+    sogas::profiler::ScopedZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name)
+#endif
@@ -2,16 +2,20 @@
 
 namespace sogas
 {
-#define kb(size) (size * 1024)
-#define mb(size) (size * 1024 * 1024)
-#define gb(size) (size * 1024 * 1024)
+#define kb(size) ((size) * 1024ull)
+#define mb(size) ((size) * 1024ull * 1024ull)
+#define gb(size) ((size) * 1024ull * 1024ull * 1024ull)
 
 struct Allocator
 {
+    virtual ~Allocator() = default;
+
     virtual void* allocate(const u64 size, const u64 alignment) = 0;
     virtual void  deallocate(void* pointer)                     = 0;
 };
 
+// Last in, first out. Each allocation keeps the top it started from, so deallocating also gives
+// back the alignment padding in front of it.
 struct StackAllocator : public Allocator
 {
     void init(const u64 size);
@@ -29,4 +33,202 @@ struct StackAllocator : public Allocator
     u64 total_memory     = 0;
     u64 allocated_memory = 0;
 };
+
+struct DoubleStackAllocator;
+
+// One end of a double stack seen as an allocator, so containers can live on either end. Single
+// allocations are not freed, the end goes back to a marker or is cleared as a whole.
+struct DoubleStackEnd : public Allocator
+{
+    void* allocate(const u64 size, const u64 alignment) override;
+    void  deallocate(void* pointer) override;
+
+    DoubleStackAllocator* stack  = nullptr;
+    bool                  is_top = false;
+};
+
+// Two stacks sharing one block, the bottom one growing up and the top one growing down. Long
+// lived data goes at one end and temporary data at the other, so clearing either end leaves no
+// holes behind.
+struct DoubleStackAllocator
+{
+    void init(const u64 size);
+    void shutdown();
+
+    void* allocate_top(const u64 size, const u64 alignment);
+    void* allocate_bottom(const u64 size, const u64 alignment);
+
+    // Markers are offsets from the start of the block for both ends.
+    u64  get_top_marker();
+    u64  get_bottom_marker();
+    void free_top_marker(u64 marker);
+    void free_bottom_marker(u64 marker);
+
+    void clear_top();
+    void clear_bottom();
+
+    u8* memory       = nullptr;
+    u64 total_memory = 0;
+    u64 top          = 0;
+    u64 bottom       = 0;
+
+    DoubleStackEnd top_end;
+    DoubleStackEnd bottom_end;
+};
+
+// Frees everything allocated from one end of a double stack during its lifetime.
+struct ScopedStackMarker
+{
+    ScopedStackMarker(DoubleStackAllocator& new_stack, const bool new_is_top);
+    ~ScopedStackMarker();
+
+    ScopedStackMarker(const ScopedStackMarker&)            = delete;
+    ScopedStackMarker& operator=(const ScopedStackMarker&) = delete;
+
+    DoubleStackAllocator& stack;
+    u64                   marker;
+    bool                  is_top;
+};
+
+// Bump allocator for transient data. Single allocations are never freed, everything goes at once
+// with clear or back to a marker.
+struct LinearAllocator : public Allocator
+{
+    void init(const u64 size);
+    void shutdown();
+
+    void* allocate(const u64 size, const u64 alignment) override;
+    void  deallocate(void* pointer) override;
+
+    u64  get_marker();
+    void free_marker(u64 marker);
+
+    void clear();
+
+    u8* memory           = nullptr;
+    u64 total_memory     = 0;
+    u64 allocated_memory = 0;
+    // Highest allocated_memory seen since init, to size the allocator.
+    u64 peak_memory      = 0;
+};
+
+// Fixed size blocks, free blocks are linked through their own memory.
+struct PoolAllocator : public Allocator
+{
+    void init(const u64 block_size, const u64 block_count, const u64 block_alignment = 16);
+    void shutdown();
+
+    // Size and alignment must fit the blocks of the pool.
+    void* allocate(const u64 size, const u64 alignment) override;
+    void  deallocate(void* pointer) override;
+
+    u8*   memory           = nullptr;
+    u8*   blocks           = nullptr;
+    void* free_list        = nullptr;
+    u64   block_size       = 0;
+    u64   block_count      = 0;
+    u64   block_alignment  = 0;
+    u64   allocated_blocks = 0;
+};
+
+struct TLSFBlock;
+
+// Two level segregated fit heap. Free blocks are kept in lists by size class, a power of two
+// split in linear subdivisions, with bitmaps to find the first non empty list that fits. Both
+// allocate and deallocate are constant time, and neighbour free blocks merge on deallocation.
+struct TLSFAllocator : public Allocator
+{
+    static constexpr u32 ALIGNMENT_LOG2      = 4;
+    static constexpr u64 ALIGNMENT           = 1ull << ALIGNMENT_LOG2;
+    static constexpr u32 SL_INDEX_COUNT_LOG2 = 5;
+    static constexpr u32 SL_INDEX_COUNT      = 1 << SL_INDEX_COUNT_LOG2;
+    // Blocks up to 4GB, sizes below 1 << FL_INDEX_SHIFT go to the first, linear, class.
+    static constexpr u32 FL_INDEX_MAX        = 32;
+    static constexpr u32 FL_INDEX_SHIFT      = SL_INDEX_COUNT_LOG2 + ALIGNMENT_LOG2;
+    static constexpr u32 FL_INDEX_COUNT      = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+
+    void init(const u64 size);
+    void shutdown();
+
+    void* allocate(const u64 size, const u64 alignment) override;
+    void  deallocate(void* pointer) override;
+
+    // Usable size of an allocated pointer, at least the requested one.
+    u64 get_allocation_size(void* pointer) const;
+
+    u8* memory           = nullptr;
+    u64 total_memory     = 0;
+    u64 allocated_memory = 0;
+
+  private:
+    void       insert_free_block(TLSFBlock* block);
+    void       remove_free_block(TLSFBlock* block);
+    TLSFBlock* find_free_block(u64 size);
+    // Splits the tail past size into a new free block, when it is large enough to hold one.
+    void       trim_free_tail(TLSFBlock* block, u64 size);
+
+    u32        fl_bitmap = 0;
+    u32        sl_bitmap[FL_INDEX_COUNT];
+    TLSFBlock* free_blocks[FL_INDEX_COUNT][SL_INDEX_COUNT];
+};
+
+// Lets std containers allocate from an engine allocator. Copies share the allocator, which must
+// outlive every container using it.
+template <typename T>
+struct StlAllocator
+{
+    using value_type = T;
+
+    StlAllocator(Allocator* new_allocator) : allocator(new_allocator)
+    {
+        ASSERT(allocator != nullptr);
+    }
+
+    template <typename U>
+    StlAllocator(const StlAllocator<U>& other) : allocator(other.allocator)
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+        void* pointer = allocator->allocate(count * sizeof(T), alignof(T));
+        if (pointer == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(pointer);
+    }
+
+    void deallocate(T* pointer, size_t /*count*/)
+    {
+        allocator->deallocate(pointer);
+    }
+
+    template <typename U>
+    bool operator==(const StlAllocator<U>& other) const
+    {
+        return allocator == other.allocator;
+    }
+
+    Allocator* allocator = nullptr;
+};
+
+template <typename T>
+using Vector = std::vector<T, StlAllocator<T>>;
+
+template <typename Key,
+          typename Value,
+          typename Hash  = std::hash<Key>,
+          typename Equal = std::equal_to<Key>>
+using UnorderedMap =
+  std::unordered_map<Key, Value, Hash, Equal, StlAllocator<std::pair<const Key, Value>>>;
+
+// Engine wide allocators, memory_init runs before any module starts.
+void memory_init(const u64 frame_size = mb(8), const u64 heap_size = mb(64));
+void memory_shutdown();
+
+// Cleared at the start of every frame, nothing allocated from it outlives the frame.
+LinearAllocator* get_frame_allocator();
+// General purpose heap for engine data.
+TLSFAllocator*   get_heap_allocator();
 } // namespace sogas
@@ -2,13 +2,18 @@
 
 namespace sogas
 {
+// Only lives while a scene is parsed, its lists come from the given scratch allocator.
 struct EntityParser
 {
-    std::string   filename;
-    EntityParser* parent = nullptr;
-    HandleVector  entities; // Root entities
-    HandleVector  all_entities; // All entities, including childs from root entities.
-    glm::mat4     transform;
+    EntityParser(Allocator* scratch) : entities(scratch), all_entities(scratch)
+    {
+    }
+
+    std::string    filename;
+    EntityParser*  parent = nullptr;
+    Vector<Handle> entities; // Root entities
+    Vector<Handle> all_entities; // All entities, including childs from root entities.
+    glm::mat4      transform;
 };
 
 bool parse_scene(const std::string& filename, EntityParser& context);
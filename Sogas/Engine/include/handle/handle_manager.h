@@ -46,18 +46,23 @@ class HandleManager
     {
         return name;
     }
-    const Handle::handle_type get_type() const
+    Handle::handle_type get_type() const
     {
         return type;
     }
-    const u32 get_size() const
+    u32 get_size() const
     {
         return number_objects_used;
     }
-    const u32 get_capacity() const
+    u32 get_capacity() const
     {
         return max_total_objects;
     }
+    // Objects the manager was initialized for, from components.json.
+    u32 get_pool_size() const
+    {
+        return static_cast<u32>(internal_to_external.size());
+    }
 
     //bool destroy_pending_objects();
 
@@ -73,10 +78,11 @@ class HandleManager
 
     static HandleManager* get_by_type(Handle::handle_type type);
     static HandleManager* get_by_name(const std::string& name);
-    static const u32      get_number_of_defined_types();
+    static u32            get_number_of_defined_types();
     static void           destroy_all_pending_objects();
 
     virtual void update_all(f32 delta_time)                             = 0;
+    virtual void fixed_update_all(f32 step)                             = 0;
     virtual void render_debug_all(pinut::resources::CommandBuffer* cmd) = 0;
 
     static HandleManagerArray predefined_handle_managers;
@@ -16,17 +16,33 @@ class ObjectManager : public HandleManager
         this->name                                             = name;
     }
 
+    ~ObjectManager()
+    {
+        if (memory == nullptr)
+        {
+            return;
+        }
+
+        delete[] memory;
+        track_deallocation(get_memory_tag(), get_pool_bytes());
+    }
+
     void init(u32 max_objects) override
     {
+        // The handle tables are only sized once, a second init would leak the objects.
+        ASSERT(memory == nullptr);
         HandleManager::init(max_objects);
 
         memory  = new u8[max_objects * sizeof(object_type)];
         objects = static_cast<object_type*>(static_cast<void*>(memory));
+
+        track_allocation(get_memory_tag(), get_pool_bytes());
     };
 
     void update_all(f32 delta_time) override
     {
         ASSERT(objects);
+        PROFILE_ZONE(name.c_str());
 
         if (number_objects_used <= 0)
         {
@@ -39,6 +55,17 @@ class ObjectManager : public HandleManager
         }
     }
 
+    void fixed_update_all(f32 step) override
+    {
+        ASSERT(objects);
+        PROFILE_ZONE(name.c_str());
+
+        for (decltype(number_objects_used) i = 0; i < number_objects_used; ++i)
+        {
+            objects[i].fixed_update(step);
+        }
+    }
+
     void render_debug_all(pinut::resources::CommandBuffer* cmd) override
     {
         ASSERT(objects);
@@ -96,6 +123,18 @@ class ObjectManager : public HandleManager
     }
 
   private:
+    MemoryTag get_memory_tag() const
+    {
+        return name == "entity" ? MemoryTag::ENTITIES : MemoryTag::COMPONENTS;
+    }
+
+    // Objects and handle tables are sized up front by the capacity from components.json.
+    u64 get_pool_bytes() const
+    {
+        return get_pool_size() * (sizeof(object_type) + sizeof(external_to_internal[0]) +
+                                  sizeof(internal_to_external[0]));
+    }
+
     void create_object(Handle::handle_index internal_index) override
     {
         object_type* address = objects + internal_index;
@@ -133,7 +172,7 @@ class ObjectManager : public HandleManager
         address->on_entity_created();
     }
 
-    u8*          memory;
+    u8*          memory  = nullptr;
     object_type* objects = nullptr;
 };
 
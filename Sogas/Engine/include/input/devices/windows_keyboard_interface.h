@@ -11,7 +11,9 @@ class WindowsKeyboardInterface
 {
   public:
     void fetch_data(KeyBoard& keyboard);
+#ifdef _WIN64
     void processMsg(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
+#endif
 
   private:
     std::bitset<NUM_KEYBOARD_KEYS> keys;
@@ -10,7 +10,9 @@ class WindowsMouseInterface
 {
   public:
     void fetch_data(Mouse& mouse);
+#ifdef _WIN64
     void processMsg(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
+#endif
 
   private:
     std::bitset<MOUSE_BUTTON_COUNT> buttons;
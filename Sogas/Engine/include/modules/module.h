@@ -26,6 +26,8 @@ class IModule
     virtual bool start()                                            = 0;
     virtual void stop()                                             = 0;
     virtual void update(f32 delta_time)                             = 0;
+    // Runs at the engine fixed timestep, zero or more times per frame before update.
+    virtual void fixed_update(f32 /*step*/){};
     virtual void render()                                           = 0;
     virtual void render_ui()                                        = 0;
     virtual void render_debug(pinut::resources::CommandBuffer* cmd) = 0;
@@ -11,7 +11,7 @@ class BootModule : public IModule
   public:
     BootModule(const std::string& name) : IModule(name){};
     bool start() override;
-    void stop() override{};
+    void stop() override;
     void update(f32 /*delta_time*/) override{};
     void render() override{};
     void render_ui() override{};
@@ -19,8 +19,29 @@ class BootModule : public IModule
     void render_debug_menu() override{};
     void resize_window(u32, u32) override{};
 
+    // Sets the memory budgets and loads the scenes listed in a boot file.
+    bool boot(const std::string& filename);
+    // Destroys the entities of every loaded scene and gives their memory back at once.
+    void unload_scenes();
+
+    // Bytes held by the entity lists of the loaded scenes.
+    u64 get_scene_memory_used() const
+    {
+        return scene_memory.bottom;
+    }
+
   private:
     void load_scene(const std::string& filename);
+
+    struct LoadedScene
+    {
+        Handle* entities     = nullptr;
+        u32     entity_count = 0;
+    };
+
+    // Loaded scenes keep their entity lists at the bottom, parsing scratch goes on top.
+    DoubleStackAllocator     scene_memory;
+    std::vector<LoadedScene> scenes;
 };
 } // namespace modules
 } // namespace sogas
@@ -18,6 +18,7 @@ class EntityModule : public IModule
     bool start() override;
     void stop() override;
     void update(f32 /*delta_time*/) override;
+    void fixed_update(f32 step) override;
     void render() override{};
     void render_ui() override{};
     void render_debug(pinut::resources::CommandBuffer*) override;
@@ -26,6 +27,7 @@ class EntityModule : public IModule
 
   private:
     std::vector<HandleManager*> managers_to_update;
+    std::vector<HandleManager*> managers_to_fixed_update;
     std::vector<HandleManager*> managers_to_render_debug;
 };
 
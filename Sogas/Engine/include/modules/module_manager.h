@@ -23,6 +23,7 @@ class ModuleManager
     void boot();
     void clear();
 
+    void fixed_update(f32 step);
     void update(f32 delta_time);
     void render();
     void render_ui();
@@ -26,6 +26,8 @@ class RendererModule : public IModule
     void set_active_camera(Handle new_camera) { active_camera = new_camera; }
     bool get_wireframe_enabled() const { return is_wireframe; }
     void set_wireframe(bool enable) { is_wireframe = enable; }
+    bool get_depth_prepass_enabled() const { return is_depth_prepass; }
+    void set_depth_prepass(bool enable) { is_depth_prepass = enable; }
     // clang-format on
 
   protected:
@@ -41,10 +43,13 @@ class RendererModule : public IModule
   private:
     //! Not a shared_ptr<pinut::GPUDevice> due to C26495.
     //! Variable not initialized and cannot initialize an abstract class.
-    pinut::GPUDevice* renderer      = nullptr;
-    void*             window_handle = nullptr;
-    Handle            active_camera;
-    bool              is_wireframe = false;
+    pinut::GPUDevice*  renderer      = nullptr;
+    pinut::GraphicsAPI graphics_api  = pinut::GraphicsAPI::Vulkan;
+    void*              window_handle = nullptr;
+    Handle             active_camera;
+    bool               is_wireframe     = false;
+    // Lays down depth first so the forward pass only shades the visible fragments.
+    bool               is_depth_prepass = true;
 };
 } // namespace modules
 } // namespace sogas
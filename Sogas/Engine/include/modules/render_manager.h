@@ -1,5 +1,8 @@
 #pragma once
 
+#include <engine/geometry.h>
+#include <resources/resources.h>
+
 namespace pinut::resources
 {
 class CommandBuffer;
@@ -16,16 +19,48 @@ class RenderManager
     {
         Handle                 owner_handle;
         const Mesh* mesh = nullptr;
-        // TODO material.
+        // Index into the bindless material table.
+        u32    material_index = 0;
         Handle transform;
+        // Distance from the eye to the closest point of the bounding sphere, set when sorting.
+        f32    view_depth = 0.0f;
+        // Transform and bounds seen by the last collect_moved_casters call.
+        glm::mat4      caster_model = glm::mat4(0.0f);
+        BoundingSphere caster_bounds;
     };
 
   public:
-    void add_key(Handle owner, const Mesh* mesh);
+    void add_key(Handle owner, const Mesh* mesh, u32 material_index = 0);
+    // Gives the keys back to the heap, before the engine memory shuts down.
+    void clear();
     void render_all(pinut::resources::CommandBuffer* cmd, Handle camera_handle);
+    // Position only draws for a depth pre-pass, the bound pipeline takes just the model matrix.
+    void render_depth(pinut::resources::CommandBuffer* cmd);
+    // Draws the casters reaching the light bounds, the bound pipeline takes the light view
+    // projection followed by the model matrix.
+    void render_shadow(pinut::resources::CommandBuffer* cmd,
+                       const glm::mat4&                 view_projection,
+                       const BoundingSphere&            light_bounds);
+
+    // Bounds of every caster moved since the last call, from both before and after the move.
+    // New keys count as moved.
+    void collect_moved_casters(Vector<BoundingSphere>& moved);
+
+    // Nearest keys first so the depth test rejects as many hidden fragments as possible.
+    void sort_front_to_back(const glm::vec3& eye);
+
+    // With a material table set, draws push their material index instead of binding sets.
+    void set_material_table(pinut::resources::BufferHandle buffer);
+
+    // Largest on screen diameter, in pixels, of the meshes drawn with the material.
+    f32 get_projected_size(u32              material_index,
+                           const glm::vec3& eye,
+                           f32              fov,
+                           f32              viewport_height) const;
 
   private:
-    std::vector<RenderKey> keys;
+    Vector<RenderKey>              keys{get_heap_allocator()};
+    pinut::resources::BufferHandle material_table{INVALID_ID};
 };
 
 extern RenderManager render_manager;
@@ -1,44 +1,65 @@
 #pragma once
 
+#include <cstdarg>
+
 #ifdef _WIN64
 #include <Windows.h>
 #endif
 
 using json = nlohmann::json;
 
-#ifdef _WIN64
 namespace sogas::platform
 {
 class Window;
 
+#ifdef _WIN64
 using window_proc   = LRESULT (*)(HWND, UINT, WPARAM, LPARAM);
 using window_handle = HWND;
-using Window_id     = u32;
+#else
+// Other platforms run headless, there is no native window nor messages to dispatch.
+using window_proc   = void (*)();
+using window_handle = void*;
+#endif
+using Window_id = u32;
 
 struct window_init_info
 {
-    const char*   caption{nullptr};
-    window_handle window_handle{nullptr}; // parent
-    window_proc   window_proc{nullptr};
-    i32           left{0};
-    i32           top{0};
-    i32           width{1280};
-    i32           height{720};
+    const char*             caption{nullptr};
+    platform::window_handle window_handle{nullptr}; // parent
+    platform::window_proc   window_proc{nullptr};
+    i32                     left{0};
+    i32                     top{0};
+    i32                     width{1280};
+    i32                     height{720};
 };
 
 // Window stuff ...
-const Window_id create_window(const window_init_info* window_init_info = nullptr);
-bool            peek_message();
-void            remove_window(Window_id id);
+Window_id create_window(const window_init_info* window_init_info = nullptr);
+bool      peek_message();
+void      remove_window(Window_id id);
 
-void      resize_window(const Window_id id, const u32 width, const u32 height);
-void      get_window_size(const Window_id id, u32& width, u32& height);
-const u32 get_window_width(const Window_id id);
-const u32 get_window_height(const Window_id id);
-void      set_window_fullscreen(const Window_id id, const bool is_fullscreen);
-bool      is_window_fullscreen(const Window_id);
+void resize_window(const Window_id id, const u32 width, const u32 height);
+void get_window_size(const Window_id id, u32& width, u32& height);
+u32  get_window_width(const Window_id id);
+u32  get_window_height(const Window_id id);
+void set_window_fullscreen(const Window_id id, const bool is_fullscreen);
+bool is_window_fullscreen(const Window_id);
 
+// Null when running headless.
 void* get_window_handle(const Window_id id);
+bool  is_headless();
+
+// Limits the frames run by the main loop, peek_message returns true once they are spent. Headless
+// runs have nothing else telling them to quit, batch jobs and benchmarks set the frame count.
+struct Frame_budget
+{
+    u32 frame_count{0}; // 0 never quits.
+    f64 frame_time{0};  // Seconds, peek_message sleeps the rest of it. 0 runs as fast as it can.
+};
+
+void set_frame_budget(const Frame_budget& budget);
+// Makes the next peek_message return true.
+void request_quit();
 
 // String functions
 constexpr auto char_buffer_size = 1024 * 4;
@@ -47,8 +68,20 @@ i32            string_format(char* dest, const char* format, va_list va_args);
 
 // File stuff
 json load_json(const std::string& filename);
-} // namespace sogas::platform
 
+// Read only view of a whole file, pages are only read when touched.
+struct Mapped_file
+{
+    const void* data{nullptr};
+    u64         size{0};
+#ifdef _WIN64
+    HANDLE file{INVALID_HANDLE_VALUE};
+    HANDLE mapping{nullptr};
 #else
-#error "No other platform is implemented."
-#endif // _WIN64
+    i32 file{-1};
+#endif
+};
+
+bool map_file(const std::string& filename, Mapped_file& out_file);
+void unmap_file(Mapped_file& file);
+} // namespace sogas::platform
@@ -0,0 +1,80 @@
+#pragma once
+
+namespace sogas
+{
+// Matches the Light struct of the forward shaders, std430.
+struct ClusterLight
+{
+    glm::vec3 position  = glm::vec3(0.0f);
+    f32       intensity = 1.0f;
+    glm::vec3 color     = glm::vec3(1.0f);
+    f32       radius    = 1.0f;
+    // Spot lights only, point lights keep a cone cosine of -1 so every direction is lit.
+    glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+    f32       cos_cone  = -1.0f;
+    // First shadow view in the atlas, -1 when the light casts no shadows.
+    i32       shadow_index = -1;
+    u32       padding[3]   = {};
+};
+
+// Lights of a cluster are light_indices[offset, offset + count).
+struct ClusterRange
+{
+    u32 offset = 0;
+    u32 count  = 0;
+};
+
+struct LightClustersDescriptor
+{
+    // Tiles across the viewport and exponential slices between the near and far planes.
+    u32 grid_x            = 16;
+    u32 grid_y            = 9;
+    u32 grid_z            = 24;
+    u32 max_lights        = 4096;
+    u32 max_light_indices = 256 * 1024;
+};
+
+// Depth slice holding a view space depth, slices grow exponentially so they stay roughly cubic.
+u32 get_cluster_slice(f32 view_depth, f32 near, f32 far, u32 slice_count);
+
+// Bins point and spot lights into view space clusters, so shading only loops over the lights
+// touching the cluster of the fragment. Each light covers a box of clusters, found from the screen
+// bounds and depth range of its sphere, filled by counting and then scattering its index into the
+// lists. Spot lights are binned by their whole sphere, the cone is only applied when shading.
+class LightClusters
+{
+  public:
+    void init(const LightClustersDescriptor& new_descriptor = {});
+
+    void clear();
+    // Returns false once max_lights is reached.
+    bool add_light(const ClusterLight& light);
+
+    // Lights are in world space, the view and perspective parameters are the camera ones.
+    void build(const glm::mat4& view, f32 fov, f32 aspect_ratio, f32 near, f32 far);
+
+    u32 get_cluster_index(u32 x, u32 y, u32 z) const;
+
+    const LightClustersDescriptor&   get_descriptor() const;
+    const std::vector<ClusterLight>& get_lights() const;
+    const std::vector<ClusterRange>& get_clusters() const;
+    const std::vector<u32>&          get_light_indices() const;
+
+  private:
+    struct LightBounds
+    {
+        u32 light;
+        u32 min_x, max_x;
+        u32 min_y, max_y;
+        u32 min_z, max_z;
+    };
+
+    LightClustersDescriptor   descriptor;
+    std::vector<ClusterLight> lights;
+    std::vector<LightBounds>  bounds;
+    std::vector<ClusterRange> clusters;
+    // Indices written so far to each cluster while scattering.
+    std::vector<u32>          cluster_fill;
+    std::vector<u32>          light_indices;
+};
+} // namespace sogas
@@ -3,10 +3,14 @@
 #include <engine/geometry.h>
 #include <resources/resources.h>
 
+#ifdef _MSC_VER
 #pragma warning(disable : 4201)
+#endif
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
+#ifdef _MSC_VER
 #pragma warning(default : 4201)
+#endif
 
 namespace pinut
 {
@@ -50,6 +54,7 @@ class Mesh
     pinut::resources::BufferHandle vertex_buffer{pinut::resources::invalid_buffer};
     pinut::resources::BufferHandle index_buffer{pinut::resources::invalid_buffer};
     BoundingSphere                 bounding_sphere;
+    u64                            tracked_memory = 0; // Vertex and index bytes reported as MESHES.
 };
 
 void init_default_meshes();
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <resources/pipeline.h>
+#include <resources/resources.h>
+#include <resources/shader_state.h>
+
+namespace pinut
+{
+class GPUDevice;
+}
+
+namespace sogas
+{
+static constexpr u32 MAX_SPEC_SHADER_STAGES =
+  static_cast<u32>(pinut::resources::ShaderStageType::MAX_SHADER_TYPE);
+
+// Everything needed to create one pipeline, as read from a json spec.
+// Owns the strings and shader code the pipeline descriptor points to.
+struct PipelineSpec
+{
+    using SetLayoutDescriptor = pinut::resources::DescriptorSetLayoutDescriptor;
+
+    std::string                                           name;
+    std::string                                           shader_name;
+    // Empty for the swapchain pass.
+    std::string                                           render_pass;
+    // SPIR-V file names, see get_shader_binary_path.
+    std::array<std::string, MAX_SPEC_SHADER_STAGES>       shader_paths;
+    pinut::resources::ShaderStateDescriptor               shader_state;
+    pinut::resources::RasterizationDescriptor             rasterization;
+    pinut::resources::DepthStencilDescriptor              depth_stencil;
+    pinut::resources::VertexInputDescriptor               vertex_input;
+    pinut::resources::TopologyType                        topology;
+    std::vector<std::string>                              set_layout_names;
+    std::vector<SetLayoutDescriptor>                      set_layouts;
+    std::vector<pinut::resources::PushConstantDescriptor> push_constants;
+    // Set index bound to the device bindless set, -1 when the pipeline does not use it.
+    i32 bindless_set = -1;
+
+    // Descriptor pointing into this spec, without set layouts. The spec must outlive it.
+    pinut::resources::PipelineDescriptor get_descriptor() const;
+};
+
+bool parse_pipeline_spec(const json& j, PipelineSpec& out_spec);
+// Specs name the SPIR-V files, the build compiles them into SOGAS_SHADER_DIR.
+std::string get_shader_binary_path(const std::string& filename);
+bool        load_pipeline_shaders(PipelineSpec& spec);
+// Fills whatever the json did not declare (set layouts, vertex input, push constants) from the
+// loaded shaders. A stream declared without attributes keeps its stride.
+bool reflect_pipeline_spec(PipelineSpec& spec);
+// Identical specs under different names hash the same.
+u64 hash_pipeline_spec(const PipelineSpec& spec);
+
+// Loads pipeline specs and creates them. Holds a reference to the set layouts of every pipeline.
+// Bindless pipelines are skipped when the device does not support them.
+class PipelineLibrary
+{
+  public:
+    using SetLayoutHandle = pinut::resources::DescriptorSetLayoutHandle;
+
+    void init(pinut::GPUDevice* new_device);
+    void shutdown();
+
+    bool load(const std::string& filename, const pinut::resources::ViewportDescriptor& viewport);
+
+    SetLayoutHandle get_set_layout(const std::string& pipeline, u32 set) const;
+
+  private:
+    pinut::GPUDevice*                                   device = nullptr;
+    std::vector<std::unique_ptr<PipelineSpec>>          specs;
+    std::map<std::string, std::vector<SetLayoutHandle>> pipeline_set_layouts;
+};
+} // namespace sogas
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <engine/geometry.h>
+
+namespace sogas
+{
+// Faces of a point light shadow, in this order in the atlas.
+static const u32 POINT_SHADOW_FACES = 6;
+
+// Matches the ShadowView struct of the forward shaders, std430.
+struct ShadowView
+{
+    glm::mat4 view_projection = glm::mat4(1.0f);
+    // Offset and scale of the tile in atlas uvs.
+    glm::vec4 atlas_rect      = glm::vec4(0.0f);
+};
+
+struct ShadowLight
+{
+    glm::vec3 position  = glm::vec3(0.0f);
+    glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+    f32       radius    = 1.0f;
+    // Full cone angle in radians, 0 for point lights which take one tile per cube face.
+    f32       cone      = 0.0f;
+
+    bool operator==(const ShadowLight& other) const = default;
+};
+
+struct ShadowAtlasDescriptor
+{
+    u32 size      = 4096;
+    u32 tile_size = 512;
+};
+
+// Vulkan ready projections, with the y axis flipped like the camera one.
+glm::mat4 get_spot_shadow_matrix(const ShadowLight& light);
+glm::mat4 get_point_shadow_matrix(const ShadowLight& light, u32 face);
+
+// Packs the shadow maps of every shadowed light into fixed size tiles of one depth texture.
+// Tiles are kept across frames and only rendered again when they get dirty: the light is new or
+// changed, or a caster moved inside its radius. Lights not added during a frame free their tiles.
+class ShadowAtlas
+{
+  public:
+    void init(const ShadowAtlasDescriptor& new_descriptor = {});
+
+    void begin_frame();
+    // Returns the first view of the light, point lights use six in a row. -1 when out of tiles.
+    i32  add_light(u64 id, const ShadowLight& light);
+    // Casters should be invalidated with their bounds both before and after moving.
+    void invalidate(const BoundingSphere& caster);
+    void end_frame();
+
+    // Views to render, cleared by mark_rendered.
+    std::vector<u32> get_dirty_views() const;
+    void             mark_rendered();
+
+    // Light the view belongs to, its caster bounds.
+    BoundingSphere get_view_bounds(u32 view) const;
+    // Tile of the view, in atlas pixels.
+    glm::uvec4     get_view_rect(u32 view) const;
+
+    const ShadowAtlasDescriptor&   get_descriptor() const;
+    const std::vector<ShadowView>& get_views() const;
+
+  private:
+    struct ShadowEntry
+    {
+        ShadowLight light;
+        u32         first_tile = 0;
+        u32         tile_count = 0;
+        bool        used       = false;
+        bool        dirty      = true;
+    };
+
+    i32  allocate_tiles(u32 count);
+    void free_tiles(const ShadowEntry& entry);
+    void update_views(const ShadowEntry& entry);
+
+    ShadowAtlasDescriptor      descriptor;
+    u32                        tiles_per_row = 0;
+    std::vector<ShadowView>    views;
+    std::vector<bool>          tile_used;
+    std::map<u64, ShadowEntry> entries;
+};
+} // namespace sogas
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <resources/resources.h>
+
+namespace pinut
+{
+class GPUDevice;
+}
+
+namespace sogas
+{
+// Uploads a blob written by the texture cooker straight from the mapped file, every level is
+// already compressed and mipped so nothing is decoded at runtime. Returns an invalid handle when
+// the file is missing or malformed.
+pinut::resources::TextureHandle load_cooked_texture(pinut::GPUDevice*  device,
+                                                    const std::string& filename);
+} // namespace sogas
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <engine/geometry.h>
+#include <resources/cooked_texture.h>
+#include <resources/resources.h>
+
+namespace pinut
+{
+class GPUDevice;
+}
+
+namespace sogas
+{
+using StreamedTextureId = u32;
+
+// Pixels covered by the diameter of the sphere on a perspective view of the given height.
+f32 get_projected_diameter(const BoundingSphere& sphere,
+                           const glm::vec3&      eye,
+                           f32                   fov,
+                           f32                   viewport_height);
+// Finest mip worth having resident for a texture spanning projected_size pixels on screen,
+// assuming its uvs cover the object once.
+u32 get_requested_mip(u32 width, u32 height, u32 mip_levels, f32 projected_size);
+
+struct TextureStreamerDescriptor
+{
+    u64 budget_bytes         = 256 * 1024 * 1024;
+    // Levels this size and smaller are always resident, they are uploaded on add_texture.
+    u32 tail_size            = 64;
+    u32 thread_count         = 2;
+    u32 max_loads_per_update = 4;
+};
+
+// Keeps cooked textures mapped and their GPU copy limited to the mips requested on screen.
+// Finer mips are read on background threads and uploaded on update, when the budget is exceeded
+// the mips of the least recently requested textures are dropped first. Uploading or dropping
+// mips recreates the GPU texture, so handles must be fetched again after update reports changes.
+class TextureStreamer
+{
+  public:
+    void init(pinut::GPUDevice* new_device, const TextureStreamerDescriptor& new_descriptor = {});
+    void shutdown();
+
+    // Only the mip tail is uploaded, returns INVALID_ID if the blob can not be mapped.
+    StreamedTextureId add_texture(const std::string& filename);
+
+    // Requests last one frame, the finest one wins.
+    void request_mip(StreamedTextureId id, u32 mip);
+    void request_projected_size(StreamedTextureId id, f32 projected_size);
+
+    // Uploads finished loads, evicts over budget and queues new loads. Returns whether any
+    // texture handle changed.
+    bool update();
+
+    pinut::resources::TextureHandle get_texture(StreamedTextureId id) const;
+    u32                             get_resident_mip(StreamedTextureId id) const;
+    u64                             get_resident_bytes() const;
+
+  private:
+    struct StreamedTexture
+    {
+        platform::Mapped_file                 file;
+        pinut::resources::CookedTextureHeader header;
+        const u8*                             data = nullptr;
+        pinut::resources::TextureHandle       handle{INVALID_ID};
+
+        u32 resident_mip    = 0;
+        u32 tail_mip        = 0;
+        u32 requested_mip   = 0;
+        u32 loading_mip     = INVALID_ID;
+        u64 last_used_frame = 0;
+    };
+
+    struct LoadRequest
+    {
+        StreamedTextureId id;
+        u32               first_mip;
+        const u8*         source;
+        u64               size;
+        std::vector<u8>   data;
+    };
+
+    void worker_loop();
+    void upload(StreamedTexture& texture, u32 first_mip, const u8* data);
+    u64  get_resident_size(const StreamedTexture& texture, u32 first_mip) const;
+
+    pinut::GPUDevice*            device = nullptr;
+    TextureStreamerDescriptor    descriptor;
+    std::vector<StreamedTexture> textures;
+    u64                          frame          = 0;
+    u64                          resident_bytes = 0;
+
+    std::vector<std::thread> workers;
+    std::mutex               mutex;
+    std::condition_variable  condition;
+    std::deque<LoadRequest>  pending_loads;
+    std::vector<LoadRequest> completed_loads;
+    bool                     stopping = false;
+};
+} // namespace sogas
@@ -24,7 +24,11 @@ void NameComponent::set_name(const std::string& new_name)
 
     if (it == all_names.end())
     {
+#ifdef _WIN64
         strcpy_s(name, new_name.c_str());
+#else
+        snprintf(name, max_length, "%s", new_name.c_str());
+#endif
         all_names[name] = Handle(this);
     }
 }
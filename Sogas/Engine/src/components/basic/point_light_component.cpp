@@ -17,9 +17,10 @@ void PointLightComponent::load(const json& j, EntityParser& /*context*/)
         color = load_vec4(j["color"]);
     }
 
-    radius    = j.value("radius", radius);
-    enabled   = j.value("enabled", enabled);
-    intensity = j.value("intensity", intensity);
+    radius        = j.value("radius", radius);
+    enabled       = j.value("enabled", enabled);
+    intensity     = j.value("intensity", intensity);
+    casts_shadows = j.value("casts_shadows", casts_shadows);
 }
 void PointLightComponent::render_debug(pinut::resources::CommandBuffer* cmd)
 {
@@ -36,5 +37,6 @@ void PointLightComponent::render_debug_menu()
     ImGui::DragFloat("Radius", &radius, 0.01f, 0.0f, 100.0f);
     ImGui::DragFloat("Intensity", &intensity, 0.1f, 0.0f, 100.0f);
     ImGui::Checkbox("Enabled", &enabled);
+    ImGui::Checkbox("Casts shadows", &casts_shadows);
 }
 } // namespace sogas
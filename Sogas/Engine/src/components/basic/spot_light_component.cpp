@@ -0,0 +1,43 @@
+#include "pch.hpp"
+
+#include <components/basic/spot_light_component.h>
+#include <components/basic/transform_component.h>
+#include <engine/primitives.h>
+#include <imgui/imgui.h>
+#include <render_device.h>
+#include <resources/json_helper.h>
+
+namespace sogas
+{
+DECLARE_OBJECT_MANAGER("spot_light", SpotLightComponent);
+void SpotLightComponent::load(const json& j, EntityParser& /*context*/)
+{
+    if (j.count("color"))
+    {
+        color = load_vec4(j["color"]);
+    }
+
+    radius        = j.value("radius", radius);
+    angle         = j.value("angle", angle);
+    enabled       = j.value("enabled", enabled);
+    intensity     = j.value("intensity", intensity);
+    casts_shadows = j.value("casts_shadows", casts_shadows);
+}
+void SpotLightComponent::render_debug(pinut::resources::CommandBuffer* cmd)
+{
+    TransformComponent* transform_component = get<TransformComponent>();
+    const auto          position            = transform_component->get_position();
+    draw_line(cmd, position, position + transform_component->get_forward() * radius, color);
+    draw_wired_sphere(cmd, glm::translate(glm::mat4(1.0f), position), 0.25f, color);
+}
+
+void SpotLightComponent::render_debug_menu()
+{
+    ImGui::ColorEdit4("Light color", &color[0]);
+    ImGui::DragFloat("Radius", &radius, 0.01f, 0.0f, 100.0f);
+    ImGui::DragFloat("Angle", &angle, 0.1f, 1.0f, 170.0f);
+    ImGui::DragFloat("Intensity", &intensity, 0.1f, 0.0f, 100.0f);
+    ImGui::Checkbox("Enabled", &enabled);
+    ImGui::Checkbox("Casts shadows", &casts_shadows);
+}
+} // namespace sogas
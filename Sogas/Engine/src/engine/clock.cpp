@@ -1,32 +1,17 @@
 #include "pch.hpp"
 
+#include <algorithm>
+#include <chrono>
+
 #include <engine/clock.h>
 
 namespace
 {
-static LARGE_INTEGER initial_time;
-static f64           frequency_timer;
-
-void setup_timer()
-{
-    LARGE_INTEGER frequency; // counts / second
-    QueryPerformanceFrequency(&frequency);
-    frequency_timer = 1.0 / (f64)frequency.QuadPart;
-    QueryPerformanceCounter(&initial_time); // counts
-}
-
-static const f64 get_current_time()
+static f64 get_current_time()
 {
-    // If no timer, start timer.
-    if (!frequency_timer)
-    {
-        setup_timer();
-    }
-
-    LARGE_INTEGER now;
-    QueryPerformanceCounter(&now);
-    // return value in micro seconds
-    return (f64)now.QuadPart * frequency_timer;
+    // Counted from an arbitrary point, never zero in practice, so zero still marks a stopped clock.
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<f64>(now).count();
 }
 } // namespace
 
@@ -50,4 +35,49 @@ void stop_clock(Clock* clock)
 {
     clock->start_time = 0;
 }
+
+u32 advance_fixed_timestep(FixedTimestep* timestep, f64 frame_time)
+{
+    ASSERT(timestep->step > 0);
+
+    timestep->accumulator += std::clamp(frame_time, 0.0, timestep->max_frame_time);
+
+    u32 steps = 0;
+    while (timestep->accumulator >= timestep->step)
+    {
+        timestep->accumulator -= timestep->step;
+        ++steps;
+    }
+
+    return steps;
+}
+
+f32 get_fixed_timestep_alpha(const FixedTimestep* timestep)
+{
+    return static_cast<f32>(timestep->accumulator / timestep->step);
+}
+
+void add_frame_time(FrameTimeStats* stats, f64 frame_time)
+{
+    stats->frame_times[stats->next] = frame_time;
+    stats->next                     = (stats->next + 1) % FrameTimeStats::HISTORY_SIZE;
+    stats->count                    = std::min(stats->count + 1, FrameTimeStats::HISTORY_SIZE);
+}
+
+f64 get_frame_time_percentile(const FrameTimeStats* stats, f64 percentile)
+{
+    if (stats->count == 0)
+    {
+        return 0.0;
+    }
+
+    // Until the ring is full the recorded times are the first count entries.
+    f64 sorted[FrameTimeStats::HISTORY_SIZE];
+    std::copy(stats->frame_times, stats->frame_times + stats->count, sorted);
+
+    const f64  rank  = std::clamp(percentile, 0.0, 1.0) * (stats->count - 1);
+    const auto index = static_cast<u32>(rank + 0.5);
+    std::nth_element(sorted, sorted + index, sorted + stats->count);
+    return sorted[index];
+}
 } // namespace sogas
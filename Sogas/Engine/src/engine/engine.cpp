@@ -11,13 +11,19 @@
 #include <platform/platform.h>
 #include <resources/mesh.h>
 
+#ifdef _WIN64
 LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
+#endif
 
 namespace
 {
 using namespace sogas::platform;
 Window_id window;
 
+// Keys are indexed by Windows virtual key codes on every platform.
+constexpr i32 KEY_F1 = 0x70;
+
+#ifdef _WIN64
 LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 {
 #if _DEBUG
@@ -95,12 +101,12 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
     return DefWindowProc(hWnd, message, wParam, lParam);
 }
+#endif
 } // namespace
 
 namespace sogas
 {
-Engine*    Engine::engine_instance = nullptr;
-static f64 time_stamp;
+Engine* Engine::engine_instance = nullptr;
 
 Engine& Engine::Get()
 {
@@ -109,14 +115,25 @@ Engine& Engine::Get()
 
 void Engine::init()
 {
+    log::init();
+    log::add_sink(std::make_unique<log::FileSink>("sogas.log"));
+
     PDEBUG("Initializing engine!");
 
     engine_instance = this;
 
+    memory_init();
+
+    profiler::set_thread_name("Main");
+
     // TODO If more than one main window ... (should not happen) close the program only when the last is closed.
     // Should have a way to check for that ... maybe a vector or array of windows.
 
+#ifdef _WIN64
     platform::window_init_info init_info{"Sogas Engine", nullptr, WndProc, 100, 100, 1280, 720};
+#else
+    platform::window_init_info init_info{"Sogas Engine", nullptr, nullptr, 100, 100, 1280, 720};
+#endif
     window = platform::create_window(&init_info);
 
     // TODO register modules
@@ -141,6 +158,7 @@ void Engine::init()
     clock = new Clock();
     start_clock(clock);
     update_clock(clock);
+    last_time = clock->elapsed_time;
 }
 
 void Engine::run()
@@ -153,18 +171,17 @@ void Engine::run()
     // Platform check for messages
     // If no messages, do frame
 
-    bool should_quit{false};
-    while (!should_quit)
+    while (!platform::peek_message())
     {
-        should_quit = platform::peek_message();
-
         update_clock(clock);
-        f64 current_time = clock->elapsed_time;
-        delta_time       = (current_time - last_time) / 10000;
+        const f64 current_time = clock->elapsed_time;
+        delta_time             = current_time - last_time;
+        last_time              = current_time;
+        add_frame_time(&frame_time_stats, delta_time);
 
         if (auto input = get_input())
         {
-            if (input->get_key(VK_F1).gets_released())
+            if (input->get_key(KEY_F1).gets_released())
             {
                 auto renderer         = get_renderer();
                 bool enable_wireframe = renderer->get_wireframe_enabled();
@@ -181,6 +198,11 @@ void Engine::shutdown()
     stop_clock(clock);
     delete clock;
 
+    PINFO("Frame times p50 %.3f ms, p99 %.3f ms over the last %u frames.",
+          get_frame_time_percentile(&frame_time_stats, 0.5) * 1000.0,
+          get_frame_time_percentile(&frame_time_stats, 0.99) * 1000.0,
+          frame_time_stats.count);
+
     PDEBUG("Shuting down engine!");
     platform::remove_window(window);
 
@@ -192,6 +214,10 @@ void Engine::shutdown()
     meshes.clear();
 
     module_manager.clear();
+
+    memory_shutdown();
+
+    log::shutdown();
 }
 
 void Engine::resize(u32 width, u32 height)
@@ -211,12 +237,26 @@ std::shared_ptr<modules::RendererModule> Engine::get_renderer()
 
 void Engine::do_frame()
 {
+    get_frame_allocator()->clear();
+
     // Calculate delta time
     // Modules update here
     // Update Input
     // Update physics
     // Update graphics
-    module_manager.update((f32)delta_time);
-    module_manager.render();
+    {
+        PROFILE_ZONE("Frame");
+
+        const u32 steps = advance_fixed_timestep(&fixed_timestep, delta_time);
+        for (u32 i = 0; i < steps; ++i)
+        {
+            module_manager.fixed_update(static_cast<f32>(fixed_timestep.step));
+        }
+
+        module_manager.update((f32)delta_time);
+        module_manager.render();
+    }
+
+    profiler::end_frame();
 }
 } // namespace sogas
@@ -21,7 +21,7 @@ ContainmentType BoundingSphere::contains(const BoundingSphere& /*sphere*/) const
 bool BoundingSphere::intersects(const BoundingSphere& sphere) const
 {
     const auto distance = glm::length(center - sphere.center);
-    return distance < radius ? true : false;
+    return distance < radius + sphere.radius;
 }
 
 bool BoundingSphere::intersects(const glm::vec3& /*origin*/,
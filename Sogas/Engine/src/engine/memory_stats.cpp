@@ -0,0 +1,160 @@
+#include "pch.hpp"
+
+#include <engine/memory_stats.h>
+#include <handle/handle_manager.h>
+#include <imgui/imgui.h>
+
+namespace sogas
+{
+static MemoryTag get_memory_tag(const std::string& name)
+{
+    for (u32 i = 0; i < static_cast<u32>(MemoryTag::COUNT); ++i)
+    {
+        if (name == get_memory_tag_name(static_cast<MemoryTag>(i)))
+        {
+            return static_cast<MemoryTag>(i);
+        }
+    }
+
+    return MemoryTag::COUNT;
+}
+
+json get_memory_stats_json()
+{
+    json j = json::object();
+    for (u32 i = 0; i < static_cast<u32>(MemoryTag::COUNT); ++i)
+    {
+        const auto tag   = static_cast<MemoryTag>(i);
+        const auto stats = get_memory_stats(tag);
+
+        j[get_memory_tag_name(tag)] = {{"current", stats.current},
+                                       {"peak", stats.peak},
+                                       {"allocations", stats.allocations},
+                                       {"budget", stats.budget}};
+    }
+
+    return j;
+}
+
+bool dump_memory_stats(const std::string& filename)
+{
+    std::ofstream ofs(filename.c_str());
+    if (!ofs.is_open())
+    {
+        PLOG(ERROR, MEMORY, "Could not write memory stats to %s.", filename.c_str());
+        return false;
+    }
+
+    ofs << get_memory_stats_json().dump(4);
+    return true;
+}
+
+void load_memory_budgets(const json& j)
+{
+    ASSERT(j.is_object());
+
+    for (const auto& budget : j.items())
+    {
+        const auto tag = get_memory_tag(budget.key());
+        if (tag == MemoryTag::COUNT)
+        {
+            PLOG(WARNING, MEMORY, "Unknown memory tag %s.", budget.key().c_str());
+            continue;
+        }
+
+        set_memory_budget(tag, budget.value().get<u64>());
+    }
+}
+
+static void memory_text(const u64 bytes)
+{
+    ImGui::Text("%.2f KB", static_cast<f64>(bytes) / 1024.0);
+}
+
+void render_memory_stats_menu()
+{
+    if (!ImGui::TreeNode("Memory"))
+    {
+        return;
+    }
+
+    if (ImGui::BeginTable("memory_tags", 5))
+    {
+        ImGui::TableSetupColumn("Tag");
+        ImGui::TableSetupColumn("Current");
+        ImGui::TableSetupColumn("Peak");
+        ImGui::TableSetupColumn("Budget");
+        ImGui::TableSetupColumn("Allocations");
+        ImGui::TableHeadersRow();
+
+        for (u32 i = 0; i < static_cast<u32>(MemoryTag::COUNT); ++i)
+        {
+            const auto tag   = static_cast<MemoryTag>(i);
+            const auto stats = get_memory_stats(tag);
+            const bool is_over_budget = stats.budget > 0 && stats.current > stats.budget;
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            if (is_over_budget)
+            {
+                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", get_memory_tag_name(tag));
+            }
+            else
+            {
+                ImGui::Text("%s", get_memory_tag_name(tag));
+            }
+            ImGui::TableNextColumn();
+            memory_text(stats.current);
+            ImGui::TableNextColumn();
+            memory_text(stats.peak);
+            ImGui::TableNextColumn();
+            if (stats.budget > 0)
+            {
+                memory_text(stats.budget);
+            }
+            else
+            {
+                ImGui::Text("-");
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", stats.allocations);
+        }
+
+        ImGui::EndTable();
+    }
+
+    if (ImGui::Button("Reset peaks"))
+    {
+        for (u32 i = 0; i < static_cast<u32>(MemoryTag::COUNT); ++i)
+        {
+            reset_memory_peak(static_cast<MemoryTag>(i));
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Dump to memory_stats.json"))
+    {
+        dump_memory_stats("memory_stats.json");
+    }
+
+    // Used against capacity of every pool, to size them in components.json.
+    if (ImGui::TreeNode("Object pools"))
+    {
+        for (u32 i = 0; i < HandleManager::get_number_of_defined_types(); ++i)
+        {
+            const auto manager = HandleManager::get_by_type(i);
+            if (manager == nullptr)
+            {
+                continue;
+            }
+
+            ImGui::Text("%s: %u / %u",
+                        manager->get_name().c_str(),
+                        manager->get_size(),
+                        manager->get_pool_size());
+        }
+        ImGui::TreePop();
+    }
+
+    ImGui::TreePop();
+}
+} // namespace sogas
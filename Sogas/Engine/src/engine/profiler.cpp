@@ -0,0 +1,376 @@
+#include "pch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#include <engine/profiler.h>
+#include <imgui/imgui.h>
+
+namespace
+{
+using namespace sogas;
+using namespace sogas::profiler;
+
+// Zones of one thread. Only the owner writes, publishing each zone with write_index, and only
+// end_frame reads. A thread ending more zones than the buffer holds in a single frame overwrites
+// the oldest ones.
+struct ThreadBuffer
+{
+    static constexpr u64 capacity = 1 << 14;
+
+    Zone             zones[capacity];
+    std::atomic<u64> write_index = 0;
+    u64              read_index  = 0;
+    u32              depth       = 0;
+    u32              index       = 0;
+    std::string      name;
+};
+
+// Buffers are never freed, so zones of a thread that already ended are still collected.
+std::mutex                                 registry_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> thread_buffers;
+thread_local ThreadBuffer*                 thread_buffer = nullptr;
+
+Frame last_frame;
+Frame collected_frame;
+u64   frame_start = 0;
+u64   dropped     = 0;
+bool  is_paused   = false;
+
+std::vector<Frame> capture;
+u32                capture_frames_left = 0;
+std::string        capture_filename;
+
+// Callers hold the registry lock.
+ThreadBuffer* create_buffer()
+{
+    auto buffer   = std::make_unique<ThreadBuffer>();
+    buffer->index = static_cast<u32>(thread_buffers.size());
+    buffer->name  = "Thread " + std::to_string(buffer->index);
+    thread_buffers.push_back(std::move(buffer));
+    return thread_buffers.back().get();
+}
+
+ThreadBuffer* get_thread_buffer()
+{
+    if (thread_buffer == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        thread_buffer = create_buffer();
+    }
+
+    return thread_buffer;
+}
+
+void push_zone(ThreadBuffer& buffer, const Zone& zone)
+{
+    const u64 write_index = buffer.write_index.load(std::memory_order_relaxed);
+    buffer.zones[write_index & (ThreadBuffer::capacity - 1)] = zone;
+    buffer.write_index.store(write_index + 1, std::memory_order_release);
+}
+
+void drain(ThreadBuffer& buffer, std::vector<Zone>& zones)
+{
+    const u64 write_index = buffer.write_index.load(std::memory_order_acquire);
+    u64       read_index  = buffer.read_index;
+    if (write_index - read_index > ThreadBuffer::capacity)
+    {
+        dropped += write_index - read_index - ThreadBuffer::capacity;
+        read_index = write_index - ThreadBuffer::capacity;
+    }
+
+    for (; read_index < write_index; ++read_index)
+    {
+        zones.push_back(buffer.zones[read_index & (ThreadBuffer::capacity - 1)]);
+    }
+    buffer.read_index = write_index;
+}
+
+// Stable per name, so a zone keeps its colour from frame to frame.
+u32 get_zone_color(const char* name)
+{
+    u32 hash = 2166136261u;
+    for (; *name; ++name)
+    {
+        hash = (hash ^ static_cast<u8>(*name)) * 16777619u;
+    }
+
+    const u32 r = 96 + (hash & 0x7F);
+    const u32 g = 96 + ((hash >> 8) & 0x7F);
+    const u32 b = 96 + ((hash >> 16) & 0x7F);
+    return IM_COL32(r, g, b, 255);
+}
+} // namespace
+
+namespace sogas
+{
+namespace profiler
+{
+ScopedZone::ScopedZone(const char* new_name) : name(new_name), start(get_time())
+{
+    get_thread_buffer()->depth++;
+}
+
+ScopedZone::~ScopedZone()
+{
+    auto buffer = get_thread_buffer();
+    buffer->depth--;
+    push_zone(*buffer, {name, start, get_time(), buffer->depth, buffer->index});
+}
+
+u64 get_time()
+{
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now().time_since_epoch())
+                              .count());
+}
+
+u32 create_lane(const char* name)
+{
+    std::lock_guard<std::mutex> lock(registry_mutex);
+
+    auto buffer  = create_buffer();
+    buffer->name = name;
+    return buffer->index;
+}
+
+void add_zone(u32 lane, const char* name, u64 start, u64 end, u32 depth)
+{
+    ThreadBuffer* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        buffer = thread_buffers.at(lane).get();
+    }
+
+    push_zone(*buffer, {name, start, end, depth, lane});
+}
+
+void set_thread_name(const char* name)
+{
+    auto buffer = get_thread_buffer();
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    buffer->name = name;
+}
+
+std::string get_thread_name(u32 thread)
+{
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    return thread < thread_buffers.size() ? thread_buffers.at(thread)->name : std::string();
+}
+
+void end_frame()
+{
+    const u64 now = get_time();
+
+    collected_frame.start = frame_start != 0 ? frame_start : now;
+    collected_frame.end   = now;
+    collected_frame.zones.clear();
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (auto& buffer : thread_buffers)
+        {
+            drain(*buffer, collected_frame.zones);
+        }
+    }
+    frame_start = now;
+
+    if (capture_frames_left > 0)
+    {
+        capture.push_back(collected_frame);
+        if (--capture_frames_left == 0)
+        {
+            export_chrome_trace(capture_filename, capture);
+            capture.clear();
+        }
+    }
+
+    // Paused keeps showing the same frame, the buffers are still drained so they do not overflow.
+    if (!is_paused)
+    {
+        std::swap(last_frame, collected_frame);
+    }
+}
+
+const Frame& get_last_frame()
+{
+    return last_frame;
+}
+
+void start_capture(u32 frame_count, const std::string& filename)
+{
+    ASSERT(frame_count > 0);
+
+    capture.clear();
+    capture.reserve(frame_count);
+    capture_frames_left = frame_count;
+    capture_filename    = filename;
+}
+
+bool is_capturing()
+{
+    return capture_frames_left > 0;
+}
+
+json get_chrome_trace_json(const std::vector<Frame>& frames)
+{
+    json events = json::array();
+
+    u32 thread_count = 0;
+    for (const auto& frame : frames)
+    {
+        for (const auto& zone : frame.zones)
+        {
+            // Complete events, timestamps and durations in microseconds.
+            events.push_back({{"name", zone.name},
+                              {"ph", "X"},
+                              {"ts", static_cast<f64>(zone.start) / 1000.0},
+                              {"dur", static_cast<f64>(zone.end - zone.start) / 1000.0},
+                              {"pid", 0},
+                              {"tid", zone.thread}});
+            thread_count = std::max(thread_count, zone.thread + 1);
+        }
+    }
+
+    for (u32 thread = 0; thread < thread_count; ++thread)
+    {
+        events.push_back({{"name", "thread_name"},
+                          {"ph", "M"},
+                          {"pid", 0},
+                          {"tid", thread},
+                          {"args", {{"name", get_thread_name(thread)}}}});
+    }
+
+    return {{"traceEvents", events}, {"displayTimeUnit", "ms"}};
+}
+
+bool export_chrome_trace(const std::string& filename, const std::vector<Frame>& frames)
+{
+    std::ofstream ofs(filename.c_str());
+    if (!ofs.is_open())
+    {
+        PERROR("Could not write the profiler trace to %s.", filename.c_str());
+        return false;
+    }
+
+    ofs << get_chrome_trace_json(frames).dump();
+    PINFO("Profiler trace of %llu frames written to %s.",
+          static_cast<u64>(frames.size()),
+          filename.c_str());
+    return true;
+}
+
+void render_profiler_menu()
+{
+    if (!ImGui::TreeNode("Profiler"))
+    {
+        return;
+    }
+
+    const auto& frame    = last_frame;
+    const u64   duration = std::max<u64>(frame.end - frame.start, 1);
+    ImGui::Text("CPU frame: %.3f ms, %llu zones, %llu dropped",
+                static_cast<f64>(duration) / 1000000.0,
+                static_cast<u64>(frame.zones.size()),
+                dropped);
+
+    ImGui::Checkbox("Pause", &is_paused);
+    ImGui::SameLine();
+    if (is_capturing())
+    {
+        ImGui::Text("Capturing, %u frames left", capture_frames_left);
+    }
+    else if (ImGui::Button("Capture 120 frames"))
+    {
+        start_capture(120, "profile.json");
+    }
+
+    // Lanes per thread, deeper zones go below the one containing them.
+    std::vector<u32> lanes;
+    for (const auto& zone : frame.zones)
+    {
+        if (zone.thread >= lanes.size())
+        {
+            lanes.resize(zone.thread + 1, 0);
+        }
+        lanes.at(zone.thread) = std::max(lanes.at(zone.thread), zone.depth + 1);
+    }
+
+    std::vector<u32> first_row(lanes.size(), 0);
+    u32              row_count = 0;
+    for (u32 thread = 0; thread < lanes.size(); ++thread)
+    {
+        if (lanes.at(thread) > 0)
+        {
+            // One row for the thread name.
+            first_row.at(thread) = row_count + 1;
+            row_count += lanes.at(thread) + 1;
+        }
+    }
+
+    // GPU zones come back a few frames late, the view reaches back up to three frames to show
+    // them. A line marks where the last frame started.
+    u64 view_start = frame.start;
+    for (const auto& zone : frame.zones)
+    {
+        view_start = std::min(view_start, zone.start);
+    }
+    view_start = std::max(view_start, frame.start - std::min(frame.start, 3 * duration));
+
+    auto         draw_list  = ImGui::GetWindowDrawList();
+    const ImVec2 origin     = ImGui::GetCursorScreenPos();
+    const f32    width      = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+    const f32    row_height = ImGui::GetTextLineHeightWithSpacing();
+    const f64    scale      = width / static_cast<f64>(std::max<u64>(frame.end - view_start, 1));
+
+    for (u32 thread = 0; thread < lanes.size(); ++thread)
+    {
+        if (lanes.at(thread) > 0)
+        {
+            const f32 y = origin.y + (first_row.at(thread) - 1) * row_height;
+            draw_list->AddText(ImVec2(origin.x, y),
+                               IM_COL32(255, 255, 255, 255),
+                               get_thread_name(thread).c_str());
+        }
+    }
+
+    for (const auto& zone : frame.zones)
+    {
+        // Zones of other threads may start long before or end while the frame is collected.
+        if (zone.end < view_start || zone.start > frame.end)
+        {
+            continue;
+        }
+        const u64 start = std::max(zone.start, view_start) - view_start;
+        const u64 end   = std::min(zone.end, frame.end) - view_start;
+
+        const f32    y = origin.y + (first_row.at(zone.thread) + zone.depth) * row_height;
+        const ImVec2 min(origin.x + static_cast<f32>(start * scale), y);
+        const ImVec2 max(std::max(origin.x + static_cast<f32>(end * scale), min.x + 1.0f),
+                         y + row_height - 1.0f);
+
+        draw_list->AddRectFilled(min, max, get_zone_color(zone.name));
+        if (ImGui::CalcTextSize(zone.name).x < max.x - min.x)
+        {
+            draw_list->AddText(ImVec2(min.x + 2.0f, min.y), IM_COL32(0, 0, 0, 255), zone.name);
+        }
+
+        if (ImGui::IsMouseHoveringRect(min, max))
+        {
+            ImGui::SetTooltip("%s: %.3f ms",
+                              zone.name,
+                              static_cast<f64>(zone.end - zone.start) / 1000000.0);
+        }
+    }
+
+    const f32 frame_x = origin.x + static_cast<f32>((frame.start - view_start) * scale);
+    draw_list->AddLine(ImVec2(frame_x, origin.y),
+                       ImVec2(frame_x, origin.y + row_count * row_height),
+                       IM_COL32(255, 255, 255, 255));
+
+    ImGui::Dummy(ImVec2(width, row_count * row_height));
+    ImGui::TreePop();
+}
+} // namespace profiler
+} // namespace sogas
@@ -1,5 +1,8 @@
 #include "pch.hpp"
 
+#include <bit>
+#include <cstddef>
+
 #include <engine/smemory.h>
 
 namespace sogas
@@ -10,6 +13,18 @@ static u64 memory_align(const u64 size, const u64 alignment)
     return (size + alignment_mask) & ~alignment_mask;
 }
 
+// Offset from base of the first address past offset with the given alignment.
+static u64 memory_align_offset(const u8* base, const u64 offset, const u64 alignment)
+{
+    const u64 address = reinterpret_cast<u64>(base) + offset;
+    return memory_align(address, alignment) - reinterpret_cast<u64>(base);
+}
+
+static bool is_power_of_two(const u64 value)
+{
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
 void StackAllocator::init(const u64 size)
 {
     memory           = (u8*)malloc(size);
@@ -25,8 +40,11 @@ void StackAllocator::shutdown()
 void* StackAllocator::allocate(const u64 size, const u64 alignment)
 {
     ASSERT(size > 0);
+    ASSERT(is_power_of_two(alignment));
 
-    const u64 new_memory_start = memory_align(allocated_memory, alignment);
+    // The previous top is stored right before the returned memory.
+    const u64 new_memory_start =
+      memory_align_offset(memory, allocated_memory + sizeof(u64), alignment);
 
     ASSERT(new_memory_start < total_memory);
 
@@ -34,10 +52,12 @@ void* StackAllocator::allocate(const u64 size, const u64 alignment)
 
     if (new_allocated_memory > total_memory)
     {
-        PWARN("Not enough memory to allocate.");
+        PLOG(WARNING, MEMORY, "Not enough memory to allocate.");
         return nullptr;
     }
 
+    memcpy(memory + new_memory_start - sizeof(u64), &allocated_memory, sizeof(u64));
+
     allocated_memory = new_allocated_memory;
     return memory + new_memory_start;
 }
@@ -48,8 +68,7 @@ void StackAllocator::deallocate(void* pointer)
     ASSERT(pointer < memory + total_memory);
     ASSERT(pointer < memory + allocated_memory);
 
-    const u64 memory_at_pointer = (u8*)pointer - memory;
-    allocated_memory            = memory_at_pointer;
+    memcpy(&allocated_memory, (u8*)pointer - sizeof(u64), sizeof(u64));
 }
 
 u64 StackAllocator::get_marker()
@@ -59,7 +78,7 @@ u64 StackAllocator::get_marker()
 
 void StackAllocator::free_marker(u64 marker)
 {
-    if (allocated_memory - marker > 0)
+    if (marker < allocated_memory)
     {
         allocated_memory = marker;
     }
@@ -69,4 +88,608 @@ void StackAllocator::clear()
 {
     allocated_memory = 0;
 }
+
+void* DoubleStackEnd::allocate(const u64 size, const u64 alignment)
+{
+    return is_top ? stack->allocate_top(size, alignment) : stack->allocate_bottom(size, alignment);
+}
+
+void DoubleStackEnd::deallocate(void* pointer)
+{
+    ASSERT(pointer >= stack->memory);
+    ASSERT(pointer < stack->memory + stack->total_memory);
+}
+
+void DoubleStackAllocator::init(const u64 size)
+{
+    memory       = (u8*)malloc(size);
+    total_memory = size;
+    top          = size;
+    bottom       = 0;
+
+    top_end    = {};
+    bottom_end = {};
+
+    top_end.stack     = this;
+    top_end.is_top    = true;
+    bottom_end.stack  = this;
+    bottom_end.is_top = false;
+}
+
+void DoubleStackAllocator::shutdown()
+{
+    free(memory);
+    memory = nullptr;
+}
+
+void* DoubleStackAllocator::allocate_top(const u64 size, const u64 alignment)
+{
+    ASSERT(size > 0);
+    ASSERT(is_power_of_two(alignment));
+
+    if (size > top - bottom)
+    {
+        PLOG(WARNING, MEMORY, "Not enough memory to allocate.");
+        return nullptr;
+    }
+
+    // Growing down, so the start of the allocation is aligned down.
+    const u64 base    = reinterpret_cast<u64>(memory);
+    const u64 address = (base + top - size) & ~(alignment - 1);
+
+    if (address < base + bottom)
+    {
+        PLOG(WARNING, MEMORY, "Not enough memory to allocate.");
+        return nullptr;
+    }
+
+    const u64 new_start = address - base;
+
+    top = new_start;
+    return memory + top;
+}
+
+void* DoubleStackAllocator::allocate_bottom(const u64 size, const u64 alignment)
+{
+    ASSERT(size > 0);
+    ASSERT(is_power_of_two(alignment));
+
+    const u64 new_start      = memory_align_offset(memory, bottom, alignment);
+    const u64 new_allocation = new_start + size;
+
+    if (new_allocation > top)
+    {
+        PLOG(WARNING, MEMORY, "Not enough memory to allocate.");
+        return nullptr;
+    }
+
+    bottom = new_allocation;
+    return memory + new_start;
+}
+
+u64 DoubleStackAllocator::get_top_marker()
+{
+    return top;
+}
+
+u64 DoubleStackAllocator::get_bottom_marker()
+{
+    return bottom;
+}
+
+void DoubleStackAllocator::free_top_marker(u64 marker)
+{
+    if (marker > top && marker <= total_memory)
+    {
+        top = marker;
+    }
+}
+
+void DoubleStackAllocator::free_bottom_marker(u64 marker)
+{
+    if (marker < bottom)
+    {
+        bottom = marker;
+    }
+}
+
+void DoubleStackAllocator::clear_top()
+{
+    top = total_memory;
+}
+
+void DoubleStackAllocator::clear_bottom()
+{
+    bottom = 0;
+}
+
+ScopedStackMarker::ScopedStackMarker(DoubleStackAllocator& new_stack, const bool new_is_top)
+: stack(new_stack),
+  marker(new_is_top ? new_stack.get_top_marker() : new_stack.get_bottom_marker()),
+  is_top(new_is_top)
+{
+}
+
+ScopedStackMarker::~ScopedStackMarker()
+{
+    if (is_top)
+    {
+        stack.free_top_marker(marker);
+    }
+    else
+    {
+        stack.free_bottom_marker(marker);
+    }
+}
+
+void LinearAllocator::init(const u64 size)
+{
+    memory           = (u8*)malloc(size);
+    total_memory     = size;
+    allocated_memory = 0;
+    peak_memory      = 0;
+}
+
+void LinearAllocator::shutdown()
+{
+    free(memory);
+    memory = nullptr;
+}
+
+void* LinearAllocator::allocate(const u64 size, const u64 alignment)
+{
+    ASSERT(size > 0);
+    ASSERT(is_power_of_two(alignment));
+
+    const u64 new_memory_start     = memory_align_offset(memory, allocated_memory, alignment);
+    const u64 new_allocated_memory = new_memory_start + size;
+
+    if (new_allocated_memory > total_memory)
+    {
+        PLOG(WARNING, MEMORY, "Not enough memory to allocate.");
+        return nullptr;
+    }
+
+    allocated_memory = new_allocated_memory;
+    peak_memory      = std::max(peak_memory, allocated_memory);
+    return memory + new_memory_start;
+}
+
+void LinearAllocator::deallocate(void* pointer)
+{
+    ASSERT(pointer >= memory);
+    ASSERT(pointer < memory + total_memory);
+}
+
+u64 LinearAllocator::get_marker()
+{
+    return allocated_memory;
+}
+
+void LinearAllocator::free_marker(u64 marker)
+{
+    if (marker < allocated_memory)
+    {
+        allocated_memory = marker;
+    }
+}
+
+void LinearAllocator::clear()
+{
+    allocated_memory = 0;
+}
+
+void PoolAllocator::init(const u64 new_block_size,
+                         const u64 new_block_count,
+                         const u64 new_block_alignment)
+{
+    ASSERT(new_block_count > 0);
+    ASSERT(is_power_of_two(new_block_alignment));
+
+    block_alignment  = new_block_alignment;
+    block_size       = memory_align(std::max<u64>(new_block_size, sizeof(void*)), block_alignment);
+    block_count      = new_block_count;
+    allocated_blocks = 0;
+
+    memory = (u8*)malloc(block_size * block_count + block_alignment);
+    blocks = memory + memory_align_offset(memory, 0, block_alignment);
+
+    // Linked back to front, so the first allocations walk the memory in order.
+    free_list = nullptr;
+    for (u64 i = block_count; i > 0; --i)
+    {
+        void* block = blocks + (i - 1) * block_size;
+
+        *static_cast<void**>(block) = free_list;
+        free_list                   = block;
+    }
+}
+
+void PoolAllocator::shutdown()
+{
+    if (allocated_blocks > 0)
+    {
+        PLOG(WARNING,
+             MEMORY,
+             "Pool allocator shut down with %llu blocks in use.",
+             allocated_blocks);
+    }
+
+    free(memory);
+    memory    = nullptr;
+    blocks    = nullptr;
+    free_list = nullptr;
+}
+
+void* PoolAllocator::allocate(const u64 size, const u64 alignment)
+{
+    ASSERT(size <= block_size);
+    ASSERT(alignment <= block_alignment);
+
+    if (free_list == nullptr)
+    {
+        PLOG(WARNING, MEMORY, "Pool allocator out of blocks.");
+        return nullptr;
+    }
+
+    void* block = free_list;
+    free_list   = *static_cast<void**>(block);
+    allocated_blocks++;
+    return block;
+}
+
+void PoolAllocator::deallocate(void* pointer)
+{
+    ASSERT(pointer >= blocks);
+    ASSERT(pointer < blocks + block_size * block_count);
+    ASSERT(((u8*)pointer - blocks) % block_size == 0);
+
+    *static_cast<void**>(pointer) = free_list;
+    free_list                     = pointer;
+    allocated_blocks--;
+}
+
+// Blocks are laid out back to back, each header followed by its payload. The previous physical
+// block pointer is only read while that block is free.
+struct TLSFBlock
+{
+    TLSFBlock* prev_physical;
+    // Payload size, the two low bits hold the flags below.
+    u64        size;
+    // Only for free blocks, stored in the payload.
+    TLSFBlock* next_free;
+    TLSFBlock* prev_free;
+};
+
+static constexpr u64 TLSF_FREE_BIT      = 1 << 0;
+static constexpr u64 TLSF_PREV_FREE_BIT = 1 << 1;
+static constexpr u64 TLSF_FLAG_MASK     = TLSF_FREE_BIT | TLSF_PREV_FREE_BIT;
+
+static constexpr u64 TLSF_HEADER_SIZE      = offsetof(TLSFBlock, next_free);
+static constexpr u64 TLSF_MIN_BLOCK_SIZE   = sizeof(TLSFBlock) - TLSF_HEADER_SIZE;
+static constexpr u64 TLSF_SMALL_BLOCK_SIZE = 1ull << TLSFAllocator::FL_INDEX_SHIFT;
+
+static_assert(TLSF_HEADER_SIZE % TLSFAllocator::ALIGNMENT == 0);
+static_assert(TLSF_MIN_BLOCK_SIZE % TLSFAllocator::ALIGNMENT == 0);
+
+static u64 get_block_size(const TLSFBlock* block)
+{
+    return block->size & ~TLSF_FLAG_MASK;
+}
+
+static void set_block_size(TLSFBlock* block, const u64 size)
+{
+    block->size = size | (block->size & TLSF_FLAG_MASK);
+}
+
+static u8* get_block_payload(TLSFBlock* block)
+{
+    return reinterpret_cast<u8*>(block) + TLSF_HEADER_SIZE;
+}
+
+static TLSFBlock* get_block_from_payload(void* pointer)
+{
+    return reinterpret_cast<TLSFBlock*>(static_cast<u8*>(pointer) - TLSF_HEADER_SIZE);
+}
+
+static TLSFBlock* get_next_physical(TLSFBlock* block)
+{
+    return reinterpret_cast<TLSFBlock*>(get_block_payload(block) + get_block_size(block));
+}
+
+static void mark_block_free(TLSFBlock* block)
+{
+    block->size |= TLSF_FREE_BIT;
+
+    TLSFBlock* next = get_next_physical(block);
+    next->size |= TLSF_PREV_FREE_BIT;
+    next->prev_physical = block;
+}
+
+static void mark_block_used(TLSFBlock* block)
+{
+    block->size &= ~TLSF_FREE_BIT;
+    get_next_physical(block)->size &= ~TLSF_PREV_FREE_BIT;
+}
+
+static u32 get_msb(const u64 value)
+{
+    return 63 - static_cast<u32>(std::countl_zero(value));
+}
+
+// Size class holding blocks of the given size.
+static void get_mapping(const u64 size, u32& fl, u32& sl)
+{
+    if (size < TLSF_SMALL_BLOCK_SIZE)
+    {
+        fl = 0;
+        sl = static_cast<u32>(size / (TLSF_SMALL_BLOCK_SIZE / TLSFAllocator::SL_INDEX_COUNT));
+        return;
+    }
+
+    const u32 msb = get_msb(size);
+    sl = static_cast<u32>(size >> (msb - TLSFAllocator::SL_INDEX_COUNT_LOG2)) ^
+         TLSFAllocator::SL_INDEX_COUNT;
+    fl = msb - (TLSFAllocator::FL_INDEX_SHIFT - 1);
+}
+
+void TLSFAllocator::init(const u64 size)
+{
+    ASSERT(size > 2 * TLSF_HEADER_SIZE + TLSF_MIN_BLOCK_SIZE + ALIGNMENT);
+    ASSERT(size < (1ull << FL_INDEX_MAX));
+
+    memory           = (u8*)malloc(size);
+    total_memory     = size;
+    allocated_memory = 0;
+
+    fl_bitmap = 0;
+    memset(sl_bitmap, 0, sizeof(sl_bitmap));
+    memset(free_blocks, 0, sizeof(free_blocks));
+
+    // One free block spanning the memory, closed by an empty used block so every block has a
+    // next one.
+    const u64 start       = memory_align_offset(memory, 0, ALIGNMENT);
+    const u64 usable_size = (size - start) & ~(ALIGNMENT - 1);
+
+    auto block  = reinterpret_cast<TLSFBlock*>(memory + start);
+    block->size = usable_size - 2 * TLSF_HEADER_SIZE;
+
+    auto sentinel  = get_next_physical(block);
+    sentinel->size = 0;
+
+    mark_block_free(block);
+    insert_free_block(block);
+}
+
+void TLSFAllocator::shutdown()
+{
+    if (allocated_memory > 0)
+    {
+        PLOG(WARNING, MEMORY, "TLSF allocator shut down with %llu bytes in use.", allocated_memory);
+    }
+
+    free(memory);
+    memory = nullptr;
+}
+
+void* TLSFAllocator::allocate(const u64 size, const u64 alignment)
+{
+    ASSERT(memory != nullptr);
+    ASSERT(is_power_of_two(alignment));
+
+    const u64 adjusted_size = std::max(memory_align(size, ALIGNMENT), TLSF_MIN_BLOCK_SIZE);
+
+    // Over aligned allocations leave room to split a free block in front of the aligned one.
+    const u64 gap_minimum = TLSF_HEADER_SIZE + TLSF_MIN_BLOCK_SIZE;
+    const u64 search_size =
+      alignment > ALIGNMENT ? adjusted_size + alignment + gap_minimum : adjusted_size;
+
+    TLSFBlock* block = find_free_block(search_size);
+    if (block == nullptr)
+    {
+        PLOG(WARNING, MEMORY, "TLSF allocator out of memory, %llu bytes requested.", size);
+        return nullptr;
+    }
+
+    remove_free_block(block);
+
+    if (alignment > ALIGNMENT)
+    {
+        u8* payload = get_block_payload(block);
+        u64 gap     = memory_align_offset(payload, 0, alignment);
+        if (gap > 0 && gap < gap_minimum)
+        {
+            gap = memory_align_offset(payload, gap_minimum, alignment);
+        }
+
+        if (gap > 0)
+        {
+            auto aligned_block  = reinterpret_cast<TLSFBlock*>(payload + gap - TLSF_HEADER_SIZE);
+            aligned_block->size = get_block_size(block) - gap;
+
+            set_block_size(block, gap - TLSF_HEADER_SIZE);
+            mark_block_free(block);
+            insert_free_block(block);
+
+            block = aligned_block;
+        }
+    }
+
+    trim_free_tail(block, adjusted_size);
+    mark_block_used(block);
+
+    allocated_memory += get_block_size(block);
+    return get_block_payload(block);
+}
+
+void TLSFAllocator::deallocate(void* pointer)
+{
+    if (pointer == nullptr)
+    {
+        return;
+    }
+
+    ASSERT(pointer > memory);
+    ASSERT(pointer < memory + total_memory);
+
+    TLSFBlock* block = get_block_from_payload(pointer);
+    ASSERT(!(block->size & TLSF_FREE_BIT));
+
+    allocated_memory -= get_block_size(block);
+
+    // Free neighbours merge, so there are never two free blocks in a row.
+    if (block->size & TLSF_PREV_FREE_BIT)
+    {
+        TLSFBlock* prev = block->prev_physical;
+        remove_free_block(prev);
+        set_block_size(prev, get_block_size(prev) + TLSF_HEADER_SIZE + get_block_size(block));
+        block = prev;
+    }
+
+    TLSFBlock* next = get_next_physical(block);
+    if (next->size & TLSF_FREE_BIT)
+    {
+        remove_free_block(next);
+        set_block_size(block, get_block_size(block) + TLSF_HEADER_SIZE + get_block_size(next));
+    }
+
+    mark_block_free(block);
+    insert_free_block(block);
+}
+
+u64 TLSFAllocator::get_allocation_size(void* pointer) const
+{
+    return get_block_size(get_block_from_payload(pointer));
+}
+
+void TLSFAllocator::insert_free_block(TLSFBlock* block)
+{
+    u32 fl, sl;
+    get_mapping(get_block_size(block), fl, sl);
+
+    TLSFBlock* head  = free_blocks[fl][sl];
+    block->next_free = head;
+    block->prev_free = nullptr;
+    if (head != nullptr)
+    {
+        head->prev_free = block;
+    }
+
+    free_blocks[fl][sl] = block;
+    fl_bitmap |= 1u << fl;
+    sl_bitmap[fl] |= 1u << sl;
+}
+
+void TLSFAllocator::remove_free_block(TLSFBlock* block)
+{
+    u32 fl, sl;
+    get_mapping(get_block_size(block), fl, sl);
+
+    if (block->prev_free != nullptr)
+    {
+        block->prev_free->next_free = block->next_free;
+    }
+    if (block->next_free != nullptr)
+    {
+        block->next_free->prev_free = block->prev_free;
+    }
+
+    if (free_blocks[fl][sl] == block)
+    {
+        free_blocks[fl][sl] = block->next_free;
+        if (block->next_free == nullptr)
+        {
+            sl_bitmap[fl] &= ~(1u << sl);
+            if (sl_bitmap[fl] == 0)
+            {
+                fl_bitmap &= ~(1u << fl);
+            }
+        }
+    }
+}
+
+TLSFBlock* TLSFAllocator::find_free_block(u64 size)
+{
+    // Rounded up to the next size class, so any block found there is large enough.
+    if (size >= TLSF_SMALL_BLOCK_SIZE)
+    {
+        size += (1ull << (get_msb(size) - SL_INDEX_COUNT_LOG2)) - 1;
+    }
+
+    u32 fl, sl;
+    get_mapping(size, fl, sl);
+    if (fl >= FL_INDEX_COUNT)
+    {
+        return nullptr;
+    }
+
+    u32 sl_map = sl_bitmap[fl] & (~0u << sl);
+    if (sl_map == 0)
+    {
+        const u32 fl_map = fl + 1 < FL_INDEX_COUNT ? fl_bitmap & (~0u << (fl + 1)) : 0;
+        if (fl_map == 0)
+        {
+            return nullptr;
+        }
+
+        fl     = static_cast<u32>(std::countr_zero(fl_map));
+        sl_map = sl_bitmap[fl];
+    }
+
+    sl = static_cast<u32>(std::countr_zero(sl_map));
+    return free_blocks[fl][sl];
+}
+
+void TLSFAllocator::trim_free_tail(TLSFBlock* block, u64 size)
+{
+    const u64 block_size = get_block_size(block);
+    if (block_size < size + TLSF_HEADER_SIZE + TLSF_MIN_BLOCK_SIZE)
+    {
+        return;
+    }
+
+    auto tail  = reinterpret_cast<TLSFBlock*>(get_block_payload(block) + size);
+    tail->size = block_size - size - TLSF_HEADER_SIZE;
+    set_block_size(block, size);
+
+    mark_block_free(tail);
+    insert_free_block(tail);
+}
+
+static LinearAllocator frame_allocator;
+static TLSFAllocator   heap_allocator;
+
+void memory_init(const u64 frame_size, const u64 heap_size)
+{
+    frame_allocator.init(frame_size);
+    heap_allocator.init(heap_size);
+
+    track_allocation(MemoryTag::ENGINE, frame_size);
+    track_allocation(MemoryTag::ENGINE, heap_size);
+}
+
+void memory_shutdown()
+{
+    PLOG(INFO,
+         MEMORY,
+         "Frame allocator peak: %llu of %llu bytes.",
+         frame_allocator.peak_memory,
+         frame_allocator.total_memory);
+
+    track_deallocation(MemoryTag::ENGINE, frame_allocator.total_memory);
+    track_deallocation(MemoryTag::ENGINE, heap_allocator.total_memory);
+
+    frame_allocator.shutdown();
+    heap_allocator.shutdown();
+}
+
+LinearAllocator* get_frame_allocator()
+{
+    return &frame_allocator;
+}
+
+TLSFAllocator* get_heap_allocator()
+{
+    return &heap_allocator;
+}
 } // namespace sogas
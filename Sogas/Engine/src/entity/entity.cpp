@@ -40,7 +40,7 @@ void Entity::render_debug_menu()
     ImGui::PushID(this);
     if (ImGui::TreeNode(get_name().c_str()))
     {
-        for (i32 i = 0; i < Handle::max_types; ++i)
+        for (u32 i = 0; i < Handle::max_types; ++i)
         {
             Handle h = components[i];
             if (h.is_valid())
@@ -88,16 +88,16 @@ void Entity::load(const nlohmann::json& json_file, EntityParser& scene)
         auto& component_name = component.key();
         auto& component_data = component.value();
 
-#ifndef NDEBUG
-        PINFO("Parsing component %s from json scene %s.",
-              component_name.c_str(),
-              component_data.dump().c_str());
-#endif
+        PLOG(DEBUG,
+             ENTITIES,
+             "Parsing component %s from %s.",
+             component_name.c_str(),
+             scene.filename.c_str());
 
         auto object_manager = HandleManager::get_by_name(component_name);
         if (!object_manager)
         {
-            PWARN("Warning! Unknown component name %s.", component_name.c_str());
+            PLOG(WARNING, ENTITIES, "Warning! Unknown component name %s.", component_name.c_str());
             return;
         }
 
@@ -12,7 +12,7 @@ bool parse_scene(const std::string& filename, EntityParser& context)
 
     ASSERT(json.is_array());
 
-    for (i32 i = 0; i < json.size(); ++i)
+    for (u32 i = 0; i < json.size(); ++i)
     {
         const auto& jscene = json[i];
         ASSERT(jscene.is_object());
@@ -186,7 +186,7 @@ HandleManager* HandleManager::get_by_name(const std::string& name)
     }
     return nullptr;
 }
-const u32 HandleManager::get_number_of_defined_types()
+u32 HandleManager::get_number_of_defined_types()
 {
     return next_type_of_handle_manager;
 }
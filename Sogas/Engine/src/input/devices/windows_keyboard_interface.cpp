@@ -13,6 +13,7 @@ void WindowsKeyboardInterface::fetch_data(KeyBoard& keyboard)
     }
 }
 
+#ifdef _WIN64
 void WindowsKeyboardInterface::processMsg(HWND /*hWnd*/, UINT message, WPARAM wParam, LPARAM /*lParam*/)
 {
     switch (message)
@@ -31,5 +32,6 @@ void WindowsKeyboardInterface::processMsg(HWND /*hWnd*/, UINT message, WPARAM wP
         }
     }
 }
+#endif
 } // namespace input
 } // namespace sogas
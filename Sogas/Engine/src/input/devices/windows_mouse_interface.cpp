@@ -21,6 +21,7 @@ void WindowsMouseInterface::fetch_data(Mouse& mouse)
     wheel_steps = 0;
 }
 
+#ifdef _WIN64
 void WindowsMouseInterface::processMsg(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 {
     switch (message)
@@ -77,5 +78,6 @@ void WindowsMouseInterface::processMsg(HWND hWnd, UINT message, WPARAM wParam, L
         }
     }
 }
+#endif
 } // namespace input
 } // namespace sogas
@@ -1,3 +1,4 @@
+#include <engine/memory_stats.h>
 #include <entity/entity_parser.h>
 #include <modules/module_boot.h>
 
@@ -7,9 +8,27 @@ namespace modules
 {
 bool BootModule::start()
 {
-    json json   = platform::load_json("../../Sogas/Engine/data/boot.json");
+    return boot("../../Sogas/Engine/data/boot.json");
+}
+
+void BootModule::stop()
+{
+    unload_scenes();
+    scene_memory.shutdown();
+}
+
+bool BootModule::boot(const std::string& filename)
+{
+    scene_memory.init(mb(1));
+
+    json json   = platform::load_json(filename);
     auto scenes = json["scenes"].get<std::vector<std::string>>();
 
+    if (json.count("memory_budgets"))
+    {
+        load_memory_budgets(json["memory_budgets"]);
+    }
+
     for (auto scene : scenes)
     {
         load_scene(scene);
@@ -18,12 +37,43 @@ bool BootModule::start()
     return true;
 }
 
+void BootModule::unload_scenes()
+{
+    for (const auto& scene : scenes)
+    {
+        for (u32 i = 0; i < scene.entity_count; ++i)
+        {
+            scene.entities[i].destroy();
+        }
+    }
+
+    scenes.clear();
+    scene_memory.clear_bottom();
+}
+
 void BootModule::load_scene(const std::string& filename)
 {
-    PDEBUG("Parsing %s", filename.c_str());
+    PLOG(DEBUG, ENTITIES, "Parsing %s", filename.c_str());
+
+    ScopedStackMarker scratch(scene_memory, true);
 
-    EntityParser context;
+    EntityParser context(&scene_memory.top_end);
     parse_scene(filename, context);
+
+    LoadedScene scene;
+    scene.entity_count = static_cast<u32>(context.all_entities.size());
+    if (scene.entity_count > 0)
+    {
+        scene.entities = static_cast<Handle*>(
+          scene_memory.allocate_bottom(scene.entity_count * sizeof(Handle), alignof(Handle)));
+        if (scene.entities == nullptr)
+        {
+            PLOG(ERROR, ENTITIES, "Not enough scene memory to keep %s loaded.", filename.c_str());
+            return;
+        }
+        std::copy(context.all_entities.begin(), context.all_entities.end(), scene.entities);
+    }
+    scenes.push_back(scene);
 }
 } // namespace modules
 } // namespace sogas
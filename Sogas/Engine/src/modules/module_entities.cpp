@@ -26,7 +26,7 @@ namespace modules
 {
 bool EntityModule::start()
 {
-    PINFO("Entity module starting!");
+    PLOG(INFO, ENTITIES, "Entity module starting!");
 
     auto j = platform::load_json("../../Sogas/Engine/data/components.json");
 
@@ -68,6 +68,7 @@ bool EntityModule::start()
 
     // TODO: Load component managers ...
     load_managers(j["update"], managers_to_update);
+    load_managers(j.value("fixed_update", json::array()), managers_to_fixed_update);
     load_managers(j["render_debug"], managers_to_render_debug);
 
     return true;
@@ -75,7 +76,7 @@ bool EntityModule::start()
 
 void EntityModule::stop()
 {
-    PINFO("Entity module stoping!");
+    PLOG(INFO, ENTITIES, "Entity module stoping!");
 }
 
 void EntityModule::update(f32 delta_time)
@@ -88,6 +89,14 @@ void EntityModule::update(f32 delta_time)
     // TODO Destroy all pending objects.
 }
 
+void EntityModule::fixed_update(f32 step)
+{
+    for (auto object_manager : managers_to_fixed_update)
+    {
+        object_manager->fixed_update_all(step);
+    }
+}
+
 void EntityModule::render_debug(pinut::resources::CommandBuffer* cmd)
 {
     //TODO get render debug pipeline
@@ -1,12 +1,15 @@
 
 #include "pch.hpp"
 
+#include <engine/memory_stats.h>
 #include <imgui/imgui.h>
 #include <modules/module.h>
 #include <modules/module_manager.h>
 #include <platform/platform.h>
 #include <resources/commandbuffer.h>
+#ifdef PINUT_VULKAN
 #include <vulkan/vulkan_imgui.h>
+#endif
 
 namespace sogas
 {
@@ -23,12 +26,28 @@ void ModuleManager::clear()
     services.clear();
 }
 
+void ModuleManager::fixed_update(f32 step)
+{
+    PROFILE_ZONE("ModuleManager::fixed_update");
+
+    for (const auto& module : update_modules)
+    {
+        if (module->get_is_active())
+        {
+            module->fixed_update(step);
+        }
+    }
+}
+
 void ModuleManager::update(f32 delta_time)
 {
+    PROFILE_ZONE("ModuleManager::update");
+
     for (const auto& module : update_modules)
     {
         if (module->get_is_active())
         {
+            PROFILE_ZONE(module->get_name().c_str());
             module->update(delta_time);
         }
     }
@@ -36,10 +55,13 @@ void ModuleManager::update(f32 delta_time)
 
 void ModuleManager::render()
 {
+    PROFILE_ZONE("ModuleManager::render");
+
     for (const auto& module : render_modules)
     {
         if (module->get_is_active())
         {
+            PROFILE_ZONE(module->get_name().c_str());
             module->render();
         }
     }
@@ -66,6 +88,7 @@ void ModuleManager::render_debug(pinut::resources::CommandBuffer* cmd)
 
 void ModuleManager::render_debug_menu(const pinut::resources::CommandBuffer& cmd)
 {
+#ifdef PINUT_VULKAN
     pinut::vulkan::start_imgui_frame();
 
     ImGui::ShowDemoWindow(nullptr);
@@ -75,7 +98,14 @@ void ModuleManager::render_debug_menu(const pinut::resources::CommandBuffer& cmd
         module.second->render_debug_menu();
     }
 
+    render_memory_stats_menu();
+    profiler::render_profiler_menu();
+
     pinut::vulkan::end_imgui_frame(cmd);
+#else
+    // Imgui only draws through the Vulkan backend.
+    UNUSED(cmd);
+#endif
 }
 
 void ModuleManager::resize_window(u32 width, u32 height)
@@ -2,58 +2,43 @@
 
 #include <components/basic/camera_component.h>
 #include <components/basic/point_light_component.h>
+#include <components/basic/spot_light_component.h>
 #include <components/basic/transform_component.h>
+#include <engine/clock.h>
 #include <engine/engine.h>
 #include <engine/primitives.h>
+#include <handle/object_manager.h>
 #include <imgui/imgui.h>
 #include <modules/module_renderer.h>
 #include <modules/render_manager.h>
 #include <resources/pipeline.h>
 #include <resources/resources.h>
 #include <resources/shader_state.h>
+#include <resources/texture_utils.h>
 
 #ifdef _WIN64
 #pragma warning(disable : 4615)
 #pragma warning(disable : 4389)
 #pragma warning(disable : 4244)
+#endif
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
+#ifdef _WIN64
 #pragma warning(enable : 4244)
 #pragma warning(enable : 4389)
 #pragma warning(enable : 4615)
-#else
-#error "Only win64 platform implemented at the moment."
 #endif
 
+#include <resources/light_clusters.h>
 #include <resources/mesh.h>
+#include <resources/pipeline_library.h>
+#include <resources/shadow_atlas.h>
+#include <resources/texture_streamer.h>
 
 namespace sogas
 {
 namespace modules
 {
-static bool read_shader_binary(const std::string& filepath, std::vector<u32>& out_buffer)
-{
-    out_buffer.clear();
-
-    std::ifstream file(filepath, std::ios::ate | std::ios::binary);
-
-    if (!file.is_open())
-    {
-        return false;
-    }
-
-    auto file_size = static_cast<size_t>(file.tellg());
-    ASSERT(file_size > 0);
-
-    out_buffer.resize(file_size / sizeof(u32));
-
-    file.seekg(0);
-    file.read((char*)(out_buffer.data()), file_size);
-    file.close();
-
-    return true;
-}
-
 static void upload_data_to_buffer(pinut::GPUDevice*              renderer,
                                   pinut::resources::BufferHandle buffer,
                                   void*                          data,
@@ -71,12 +56,12 @@ struct UniformBuffer
     glm::mat4 proj;
 };
 
-struct LightData
+// Must match the ClusterInfo block of clustered_lighting.glsl.
+struct ClusterInfo
 {
-    glm::vec3 position     = glm::vec3(0.0f, 5.0f, 0.0f);
-    f32       intensity    = 1.0f;
-    glm::vec3 color        = glm::vec3(1.0f);
-    f32       max_distance = 100.0f;
+    glm::mat4  view;
+    glm::uvec4 grid_size;
+    glm::vec4  viewport_depth;
 };
 
 using namespace pinut::resources;
@@ -91,244 +76,503 @@ struct Material
     TextureHandle ambient_occlusion_texture;
 };
 
-BufferHandle              global_ubo;
-BufferHandle              light_ubo;
+// Entry of the bindless material table, textures are referenced by handle id.
+struct MaterialData
+{
+    glm::vec4 color;
+    u32       albedo_texture;
+    u32       normal_texture;
+    u32       padding[2];
+};
+
+// Buffers the CPU rewrites every frame, and the sets reading them. There is one per frame in
+// flight so a frame never overwrites data the GPU may still be reading for an earlier one.
+struct FrameResources
+{
+    BufferHandle        global_ubo;
+    BufferHandle        light_buffer;
+    BufferHandle        cluster_buffer;
+    BufferHandle        light_index_buffer;
+    BufferHandle        cluster_info_ubo;
+    BufferHandle        shadow_view_buffer;
+    // Bindless material table, only created when the device supports bindless.
+    BufferHandle        material_table = invalid_buffer;
+    // Material version last written to material_table.
+    u32                 material_version = 0;
+    DescriptorSetHandle descriptor_set_handle;
+    DescriptorSetHandle wireframe_descriptor_set_handle;
+    DescriptorSetHandle depth_descriptor_set_handle;
+};
+
+FrameResources frames[pinut::GPUDevice::MAX_FRAMES_IN_FLIGHT];
+
 BufferHandle              material_buffer;
-DescriptorSetHandle       wireframe_descriptor_set_handle;
 DescriptorSetLayoutHandle wireframe_descriptor_set_layout_handle;
-DescriptorSetHandle       descriptor_set_handle;
 DescriptorSetHandle       instance_descriptor_set_handle;
 DescriptorSetLayoutHandle descriptor_set_layout_handle;
 DescriptorSetLayoutHandle instance_descriptor_set_layout_handle;
 
 Material material;
+// Bumped when the material changes, each frame's table catches up when it is next recorded.
+u32      material_version = 0;
 
-static const u32 LIGHT_COUNT = 3;
+PipelineLibrary pipeline_library;
 
-bool RendererModule::start()
-{
-    PINFO("Starting renderer module.");
+TextureStreamer   texture_streamer;
+StreamedTextureId albedo_stream   = INVALID_ID;
+u32               viewport_width  = 1280;
+u32               viewport_height = 720;
 
-    pinut::DeviceDescriptor descriptor;
-    descriptor.set_window(1280, 720, window_handle);
+LightClusters light_clusters;
 
-    renderer = pinut::GPUDevice::create(pinut::GraphicsAPI::Vulkan);
-    renderer->init(descriptor);
+ShadowAtlas   shadow_atlas;
+TextureHandle shadow_atlas_texture;
+// The first shadow pass clears the whole atlas, later ones only clear the tiles they render.
+bool          is_shadow_atlas_cleared = false;
 
-    init_default_meshes();
+static DescriptorSetHandle create_instance_descriptor_set(pinut::GPUDevice* renderer)
+{
+    DescriptorSetDescriptor instance_descriptor_set_descriptor = {};
+    instance_descriptor_set_descriptor.set_layout(instance_descriptor_set_layout_handle)
+      .add_buffer(material_buffer, 0)
+      .add_texture(material.albedo_texture, 1)
+      .add_texture(material.normal_texture, 2);
 
-    create_primitives();
+    return renderer->create_descriptor_set(instance_descriptor_set_descriptor);
+}
 
-    std::vector<u32> vs_buffer, fs_buffer;
+static MaterialData get_material_data()
+{
+    MaterialData material_data   = {};
+    material_data.color          = glm::vec4(material.color, 1.0f);
+    material_data.albedo_texture = material.albedo_texture.id;
+    material_data.normal_texture = material.normal_texture.id;
+    return material_data;
+}
 
-    if (!read_shader_binary("../../Sogas/Engine/data/shaders/bin/forward.vert.spv", vs_buffer))
+// Streamed textures get a new handle whenever their resident mips change.
+static void stream_material_textures(pinut::GPUDevice* renderer, const CameraComponent& camera)
+{
+    if (albedo_stream == INVALID_ID)
     {
-        throw std::runtime_error("Failed to load vertex shader data.");
+        return;
     }
 
-    if (!read_shader_binary("../../Sogas/Engine/data/shaders/bin/forward.frag.spv", fs_buffer))
+    texture_streamer.request_projected_size(
+      albedo_stream,
+      render_manager.get_projected_size(
+        0, camera.get_eye(), camera.get_radians_fov(), static_cast<f32>(viewport_height)));
+
+    if (!texture_streamer.update())
     {
-        throw std::runtime_error("Failed to load fragment shader data.");
+        return;
     }
 
-    ShaderStateDescriptor shader_state = {};
-    shader_state.add_name("forward_shader")
-      .add_shader_stage({vs_buffer, ShaderStageType::VERTEX})
-      .add_shader_stage({fs_buffer, ShaderStageType::FRAGMENT});
+    material.albedo_texture = texture_streamer.get_texture(albedo_stream);
 
-    ViewportDescriptor viewport_state = {{0, 0, static_cast<f32>(1280), static_cast<f32>(720)},
-                                         {0, 0, 1280, 720}};
+    renderer->destroy_descriptor_set(instance_descriptor_set_handle);
+    instance_descriptor_set_handle = create_instance_descriptor_set(renderer);
 
-    RasterizationDescriptor raster = {};
-    raster.cull_mode               = CullMode::NONE;
-    raster.line_width              = 1.0f;
-
-    PipelineDescriptor pipeline_descriptor = {};
-    pipeline_descriptor.add_name("forward_pipeline")
-      .set_topology(TopologyType::TRIANGLE)
-      .add_shader_state(shader_state)
-      .add_viewport(viewport_state)
-      .add_rasterization(raster);
-
-    pipeline_descriptor.vertex_input.add_vertex_stream({0, sizeof(sogas::Vertex)});
-    pipeline_descriptor.vertex_input.add_vertex_attribute(
-      {0, 0, offsetof(sogas::Vertex, position), VertexInputFormatType::VEC3});
-    pipeline_descriptor.vertex_input.add_vertex_attribute(
-      {1, 0, offsetof(sogas::Vertex, normal), VertexInputFormatType::VEC3});
-    pipeline_descriptor.vertex_input.add_vertex_attribute(
-      {2, 0, offsetof(sogas::Vertex, color), VertexInputFormatType::VEC3});
-    pipeline_descriptor.vertex_input.add_vertex_attribute(
-      {3, 0, offsetof(sogas::Vertex, uv), VertexInputFormatType::VEC2});
-
-    // CREATING UNIFORM BUFFERS
-    global_ubo = renderer->create_buffer({sizeof(UniformBuffer), BufferType::UNIFORM});
+    ++material_version;
+}
 
-    // CREATING TEXTURE DESCRIPTOR
-    i32  w, h, c;
-    auto pixels =
-      stbi_load("D:/Meshes/viking-room/textures/texture.png", &w, &h, &c, STBI_rgb_alpha);
+// The GPU may still read the tables of the other frames in flight, only this frame's is written.
+static void update_material_table(pinut::GPUDevice* renderer, FrameResources& frame)
+{
+    if (frame.material_table.id == INVALID_ID || frame.material_version == material_version)
+    {
+        return;
+    }
 
-    ASSERT(pixels);
+    auto material_data = get_material_data();
+    upload_data_to_buffer(renderer, frame.material_table, &material_data, sizeof(MaterialData));
+    frame.material_version = material_version;
+}
 
-    //u32               texture_data = 0xFF00FFFF;
-    TextureDescriptor texture_descriptor{};
-    texture_descriptor.width         = w;
-    texture_descriptor.height        = h;
-    texture_descriptor.channel_count = 4;
-    texture_descriptor.data          = pixels;
-    material.albedo_texture          = renderer->create_texture(texture_descriptor);
+// Shadowed lights are keyed by their component handle, so their atlas tiles survive across frames.
+static u64 get_shadow_id(Handle handle)
+{
+    return (static_cast<u64>(handle.get_type()) << 32) |
+           (static_cast<u64>(handle.get_external_index()) << Handle::num_bits_generation) |
+           handle.get_generation();
+}
 
-    stbi_image_free(pixels);
+// Lights past the atlas capacity are drawn without shadows.
+static i32 add_shadow(Handle handle, const ClusterLight& light, f32 cone)
+{
+    ShadowLight shadow_light;
+    shadow_light.position  = light.position;
+    shadow_light.direction = light.direction;
+    shadow_light.radius    = light.radius;
+    shadow_light.cone      = cone;
 
-    u32               normal_texture_data = 0xFFFFFF00;
-    TextureDescriptor normal_texture_descriptor{};
-    normal_texture_descriptor.data = &normal_texture_data;
-    material.normal_texture        = renderer->create_texture(normal_texture_descriptor);
+    return shadow_atlas.add_light(get_shadow_id(handle), shadow_light);
+}
 
-    light_ubo =
-      renderer->create_buffer({sizeof(LightData) * LIGHT_COUNT, BufferType::UNIFORM, nullptr});
+// Every enabled point and spot light is binned into the clusters of the camera view. Shadowed
+// lights get their atlas views, which are only rendered again when something they see changed.
+static void update_light_clusters(pinut::GPUDevice* renderer,
+                                  CameraComponent&  camera,
+                                  FrameResources&   frame)
+{
+    light_clusters.clear();
+    shadow_atlas.begin_frame();
+
+    get_object_manager<PointLightComponent>()->for_each([](PointLightComponent* point_light) {
+        if (!point_light->enabled)
+        {
+            return;
+        }
+
+        Entity*             entity    = Handle(point_light).get_owner();
+        TransformComponent* transform = entity->get<TransformComponent>();
+
+        ClusterLight light;
+        light.position  = transform->get_position();
+        light.intensity = point_light->intensity;
+        light.color     = glm::vec3(point_light->color);
+        light.radius    = point_light->radius;
+        if (point_light->casts_shadows)
+        {
+            light.shadow_index = add_shadow(Handle(point_light), light, 0.0f);
+        }
+        light_clusters.add_light(light);
+    });
+
+    get_object_manager<SpotLightComponent>()->for_each([](SpotLightComponent* spot_light) {
+        if (!spot_light->enabled)
+        {
+            return;
+        }
+
+        Entity*             entity    = Handle(spot_light).get_owner();
+        TransformComponent* transform = entity->get<TransformComponent>();
+        const f32           cone      = glm::radians(spot_light->angle);
+
+        ClusterLight light;
+        light.position  = transform->get_position();
+        light.intensity = spot_light->intensity;
+        light.color     = glm::vec3(spot_light->color);
+        light.radius    = spot_light->radius;
+        light.direction = transform->get_forward();
+        light.cos_cone  = std::cos(cone * 0.5f);
+        if (spot_light->casts_shadows)
+        {
+            light.shadow_index = add_shadow(Handle(spot_light), light, cone);
+        }
+        light_clusters.add_light(light);
+    });
+
+    Vector<BoundingSphere> moved_casters{get_frame_allocator()};
+    render_manager.collect_moved_casters(moved_casters);
+    for (const auto& caster : moved_casters)
+    {
+        shadow_atlas.invalidate(caster);
+    }
+    shadow_atlas.end_frame();
 
-    glm::vec3 color = glm::vec3(1.0f);
-    material_buffer = renderer->create_buffer({sizeof(glm::vec3), BufferType::UNIFORM, &color});
+    light_clusters.build(camera.get_view(),
+                         camera.get_radians_fov(),
+                         camera.get_aspect_ratio(),
+                         camera.get_near(),
+                         camera.get_far());
 
-    // CREATING DESCRIPTOR SET LAYOUTS
-    DescriptorSetBindingDescriptor binding = {0,
-                                              1,
-                                              ShaderStageType::VERTEX,
-                                              DescriptorType::UNIFORM};
-
-    DescriptorSetBindingDescriptor light_binding = {1,
-                                                    1,
-                                                    ShaderStageType::FRAGMENT,
-                                                    DescriptorType::UNIFORM};
-
-    DescriptorSetBindingDescriptor instance_binding = {0,
-                                                       1,
-                                                       ShaderStageType::FRAGMENT,
-                                                       DescriptorType::UNIFORM};
-
-    DescriptorSetBindingDescriptor texture_binding = {1,
-                                                      1,
-                                                      ShaderStageType::FRAGMENT,
-                                                      DescriptorType::COMBINED_IMAGE_SAMPLER};
-
-    DescriptorSetBindingDescriptor normal_binding = {2,
-                                                     1,
-                                                     ShaderStageType::FRAGMENT,
-                                                     DescriptorType::COMBINED_IMAGE_SAMPLER};
-
-    DescriptorSetLayoutDescriptor descriptor_set_layout_descriptor = {};
-    descriptor_set_layout_descriptor.add_binding(binding)
-      .add_binding(light_binding)
-      .add_name("GLOBAL");
-
-    descriptor_set_layout_handle =
-      renderer->create_descriptor_set_layout(descriptor_set_layout_descriptor);
-
-    DescriptorSetLayoutDescriptor instance_descriptor_set_layout_descriptor = {};
-    instance_descriptor_set_layout_descriptor.add_binding(instance_binding)
-      .add_binding(texture_binding)
-      .add_binding(normal_binding)
-      .add_name("INSTANCE");
-
-    instance_descriptor_set_layout_handle =
-      renderer->create_descriptor_set_layout(instance_descriptor_set_layout_descriptor);
-
-    pipeline_descriptor.add_descriptor_set_layout(descriptor_set_layout_handle);
-    pipeline_descriptor.add_descriptor_set_layout(instance_descriptor_set_layout_handle);
-
-    DescriptorSetDescriptor descriptor_set_descriptor = {};
-    descriptor_set_descriptor.set_layout(descriptor_set_layout_handle)
-      .add_buffer(global_ubo, 0)
-      .add_buffer(light_ubo, 1);
-    descriptor_set_handle = renderer->create_descriptor_set(descriptor_set_descriptor);
+    const auto& lights        = light_clusters.get_lights();
+    const auto& clusters      = light_clusters.get_clusters();
+    const auto& light_indices = light_clusters.get_light_indices();
+    const auto& descriptor    = light_clusters.get_descriptor();
 
-    DescriptorSetDescriptor instance_descriptor_set_descriptor = {};
-    instance_descriptor_set_descriptor.set_layout(instance_descriptor_set_layout_handle)
-      .add_buffer(material_buffer, 0)
-      .add_texture(material.albedo_texture, 1)
-      .add_texture(material.normal_texture, 2);
+    // Empty lists are left as they are, no cluster points into them.
+    if (!lights.empty())
+    {
+        upload_data_to_buffer(renderer,
+                              frame.light_buffer,
+                              (void*)lights.data(),
+                              lights.size() * sizeof(ClusterLight));
+    }
+    if (!light_indices.empty())
+    {
+        upload_data_to_buffer(renderer,
+                              frame.light_index_buffer,
+                              (void*)light_indices.data(),
+                              light_indices.size() * sizeof(u32));
+    }
+    upload_data_to_buffer(renderer,
+                          frame.cluster_buffer,
+                          (void*)clusters.data(),
+                          clusters.size() * sizeof(ClusterRange));
+
+    ClusterInfo info    = {};
+    info.view           = camera.get_view();
+    info.grid_size      = glm::uvec4(descriptor.grid_x, descriptor.grid_y, descriptor.grid_z, 0);
+    info.viewport_depth = glm::vec4(static_cast<f32>(viewport_width),
+                                    static_cast<f32>(viewport_height),
+                                    camera.get_near(),
+                                    camera.get_far());
+    upload_data_to_buffer(renderer, frame.cluster_info_ubo, &info, sizeof(ClusterInfo));
+
+    const auto& shadow_views = shadow_atlas.get_views();
+    upload_data_to_buffer(renderer,
+                          frame.shadow_view_buffer,
+                          (void*)shadow_views.data(),
+                          shadow_views.size() * sizeof(ShadowView));
+}
 
-    instance_descriptor_set_handle =
-      renderer->create_descriptor_set(instance_descriptor_set_descriptor);
+// Dirty atlas tiles are cleared and drawn again, clean ones keep last frame shadows.
+static void render_shadows(CommandBuffer* cmd)
+{
+    const auto dirty_views = shadow_atlas.get_dirty_views();
+    if (is_shadow_atlas_cleared && dirty_views.empty())
+    {
+        return;
+    }
 
-    pipeline_descriptor.add_push_constant({ShaderStageType::VERTEX, sizeof(glm::mat4)});
+    cmd->bind_pass(is_shadow_atlas_cleared ? "Shadow_atlas" : "Shadow_atlas_clear");
+    cmd->bind_pipeline("shadow_pipeline");
+    is_shadow_atlas_cleared = true;
 
-    renderer->create_pipeline(pipeline_descriptor);
+    for (const u32 view : dirty_views)
+    {
+        const auto tile = shadow_atlas.get_view_rect(view);
+
+        Viewport viewport = {static_cast<f32>(tile.x),
+                             static_cast<f32>(tile.y),
+                             static_cast<f32>(tile.z),
+                             static_cast<f32>(tile.w)};
+        Rect     rect     = {static_cast<f32>(tile.x), static_cast<f32>(tile.y), tile.z, tile.w};
+        cmd->set_viewport(&viewport);
+        cmd->set_scissors(&rect);
+        cmd->clear_depth(rect);
+
+        render_manager.render_shadow(cmd,
+                                     shadow_atlas.get_views().at(view).view_projection,
+                                     shadow_atlas.get_view_bounds(view));
+    }
 
-    // Create wireframe pipeline
+    shadow_atlas.mark_rendered();
+}
+
+bool RendererModule::start()
+{
+    PLOG(INFO, RENDER, "Starting renderer module.");
 
-    std::vector<u32> vs_wireframe_buffer, fs_wireframe_buffer;
+    pinut::DeviceDescriptor descriptor;
+    descriptor.set_window(1280, 720, window_handle).set_pipeline_cache("pipeline_cache.bin");
 
-    if (!read_shader_binary("../../Sogas/Engine/data/shaders/bin/wireframe.vert.spv",
-                            vs_wireframe_buffer))
+    // Headless runs and builds without the Vulkan SDK use the null device, it only records the
+    // commands.
+#ifdef PINUT_VULKAN
+    graphics_api = window_handle ? pinut::GraphicsAPI::Vulkan : pinut::GraphicsAPI::Null;
+#else
+    graphics_api = pinut::GraphicsAPI::Null;
+#endif
+    renderer     = pinut::GPUDevice::create(graphics_api);
+    renderer->init(descriptor);
+
+    init_default_meshes();
+
+    create_primitives();
+
+    ViewportDescriptor viewport_state = {{0, 0, static_cast<f32>(1280), static_cast<f32>(720)},
+                                         {0, 0, 1280, 720}};
+
+    // Shadow passes must exist before the pipelines drawing in them are built.
+    shadow_atlas.init();
+    const auto& shadow_descriptor = shadow_atlas.get_descriptor();
+
+    SamplerDescriptor shadow_sampler;
+    shadow_sampler
+      .set_filter(SamplerFilter::NEAREST, SamplerFilter::NEAREST, SamplerMipmapMode::NEAREST)
+      .set_address_mode(SamplerAddressMode::CLAMP_TO_EDGE, SamplerAddressMode::CLAMP_TO_EDGE)
+      .set_anisotropy(false);
+
+    TextureDescriptor shadow_texture_descriptor{};
+    shadow_texture_descriptor
+      .set_size(static_cast<u16>(shadow_descriptor.size), static_cast<u16>(shadow_descriptor.size))
+      .set_format(TextureFormat::D32_SFLOAT)
+      .set_render_target(true)
+      .set_sampler(shadow_sampler)
+      .add_name("Shadow atlas");
+    shadow_atlas_texture = renderer->create_texture(shadow_texture_descriptor);
+
+    RenderPassDescriptor shadow_pass_descriptor;
+    shadow_pass_descriptor.name = "Shadow_atlas_clear";
+    shadow_pass_descriptor.set_depth_attachment(shadow_atlas_texture)
+      .set_operations(RenderPassOperation::DONT_CARE, RenderPassOperation::CLEAR);
+    renderer->create_renderpass(shadow_pass_descriptor);
+
+    shadow_pass_descriptor.name = "Shadow_atlas";
+    shadow_pass_descriptor.set_operations(RenderPassOperation::DONT_CARE,
+                                          RenderPassOperation::LOAD);
+    renderer->create_renderpass(shadow_pass_descriptor);
+
+    pipeline_library.init(renderer);
+    if (!pipeline_library.load("../../Sogas/Engine/data/pipelines.json", viewport_state))
     {
-        throw std::runtime_error("Failed to load vertex shader data.");
+        throw std::runtime_error("Failed to load pipeline specs.");
     }
 
-    if (!read_shader_binary("../../Sogas/Engine/data/shaders/bin/wireframe.frag.spv",
-                            fs_wireframe_buffer))
+    // CREATING TEXTURE DESCRIPTOR
+    // Prefer the blob written by the texture cooker, streamed in from its mip tail. Decoding the
+    // png is only a fallback.
+    texture_streamer.init(renderer);
+    albedo_stream = texture_streamer.add_texture("D:/Meshes/viking-room/textures/texture.ptex");
+
+    if (albedo_stream != INVALID_ID)
     {
-        throw std::runtime_error("Failed to load fragment shader data.");
+        material.albedo_texture = texture_streamer.get_texture(albedo_stream);
     }
+    else
+    {
+        Clock clock;
+        start_clock(&clock);
+
+        i32  w, h, c;
+        auto pixels =
+          stbi_load("D:/Meshes/viking-room/textures/texture.png", &w, &h, &c, STBI_rgb_alpha);
+
+        // A single white texel keeps the material valid when the texture is not there.
+        u8 white[4] = {255, 255, 255, 255};
+        if (!pixels)
+        {
+            PLOG(ERROR, RENDER, "Could not load texture.png, using a white texture instead.");
+            w = h = 1;
+        }
+
+        TextureDescriptor texture_descriptor{};
+        texture_descriptor.width         = static_cast<u16>(w);
+        texture_descriptor.height        = static_cast<u16>(h);
+        texture_descriptor.channel_count = 4;
+        texture_descriptor.data          = pixels ? pixels : white;
+        texture_descriptor.set_mips(static_cast<u8>(get_mip_count(w, h)), true);
+        material.albedo_texture = renderer->create_texture(texture_descriptor);
+
+        if (pixels)
+        {
+            stbi_image_free(pixels);
+        }
+
+        update_clock(&clock);
+        PLOG(INFO, RENDER, "Loaded texture.png with stb in %.2f ms.", clock.elapsed_time * 1000.0);
+    }
+
+    u32               normal_texture_data = 0xFFFFFF00;
+    TextureDescriptor normal_texture_descriptor{};
+    normal_texture_descriptor.data = &normal_texture_data;
+    material.normal_texture        = renderer->create_texture(normal_texture_descriptor);
 
-    ShaderStateDescriptor wireframe_shader_state = {};
-    wireframe_shader_state.add_name("wireframe_shader")
-      .add_shader_stage({vs_wireframe_buffer, ShaderStageType::VERTEX})
-      .add_shader_stage({fs_wireframe_buffer, ShaderStageType::FRAGMENT});
+    light_clusters.init();
+    const auto& cluster_descriptor = light_clusters.get_descriptor();
+    const u32   cluster_count =
+      cluster_descriptor.grid_x * cluster_descriptor.grid_y * cluster_descriptor.grid_z;
 
-    PipelineDescriptor wireframe_pipeline_descriptor = {};
-    wireframe_pipeline_descriptor.add_name("wireframe_pipeline")
-      .set_topology(TopologyType::LINE)
-      .add_shader_state(wireframe_shader_state)
-      .add_viewport(viewport_state)
-      .add_rasterization(raster);
+    const u32 light_size = static_cast<u32>(sizeof(ClusterLight)) * cluster_descriptor.max_lights;
+    const u32 cluster_size = static_cast<u32>(sizeof(ClusterRange)) * cluster_count;
+    const u32 light_index_size =
+      static_cast<u32>(sizeof(u32)) * cluster_descriptor.max_light_indices;
+    const u32 shadow_view_size =
+      static_cast<u32>(sizeof(ShadowView) * shadow_atlas.get_views().size());
 
-    wireframe_pipeline_descriptor.vertex_input.add_vertex_stream({0, sizeof(Vertex)});
-    wireframe_pipeline_descriptor.vertex_input.add_vertex_attribute(
-      {0, 0, offsetof(sogas::Vertex, position), VertexInputFormatType::VEC3});
+    glm::vec3 color = glm::vec3(1.0f);
+    material_buffer = renderer->create_buffer({sizeof(glm::vec3), BufferType::UNIFORM, &color});
 
-    DescriptorSetBindingDescriptor wireframe_global_binding = {0,
-                                                               1,
-                                                               ShaderStageType::VERTEX,
-                                                               DescriptorType::UNIFORM};
+    // Set layouts are owned by the pipeline library.
+    descriptor_set_layout_handle = pipeline_library.get_set_layout("forward_pipeline", 0);
 
-    DescriptorSetLayoutDescriptor wireframe_descriptor_set_layout_descriptor = {};
-    wireframe_descriptor_set_layout_descriptor.add_binding(wireframe_global_binding)
-      .add_name("GLOBAL");
+    instance_descriptor_set_layout_handle = pipeline_library.get_set_layout("forward_pipeline", 1);
 
     wireframe_descriptor_set_layout_handle =
-      renderer->create_descriptor_set_layout(wireframe_descriptor_set_layout_descriptor);
-
-    wireframe_pipeline_descriptor.add_descriptor_set_layout(wireframe_descriptor_set_layout_handle);
+      pipeline_library.get_set_layout("wireframe_pipeline", 0);
 
-    DescriptorSetDescriptor wireframe_descriptor_set_descriptor = {};
-    wireframe_descriptor_set_descriptor.set_layout(wireframe_descriptor_set_layout_handle)
-      .add_buffer(global_ubo, 0);
-    wireframe_descriptor_set_handle =
-      renderer->create_descriptor_set(wireframe_descriptor_set_descriptor);
+    // The light buffers are mapped and rewritten by the CPU every frame.
+    for (auto& frame : frames)
+    {
+        frame.global_ubo = renderer->create_buffer({sizeof(UniformBuffer), BufferType::UNIFORM});
+        frame.light_buffer = renderer->create_buffer(
+          BufferDescriptor{light_size, BufferType::STORAGE}.set_host_visible());
+        frame.cluster_buffer = renderer->create_buffer(
+          BufferDescriptor{cluster_size, BufferType::STORAGE}.set_host_visible());
+        frame.light_index_buffer = renderer->create_buffer(
+          BufferDescriptor{light_index_size, BufferType::STORAGE}.set_host_visible());
+        frame.cluster_info_ubo =
+          renderer->create_buffer({sizeof(ClusterInfo), BufferType::UNIFORM, nullptr});
+        frame.shadow_view_buffer = renderer->create_buffer(
+          BufferDescriptor{shadow_view_size, BufferType::STORAGE}.set_host_visible());
+
+        DescriptorSetDescriptor descriptor_set_descriptor = {};
+        descriptor_set_descriptor.set_layout(descriptor_set_layout_handle)
+          .add_buffer(frame.global_ubo, 0)
+          .add_buffer(frame.light_buffer, 1)
+          .add_buffer(frame.cluster_buffer, 2)
+          .add_buffer(frame.light_index_buffer, 3)
+          .add_buffer(frame.cluster_info_ubo, 4)
+          .add_texture(shadow_atlas_texture, 5)
+          .add_buffer(frame.shadow_view_buffer, 6);
+        frame.descriptor_set_handle = renderer->create_descriptor_set(descriptor_set_descriptor);
+
+        DescriptorSetDescriptor wireframe_descriptor_set_descriptor = {};
+        wireframe_descriptor_set_descriptor.set_layout(wireframe_descriptor_set_layout_handle)
+          .add_buffer(frame.global_ubo, 0);
+        frame.wireframe_descriptor_set_handle =
+          renderer->create_descriptor_set(wireframe_descriptor_set_descriptor);
+
+        DescriptorSetDescriptor depth_descriptor_set_descriptor = {};
+        depth_descriptor_set_descriptor
+          .set_layout(pipeline_library.get_set_layout("depth_prepass_pipeline", 0))
+          .add_buffer(frame.global_ubo, 0);
+        frame.depth_descriptor_set_handle =
+          renderer->create_descriptor_set(depth_descriptor_set_descriptor);
+    }
 
-    wireframe_pipeline_descriptor.add_push_constant({ShaderStageType::VERTEX, sizeof(glm::mat4)});
+    instance_descriptor_set_handle = create_instance_descriptor_set(renderer);
 
-    renderer->create_pipeline(wireframe_pipeline_descriptor);
+    // Bindless materials are plain indices into a table, no per material set is needed.
+    if (renderer->is_bindless_supported())
+    {
+        auto material_data = get_material_data();
+        for (auto& frame : frames)
+        {
+            frame.material_table = renderer->create_buffer(
+              BufferDescriptor{sizeof(MaterialData), BufferType::STORAGE, &material_data}
+                .set_bindless()
+                .set_host_visible());
+            frame.material_version = material_version;
+        }
+    }
 
     return true;
 }
 
 void RendererModule::stop()
 {
-    PINFO("Shutting down renderer.");
+    PLOG(INFO, RENDER, "Shutting down renderer.");
 
-    renderer->destroy_descriptor_set_layout(wireframe_descriptor_set_layout_handle);
-    renderer->destroy_descriptor_set_layout(descriptor_set_layout_handle);
-    renderer->destroy_descriptor_set_layout(instance_descriptor_set_layout_handle);
-    renderer->destroy_descriptor_set(descriptor_set_handle);
-    renderer->destroy_descriptor_set(wireframe_descriptor_set_handle);
+    pipeline_library.shutdown();
+    render_manager.clear();
+    for (auto& frame : frames)
+    {
+        renderer->destroy_descriptor_set(frame.descriptor_set_handle);
+        renderer->destroy_descriptor_set(frame.wireframe_descriptor_set_handle);
+        renderer->destroy_descriptor_set(frame.depth_descriptor_set_handle);
+        renderer->destroy_buffer(frame.global_ubo);
+        renderer->destroy_buffer(frame.light_buffer);
+        renderer->destroy_buffer(frame.cluster_buffer);
+        renderer->destroy_buffer(frame.light_index_buffer);
+        renderer->destroy_buffer(frame.cluster_info_ubo);
+        renderer->destroy_buffer(frame.shadow_view_buffer);
+        if (frame.material_table.id != INVALID_ID)
+        {
+            renderer->destroy_buffer(frame.material_table);
+        }
+    }
     renderer->destroy_descriptor_set(instance_descriptor_set_handle);
-    renderer->destroy_texture(material.albedo_texture);
+    if (albedo_stream == INVALID_ID)
+    {
+        renderer->destroy_texture(material.albedo_texture);
+    }
+    texture_streamer.shutdown();
     renderer->destroy_texture(material.normal_texture);
-    renderer->destroy_buffer(global_ubo);
-    renderer->destroy_buffer(light_ubo);
+    renderer->destroy_texture(shadow_atlas_texture);
     renderer->destroy_buffer(material_buffer);
 
     renderer->shutdown();
@@ -337,8 +581,15 @@ void RendererModule::stop()
 void RendererModule::render()
 {
     renderer->begin_frame();
+    auto& frame = frames[renderer->get_frame_index()];
 
     static u32 current_image = 0;
+    static u32 gpu_lane      = profiler::create_lane("GPU");
+
+    for (const auto& zone : renderer->get_gpu_zones())
+    {
+        profiler::add_zone(gpu_lane, zone.name, zone.start, zone.end, zone.depth);
+    }
 
     UniformBuffer ubo{};
 
@@ -357,85 +608,133 @@ void RendererModule::render()
     ubo.proj = camera->get_projection();
     ubo.proj[1][1] *= -1;
 
-    upload_data_to_buffer(renderer, global_ubo, &ubo, sizeof(ubo));
-
-    Entity* light_entity = get_entity_by_name("light");
-    ASSERT(light_entity);
-
-    PointLightComponent* point_light     = light_entity->get<PointLightComponent>();
-    TransformComponent*  point_transform = light_entity->get<TransformComponent>();
-
-    LightData light_data[3];
-    light_data[0].color        = point_light->color;
-    light_data[0].intensity    = point_light->intensity;
-    light_data[0].max_distance = point_light->radius;
-    light_data[0].position     = point_transform->get_position();
-
-    Entity* light_entity1 = get_entity_by_name("light1");
-    ASSERT(light_entity1);
+    upload_data_to_buffer(renderer, frame.global_ubo, &ubo, sizeof(ubo));
 
-    PointLightComponent* point_light1     = light_entity1->get<PointLightComponent>();
-    TransformComponent*  point_transform1 = light_entity1->get<TransformComponent>();
+    stream_material_textures(renderer, *camera);
+    update_material_table(renderer, frame);
 
-    light_data[1].color        = point_light1->color;
-    light_data[1].intensity    = point_light1->intensity;
-    light_data[1].max_distance = point_light1->radius;
-    light_data[1].position     = point_transform1->get_position();
+    update_light_clusters(renderer, *camera, frame);
 
-    Entity* light_entity2 = get_entity_by_name("light2");
-    ASSERT(light_entity2);
+    auto cmd = renderer->get_command_buffer(true);
+    cmd->begin_gpu_zone("Frame");
 
-    PointLightComponent* point_light2     = light_entity2->get<PointLightComponent>();
-    TransformComponent*  point_transform2 = light_entity2->get<TransformComponent>();
+    cmd->clear(0.3f, 0.5f, 0.3f, 1.0f);
+    cmd->begin_gpu_zone("Shadows");
+    render_shadows(cmd);
+    cmd->end_gpu_zone();
+    cmd->bind_pass("Swapchain_renderpass");
 
-    light_data[2].color        = point_light2->color;
-    light_data[2].intensity    = point_light2->intensity;
-    light_data[2].max_distance = point_light2->radius;
-    light_data[2].position     = point_transform2->get_position();
+    const bool bindless      = !is_wireframe && frame.material_table.id != INVALID_ID;
+    const bool depth_prepass = !is_wireframe && is_depth_prepass;
+    render_manager.set_material_table(bindless ? frame.material_table : invalid_buffer);
+    render_manager.sort_front_to_back(camera->get_eye());
 
-    upload_data_to_buffer(renderer, light_ubo, &light_data, sizeof(LightData) * LIGHT_COUNT, 0);
+    if (depth_prepass)
+    {
+        cmd->begin_gpu_zone("Depth pre-pass");
+        cmd->bind_pipeline("depth_prepass_pipeline");
+        cmd->set_scissors(nullptr);
+        cmd->set_viewport(nullptr);
+        cmd->bind_descriptor_set(frame.depth_descriptor_set_handle);
+        render_manager.render_depth(cmd);
+        cmd->end_gpu_zone();
+    }
 
-    auto cmd = renderer->get_command_buffer(true);
+    cmd->begin_gpu_zone("Forward");
 
-    cmd->clear(0.3f, 0.5f, 0.3f, 1.0f);
-    cmd->bind_pass("Swapchain_renderpass");
-    is_wireframe ? cmd->bind_pipeline("wireframe_pipeline") :
-                   cmd->bind_pipeline("forward_pipeline");
+    if (is_wireframe)
+    {
+        cmd->bind_pipeline("wireframe_pipeline");
+    }
+    else if (bindless)
+    {
+        depth_prepass ? cmd->bind_pipeline("forward_bindless_depth_equal_pipeline") :
+                        cmd->bind_pipeline("forward_bindless_pipeline");
+    }
+    else
+    {
+        depth_prepass ? cmd->bind_pipeline("forward_depth_equal_pipeline") :
+                        cmd->bind_pipeline("forward_pipeline");
+    }
     cmd->set_scissors(nullptr);
     cmd->set_viewport(nullptr);
 
     if (is_wireframe)
     {
-        cmd->bind_descriptor_set(wireframe_descriptor_set_handle);
+        cmd->bind_descriptor_set(frame.wireframe_descriptor_set_handle);
+    }
+    else if (bindless)
+    {
+        cmd->bind_descriptor_set(frame.descriptor_set_handle);
+        cmd->bind_descriptor_set(renderer->get_bindless_set(), 1);
     }
     else
     {
-        cmd->bind_descriptor_set(descriptor_set_handle);
+        cmd->bind_descriptor_set(frame.descriptor_set_handle);
         cmd->bind_descriptor_set(instance_descriptor_set_handle, 1);
     }
 
     render_manager.render_all(cmd, Handle());
+    cmd->end_gpu_zone();
 
+    cmd->begin_gpu_zone("Debug");
     cmd->bind_pipeline("wireframe_pipeline");
-    cmd->bind_descriptor_set(wireframe_descriptor_set_handle);
+    cmd->bind_descriptor_set(frame.wireframe_descriptor_set_handle);
 
     auto module_manager = Engine::Get().get_module_manager();
     module_manager->render_debug(cmd);
-    module_manager->render_debug_menu(*cmd);
+    // There is no UI without a window.
+    if (graphics_api != pinut::GraphicsAPI::Null)
+    {
+        module_manager->render_debug_menu(*cmd);
+    }
+    cmd->end_gpu_zone();
+
+    cmd->end_gpu_zone();
 
-    renderer->end_frame();
+    {
+        PROFILE_ZONE("GPUDevice::end_frame");
+        renderer->end_frame();
+    }
 
     current_image++;
 }
 
 void RendererModule::render_debug_menu()
 {
-    auto io = ImGui::GetIO();
-    ImGui::Text("Time: %lf (Delta:%f FPS:%f)", 0.0f, io.DeltaTime, io.Framerate);
+    auto        io     = ImGui::GetIO();
+    const auto& frame  = profiler::get_last_frame();
+    const f64   cpu_ms = static_cast<f64>(frame.end - frame.start) / 1000000.0;
+
+    // Outermost zones only, nested ones are already inside them.
+    f64 gpu_ms = 0.0;
+    for (const auto& zone : renderer->get_gpu_zones())
+    {
+        if (zone.depth == 0)
+        {
+            gpu_ms += static_cast<f64>(zone.end - zone.start) / 1000000.0;
+        }
+    }
+
+    ImGui::Text("CPU: %.3f ms GPU: %.3f ms (Delta:%f FPS:%f)",
+                cpu_ms,
+                gpu_ms,
+                io.DeltaTime,
+                io.Framerate);
+
+    const auto& engine      = Engine::Get();
+    const auto& frame_times = engine.get_frame_time_stats();
+    ImGui::Text("Frame time p50: %.3f ms p99: %.3f ms, fixed step alpha: %.2f",
+                get_frame_time_percentile(&frame_times, 0.5) * 1000.0,
+                get_frame_time_percentile(&frame_times, 0.99) * 1000.0,
+                engine.get_fixed_timestep_alpha());
+    ImGui::Checkbox("Depth pre-pass", &is_depth_prepass);
 }
 
 void RendererModule::resize_window(u32 width, u32 height)
 {
+    viewport_width  = width;
+    viewport_height = height;
     renderer->resize(width, height);
 }
 } // namespace modules
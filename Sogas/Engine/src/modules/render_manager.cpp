@@ -7,6 +7,7 @@
 #include <modules/render_manager.h>
 #include <render_device.h>
 #include <resources/mesh.h>
+#include <resources/texture_streamer.h>
 
 namespace sogas
 {
@@ -14,23 +15,98 @@ namespace modules
 {
 RenderManager render_manager;
 
-void RenderManager::add_key(Handle owner, const Mesh* mesh)
+// Must match the push constant block of the bindless shaders.
+struct DrawConstants
+{
+    glm::mat4 model;
+    u32       material_buffer;
+    u32       material_index;
+};
+
+// Must match the push constant block of shadow.vert.
+struct ShadowConstants
+{
+    glm::mat4 view_projection;
+    glm::mat4 model;
+};
+
+void RenderManager::add_key(Handle owner, const Mesh* mesh, u32 material_index)
 {
     RenderKey key;
-    key.owner_handle = owner;
-    key.mesh         = mesh;
-    key.transform    = Handle();
+    key.owner_handle   = owner;
+    key.mesh           = mesh;
+    key.material_index = material_index;
+    key.transform      = Handle();
 
     keys.push_back(key);
 }
 
-void RenderManager::render_all(pinut::resources::CommandBuffer* cmd, Handle /*camera_handle*/)
+void RenderManager::clear()
 {
-    // TODO If keys are dirty, sort keys.
+    keys = Vector<RenderKey>(get_heap_allocator());
+}
 
-    /*Entity* camera = camera_handle;
-    ASSERT(camera);*/
+void RenderManager::set_material_table(pinut::resources::BufferHandle buffer)
+{
+    material_table = buffer;
+}
 
+// World space bounds of the mesh, scaled by the largest axis of the transform.
+static BoundingSphere get_world_bounding_sphere(TransformComponent* transform, const Mesh* mesh)
+{
+    const auto model = transform->as_matrix();
+    const auto scale = transform->get_scale();
+
+    BoundingSphere sphere;
+    sphere.center = glm::vec3(model * glm::vec4(mesh->bounding_sphere.center, 1.0f));
+    sphere.radius = mesh->bounding_sphere.radius * std::max({scale.x, scale.y, scale.z});
+    return sphere;
+}
+
+void RenderManager::sort_front_to_back(const glm::vec3& eye)
+{
+    for (auto& key : keys)
+    {
+        Entity*    entity = key.owner_handle.get_owner();
+        const auto sphere = get_world_bounding_sphere(entity->get<TransformComponent>(), key.mesh);
+        key.view_depth    = glm::length(sphere.center - eye) - sphere.radius;
+    }
+
+    // Keys at the same depth stay grouped by mesh to save vertex buffer binds.
+    std::sort(keys.begin(), keys.end(), [](const RenderKey& a, const RenderKey& b) {
+        if (a.view_depth != b.view_depth)
+        {
+            return a.view_depth < b.view_depth;
+        }
+        return a.mesh < b.mesh;
+    });
+}
+
+f32 RenderManager::get_projected_size(u32              material_index,
+                                      const glm::vec3& eye,
+                                      f32              fov,
+                                      f32              viewport_height) const
+{
+    f32 projected_size = 0.0f;
+    for (const auto& key : keys)
+    {
+        if (key.material_index != material_index)
+        {
+            continue;
+        }
+
+        Entity*    entity = key.owner_handle.get_owner();
+        const auto sphere = get_world_bounding_sphere(entity->get<TransformComponent>(), key.mesh);
+
+        projected_size =
+          std::max(projected_size, get_projected_diameter(sphere, eye, fov, viewport_height));
+    }
+
+    return projected_size;
+}
+
+void RenderManager::render_depth(pinut::resources::CommandBuffer* cmd)
+{
     for (auto& key : keys)
     {
         Entity*             entity    = key.owner_handle.get_owner();
@@ -41,6 +117,90 @@ void RenderManager::render_all(pinut::resources::CommandBuffer* cmd, Handle /*ca
                                sizeof(glm::mat4),
                                0,
                                &model);
+
+        key.mesh->draw_indexed(cmd);
+    }
+}
+
+void RenderManager::render_shadow(pinut::resources::CommandBuffer* cmd,
+                                  const glm::mat4&                 view_projection,
+                                  const BoundingSphere&            light_bounds)
+{
+    for (auto& key : keys)
+    {
+        Entity*             entity    = key.owner_handle.get_owner();
+        TransformComponent* transform = entity->get<TransformComponent>();
+
+        if (!get_world_bounding_sphere(transform, key.mesh).intersects(light_bounds))
+        {
+            continue;
+        }
+
+        ShadowConstants constants = {view_projection, transform->as_matrix()};
+        cmd->set_push_constant(pinut::resources::ShaderStageType::VERTEX,
+                               sizeof(ShadowConstants),
+                               0,
+                               &constants);
+
+        key.mesh->draw_indexed(cmd);
+    }
+}
+
+void RenderManager::collect_moved_casters(Vector<BoundingSphere>& moved)
+{
+    for (auto& key : keys)
+    {
+        Entity*             entity    = key.owner_handle.get_owner();
+        TransformComponent* transform = entity->get<TransformComponent>();
+        const auto          model     = transform->as_matrix();
+
+        // Rotating in place keeps the bounds but still changes the shadow.
+        if (model == key.caster_model)
+        {
+            continue;
+        }
+
+        // A zero matrix is never a valid transform, the key has not been seen yet.
+        if (key.caster_model != glm::mat4(0.0f))
+        {
+            moved.push_back(key.caster_bounds);
+        }
+
+        key.caster_model  = model;
+        key.caster_bounds = get_world_bounding_sphere(transform, key.mesh);
+        moved.push_back(key.caster_bounds);
+    }
+}
+
+void RenderManager::render_all(pinut::resources::CommandBuffer* cmd, Handle /*camera_handle*/)
+{
+    PROFILE_ZONE("RenderManager::render_all");
+
+    /*Entity* camera = camera_handle;
+    ASSERT(camera);*/
+
+    for (auto& key : keys)
+    {
+        Entity*             entity    = key.owner_handle.get_owner();
+        TransformComponent* transform = entity->get<TransformComponent>();
+        auto                model     = transform->as_matrix();
+
+        if (material_table.id != INVALID_ID)
+        {
+            DrawConstants constants = {model, material_table.id, key.material_index};
+            cmd->set_push_constant(pinut::resources::ShaderStageType::ALL_GRAPHICS,
+                                   sizeof(DrawConstants),
+                                   0,
+                                   &constants);
+        }
+        else
+        {
+            cmd->set_push_constant(pinut::resources::ShaderStageType::VERTEX,
+                                   sizeof(glm::mat4),
+                                   0,
+                                   &model);
+        }
+
         key.mesh->draw_indexed(cmd);
     }
 }
@@ -35,9 +35,13 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
+#ifdef _MSC_VER
 #pragma warning(disable : 4201)
+#endif
 #include <glm/ext/quaternion_float.hpp>
+#ifdef _MSC_VER
 #pragma warning(default : 4201)
+#endif
 #include <glm/ext/quaternion_common.hpp>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/matrix_decompose.hpp>
@@ -49,9 +53,11 @@
 
 // engine includes
 #include <engine/defines.h>
+#include <memory_tracker.h>
 #include <engine/math.h>
 #include <engine/smemory.h>
-#include <handle/handle.h>
 #include <platform/platform.h>
+#include <engine/profiler.h>
+#include <handle/handle.h>
 
 #endif //PCH_HPP
@@ -1,14 +1,23 @@
 #include "pch.hpp"
 
+#include <chrono>
 #include <fstream>
+#include <thread>
 
 #include <platform/platform.h>
 
-#ifdef _WIN64
+#ifndef _WIN64
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace
 {
 using namespace sogas::platform;
 
+#ifdef _WIN64
 // Called every time the application receives a message
 LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 {
@@ -27,12 +36,28 @@ struct Window_info
     DWORD       style{0};
     bool        is_fullscreen{false};
 };
+#else
+// Headless windows only keep the sizes asked for, so the renderer and the UI see a consistent
+// client area.
+struct Window_info
+{
+    const char* caption{nullptr};
+    u32         width{1920};
+    u32         height{1080};
+    bool        is_fullscreen{false};
+};
+#endif
 
 std::vector<Window_info> windows; // Holds info for the open windows.
 std::vector<Window_id>
   available_windows; // If there is any empty slot in the windows vector, this will hold its id.
 
-static const Window_id add_window(Window_info info)
+Frame_budget                          frame_budget;
+u32                                   frames_run{0};
+bool                                  quit_requested{false};
+std::chrono::steady_clock::time_point next_frame_time{};
+
+static Window_id add_window(Window_info info)
 {
     u32 id{INVALID_ID};
     if (available_windows.empty())
@@ -61,6 +86,40 @@ static void remove_from_windows(Window_id id)
     available_windows.emplace_back(id);
 }
 
+// Called once per frame by peek_message, returns true when the main loop has to quit.
+static bool spend_frame_budget()
+{
+    if (quit_requested)
+    {
+        return true;
+    }
+
+    if (frame_budget.frame_time > 0)
+    {
+        using namespace std::chrono;
+
+        // A frame running over its time starts the next one right away, without catching up.
+        const auto now = steady_clock::now();
+        if (next_frame_time > now)
+        {
+            std::this_thread::sleep_until(next_frame_time);
+        }
+        next_frame_time = std::max(next_frame_time, now) +
+                          duration_cast<steady_clock::duration>(
+                            duration<f64>(frame_budget.frame_time));
+    }
+
+    if (frame_budget.frame_count != 0 && frames_run >= frame_budget.frame_count)
+    {
+        quit_requested = true;
+        return true;
+    }
+
+    frames_run++;
+    return false;
+}
+
+#ifdef _WIN64
 static void resize_window(const Window_info& info, const RECT& rect)
 {
     RECT window_rect{rect};
@@ -71,14 +130,14 @@ static void resize_window(const Window_info& info, const RECT& rect)
 
     MoveWindow(info.handle, info.top_left.x, info.top_left.y, width, height, true);
 }
-} // namespace
 #endif
+} // namespace
 
 namespace sogas::platform
 {
 #ifdef _WIN64
 
-const Window_id create_window(const window_init_info* window_init_info)
+Window_id create_window(const window_init_info* window_init_info)
 {
     window_proc   callback = window_init_info ? window_init_info->window_proc : nullptr;
     window_handle parent   = window_init_info ? window_init_info->window_handle : nullptr;
@@ -178,7 +237,7 @@ bool peek_message()
             DispatchMessage(&msg);
         }
         else
-            return false;
+            return spend_frame_budget();
     }
 
     return true;
@@ -208,13 +267,13 @@ void get_window_size(const Window_id id, u32& width, u32& height)
     height           = info.client_area.bottom - info.client_area.top;
 }
 
-const u32 get_window_width(const Window_id id)
+u32 get_window_width(const Window_id id)
 {
     const auto& client_area = get_from_id(id).client_area;
     return client_area.left - client_area.right;
 }
 
-const u32 get_window_height(const Window_id id)
+u32 get_window_height(const Window_id id)
 {
     const auto& client_area = get_from_id(id).client_area;
     return client_area.bottom - client_area.top;
@@ -260,28 +319,245 @@ void* get_window_handle(const Window_id id)
     return get_from_id(id).handle;
 }
 
-i32 string_format(char* dest, const char* format, ...)
+bool is_headless()
+{
+    return false;
+}
+
+i32 string_format(char* dest, const char* format, va_list va_args)
 {
     if (dest != nullptr)
     {
-        va_list argptr;
-        va_start(argptr, format);
-        const auto number_written = string_format(dest, format, argptr);
-        va_end(argptr);
+        char       buffer[char_buffer_size];
+        const auto number_written =
+          _vsnprintf_s(buffer, sizeof(buffer), (size_t)char_buffer_size, format, va_args);
+        memcpy(dest, buffer, number_written + 1);
         return number_written;
     }
 
     return -1;
 }
 
+bool map_file(const std::string& filename, Mapped_file& out_file)
+{
+    out_file      = {};
+    out_file.file = CreateFileA(filename.c_str(),
+                                GENERIC_READ,
+                                FILE_SHARE_READ,
+                                nullptr,
+                                OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                                nullptr);
+    if (out_file.file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(out_file.file, &size) || size.QuadPart == 0)
+    {
+        unmap_file(out_file);
+        return false;
+    }
+
+    out_file.size    = static_cast<u64>(size.QuadPart);
+    out_file.mapping = CreateFileMappingA(out_file.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (out_file.mapping)
+    {
+        out_file.data = MapViewOfFile(out_file.mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+
+    if (!out_file.data)
+    {
+        PERROR("Failed to map file %s.", filename.c_str());
+        unmap_file(out_file);
+        return false;
+    }
+
+    return true;
+}
+
+void unmap_file(Mapped_file& file)
+{
+    if (file.data)
+    {
+        UnmapViewOfFile(file.data);
+    }
+
+    if (file.mapping)
+    {
+        CloseHandle(file.mapping);
+    }
+
+    if (file.file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(file.file);
+    }
+
+    file = {};
+}
+
+#else
+
+Window_id create_window(const window_init_info* window_init_info)
+{
+    Window_info info{};
+    info.caption =
+      (window_init_info && window_init_info->caption) ? window_init_info->caption : "Sogas Engine";
+
+    if (window_init_info)
+    {
+        info.width  = static_cast<u32>(window_init_info->width);
+        info.height = static_cast<u32>(window_init_info->height);
+    }
+
+    PINFO("Running headless, no window created for %s.", info.caption);
+
+    return add_window(std::move(info));
+}
+
+bool peek_message()
+{
+    return spend_frame_budget();
+}
+
+void remove_window(Window_id id)
+{
+    remove_from_windows(id);
+}
+
+void resize_window(const Window_id id, const u32 width, const u32 height)
+{
+    auto& info{get_from_id(id)};
+    info.width  = width;
+    info.height = height;
+}
+
+void get_window_size(const Window_id id, u32& width, u32& height)
+{
+    const auto& info = get_from_id(id);
+    width            = info.width;
+    height           = info.height;
+}
+
+u32 get_window_width(const Window_id id)
+{
+    return get_from_id(id).width;
+}
+
+u32 get_window_height(const Window_id id)
+{
+    return get_from_id(id).height;
+}
+
+void set_window_fullscreen(const Window_id id, bool is_fullscreen)
+{
+    get_from_id(id).is_fullscreen = is_fullscreen;
+}
+
+bool is_window_fullscreen(const Window_id id)
+{
+    return get_from_id(id).is_fullscreen;
+}
+
+void* get_window_handle(const Window_id /*id*/)
+{
+    return nullptr;
+}
+
+bool is_headless()
+{
+    return true;
+}
+
 i32 string_format(char* dest, const char* format, va_list va_args)
 {
     if (dest != nullptr)
     {
         char       buffer[char_buffer_size];
-        const auto number_written =
-          _vsnprintf_s(buffer, sizeof(buffer), (size_t)char_buffer_size, format, va_args);
-        memcpy(dest, buffer, number_written + 1);
+        const auto number_written = vsnprintf(buffer, sizeof(buffer), format, va_args);
+        if (number_written < 0)
+        {
+            return -1;
+        }
+
+        // vsnprintf returns the length the whole string would have, copy only what fit.
+        const auto length = std::min(number_written, char_buffer_size - 1);
+        memcpy(dest, buffer, length + 1);
+        return length;
+    }
+
+    return -1;
+}
+
+bool map_file(const std::string& filename, Mapped_file& out_file)
+{
+    out_file      = {};
+    out_file.file = open(filename.c_str(), O_RDONLY);
+    if (out_file.file < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(out_file.file, &info) != 0 || info.st_size == 0)
+    {
+        unmap_file(out_file);
+        return false;
+    }
+
+    out_file.size = static_cast<u64>(info.st_size);
+    void* data    = mmap(nullptr, out_file.size, PROT_READ, MAP_PRIVATE, out_file.file, 0);
+    if (data == MAP_FAILED)
+    {
+        PERROR("Failed to map file %s.", filename.c_str());
+        unmap_file(out_file);
+        return false;
+    }
+
+    // Same hint FILE_FLAG_SEQUENTIAL_SCAN gives on Windows.
+    posix_madvise(data, out_file.size, POSIX_MADV_SEQUENTIAL);
+    out_file.data = data;
+    return true;
+}
+
+void unmap_file(Mapped_file& file)
+{
+    if (file.data)
+    {
+        munmap(const_cast<void*>(file.data), file.size);
+    }
+
+    if (file.file >= 0)
+    {
+        close(file.file);
+    }
+
+    file = {};
+}
+#endif
+
+void set_frame_budget(const Frame_budget& budget)
+{
+    frame_budget    = budget;
+    frames_run      = 0;
+    quit_requested  = false;
+    next_frame_time = {};
+}
+
+void request_quit()
+{
+    quit_requested = true;
+}
+
+i32 string_format(char* dest, const char* format, ...)
+{
+    if (dest != nullptr)
+    {
+        va_list argptr;
+        va_start(argptr, format);
+        const auto number_written = string_format(dest, format, argptr);
+        va_end(argptr);
         return number_written;
     }
 
@@ -301,8 +577,25 @@ json load_json(const std::string& filename)
             continue;
         }
 
+        // Read the whole file into frame scratch, parsing from memory is much faster than from the
+        // stream. The scratch is given back as soon as the file is parsed.
+        auto&     scratch = *get_frame_allocator();
+        const u64 marker  = scratch.get_marker();
+        ifs.seekg(0, std::ios::end);
+        const u64 size = static_cast<u64>(ifs.tellg());
+        ifs.seekg(0, std::ios::beg);
+        auto text = static_cast<char*>(scratch.allocate(size, 1));
+        if (text && !ifs.read(text, static_cast<std::streamsize>(size)))
+        {
+            scratch.free_marker(marker);
+            text = nullptr;
+            ifs.clear();
+            ifs.seekg(0, std::ios::beg);
+        }
+
 #ifdef NDEBUG
-        j = json::parse(ifs, nullptr, false);
+        j = text ? json::parse(text, text + size, nullptr, false) : json::parse(ifs, nullptr, false);
+        scratch.free_marker(marker);
 
         if (j.is_discarded())
         {
@@ -312,15 +605,12 @@ json load_json(const std::string& filename)
             continue;
         }
 #else
-        j = json::parse(ifs);
+        j = text ? json::parse(text, text + size) : json::parse(ifs);
+        scratch.free_marker(marker);
 #endif
         break;
     }
 
     return j;
 }
-
-#else
-#error "Only win64 platform implemented at the moment."
-#endif
 } // namespace sogas::platform
@@ -2,6 +2,11 @@
 
 #include <resources/json_helper.h>
 
+#ifndef _WIN64
+// Only floats are read, sscanf_s takes the same arguments as sscanf for them.
+#define sscanf_s sscanf
+#endif
+
 namespace sogas
 {
 glm::vec2 load_vec2(const std::string& s)
@@ -0,0 +1,178 @@
+#include "pch.hpp"
+
+#include <cmath>
+
+#include <resources/light_clusters.h>
+
+namespace sogas
+{
+u32 get_cluster_slice(f32 view_depth, f32 near, f32 far, u32 slice_count)
+{
+    if (view_depth <= near)
+    {
+        return 0;
+    }
+
+    const f32 slice = std::log(view_depth / near) / std::log(far / near) * slice_count;
+    return std::min(static_cast<u32>(slice), slice_count - 1);
+}
+
+// Tile covering a normalized [0, 1] screen coordinate.
+static u32 get_tile(f32 coordinate, u32 tile_count)
+{
+    const f32 tile = std::floor(coordinate * tile_count);
+    return static_cast<u32>(std::clamp(tile, 0.0f, static_cast<f32>(tile_count - 1)));
+}
+
+void LightClusters::init(const LightClustersDescriptor& new_descriptor)
+{
+    descriptor = new_descriptor;
+
+    lights.reserve(descriptor.max_lights);
+    bounds.reserve(descriptor.max_lights);
+    clusters.resize(descriptor.grid_x * descriptor.grid_y * descriptor.grid_z);
+    cluster_fill.resize(clusters.size());
+    light_indices.reserve(descriptor.max_light_indices);
+}
+
+void LightClusters::clear()
+{
+    lights.clear();
+}
+
+bool LightClusters::add_light(const ClusterLight& light)
+{
+    if (lights.size() >= descriptor.max_lights)
+    {
+        return false;
+    }
+
+    lights.push_back(light);
+    return true;
+}
+
+void LightClusters::build(const glm::mat4& view, f32 fov, f32 aspect_ratio, f32 near, f32 far)
+{
+    const f32 tan_half_fov = std::tan(fov * 0.5f);
+    const f32 scale_x      = 1.0f / (tan_half_fov * aspect_ratio);
+    const f32 scale_y      = 1.0f / tan_half_fov;
+
+    bounds.clear();
+    for (u32 i = 0; i < lights.size(); ++i)
+    {
+        const auto& light    = lights.at(i);
+        const auto  position = glm::vec3(view * glm::vec4(light.position, 1.0f));
+
+        // The camera looks down -z.
+        const f32 depth     = -position.z;
+        const f32 min_depth = std::max(depth - light.radius, near);
+        const f32 max_depth = std::min(depth + light.radius, far);
+        if (min_depth > max_depth)
+        {
+            continue;
+        }
+
+        // Projection of the view space box around the sphere, the extremes are at its corners.
+        const f32 x0 = position.x - light.radius;
+        const f32 x1 = position.x + light.radius;
+        const f32 y0 = position.y - light.radius;
+        const f32 y1 = position.y + light.radius;
+
+        const f32 min_x = std::min(x0 / min_depth, x0 / max_depth) * scale_x;
+        const f32 max_x = std::max(x1 / min_depth, x1 / max_depth) * scale_x;
+        const f32 min_y = std::min(y0 / min_depth, y0 / max_depth) * scale_y;
+        const f32 max_y = std::max(y1 / min_depth, y1 / max_depth) * scale_y;
+        if (max_x < -1.0f || min_x > 1.0f || max_y < -1.0f || min_y > 1.0f)
+        {
+            continue;
+        }
+
+        // Framebuffer rows go top to bottom.
+        LightBounds light_bounds;
+        light_bounds.light = i;
+        light_bounds.min_x = get_tile((min_x + 1.0f) * 0.5f, descriptor.grid_x);
+        light_bounds.max_x = get_tile((max_x + 1.0f) * 0.5f, descriptor.grid_x);
+        light_bounds.min_y = get_tile((1.0f - max_y) * 0.5f, descriptor.grid_y);
+        light_bounds.max_y = get_tile((1.0f - min_y) * 0.5f, descriptor.grid_y);
+        light_bounds.min_z = get_cluster_slice(min_depth, near, far, descriptor.grid_z);
+        light_bounds.max_z = get_cluster_slice(max_depth, near, far, descriptor.grid_z);
+        bounds.push_back(light_bounds);
+    }
+
+    for (auto& cluster : clusters)
+    {
+        cluster = {};
+    }
+
+    for (const auto& light_bounds : bounds)
+    {
+        for (u32 z = light_bounds.min_z; z <= light_bounds.max_z; ++z)
+        {
+            for (u32 y = light_bounds.min_y; y <= light_bounds.max_y; ++y)
+            {
+                for (u32 x = light_bounds.min_x; x <= light_bounds.max_x; ++x)
+                {
+                    clusters.at(get_cluster_index(x, y, z)).count++;
+                }
+            }
+        }
+    }
+
+    // Lists past the index budget are cut short rather than overflowing.
+    u32 offset = 0;
+    for (auto& cluster : clusters)
+    {
+        cluster.offset = offset;
+        cluster.count  = std::min(cluster.count, descriptor.max_light_indices - offset);
+        offset += cluster.count;
+    }
+
+    light_indices.resize(offset);
+
+    std::fill(cluster_fill.begin(), cluster_fill.end(), 0);
+    for (const auto& light_bounds : bounds)
+    {
+        for (u32 z = light_bounds.min_z; z <= light_bounds.max_z; ++z)
+        {
+            for (u32 y = light_bounds.min_y; y <= light_bounds.max_y; ++y)
+            {
+                for (u32 x = light_bounds.min_x; x <= light_bounds.max_x; ++x)
+                {
+                    const u32   index   = get_cluster_index(x, y, z);
+                    const auto& cluster = clusters.at(index);
+                    auto&       fill    = cluster_fill.at(index);
+                    if (fill < cluster.count)
+                    {
+                        light_indices.at(cluster.offset + fill++) = light_bounds.light;
+                    }
+                }
+            }
+        }
+    }
+}
+
+u32 LightClusters::get_cluster_index(u32 x, u32 y, u32 z) const
+{
+    return (z * descriptor.grid_y + y) * descriptor.grid_x + x;
+}
+
+const LightClustersDescriptor& LightClusters::get_descriptor() const
+{
+    return descriptor;
+}
+
+const std::vector<ClusterLight>& LightClusters::get_lights() const
+{
+    return lights;
+}
+
+const std::vector<ClusterRange>& LightClusters::get_clusters() const
+{
+    return clusters;
+}
+
+const std::vector<u32>& LightClusters::get_light_indices() const
+{
+    return light_indices;
+}
+} // namespace sogas
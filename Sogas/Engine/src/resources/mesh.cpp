@@ -12,7 +12,6 @@ static void calculate_bounding_sphere(sogas::BoundingSphere&            sphere,
     sphere.center = glm::vec3(0.0f);
     sphere.radius = 0.0f;
 
-    glm::vec3 point = glm::vec3(0.0f);
     for (const auto& vertex : vertices)
     {
         const auto distance = glm::length(sphere.center - vertex.position);
@@ -110,6 +109,18 @@ static void upload_buffer(pinut::resources::BufferHandle buffer, const u32 size,
     device->destroy_buffer({vertex_staging_buffer});
 }
 
+static void track_mesh_memory(Mesh* mesh)
+{
+    if (mesh->tracked_memory > 0)
+    {
+        track_deallocation(MemoryTag::MESHES, mesh->tracked_memory);
+    }
+
+    mesh->tracked_memory =
+      mesh->vertices.capacity() * sizeof(Vertex) + mesh->indices.capacity() * sizeof(u16);
+    track_allocation(MemoryTag::MESHES, mesh->tracked_memory);
+}
+
 void init_default_meshes()
 {
     auto device = sogas::Engine::Get().get_renderer()->get_device();
@@ -128,6 +139,7 @@ void init_default_meshes()
     upload_buffer(plane->vertex_buffer, plane_vertex_size, plane_vertices.data());
     upload_buffer(plane->index_buffer, plane_index_size, plane_indices.data());
 
+    track_mesh_memory(plane);
     meshes->insert({"plane", plane});
 
     Mesh*     cube             = new Mesh();
@@ -142,6 +154,7 @@ void init_default_meshes()
 
     upload_buffer(cube->vertex_buffer, cube_vertex_size, cube_vertices.data());
     upload_buffer(cube->index_buffer, cube_index_size, cube_indices.data());
+    track_mesh_memory(cube);
     meshes->insert({"cube", cube});
 }
 
@@ -173,17 +186,29 @@ void load_mesh(const std::string& name, const std::string& filename)
 
     if (!warn.empty())
     {
-        PWARN(warn.c_str());
+        PLOG(WARNING, RESOURCES, "%s", warn.c_str());
     }
 
     if (!err.empty())
     {
-        PERROR(err.c_str());
+        PLOG(ERROR, RESOURCES, "%s", err.c_str());
         ASSERT(false);
     }
 
-    Mesh*                                mesh = new Mesh();
-    std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+    Mesh* mesh = new Mesh();
+
+    // Every index may add a vertex, reserving up front avoids regrowing while building. The
+    // vertices are kept with the mesh, they are not reserved for the worst case.
+    u64 index_count = 0;
+    for (const auto& shape : shapes)
+    {
+        index_count += shape.mesh.indices.size();
+    }
+    mesh->indices.reserve(index_count);
+
+    // Only needed while building, it goes back to the heap once the mesh is uploaded.
+    UnorderedMap<Vertex, u32> uniqueVertices{get_heap_allocator()};
+    uniqueVertices.reserve(index_count);
 
     for (const auto& shape : shapes)
     {
@@ -242,6 +267,7 @@ void load_mesh(const std::string& name, const std::string& filename)
 
     calculate_bounding_sphere(mesh->bounding_sphere, mesh->vertices);
 
+    track_mesh_memory(mesh);
     meshes->insert({name, mesh});
 }
 
@@ -260,15 +286,30 @@ void Mesh::draw_indexed(pinut::resources::CommandBuffer* cmd) const
 
 void Mesh::destroy()
 {
-    auto device = sogas::Engine::Get().get_renderer()->get_device();
+    if (tracked_memory > 0)
+    {
+        track_deallocation(MemoryTag::MESHES, tracked_memory);
+        tracked_memory = 0;
+    }
 
     vertices.clear();
+    indices.clear();
+
+    // Never uploaded or already destroyed, the destructor runs after an explicit destroy.
+    if (vertex_buffer.id == INVALID_ID)
+    {
+        return;
+    }
+
+    auto device = sogas::Engine::Get().get_renderer()->get_device();
+
     device->destroy_buffer(vertex_buffer);
+    vertex_buffer = pinut::resources::invalid_buffer;
 
-    if (!indices.empty())
+    if (index_buffer.id != INVALID_ID)
     {
         device->destroy_buffer(index_buffer);
-        indices.clear();
+        index_buffer = pinut::resources::invalid_buffer;
     }
 }
 
@@ -301,6 +342,7 @@ void Mesh::upload()
     }
 
     auto meshes = Engine::Get().get_meshes();
+    track_mesh_memory(this);
     meshes->insert({name, this});
 }
 } // namespace sogas
@@ -0,0 +1,437 @@
+#include "pch.hpp"
+
+#include <render_device.h>
+#include <resources/hash.h>
+#include <resources/pipeline_library.h>
+#include <resources/shader_reflection.h>
+
+#ifndef SOGAS_SHADER_DIR
+#define SOGAS_SHADER_DIR "shaders/"
+#endif
+
+namespace sogas
+{
+using namespace pinut::resources;
+
+// Looks up a json string in a name table, the index in the table is the enum value.
+template <typename T, size_t N>
+static bool parse_enum(const json&                       j,
+                       const char*                       attribute,
+                       const std::array<const char*, N>& names,
+                       T&                                out_value)
+{
+    if (j.count(attribute) == 0)
+    {
+        return true;
+    }
+
+    const std::string value = j[attribute].get<std::string>();
+    for (size_t i = 0; i < N; ++i)
+    {
+        if (value == names.at(i))
+        {
+            out_value = static_cast<T>(i);
+            return true;
+        }
+    }
+
+    PLOG(ERROR, RENDER, "Unknown value %s for pipeline attribute %s.", value.c_str(), attribute);
+    return false;
+}
+
+static const std::array<const char*, 4> cull_mode_names  = {"none", "front", "back", "both"};
+static const std::array<const char*, 2> front_face_names = {"counter_clockwise", "clockwise"};
+static const std::array<const char*, 3> fill_mode_names  = {"fill", "line", "point"};
+static const std::array<const char*, 6> topology_names   = {"point",
+                                                            "line",
+                                                            "line_strip",
+                                                            "triangle",
+                                                            "triangle_strip",
+                                                            "triangle_fan"};
+static const std::array<const char*, 7> format_names     = {"float",
+                                                            "int",
+                                                            "uint",
+                                                            "bool",
+                                                            "vec2",
+                                                            "vec3",
+                                                            "vec4"};
+static const std::array<const char*, 8> compare_names    = {"never",
+                                                            "less",
+                                                            "equal",
+                                                            "less_or_equal",
+                                                            "greater",
+                                                            "not_equal",
+                                                            "greater_or_equal",
+                                                            "always"};
+static const std::array<const char*, 2> input_rate_names = {"vertex", "instance"};
+static const std::array<const char*, 4> stage_names = {"vertex", "geometry", "fragment", "compute"};
+static const std::array<const char*, 9> descriptor_type_names = {"sampler",
+                                                                 "combined_image_sampler",
+                                                                 "sampled_image",
+                                                                 "storage_image",
+                                                                 "uniform",
+                                                                 "storage",
+                                                                 "uniform_dynamic",
+                                                                 "storage_dynamic",
+                                                                 "input_attachment"};
+
+static bool read_shader_binary(const std::string& filepath, std::vector<u32>& out_buffer)
+{
+    out_buffer.clear();
+
+    std::ifstream file(filepath, std::ios::ate | std::ios::binary);
+
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    auto file_size = static_cast<size_t>(file.tellg());
+    ASSERT(file_size > 0);
+
+    out_buffer.resize(file_size / sizeof(u32));
+
+    file.seekg(0);
+    file.read((char*)(out_buffer.data()), file_size);
+    file.close();
+
+    return true;
+}
+
+PipelineDescriptor PipelineSpec::get_descriptor() const
+{
+    PipelineDescriptor descriptor = {};
+    descriptor.name               = name.c_str();
+    descriptor.shader_state       = shader_state;
+    descriptor.shader_state.name  = shader_name.c_str();
+    descriptor.rasterization      = rasterization;
+    descriptor.depth_stencil      = depth_stencil;
+    descriptor.vertex_input       = vertex_input;
+    descriptor.topology           = topology;
+    descriptor.render_pass        = render_pass.empty() ? nullptr : render_pass.c_str();
+
+    for (const auto& push_constant : push_constants)
+    {
+        descriptor.add_push_constant(push_constant);
+    }
+
+    return descriptor;
+}
+
+bool parse_pipeline_spec(const json& j, PipelineSpec& out_spec)
+{
+    ASSERT(j.is_object());
+
+    out_spec.name         = j.value("name", "");
+    out_spec.render_pass  = j.value("render_pass", "");
+    out_spec.topology     = TopologyType::TRIANGLE;
+    out_spec.bindless_set = j.value("bindless_set", -1);
+
+    if (out_spec.name.empty())
+    {
+        PLOG(ERROR, RENDER, "Pipeline spec without name.");
+        return false;
+    }
+
+    bool ok = parse_enum(j, "topology", topology_names, out_spec.topology);
+
+    if (j.count("shaders"))
+    {
+        const auto& jshaders = j["shaders"];
+        out_spec.shader_name = jshaders.value("name", out_spec.name);
+
+        for (u32 i = 0; i < MAX_SPEC_SHADER_STAGES; ++i)
+        {
+            out_spec.shader_paths.at(i) = jshaders.value(stage_names.at(i), "");
+        }
+    }
+
+    if (j.count("rasterization"))
+    {
+        const auto& jraster = j["rasterization"];
+        auto&       raster  = out_spec.rasterization;
+
+        ok &= parse_enum(jraster, "cull_mode", cull_mode_names, raster.cull_mode);
+        ok &= parse_enum(jraster, "front_face", front_face_names, raster.front_face);
+        ok &= parse_enum(jraster, "fill_mode", fill_mode_names, raster.fill_mode);
+        raster.line_width = jraster.value("line_width", 1.0f);
+    }
+
+    out_spec.depth_stencil = {};
+    if (j.count("depth_stencil"))
+    {
+        const auto& jdepth = j["depth_stencil"];
+        auto&       depth  = out_spec.depth_stencil;
+
+        depth.depth_test  = jdepth.value("depth_test", true);
+        depth.depth_write = jdepth.value("depth_write", true);
+        ok &= parse_enum(jdepth, "depth_compare", compare_names, depth.depth_compare);
+    }
+
+    out_spec.vertex_input.reset();
+    if (j.count("vertex_input"))
+    {
+        const auto& jinput = j["vertex_input"];
+
+        for (const auto& jstream : jinput.value("streams", json::array()))
+        {
+            VertexStream stream = {};
+            stream.binding      = static_cast<u16>(jstream.value("binding", 0u));
+            stream.stride       = static_cast<u16>(jstream.value("stride", 0u));
+            ok &= parse_enum(jstream, "input_rate", input_rate_names, stream.input_rate);
+            out_spec.vertex_input.add_vertex_stream(stream);
+        }
+
+        for (const auto& jattribute : jinput.value("attributes", json::array()))
+        {
+            VertexAttribute attribute = {};
+            attribute.location        = static_cast<u16>(jattribute.value("location", 0u));
+            attribute.binding         = static_cast<u16>(jattribute.value("binding", 0u));
+            attribute.offset          = jattribute.value("offset", 0u);
+            ok &= parse_enum(jattribute, "format", format_names, attribute.format_type);
+            out_spec.vertex_input.add_vertex_attribute(attribute);
+        }
+    }
+
+    out_spec.set_layouts.clear();
+    out_spec.set_layout_names.clear();
+    for (const auto& jlayout : j.value("set_layouts", json::array()))
+    {
+        PipelineSpec::SetLayoutDescriptor layout = {};
+        for (const auto& jbinding : jlayout.value("bindings", json::array()))
+        {
+            DescriptorSetBindingDescriptor binding = {};
+            binding.binding                        = jbinding.value("binding", 0u);
+            binding.count                          = jbinding.value("count", 1u);
+            ok &= parse_enum(jbinding, "stage", stage_names, binding.shader_stage);
+            ok &= parse_enum(jbinding, "type", descriptor_type_names, binding.descriptor_type);
+            layout.add_binding(binding);
+        }
+
+        out_spec.set_layout_names.push_back(jlayout.value("name", ""));
+        out_spec.set_layouts.push_back(layout);
+    }
+
+    out_spec.push_constants.clear();
+    for (const auto& jpush_constant : j.value("push_constants", json::array()))
+    {
+        PushConstantDescriptor push_constant = {};
+        push_constant.size                   = jpush_constant.value("size", 0u);
+        push_constant.offset                 = jpush_constant.value("offset", 0u);
+        ok &= parse_enum(jpush_constant, "stage", stage_names, push_constant.stage);
+        out_spec.push_constants.push_back(push_constant);
+    }
+
+    return ok;
+}
+
+std::string get_shader_binary_path(const std::string& filename)
+{
+    return SOGAS_SHADER_DIR + filename;
+}
+
+bool load_pipeline_shaders(PipelineSpec& spec)
+{
+    spec.shader_state = {};
+
+    for (u32 i = 0; i < MAX_SPEC_SHADER_STAGES; ++i)
+    {
+        if (spec.shader_paths.at(i).empty())
+        {
+            continue;
+        }
+
+        const auto path = get_shader_binary_path(spec.shader_paths.at(i));
+
+        ShaderStage stage = {};
+        stage.type        = static_cast<ShaderStageType>(i);
+        if (!read_shader_binary(path, stage.code))
+        {
+            PLOG(ERROR,
+                 RENDER,
+                 "Failed to load shader %s for pipeline %s.",
+                 path.c_str(),
+                 spec.name.c_str());
+            return false;
+        }
+
+        spec.shader_state.add_shader_stage(stage);
+    }
+
+    return true;
+}
+
+bool reflect_pipeline_spec(PipelineSpec& spec)
+{
+    ShaderReflection reflection;
+    if (!reflect_shader_state(spec.shader_state, reflection))
+    {
+        PLOG(ERROR, RENDER, "Failed to reflect shaders of pipeline %s.", spec.name.c_str());
+        return false;
+    }
+
+    if (spec.set_layouts.empty())
+    {
+        for (u32 i = 0; i < reflection.set_count; ++i)
+        {
+            spec.set_layouts.push_back(reflection.set_layouts[i]);
+            spec.set_layout_names.push_back(spec.name + "_set_" + std::to_string(i));
+        }
+    }
+
+    auto& vertex_input = spec.vertex_input;
+    if (vertex_input.attribute_count == 0)
+    {
+        const auto& reflected = reflection.vertex_input;
+        for (u32 i = 0; i < reflected.attribute_count; ++i)
+        {
+            vertex_input.add_vertex_attribute(reflected.attributes[i]);
+        }
+
+        if (vertex_input.stream_count == 0)
+        {
+            for (u32 i = 0; i < reflected.stream_count; ++i)
+            {
+                vertex_input.add_vertex_stream(reflected.streams[i]);
+            }
+        }
+    }
+
+    if (spec.push_constants.empty() && reflection.push_constant.size > 0)
+    {
+        spec.push_constants.push_back(reflection.push_constant);
+    }
+
+    if (spec.bindless_set >= static_cast<i32>(spec.set_layouts.size()))
+    {
+        PLOG(ERROR,
+             RENDER,
+             "Bindless set %d not used by pipeline %s.",
+             spec.bindless_set,
+             spec.name.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+u64 hash_pipeline_spec(const PipelineSpec& spec)
+{
+    u64 hash = hash_pipeline(spec.get_descriptor());
+
+    // Shader code may not be loaded yet, so the paths take part in the hash too.
+    for (const auto& path : spec.shader_paths)
+    {
+        hash = hash_bytes(path.data(), path.size(), hash);
+    }
+
+    for (const auto& layout : spec.set_layouts)
+    {
+        hash = hash_descriptor_set_layout(layout, hash);
+    }
+
+    return hash;
+}
+
+void PipelineLibrary::init(pinut::GPUDevice* new_device)
+{
+    ASSERT(new_device);
+    device = new_device;
+}
+
+void PipelineLibrary::shutdown()
+{
+    for (auto& it : pipeline_set_layouts)
+    {
+        for (auto handle : it.second)
+        {
+            // The bindless layout belongs to the device.
+            if (handle.id != device->get_bindless_set_layout().id)
+            {
+                device->destroy_descriptor_set_layout(handle);
+            }
+        }
+    }
+
+    pipeline_set_layouts.clear();
+    specs.clear();
+}
+
+bool PipelineLibrary::load(const std::string& filename, const ViewportDescriptor& viewport)
+{
+    const auto& jpipelines = platform::load_json(filename);
+    ASSERT(jpipelines.is_array());
+
+    std::vector<PipelineDescriptor> descriptors;
+    descriptors.reserve(jpipelines.size());
+
+    for (const auto& jpipeline : jpipelines)
+    {
+        auto spec = std::make_unique<PipelineSpec>();
+        if (!parse_pipeline_spec(jpipeline, *spec))
+        {
+            PLOG(ERROR, RENDER, "Failed to load pipeline spec from %s.", filename.c_str());
+            return false;
+        }
+
+        if (spec->bindless_set >= 0 && !device->is_bindless_supported())
+        {
+            PLOG(WARNING,
+                 RENDER,
+                 "Skipping pipeline %s, bindless is not supported.",
+                 spec->name.c_str());
+            continue;
+        }
+
+        if (!load_pipeline_shaders(*spec) || !reflect_pipeline_spec(*spec))
+        {
+            PLOG(ERROR, RENDER, "Failed to load pipeline spec from %s.", filename.c_str());
+            return false;
+        }
+
+        auto descriptor     = spec->get_descriptor();
+        descriptor.viewport = viewport;
+
+        // The device shares identical layouts, every pipeline just holds a reference.
+        auto& layouts = pipeline_set_layouts[spec->name];
+        for (size_t i = 0; i < spec->set_layouts.size(); ++i)
+        {
+            // Every bindless pipeline shares the device set, whatever the shader declared.
+            if (static_cast<i32>(i) == spec->bindless_set)
+            {
+                const auto handle = device->get_bindless_set_layout();
+                descriptor.add_descriptor_set_layout(handle);
+                layouts.push_back(handle);
+                continue;
+            }
+
+            auto layout_descriptor = spec->set_layouts.at(i);
+            layout_descriptor.add_name(spec->set_layout_names.at(i).c_str());
+
+            const auto handle = device->create_descriptor_set_layout(layout_descriptor);
+            descriptor.add_descriptor_set_layout(handle);
+            layouts.push_back(handle);
+        }
+
+        descriptors.push_back(descriptor);
+        specs.push_back(std::move(spec));
+    }
+
+    device->create_pipelines(descriptors);
+
+    return true;
+}
+
+PipelineLibrary::SetLayoutHandle PipelineLibrary::get_set_layout(const std::string& pipeline,
+                                                                 u32                set) const
+{
+    const auto it = pipeline_set_layouts.find(pipeline);
+    if (it == pipeline_set_layouts.end() || set >= it->second.size())
+    {
+        PLOG(WARNING, RENDER, "No set layout %u found for pipeline %s.", set, pipeline.c_str());
+        return invalid_descriptor_set_layout;
+    }
+
+    return it->second.at(set);
+}
+} // namespace sogas
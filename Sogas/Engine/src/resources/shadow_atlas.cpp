@@ -0,0 +1,245 @@
+#include "pch.hpp"
+
+#include <resources/shadow_atlas.h>
+
+namespace sogas
+{
+// Shadows only reach the radius of the light, the near plane keeps most of the depth precision.
+static const f32 SHADOW_NEAR_FACTOR = 0.01f;
+
+static const glm::vec3 point_face_directions[POINT_SHADOW_FACES] = {{1.0f, 0.0f, 0.0f},
+                                                                    {-1.0f, 0.0f, 0.0f},
+                                                                    {0.0f, 1.0f, 0.0f},
+                                                                    {0.0f, -1.0f, 0.0f},
+                                                                    {0.0f, 0.0f, 1.0f},
+                                                                    {0.0f, 0.0f, -1.0f}};
+
+static glm::mat4 get_shadow_matrix(const glm::vec3& position,
+                                   const glm::vec3& direction,
+                                   f32              fov,
+                                   f32              radius)
+{
+    const glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) :
+                                                          glm::vec3(0.0f, 1.0f, 0.0f);
+
+    auto projection = glm::perspective(fov, 1.0f, radius * SHADOW_NEAR_FACTOR, radius);
+    projection[1][1] *= -1;
+
+    return projection * glm::lookAt(position, position + direction, up);
+}
+
+glm::mat4 get_spot_shadow_matrix(const ShadowLight& light)
+{
+    return get_shadow_matrix(light.position,
+                             glm::normalize(light.direction),
+                             light.cone,
+                             light.radius);
+}
+
+glm::mat4 get_point_shadow_matrix(const ShadowLight& light, u32 face)
+{
+    ASSERT(face < POINT_SHADOW_FACES);
+    return get_shadow_matrix(light.position,
+                             point_face_directions[face],
+                             glm::radians(90.0f),
+                             light.radius);
+}
+
+void ShadowAtlas::init(const ShadowAtlasDescriptor& new_descriptor)
+{
+    descriptor    = new_descriptor;
+    tiles_per_row = descriptor.size / descriptor.tile_size;
+
+    views.assign(tiles_per_row * tiles_per_row, {});
+    tile_used.assign(views.size(), false);
+    entries.clear();
+}
+
+void ShadowAtlas::begin_frame()
+{
+    for (auto& it : entries)
+    {
+        it.second.used = false;
+    }
+}
+
+i32 ShadowAtlas::add_light(u64 id, const ShadowLight& light)
+{
+    const u32 tile_count = light.cone > 0.0f ? 1 : POINT_SHADOW_FACES;
+
+    auto it = entries.find(id);
+    if (it != entries.end() && it->second.tile_count != tile_count)
+    {
+        free_tiles(it->second);
+        entries.erase(it);
+        it = entries.end();
+    }
+
+    if (it == entries.end())
+    {
+        const i32 first_tile = allocate_tiles(tile_count);
+        if (first_tile < 0)
+        {
+            return -1;
+        }
+
+        ShadowEntry entry;
+        entry.first_tile = static_cast<u32>(first_tile);
+        entry.tile_count = tile_count;
+        it               = entries.insert({id, entry}).first;
+    }
+
+    auto& entry = it->second;
+    entry.used  = true;
+    if (entry.dirty || !(entry.light == light))
+    {
+        entry.light = light;
+        entry.dirty = true;
+        update_views(entry);
+    }
+
+    return static_cast<i32>(entry.first_tile);
+}
+
+void ShadowAtlas::invalidate(const BoundingSphere& caster)
+{
+    for (auto& it : entries)
+    {
+        auto&          entry = it.second;
+        BoundingSphere bounds;
+        bounds.center = entry.light.position;
+        bounds.radius = entry.light.radius;
+
+        if (bounds.intersects(caster))
+        {
+            entry.dirty = true;
+        }
+    }
+}
+
+void ShadowAtlas::end_frame()
+{
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (it->second.used)
+        {
+            ++it;
+            continue;
+        }
+
+        free_tiles(it->second);
+        it = entries.erase(it);
+    }
+}
+
+std::vector<u32> ShadowAtlas::get_dirty_views() const
+{
+    std::vector<u32> dirty_views;
+    for (const auto& it : entries)
+    {
+        const auto& entry = it.second;
+        if (!entry.dirty)
+        {
+            continue;
+        }
+
+        for (u32 i = 0; i < entry.tile_count; ++i)
+        {
+            dirty_views.push_back(entry.first_tile + i);
+        }
+    }
+
+    return dirty_views;
+}
+
+void ShadowAtlas::mark_rendered()
+{
+    for (auto& it : entries)
+    {
+        it.second.dirty = false;
+    }
+}
+
+BoundingSphere ShadowAtlas::get_view_bounds(u32 view) const
+{
+    BoundingSphere bounds;
+    for (const auto& it : entries)
+    {
+        const auto& entry = it.second;
+        if (view >= entry.first_tile && view < entry.first_tile + entry.tile_count)
+        {
+            bounds.center = entry.light.position;
+            bounds.radius = entry.light.radius;
+            break;
+        }
+    }
+
+    return bounds;
+}
+
+glm::uvec4 ShadowAtlas::get_view_rect(u32 view) const
+{
+    return glm::uvec4((view % tiles_per_row) * descriptor.tile_size,
+                      (view / tiles_per_row) * descriptor.tile_size,
+                      descriptor.tile_size,
+                      descriptor.tile_size);
+}
+
+const ShadowAtlasDescriptor& ShadowAtlas::get_descriptor() const
+{
+    return descriptor;
+}
+
+const std::vector<ShadowView>& ShadowAtlas::get_views() const
+{
+    return views;
+}
+
+// First fit, point lights need their six faces in a row.
+i32 ShadowAtlas::allocate_tiles(u32 count)
+{
+    u32 run = 0;
+    for (u32 i = 0; i < tile_used.size(); ++i)
+    {
+        run = tile_used.at(i) ? 0 : run + 1;
+        if (run == count)
+        {
+            const u32 first_tile = i + 1 - count;
+            for (u32 j = first_tile; j <= i; ++j)
+            {
+                tile_used.at(j) = true;
+            }
+            return static_cast<i32>(first_tile);
+        }
+    }
+
+    return -1;
+}
+
+void ShadowAtlas::free_tiles(const ShadowEntry& entry)
+{
+    for (u32 i = 0; i < entry.tile_count; ++i)
+    {
+        tile_used.at(entry.first_tile + i) = false;
+    }
+}
+
+void ShadowAtlas::update_views(const ShadowEntry& entry)
+{
+    const f32 scale = static_cast<f32>(descriptor.tile_size) / descriptor.size;
+    for (u32 i = 0; i < entry.tile_count; ++i)
+    {
+        const u32  view = entry.first_tile + i;
+        const auto rect = get_view_rect(view);
+
+        auto& shadow_view           = views.at(view);
+        shadow_view.view_projection = entry.tile_count == 1 ?
+                                        get_spot_shadow_matrix(entry.light) :
+                                        get_point_shadow_matrix(entry.light, i);
+        shadow_view.atlas_rect      = glm::vec4(static_cast<f32>(rect.x) / descriptor.size,
+                                           static_cast<f32>(rect.y) / descriptor.size,
+                                           scale,
+                                           scale);
+    }
+}
+} // namespace sogas
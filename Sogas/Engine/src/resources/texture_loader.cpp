@@ -0,0 +1,49 @@
+#include "pch.hpp"
+
+#include <engine/clock.h>
+#include <render_device.h>
+#include <resources/cooked_texture.h>
+#include <resources/texture_loader.h>
+
+namespace sogas
+{
+pinut::resources::TextureHandle load_cooked_texture(pinut::GPUDevice*  device,
+                                                    const std::string& filename)
+{
+    using namespace pinut::resources;
+
+    Clock clock;
+    start_clock(&clock);
+
+    platform::Mapped_file file;
+    if (!platform::map_file(filename, file))
+    {
+        return invalid_texture;
+    }
+
+    CookedTextureHeader header;
+    const u8*           data = nullptr;
+    if (!parse_cooked_texture(file.data, file.size, header, data))
+    {
+        PLOG(ERROR, RESOURCES, "Invalid cooked texture %s.", filename.c_str());
+        platform::unmap_file(file);
+        return invalid_texture;
+    }
+
+    // The upload copies into a staging buffer, the mapping is not needed afterwards.
+    const auto handle = device->create_texture(get_cooked_texture_descriptor(header, data));
+    platform::unmap_file(file);
+
+    update_clock(&clock);
+    PLOG(INFO,
+         RESOURCES,
+         "Loaded cooked texture %s (%ux%u, %u mips) in %.2f ms.",
+         filename.c_str(),
+         header.width,
+         header.height,
+         header.mip_levels,
+         clock.elapsed_time * 1000.0);
+
+    return handle;
+}
+} // namespace sogas
@@ -0,0 +1,329 @@
+#include "pch.hpp"
+
+#include <cmath>
+#include <limits>
+
+#include <render_device.h>
+#include <resources/texture_streamer.h>
+#include <resources/texture_utils.h>
+
+namespace sogas
+{
+using namespace pinut::resources;
+
+f32 get_projected_diameter(const BoundingSphere& sphere,
+                           const glm::vec3&      eye,
+                           f32                   fov,
+                           f32                   viewport_height)
+{
+    const f32 distance = glm::length(sphere.center - eye);
+    if (distance <= sphere.radius)
+    {
+        return std::numeric_limits<f32>::max();
+    }
+
+    // Projected radius in normalized device coordinates spans half the viewport height.
+    return sphere.radius / (distance * std::tan(fov * 0.5f)) * viewport_height;
+}
+
+u32 get_requested_mip(u32 width, u32 height, u32 mip_levels, f32 projected_size)
+{
+    const u32 coarsest = mip_levels > 0 ? mip_levels - 1 : 0;
+    if (projected_size <= 0.0f)
+    {
+        return coarsest;
+    }
+
+    const f32 texels_per_pixel = static_cast<f32>(std::max(width, height)) / projected_size;
+    if (texels_per_pixel <= 1.0f)
+    {
+        return 0;
+    }
+
+    return std::min(static_cast<u32>(std::floor(std::log2(texels_per_pixel))), coarsest);
+}
+
+void TextureStreamer::init(pinut::GPUDevice*                new_device,
+                           const TextureStreamerDescriptor& new_descriptor)
+{
+    device     = new_device;
+    descriptor = new_descriptor;
+    stopping   = false;
+
+    for (u32 i = 0; i < std::max(1u, descriptor.thread_count); ++i)
+    {
+        workers.emplace_back(&TextureStreamer::worker_loop, this);
+    }
+}
+
+void TextureStreamer::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+    pending_loads.clear();
+    completed_loads.clear();
+
+    for (auto& texture : textures)
+    {
+        if (texture.handle.id != INVALID_ID)
+        {
+            device->destroy_texture(texture.handle);
+        }
+        platform::unmap_file(texture.file);
+    }
+
+    textures.clear();
+    resident_bytes = 0;
+}
+
+StreamedTextureId TextureStreamer::add_texture(const std::string& filename)
+{
+    StreamedTexture texture;
+    if (!platform::map_file(filename, texture.file))
+    {
+        return INVALID_ID;
+    }
+
+    if (!parse_cooked_texture(texture.file.data, texture.file.size, texture.header, texture.data))
+    {
+        PERROR("Invalid cooked texture %s.", filename.c_str());
+        platform::unmap_file(texture.file);
+        return INVALID_ID;
+    }
+
+    const auto& header = texture.header;
+    texture.tail_mip   = header.mip_levels - 1;
+    for (u32 level = 0; level < header.mip_levels; ++level)
+    {
+        if (std::max(get_mip_dimension(header.width, level),
+                     get_mip_dimension(header.height, level)) <= descriptor.tail_size)
+        {
+            texture.tail_mip = level;
+            break;
+        }
+    }
+
+    texture.resident_mip  = header.mip_levels;
+    texture.requested_mip = texture.tail_mip;
+    upload(texture, texture.tail_mip, texture.data + header.level_offsets[texture.tail_mip]);
+
+    textures.push_back(texture);
+    return static_cast<StreamedTextureId>(textures.size() - 1);
+}
+
+void TextureStreamer::request_mip(StreamedTextureId id, u32 mip)
+{
+    auto& texture           = textures.at(id);
+    texture.requested_mip   = std::min(texture.requested_mip, mip);
+    texture.last_used_frame = frame;
+}
+
+void TextureStreamer::request_projected_size(StreamedTextureId id, f32 projected_size)
+{
+    const auto& header = textures.at(id).header;
+    request_mip(id,
+                get_requested_mip(header.width, header.height, header.mip_levels, projected_size));
+}
+
+bool TextureStreamer::update()
+{
+    bool changed = false;
+
+    std::vector<LoadRequest> loads;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        loads.swap(completed_loads);
+    }
+
+    for (auto& load : loads)
+    {
+        auto& texture       = textures.at(load.id);
+        texture.loading_mip = INVALID_ID;
+        if (load.first_mip < texture.resident_mip)
+        {
+            upload(texture, load.first_mip, load.data.data());
+            changed = true;
+        }
+    }
+
+    // Only mips finer than requested are evicted, least recently requested textures first.
+    while (resident_bytes > descriptor.budget_bytes)
+    {
+        StreamedTexture* victim = nullptr;
+        for (auto& texture : textures)
+        {
+            if (texture.resident_mip < texture.requested_mip &&
+                (!victim || texture.last_used_frame < victim->last_used_frame))
+            {
+                victim = &texture;
+            }
+        }
+
+        if (!victim)
+        {
+            break;
+        }
+
+        // Every upload recreates the texture, all the levels the budget needs go at once.
+        const u64 resident_size = get_resident_size(*victim, victim->resident_mip);
+        u32       first_mip     = victim->resident_mip + 1;
+        while (first_mip < victim->requested_mip &&
+               resident_bytes - resident_size + get_resident_size(*victim, first_mip) >
+                 descriptor.budget_bytes)
+        {
+            first_mip++;
+        }
+
+        upload(*victim, first_mip, victim->data + victim->header.level_offsets[first_mip]);
+        changed = true;
+    }
+
+    // Largest deficits first, as long as the result fits in the budget.
+    std::vector<StreamedTextureId> candidates;
+    for (StreamedTextureId id = 0; id < textures.size(); ++id)
+    {
+        const auto& texture = textures.at(id);
+        if (texture.loading_mip == INVALID_ID && texture.requested_mip < texture.resident_mip)
+        {
+            candidates.push_back(id);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [this](auto a, auto b) {
+        const auto& texture_a = textures.at(a);
+        const auto& texture_b = textures.at(b);
+        return texture_a.resident_mip - texture_a.requested_mip >
+               texture_b.resident_mip - texture_b.requested_mip;
+    });
+
+    u64 projected_bytes = resident_bytes;
+    u32 load_count      = 0;
+    for (auto id : candidates)
+    {
+        if (load_count == descriptor.max_loads_per_update)
+        {
+            break;
+        }
+
+        auto&     texture    = textures.at(id);
+        const u64 extra_size = get_resident_size(texture, texture.requested_mip) -
+                               get_resident_size(texture, texture.resident_mip);
+        if (projected_bytes + extra_size > descriptor.budget_bytes)
+        {
+            continue;
+        }
+
+        const u64 offset    = texture.header.level_offsets[texture.requested_mip];
+        const u64 size      = texture.header.data_size - offset;
+        texture.loading_mip = texture.requested_mip;
+        projected_bytes += extra_size;
+        load_count++;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        pending_loads.push_back({id, texture.requested_mip, texture.data + offset, size, {}});
+    }
+
+    if (load_count > 0)
+    {
+        condition.notify_all();
+    }
+
+    // Requests are rebuilt every frame.
+    for (auto& texture : textures)
+    {
+        texture.requested_mip = texture.tail_mip;
+    }
+    frame++;
+
+    return changed;
+}
+
+TextureHandle TextureStreamer::get_texture(StreamedTextureId id) const
+{
+    return textures.at(id).handle;
+}
+
+u32 TextureStreamer::get_resident_mip(StreamedTextureId id) const
+{
+    return textures.at(id).resident_mip;
+}
+
+u64 TextureStreamer::get_resident_bytes() const
+{
+    return resident_bytes;
+}
+
+void TextureStreamer::worker_loop()
+{
+    profiler::set_thread_name("Texture streamer");
+
+    while (true)
+    {
+        LoadRequest load;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopping || !pending_loads.empty(); });
+            if (stopping)
+            {
+                return;
+            }
+
+            load = std::move(pending_loads.front());
+            pending_loads.pop_front();
+        }
+
+        // Touching the mapped pages here keeps the file reads off the main thread.
+        {
+            PROFILE_ZONE("TextureStreamer::load");
+            load.data.assign(load.source, load.source + load.size);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        completed_loads.push_back(std::move(load));
+    }
+}
+
+void TextureStreamer::upload(StreamedTexture& texture, u32 first_mip, const u8* data)
+{
+    const auto& header = texture.header;
+
+    TextureDescriptor texture_descriptor = {};
+    texture_descriptor
+      .set_size(static_cast<u16>(get_mip_dimension(header.width, first_mip)),
+                static_cast<u16>(get_mip_dimension(header.height, first_mip)))
+      .set_format(header.format)
+      .set_mips(static_cast<u8>(header.mip_levels - first_mip), false);
+    texture_descriptor.data = const_cast<u8*>(data);
+
+    // The old texture may still be in flight, it goes through the deferred deletion.
+    const auto handle = device->create_texture(texture_descriptor);
+    if (texture.handle.id != INVALID_ID)
+    {
+        device->destroy_texture(texture.handle);
+        resident_bytes -= get_resident_size(texture, texture.resident_mip);
+    }
+
+    texture.handle       = handle;
+    texture.resident_mip = first_mip;
+    resident_bytes += get_resident_size(texture, first_mip);
+}
+
+u64 TextureStreamer::get_resident_size(const StreamedTexture& texture, u32 first_mip) const
+{
+    if (first_mip >= texture.header.mip_levels)
+    {
+        return 0;
+    }
+
+    return texture.header.data_size - texture.header.level_offsets[first_mip];
+}
+} // namespace sogas
@@ -0,0 +1,63 @@
+#include "pch.h"
+
+#include <thread>
+
+#include <engine/clock.h>
+
+using namespace sogas;
+
+TEST(ClockTest, MeasuresElapsedTime)
+{
+    Clock clock;
+    start_clock(&clock);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    update_clock(&clock);
+
+    EXPECT_GE(clock.elapsed_time, 0.01);
+    EXPECT_LT(clock.elapsed_time, 5.0);
+
+    // A stopped clock keeps the last elapsed time.
+    const f64 elapsed = clock.elapsed_time;
+    stop_clock(&clock);
+    update_clock(&clock);
+    EXPECT_EQ(clock.elapsed_time, elapsed);
+}
+
+TEST(ClockTest, FixedTimestep)
+{
+    FixedTimestep timestep;
+    timestep.step = 0.01;
+
+    EXPECT_EQ(advance_fixed_timestep(&timestep, 0.025), 2u);
+    EXPECT_NEAR(get_fixed_timestep_alpha(&timestep), 0.5f, 1e-4f);
+
+    EXPECT_EQ(advance_fixed_timestep(&timestep, 0.004), 0u);
+    EXPECT_EQ(advance_fixed_timestep(&timestep, 0.006), 1u);
+    EXPECT_NEAR(get_fixed_timestep_alpha(&timestep), 0.5f, 1e-4f);
+
+    // A long stall only runs up to max_frame_time worth of steps.
+    EXPECT_EQ(advance_fixed_timestep(&timestep, 10.0), 25u);
+}
+
+TEST(ClockTest, FrameTimePercentiles)
+{
+    FrameTimeStats stats;
+    EXPECT_EQ(get_frame_time_percentile(&stats, 0.5), 0.0);
+
+    for (u32 i = 1; i <= 100; ++i)
+    {
+        add_frame_time(&stats, i / 1000.0);
+    }
+    EXPECT_EQ(stats.count, 100u);
+    EXPECT_NEAR(get_frame_time_percentile(&stats, 0.5), 0.050, 0.0011);
+    EXPECT_NEAR(get_frame_time_percentile(&stats, 0.99), 0.099, 0.0011);
+    EXPECT_EQ(get_frame_time_percentile(&stats, 1.0), 0.100);
+
+    // Older frames drop out once the history is full.
+    for (u32 i = 0; i < FrameTimeStats::HISTORY_SIZE; ++i)
+    {
+        add_frame_time(&stats, 0.016);
+    }
+    EXPECT_EQ(stats.count, FrameTimeStats::HISTORY_SIZE);
+    EXPECT_EQ(get_frame_time_percentile(&stats, 0.99), 0.016);
+}
@@ -0,0 +1,45 @@
+#include "pch.h"
+
+#include <engine/memory_stats.h>
+
+using namespace sogas;
+
+// Counters are global, tests only look at what changed while they run.
+TEST(MemoryStatsTest, TracksCurrentAndPeak)
+{
+    const auto before = get_memory_stats(MemoryTag::MESHES);
+
+    track_allocation(MemoryTag::MESHES, 1000);
+    track_allocation(MemoryTag::MESHES, 500);
+    track_deallocation(MemoryTag::MESHES, 1000);
+
+    const auto after = get_memory_stats(MemoryTag::MESHES);
+    EXPECT_EQ(after.current, before.current + 500);
+    EXPECT_EQ(after.allocations, before.allocations + 1);
+    EXPECT_GE(after.peak, before.current + 1500);
+
+    reset_memory_peak(MemoryTag::MESHES);
+    EXPECT_EQ(get_memory_stats(MemoryTag::MESHES).peak, after.current);
+
+    track_deallocation(MemoryTag::MESHES, 500);
+    EXPECT_EQ(get_memory_stats(MemoryTag::MESHES).current, before.current);
+}
+
+TEST(MemoryStatsTest, Json)
+{
+    load_memory_budgets({{"logger", 4096}, {"not_a_tag", 1}});
+    EXPECT_EQ(get_memory_stats(MemoryTag::LOGGER).budget, 4096u);
+
+    const auto j = get_memory_stats_json();
+    for (u32 i = 0; i < static_cast<u32>(MemoryTag::COUNT); ++i)
+    {
+        const char* name = get_memory_tag_name(static_cast<MemoryTag>(i));
+        ASSERT_TRUE(j.count(name)) << name;
+        EXPECT_EQ(j[name]["current"].get<u64>(),
+                  get_memory_stats(static_cast<MemoryTag>(i)).current);
+    }
+    EXPECT_EQ(j["logger"]["budget"].get<u64>(), 4096u);
+
+    load_memory_budgets({{"logger", 0}});
+    EXPECT_EQ(get_memory_stats(MemoryTag::LOGGER).budget, 0u);
+}
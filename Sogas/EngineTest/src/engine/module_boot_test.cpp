@@ -0,0 +1,52 @@
+#include "pch.h"
+
+#include <fstream>
+
+#include <engine/smemory.h>
+#include <entity/entity.h>
+#include <modules/module_boot.h>
+
+using namespace sogas;
+
+TEST(BootModuleTest, UnloadResetsSceneMemory)
+{
+    // Booting the engine sizes the managers from components.json.
+    auto entities = get_object_manager<Entity>();
+    if (entities->get_type() == 0)
+    {
+        entities->init(64);
+    }
+    if (entities->get_size() + 4 > entities->get_pool_size())
+    {
+        GTEST_SKIP() << "Not enough free entities.";
+    }
+
+    memory_init();
+
+    const std::string scene_filename = "module_boot_test_scene.json";
+    const std::string boot_filename  = "module_boot_test_boot.json";
+    {
+        std::ofstream scene(scene_filename);
+        scene << R"([{"entity": {}}, {"entity": {}}])";
+        std::ofstream boot(boot_filename);
+        boot << R"({"scenes": [")" << scene_filename << R"("]})";
+    }
+
+    modules::BootModule boot("boot");
+    ASSERT_TRUE(boot.boot(boot_filename));
+    EXPECT_GE(boot.get_scene_memory_used(), 2 * sizeof(Handle));
+
+    boot.unload_scenes();
+    EXPECT_EQ(boot.get_scene_memory_used(), 0u);
+    boot.stop();
+
+    // Stopping the module unloads whatever is still loaded.
+    ASSERT_TRUE(boot.boot(boot_filename));
+    EXPECT_GE(boot.get_scene_memory_used(), 2 * sizeof(Handle));
+    boot.stop();
+    EXPECT_EQ(boot.get_scene_memory_used(), 0u);
+
+    std::remove(scene_filename.c_str());
+    std::remove(boot_filename.c_str());
+    memory_shutdown();
+}
@@ -0,0 +1,134 @@
+#include "pch.h"
+
+#include <thread>
+
+#include <engine/profiler.h>
+
+using namespace sogas;
+using namespace sogas::profiler;
+
+// Zones go to whatever frame ends next, each test starts by ending the frame of the previous one.
+TEST(ProfilerTest, NestedZones)
+{
+    end_frame();
+
+    {
+        PROFILE_ZONE("outer");
+        {
+            PROFILE_ZONE("inner");
+        }
+    }
+    end_frame();
+
+    const auto& frame = get_last_frame();
+    ASSERT_EQ(frame.zones.size(), 2u);
+
+    // Zones are kept in the order they end.
+    const auto& inner = frame.zones.at(0);
+    const auto& outer = frame.zones.at(1);
+    EXPECT_STREQ(inner.name, "inner");
+    EXPECT_STREQ(outer.name, "outer");
+    EXPECT_EQ(inner.depth, 1u);
+    EXPECT_EQ(outer.depth, 0u);
+    EXPECT_EQ(inner.thread, outer.thread);
+    EXPECT_LE(outer.start, inner.start);
+    EXPECT_LE(inner.end, outer.end);
+    EXPECT_LE(frame.start, outer.start);
+    EXPECT_LE(outer.end, frame.end);
+}
+
+TEST(ProfilerTest, ZonesFromOtherThreads)
+{
+    end_frame();
+
+    std::thread worker([]() {
+        set_thread_name("Worker");
+        for (u32 i = 0; i < 100; ++i)
+        {
+            PROFILE_ZONE("work");
+        }
+    });
+    worker.join();
+    end_frame();
+
+    const auto& frame = get_last_frame();
+    ASSERT_EQ(frame.zones.size(), 100u);
+    EXPECT_EQ(get_thread_name(frame.zones.at(0).thread), "Worker");
+}
+
+TEST(ProfilerTest, Lanes)
+{
+    static const u32 lane = create_lane("Lane");
+    EXPECT_EQ(get_thread_name(lane), "Lane");
+
+    end_frame();
+    const u64 now = get_time();
+    add_zone(lane, "outer", now - 2000, now - 1000, 0);
+    add_zone(lane, "inner", now - 1800, now - 1200, 1);
+    end_frame();
+
+    const auto& frame = get_last_frame();
+    ASSERT_EQ(frame.zones.size(), 2u);
+    EXPECT_STREQ(frame.zones.at(0).name, "outer");
+    EXPECT_EQ(frame.zones.at(0).thread, lane);
+    EXPECT_EQ(frame.zones.at(0).end, now - 1000);
+    EXPECT_EQ(frame.zones.at(1).depth, 1u);
+}
+
+TEST(ProfilerTest, ChromeTrace)
+{
+    end_frame();
+
+    {
+        PROFILE_ZONE("traced");
+    }
+    end_frame();
+
+    const auto trace  = get_chrome_trace_json({get_last_frame()});
+    const auto events = trace["traceEvents"];
+    ASSERT_TRUE(events.is_array());
+
+    const auto& zone       = get_last_frame().zones.at(0);
+    bool        found_zone = false, found_thread = false;
+    for (const auto& event : events)
+    {
+        if (event["ph"] == "X")
+        {
+            EXPECT_EQ(event["name"], "traced");
+            EXPECT_DOUBLE_EQ(event["ts"].get<f64>(), zone.start / 1000.0);
+            EXPECT_GE(event["dur"].get<f64>(), 0.0);
+            found_zone = true;
+        }
+        else if (event["ph"] == "M" && event["tid"] == zone.thread)
+        {
+            EXPECT_EQ(event["args"]["name"], get_thread_name(zone.thread));
+            found_thread = true;
+        }
+    }
+    EXPECT_TRUE(found_zone);
+    EXPECT_TRUE(found_thread);
+}
+
+TEST(ProfilerTest, Capture)
+{
+    const std::string filename = "profiler_test_capture.json";
+    std::remove(filename.c_str());
+
+    start_capture(2, filename);
+    EXPECT_TRUE(is_capturing());
+    end_frame();
+    EXPECT_TRUE(is_capturing());
+    {
+        PROFILE_ZONE("captured");
+    }
+    end_frame();
+    EXPECT_FALSE(is_capturing());
+
+    std::ifstream ifs(filename);
+    ASSERT_TRUE(ifs.is_open());
+    const auto trace = json::parse(ifs);
+    EXPECT_FALSE(trace["traceEvents"].empty());
+
+    ifs.close();
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,121 @@
+#include "pch.h"
+
+#include <chrono>
+
+#include <components/basic/transform_component.h>
+#include <engine/smemory.h>
+#include <entity/entity.h>
+#include <modules/render_manager.h>
+#include <null/null_device.h>
+#include <resources/mesh.h>
+
+// CPU cost of recording the scene draws, on the null device so no GPU or driver is involved.
+// Disabled by default, run it with
+// EngineTest --gtest_also_run_disabled_tests --gtest_filter=RenderManagerBenchmark.*
+
+using namespace sogas;
+using namespace pinut;
+
+// Handles index 14 bits, so the draws come from several keys per entity, as a render component
+// with many draw calls adds them.
+static const u32 ENTITIES        = 1000;
+static const u32 KEYS_PER_ENTITY = 100;
+static const u32 FRAMES          = 20;
+
+TEST(RenderManagerBenchmark, DISABLED_RenderAll)
+{
+    auto entities   = get_object_manager<Entity>();
+    auto transforms = get_object_manager<TransformComponent>();
+
+    // Booting the engine sizes the managers from components.json. The last slot of a manager is
+    // never handed out.
+    if (entities->get_type() == 0)
+    {
+        entities->init(ENTITIES + 1);
+        transforms->init(ENTITIES + 1);
+    }
+    if (entities->get_size() + ENTITIES > entities->get_pool_size() ||
+        transforms->get_size() + ENTITIES > transforms->get_pool_size())
+    {
+        GTEST_SKIP() << "Not enough free entities, run the benchmark once per process.";
+    }
+
+    memory_init(mb(8), mb(128));
+
+    auto device = static_cast<null::NullDevice*>(GPUDevice::create(GraphicsAPI::Null));
+    device->init({});
+
+    Mesh cube;
+    cube.name = "benchmark_cube";
+    cube.indices.resize(36);
+    cube.vertex_buffer =
+      device->create_buffer({sizeof(Vertex) * 24, resources::BufferType::VERTEX});
+    cube.index_buffer = device->create_buffer({sizeof(u16) * 36, resources::BufferType::INDEX});
+
+    std::vector<Handle>    entity_handles;
+    modules::RenderManager manager;
+    for (u32 i = 0; i < ENTITIES; ++i)
+    {
+        Handle entity_handle;
+        entity_handle.create<Entity>();
+        Handle transform_handle;
+        transform_handle.create<TransformComponent>();
+
+        TransformComponent* transform = transform_handle;
+        transform->set_position(
+          glm::vec3(static_cast<f32>(i % 32), 0.0f, static_cast<f32>(i / 32)));
+
+        Entity* entity = entity_handle;
+        entity->add_component(transform_handle);
+        entity_handles.push_back(entity_handle);
+
+        // The transform is owned by the entity, which is what render_all reads the model from.
+        for (u32 key = 0; key < KEYS_PER_ENTITY; ++key)
+        {
+            manager.add_key(transform_handle, &cube);
+        }
+    }
+
+    const auto record_frame = [&]() {
+        auto cmd = device->get_command_buffer(true);
+        cmd->bind_pass("Swapchain_renderpass");
+        manager.render_all(cmd, Handle());
+        device->end_frame();
+    };
+
+    // Untimed first frame, the command buffers grow to their size.
+    record_frame();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < FRAMES; ++i)
+    {
+        record_frame();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const u32   draws = ENTITIES * KEYS_PER_ENTITY;
+    const auto& frame = device->get_last_frame_commands();
+    EXPECT_EQ(frame.get_command_count(null::NullCommandType::DRAW_INDEXED), draws);
+
+    const f64 frame_ms = std::chrono::duration<f64, std::milli>(end - start).count() / FRAMES;
+    printf("render_all, %u draws: %8.3f ms/frame, %6.2f ns/draw\n",
+           draws,
+           frame_ms,
+           frame_ms * 1e6 / draws);
+
+    manager.clear();
+    for (auto& entity_handle : entity_handles)
+    {
+        entity_handle.destroy();
+    }
+
+    device->destroy_buffer(cube.vertex_buffer);
+    device->destroy_buffer(cube.index_buffer);
+    cube.vertex_buffer = resources::invalid_buffer;
+    cube.index_buffer  = resources::invalid_buffer;
+
+    device->shutdown();
+    delete device;
+
+    memory_shutdown();
+}
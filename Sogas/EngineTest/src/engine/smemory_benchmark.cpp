@@ -0,0 +1,216 @@
+#include "pch.h"
+
+#include <chrono>
+#include <random>
+
+#include <engine/smemory.h>
+
+// Allocator microbenchmarks against malloc. Disabled by default, run them with
+// EngineTest --gtest_also_run_disabled_tests --gtest_filter=SMemoryBenchmark.*
+
+using namespace sogas;
+
+static const u32 ITERATIONS = 100000;
+
+// Runs once untimed first, so page faults on fresh allocator memory are not measured.
+template <typename Function>
+static f64 measure_ns(Function&& function)
+{
+    function();
+
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<f64, std::nano>(end - start).count() / ITERATIONS;
+}
+
+static void report(const char* name, f64 allocator_ns, f64 malloc_ns)
+{
+    printf("%-28s %8.2f ns/op, malloc %8.2f ns/op (%.2fx)\n",
+           name,
+           allocator_ns,
+           malloc_ns,
+           malloc_ns / allocator_ns);
+}
+
+// Keeps the compiler from dropping allocations nobody uses.
+static void touch(void* pointer)
+{
+    *static_cast<volatile u8*>(pointer) = 0;
+}
+
+TEST(SMemoryBenchmark, DISABLED_FrameLinear)
+{
+    LinearAllocator linear;
+    linear.init(mb(16));
+
+    const f64 linear_ns = measure_ns([&]() {
+        for (u32 i = 0; i < ITERATIONS; ++i)
+        {
+            auto pointer = linear.allocate(64, 16);
+            touch(pointer);
+            if ((i & 1023) == 1023)
+            {
+                linear.clear();
+            }
+        }
+    });
+
+    std::vector<void*> frame;
+    frame.reserve(1024);
+    const f64 malloc_ns = measure_ns([&]() {
+        for (u32 i = 0; i < ITERATIONS; ++i)
+        {
+            frame.push_back(malloc(64));
+            touch(frame.back());
+            if ((i & 1023) == 1023)
+            {
+                for (auto pointer : frame)
+                {
+                    free(pointer);
+                }
+                frame.clear();
+            }
+        }
+    });
+
+    report("Linear 64B, 1024 per frame", linear_ns, malloc_ns);
+    linear.shutdown();
+}
+
+TEST(SMemoryBenchmark, DISABLED_PoolChurn)
+{
+    PoolAllocator pool;
+    pool.init(64, 1024);
+
+    std::vector<void*> live(256, nullptr);
+    std::mt19937       random(7);
+
+    const f64 pool_ns = measure_ns([&]() {
+        for (u32 i = 0; i < ITERATIONS; ++i)
+        {
+            auto& slot = live.at(random() % live.size());
+            if (slot)
+            {
+                pool.deallocate(slot);
+            }
+            slot = pool.allocate(64, 16);
+            touch(slot);
+        }
+    });
+    for (auto& slot : live)
+    {
+        if (slot)
+        {
+            pool.deallocate(slot);
+            slot = nullptr;
+        }
+    }
+
+    random.seed(7);
+    const f64 malloc_ns = measure_ns([&]() {
+        for (u32 i = 0; i < ITERATIONS; ++i)
+        {
+            auto& slot = live.at(random() % live.size());
+            free(slot);
+            slot = malloc(64);
+            touch(slot);
+        }
+    });
+    for (auto slot : live)
+    {
+        free(slot);
+    }
+
+    report("Pool 64B churn", pool_ns, malloc_ns);
+    pool.shutdown();
+}
+
+TEST(SMemoryBenchmark, DISABLED_TLSFMixedSizes)
+{
+    TLSFAllocator heap;
+    heap.init(mb(64));
+
+    std::vector<u32> sizes(ITERATIONS);
+    std::mt19937     random(11);
+    for (auto& size : sizes)
+    {
+        // Mostly small, now and then a large block.
+        size = random() % 16 == 0 ? 4096 + random() % 65536 : 16 + random() % 512;
+    }
+
+    std::vector<void*> live(1024, nullptr);
+
+    random.seed(11);
+    const f64 tlsf_ns = measure_ns([&]() {
+        for (u32 i = 0; i < ITERATIONS; ++i)
+        {
+            auto& slot = live.at(random() % live.size());
+            if (slot)
+            {
+                heap.deallocate(slot);
+            }
+            slot = heap.allocate(sizes.at(i), 16);
+            touch(slot);
+        }
+    });
+    for (auto& slot : live)
+    {
+        if (slot)
+        {
+            heap.deallocate(slot);
+            slot = nullptr;
+        }
+    }
+
+    random.seed(11);
+    const f64 malloc_ns = measure_ns([&]() {
+        for (u32 i = 0; i < ITERATIONS; ++i)
+        {
+            auto& slot = live.at(random() % live.size());
+            free(slot);
+            slot = malloc(sizes.at(i));
+            touch(slot);
+        }
+    });
+    for (auto slot : live)
+    {
+        free(slot);
+    }
+
+    report("TLSF mixed sizes", tlsf_ns, malloc_ns);
+    heap.shutdown();
+}
+
+TEST(SMemoryBenchmark, DISABLED_FrameVectors)
+{
+    LinearAllocator linear;
+    linear.init(mb(16));
+
+    // Short lived vectors growing one element at a time, like per frame scratch lists.
+    const f64 linear_ns = measure_ns([&]() {
+        for (u32 i = 0; i < ITERATIONS / 100; ++i)
+        {
+            Vector<u32> values{&linear};
+            for (u32 j = 0; j < 100; ++j)
+            {
+                values.push_back(j);
+            }
+            linear.clear();
+        }
+    });
+
+    const f64 malloc_ns = measure_ns([&]() {
+        for (u32 i = 0; i < ITERATIONS / 100; ++i)
+        {
+            std::vector<u32> values;
+            for (u32 j = 0; j < 100; ++j)
+            {
+                values.push_back(j);
+            }
+        }
+    });
+
+    report("Frame vector, 100 pushes", linear_ns, malloc_ns);
+    linear.shutdown();
+}
@@ -0,0 +1,300 @@
+#include "pch.h"
+
+#include <random>
+
+#include <engine/smemory.h>
+
+using namespace sogas;
+
+static bool is_aligned(const void* pointer, u64 alignment)
+{
+    return reinterpret_cast<u64>(pointer) % alignment == 0;
+}
+
+TEST(SMemoryTest, SizeMacros)
+{
+    EXPECT_EQ(kb(1), 1024ull);
+    EXPECT_EQ(mb(2), 2ull * 1024 * 1024);
+    EXPECT_EQ(gb(4), 4ull * 1024 * 1024 * 1024);
+    EXPECT_EQ(kb(1 + 1), 2048ull);
+}
+
+TEST(SMemoryTest, StackDeallocateReturnsPadding)
+{
+    StackAllocator stack;
+    stack.init(kb(1));
+
+    auto first = stack.allocate(3, 1);
+    ASSERT_NE(first, nullptr);
+    const u64 marker = stack.get_marker();
+
+    auto second = stack.allocate(64, 64);
+    ASSERT_NE(second, nullptr);
+    EXPECT_TRUE(is_aligned(second, 64));
+
+    stack.deallocate(second);
+    EXPECT_EQ(stack.get_marker(), marker);
+
+    stack.deallocate(first);
+    EXPECT_EQ(stack.get_marker(), 0u);
+
+    stack.shutdown();
+}
+
+TEST(SMemoryTest, LinearMarkers)
+{
+    LinearAllocator linear;
+    linear.init(256);
+
+    auto first = linear.allocate(16, 16);
+    EXPECT_TRUE(is_aligned(first, 16));
+
+    const u64 marker = linear.get_marker();
+    EXPECT_NE(linear.allocate(100, 8), nullptr);
+    linear.free_marker(marker);
+    EXPECT_EQ(linear.get_marker(), marker);
+
+    // Out of memory leaves it untouched.
+    EXPECT_EQ(linear.allocate(1024, 8), nullptr);
+    EXPECT_EQ(linear.get_marker(), marker);
+
+    linear.clear();
+    EXPECT_EQ(linear.get_marker(), 0u);
+    EXPECT_GE(linear.peak_memory, 116u);
+
+    linear.shutdown();
+}
+
+TEST(SMemoryTest, PoolReusesBlocks)
+{
+    PoolAllocator pool;
+    pool.init(24, 4, 16);
+    EXPECT_EQ(pool.block_size, 32u);
+
+    void* blocks[4];
+    for (auto& block : blocks)
+    {
+        block = pool.allocate(24, 8);
+        ASSERT_NE(block, nullptr);
+        EXPECT_TRUE(is_aligned(block, 16));
+    }
+    EXPECT_EQ(pool.allocate(24, 8), nullptr);
+
+    pool.deallocate(blocks[2]);
+    EXPECT_EQ(pool.allocate(24, 8), blocks[2]);
+
+    for (auto block : blocks)
+    {
+        pool.deallocate(block);
+    }
+    EXPECT_EQ(pool.allocated_blocks, 0u);
+
+    pool.shutdown();
+}
+
+TEST(SMemoryTest, TLSFAllocateAndMerge)
+{
+    TLSFAllocator heap;
+    heap.init(kb(64));
+
+    auto a = heap.allocate(100, 8);
+    auto b = heap.allocate(1000, 8);
+    auto c = heap.allocate(10000, 8);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    ASSERT_NE(c, nullptr);
+    EXPECT_GE(heap.get_allocation_size(b), 1000u);
+
+    heap.deallocate(a);
+    heap.deallocate(c);
+    heap.deallocate(b);
+    EXPECT_EQ(heap.allocated_memory, 0u);
+
+    // Everything merged back, the whole heap fits again.
+    auto all = heap.allocate(kb(60), 8);
+    EXPECT_NE(all, nullptr);
+    heap.deallocate(all);
+
+    heap.shutdown();
+}
+
+TEST(SMemoryTest, TLSFAlignment)
+{
+    TLSFAllocator heap;
+    heap.init(kb(64));
+
+    std::vector<void*> pointers;
+    for (u64 alignment = 1; alignment <= 1024; alignment *= 2)
+    {
+        auto pointer = heap.allocate(40, alignment);
+        ASSERT_NE(pointer, nullptr);
+        EXPECT_TRUE(is_aligned(pointer, std::max<u64>(alignment, TLSFAllocator::ALIGNMENT)));
+        pointers.push_back(pointer);
+    }
+
+    for (auto pointer : pointers)
+    {
+        heap.deallocate(pointer);
+    }
+    EXPECT_EQ(heap.allocated_memory, 0u);
+
+    heap.shutdown();
+}
+
+TEST(SMemoryTest, TLSFOutOfMemory)
+{
+    TLSFAllocator heap;
+    heap.init(kb(4));
+
+    EXPECT_EQ(heap.allocate(kb(8), 8), nullptr);
+
+    auto pointer = heap.allocate(kb(2), 8);
+    EXPECT_NE(pointer, nullptr);
+    EXPECT_EQ(heap.allocate(kb(2), 8), nullptr);
+    heap.deallocate(pointer);
+
+    heap.shutdown();
+}
+
+TEST(SMemoryTest, TLSFRandomAllocations)
+{
+    TLSFAllocator heap;
+    heap.init(mb(1));
+
+    std::mt19937                       random(42);
+    std::uniform_int_distribution<u32> size_distribution(1, 4096);
+
+    // Each live allocation is filled with its own byte, overlaps would break the pattern.
+    struct Allocation
+    {
+        u8* pointer;
+        u32 size;
+        u8  value;
+    };
+
+    auto check = [](const Allocation& allocation) {
+        for (u32 i = 0; i < allocation.size; ++i)
+        {
+            if (allocation.pointer[i] != allocation.value)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::vector<Allocation> live;
+    for (u32 i = 0; i < 10000; ++i)
+    {
+        if (live.empty() || random() % 3 != 0)
+        {
+            const u32 size    = size_distribution(random);
+            auto      pointer = static_cast<u8*>(heap.allocate(size, 16));
+            if (pointer == nullptr)
+            {
+                continue;
+            }
+
+            const auto value = static_cast<u8>(i);
+            memset(pointer, value, size);
+            live.push_back({pointer, size, value});
+            continue;
+        }
+
+        std::swap(live.at(random() % live.size()), live.back());
+        ASSERT_TRUE(check(live.back()));
+        heap.deallocate(live.back().pointer);
+        live.pop_back();
+    }
+
+    for (const auto& allocation : live)
+    {
+        ASSERT_TRUE(check(allocation));
+        heap.deallocate(allocation.pointer);
+    }
+    EXPECT_EQ(heap.allocated_memory, 0u);
+
+    heap.shutdown();
+}
+
+TEST(SMemoryTest, StlContainers)
+{
+    TLSFAllocator heap;
+    heap.init(kb(256));
+
+    {
+        Vector<u32> values{&heap};
+        for (u32 i = 0; i < 1000; ++i)
+        {
+            values.push_back(i);
+        }
+        EXPECT_EQ(values.at(999), 999u);
+
+        UnorderedMap<u32, u32> map{&heap};
+        map[7] = 49;
+        EXPECT_EQ(map.at(7), 49u);
+        EXPECT_GT(heap.allocated_memory, 0u);
+    }
+    EXPECT_EQ(heap.allocated_memory, 0u);
+
+    heap.shutdown();
+}
+
+TEST(SMemoryTest, DoubleStackEnds)
+{
+    DoubleStackAllocator stack;
+    stack.init(kb(1));
+
+    auto bottom = stack.allocate_bottom(100, 16);
+    auto top    = stack.allocate_top(100, 64);
+    ASSERT_NE(bottom, nullptr);
+    ASSERT_NE(top, nullptr);
+    EXPECT_TRUE(is_aligned(bottom, 16));
+    EXPECT_TRUE(is_aligned(top, 64));
+    EXPECT_GE(static_cast<u8*>(top), static_cast<u8*>(bottom) + 100);
+    EXPECT_LE(static_cast<u8*>(top) + 100, stack.memory + stack.total_memory);
+
+    // Both ends share the block, neither can grow into the other.
+    EXPECT_EQ(stack.allocate_bottom(kb(1), 8), nullptr);
+    EXPECT_EQ(stack.allocate_top(kb(1), 8), nullptr);
+
+    stack.clear_top();
+    EXPECT_EQ(stack.get_top_marker(), kb(1));
+    EXPECT_EQ(stack.get_bottom_marker(), 100u);
+
+    stack.clear_bottom();
+    EXPECT_NE(stack.allocate_top(kb(1), 8), nullptr);
+
+    stack.shutdown();
+}
+
+TEST(SMemoryTest, ScopedStackMarker)
+{
+    DoubleStackAllocator stack;
+    stack.init(kb(4));
+
+    stack.allocate_bottom(64, 8);
+    const u64 bottom_marker = stack.get_bottom_marker();
+    const u64 top_marker    = stack.get_top_marker();
+    {
+        ScopedStackMarker scratch(stack, true);
+
+        Vector<u32> values{&stack.top_end};
+        for (u32 i = 0; i < 100; ++i)
+        {
+            values.push_back(i);
+        }
+        EXPECT_LT(stack.get_top_marker(), top_marker);
+        EXPECT_EQ(stack.get_bottom_marker(), bottom_marker);
+    }
+    EXPECT_EQ(stack.get_top_marker(), top_marker);
+    EXPECT_EQ(stack.get_bottom_marker(), bottom_marker);
+
+    {
+        ScopedStackMarker persistent(stack, false);
+        stack.allocate_bottom(256, 8);
+    }
+    EXPECT_EQ(stack.get_bottom_marker(), bottom_marker);
+
+    stack.shutdown();
+}
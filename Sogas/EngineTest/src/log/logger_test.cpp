@@ -0,0 +1,163 @@
+#include "pch.h"
+
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <logger.h>
+
+using namespace sogas;
+using namespace sogas::log;
+
+// Keeps every line it receives.
+struct CaptureSink : public LogSink
+{
+    void write(Logger_types /*type*/, const char* text, u32 length) override
+    {
+        std::lock_guard lock(mutex);
+        lines.emplace_back(text, length);
+    }
+
+    std::mutex               mutex;
+    std::vector<std::string> lines;
+};
+
+class LoggerTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        auto new_sink = std::make_unique<CaptureSink>();
+        sink          = new_sink.get();
+        add_sink(std::move(new_sink));
+    }
+
+    void TearDown() override
+    {
+        shutdown();
+        remove_sink(sink);
+
+        for (u32 i = 0; i < static_cast<u32>(Log_category::COUNT); ++i)
+        {
+            set_category_mask(static_cast<Log_category>(i), ~0u);
+        }
+    }
+
+    CaptureSink* sink = nullptr;
+};
+
+TEST_F(LoggerTest, FormatsArguments)
+{
+    const std::string name = "cube";
+    PINFO("Mesh %s, %u vertices, %d offset, %llu bytes, %.2f ms, %x, 100%%.",
+          name.c_str(),
+          24u,
+          -3,
+          static_cast<u64>(1) << 40,
+          1.5f,
+          255);
+    PWARN("%5s|%-3d|%c", "ab", 7, 'z');
+    PERROR("Missing %s and %d.", "one");
+
+    ASSERT_EQ(sink->lines.size(), 3u);
+    EXPECT_EQ(sink->lines.at(0),
+              "[INFO]: Mesh cube, 24 vertices, -3 offset, 1099511627776 bytes, 1.50 ms, ff, 100%.\n");
+    EXPECT_EQ(sink->lines.at(1), "[WARN]:    ab|7  |z\n");
+    EXPECT_EQ(sink->lines.at(2), "[ERROR]: Missing one and %d.\n");
+}
+
+TEST_F(LoggerTest, TruncatesLongStrings)
+{
+    const std::string text(1000, 'a');
+    PINFO("%s", text.c_str());
+
+    ASSERT_EQ(sink->lines.size(), 1u);
+    EXPECT_LT(sink->lines.at(0).size(), text.size());
+    EXPECT_EQ(sink->lines.at(0).back(), '\n');
+}
+
+TEST_F(LoggerTest, WriterThreadKeepsOrderPerThread)
+{
+    init();
+
+    // More lines than the queue holds, so producers also wait for the writer.
+    constexpr u32            thread_count = 4;
+    constexpr u32            line_count   = 5000;
+    std::vector<std::thread> threads;
+    for (u32 t = 0; t < thread_count; ++t)
+    {
+        threads.emplace_back(
+          [t]()
+          {
+              for (u32 i = 0; i < line_count; ++i)
+              {
+                  PINFO("%u %u", t, i);
+              }
+          });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    flush();
+
+    ASSERT_EQ(sink->lines.size(), thread_count * line_count);
+
+    u32 next[thread_count] = {};
+    for (const auto& line : sink->lines)
+    {
+        ASSERT_EQ(line.rfind("[INFO]: ", 0), 0u);
+
+        u32                t = 0, i = 0;
+        std::istringstream stream(line.substr(8));
+        stream >> t >> i;
+        ASSERT_LT(t, thread_count);
+        EXPECT_EQ(i, next[t]++);
+    }
+}
+
+TEST_F(LoggerTest, CategoryMaskSkipsArguments)
+{
+    u32  evaluated = 0;
+    auto argument  = [&evaluated]() { return ++evaluated; };
+
+    set_category_mask(Log_category::RENDER, 0);
+    PLOG(ERROR, RENDER, "Filtered %u.", argument());
+    PLOG(ERROR, MEMORY, "Kept %u.", argument());
+
+    ASSERT_EQ(sink->lines.size(), 1u);
+    EXPECT_EQ(sink->lines.at(0), "[ERROR]: Kept 1.\n");
+    EXPECT_EQ(evaluated, 1u);
+}
+
+TEST_F(LoggerTest, CategoryLevel)
+{
+    set_category_level(Log_category::RESOURCES, Logger_types::WARNING);
+    PLOG(INFO, RESOURCES, "Hidden.");
+    PLOG(WARNING, RESOURCES, "Shown.");
+    PLOG(ERROR, RESOURCES, "Also shown.");
+    PLOG(INFO, ENTITIES, "Other category.");
+
+    ASSERT_EQ(sink->lines.size(), 3u);
+    EXPECT_EQ(sink->lines.at(0), "[WARN]: Shown.\n");
+    EXPECT_EQ(sink->lines.at(1), "[ERROR]: Also shown.\n");
+    EXPECT_EQ(sink->lines.at(2), "[INFO]: Other category.\n");
+}
+
+// Cost on the calling thread, run with --gtest_also_run_disabled_tests.
+TEST_F(LoggerTest, DISABLED_CallerCost)
+{
+    init();
+
+    constexpr u32 count = 2000;
+    const auto    start = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < count; ++i)
+    {
+        PINFO("Frame %u took %.2f ms in %s.", i, 16.6f, "render");
+    }
+    const auto end = std::chrono::steady_clock::now();
+    flush();
+
+    printf("%.1f ns per line\n", std::chrono::duration<f64, std::nano>(end - start).count() / count);
+}
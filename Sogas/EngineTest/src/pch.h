@@ -7,11 +7,11 @@
 #ifdef _WIN64
 #pragma warning(disable : 4615)
 #pragma warning(disable : 4389)
+#endif
 #include <gtest/gtest.h>
+#ifdef _WIN64
 #pragma warning(enable : 4389)
 #pragma warning(enable : 4615)
-#else
-#error "Only win64 platform implemented at the moment."
 #endif
 
 #include <engine/defines.h>
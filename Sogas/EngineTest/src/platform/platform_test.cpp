@@ -1,21 +1,24 @@
 
 #include "pch.h"
 
-#include <../include/platform/platform.h>
+#include <chrono>
+#include <cstdio>
 
-using namespace sogas::engine::platform;
+#include <platform/platform.h>
+
+using namespace sogas::platform;
 
 TEST(PlatformTest, OpenWindowWithoutParameters)
 {
     auto window = create_window();
 
-    EXPECT_TRUE(window >= 0);
+    EXPECT_NE(window, INVALID_ID);
     EXPECT_FALSE(is_window_fullscreen(window));
 
     u32 w, h;
     get_window_size(window, w, h);
-    EXPECT_EQ(w, 1920);
-    EXPECT_EQ(h, 1080);
+    EXPECT_EQ(w, 1920u);
+    EXPECT_EQ(h, 1080u);
 
     remove_window(window);
 }
@@ -25,13 +28,13 @@ TEST(PlatformTest, OpenWindowWithParameters)
     window_init_info window_info{"Sogas Engine Test", nullptr, nullptr, 0, 0, 1280, 720};
     auto             window = create_window(&window_info);
 
-    EXPECT_TRUE(window >= 0);
+    EXPECT_NE(window, INVALID_ID);
     EXPECT_FALSE(is_window_fullscreen(window));
 
     u32 w, h;
     get_window_size(window, w, h);
-    EXPECT_EQ(w, 1280);
-    EXPECT_EQ(h, 720);
+    EXPECT_EQ(w, 1280u);
+    EXPECT_EQ(h, 720u);
 
     remove_window(window);
 }
@@ -41,19 +44,19 @@ TEST(PlatformTest, ResizeWindow)
     window_init_info window_info{"Sogas Engine Test", nullptr, nullptr, 0, 0, 1280, 720};
     auto             window = create_window(&window_info);
 
-    EXPECT_TRUE(window >= 0);
+    EXPECT_NE(window, INVALID_ID);
     EXPECT_FALSE(is_window_fullscreen(window));
 
     u32 w, h;
     get_window_size(window, w, h);
-    EXPECT_EQ(w, 1280);
-    EXPECT_EQ(h, 720);
+    EXPECT_EQ(w, 1280u);
+    EXPECT_EQ(h, 720u);
 
     resize_window(window, 800, 400);
 
     get_window_size(window, w, h);
-    EXPECT_EQ(w, 800);
-    EXPECT_EQ(h, 400);
+    EXPECT_EQ(w, 800u);
+    EXPECT_EQ(h, 400u);
 
     remove_window(window);
 }
@@ -62,7 +65,7 @@ TEST(PlatformTest, SetFullscreenWindow)
 {
     auto window = create_window();
 
-    EXPECT_TRUE(window >= 0);
+    EXPECT_NE(window, INVALID_ID);
     EXPECT_FALSE(is_window_fullscreen(window));
 
     set_window_fullscreen(window, true);
@@ -71,3 +74,55 @@ TEST(PlatformTest, SetFullscreenWindow)
 
     remove_window(window);
 }
+
+TEST(PlatformTest, FrameBudget)
+{
+    set_frame_budget({3, 0.0});
+    EXPECT_FALSE(peek_message());
+    EXPECT_FALSE(peek_message());
+    EXPECT_FALSE(peek_message());
+    EXPECT_TRUE(peek_message());
+    EXPECT_TRUE(peek_message());
+
+    // Paced frames start no sooner than the frame time apart.
+    set_frame_budget({0, 0.005});
+    const auto start = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < 4; ++i)
+    {
+        EXPECT_FALSE(peek_message());
+    }
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(15));
+
+    request_quit();
+    EXPECT_TRUE(peek_message());
+
+    set_frame_budget({});
+    EXPECT_FALSE(peek_message());
+}
+
+TEST(PlatformTest, MapFile)
+{
+    const std::string filename = "platform_test_map.txt";
+    {
+        std::ofstream ofs(filename);
+        ofs << "mapped";
+    }
+
+    Mapped_file file;
+    ASSERT_TRUE(map_file(filename, file));
+    ASSERT_EQ(file.size, 6u);
+    EXPECT_EQ(std::string(static_cast<const char*>(file.data), file.size), "mapped");
+    unmap_file(file);
+    EXPECT_EQ(file.data, nullptr);
+
+    std::remove(filename.c_str());
+    EXPECT_FALSE(map_file(filename, file));
+}
+
+TEST(PlatformTest, StringFormat)
+{
+    char buffer[char_buffer_size];
+    EXPECT_EQ(string_format(buffer, "%s %d", "frame", 42), 8);
+    EXPECT_STREQ(buffer, "frame 42");
+    EXPECT_EQ(string_format(nullptr, "%d", 1), -1);
+}
@@ -0,0 +1,136 @@
+#include "pch.h"
+
+#include <resources/light_clusters.h>
+
+using namespace sogas;
+
+static const f32 NEAR = 0.1f;
+static const f32 FAR  = 1000.0f;
+static const f32 FOV  = glm::radians(90.0f);
+
+static std::vector<u32> get_cluster_lights(const LightClusters& clusters, u32 x, u32 y, u32 z)
+{
+    const auto& range = clusters.get_clusters().at(clusters.get_cluster_index(x, y, z));
+    const auto& lists = clusters.get_light_indices();
+    return {lists.begin() + range.offset, lists.begin() + range.offset + range.count};
+}
+
+TEST(LightClustersTest, ClusterSlice)
+{
+    EXPECT_EQ(get_cluster_slice(0.0f, NEAR, FAR, 24), 0u);
+    EXPECT_EQ(get_cluster_slice(NEAR, NEAR, FAR, 24), 0u);
+    EXPECT_EQ(get_cluster_slice(FAR, NEAR, FAR, 24), 23u);
+    EXPECT_EQ(get_cluster_slice(FAR * 2.0f, NEAR, FAR, 24), 23u);
+
+    // Four decades over 24 slices, each decade spans six of them.
+    EXPECT_EQ(get_cluster_slice(1.01f, NEAR, FAR, 24), 6u);
+    EXPECT_EQ(get_cluster_slice(10.1f, NEAR, FAR, 24), 12u);
+    EXPECT_EQ(get_cluster_slice(9.9f, NEAR, FAR, 24), 11u);
+}
+
+TEST(LightClustersTest, LightInFrontOfCamera)
+{
+    LightClustersDescriptor descriptor;
+    descriptor.grid_x = 4;
+    descriptor.grid_y = 4;
+    descriptor.grid_z = 24;
+
+    LightClusters clusters;
+    clusters.init(descriptor);
+
+    // Small light straight ahead, just right and above the center of the screen.
+    ClusterLight light;
+    light.position = glm::vec3(0.5f, 0.5f, -10.1f);
+    light.radius   = 0.1f;
+    clusters.add_light(light);
+    clusters.build(glm::mat4(1.0f), FOV, 1.0f, NEAR, FAR);
+
+    ASSERT_EQ(clusters.get_light_indices().size(), 1u);
+    EXPECT_EQ(get_cluster_lights(clusters, 2, 1, 12), std::vector<u32>{0});
+    EXPECT_TRUE(get_cluster_lights(clusters, 1, 1, 12).empty());
+    EXPECT_TRUE(get_cluster_lights(clusters, 2, 2, 12).empty());
+}
+
+TEST(LightClustersTest, LightsOutsideFrustumAreCulled)
+{
+    LightClusters clusters;
+    clusters.init();
+
+    ClusterLight behind;
+    behind.position = glm::vec3(0.0f, 0.0f, 5.0f);
+    clusters.add_light(behind);
+
+    ClusterLight beside;
+    beside.position = glm::vec3(50.0f, 0.0f, -10.0f);
+    clusters.add_light(beside);
+
+    ClusterLight beyond_far;
+    beyond_far.position = glm::vec3(0.0f, 0.0f, -FAR - 10.0f);
+    clusters.add_light(beyond_far);
+
+    clusters.build(glm::mat4(1.0f), FOV, 16.0f / 9.0f, NEAR, FAR);
+    EXPECT_TRUE(clusters.get_light_indices().empty());
+}
+
+TEST(LightClustersTest, CameraInsideLight)
+{
+    LightClustersDescriptor descriptor;
+    descriptor.grid_x = 4;
+    descriptor.grid_y = 4;
+    descriptor.grid_z = 8;
+
+    LightClusters clusters;
+    clusters.init(descriptor);
+
+    ClusterLight light;
+    light.radius = 5.0f;
+    clusters.add_light(light);
+
+    // The view matrix moves the light in front of the camera, still around the eye.
+    clusters.build(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -1.0f)),
+                   FOV,
+                   1.0f,
+                   NEAR,
+                   FAR);
+
+    // Every tile of the closest slices sees it.
+    for (u32 y = 0; y < descriptor.grid_y; ++y)
+    {
+        for (u32 x = 0; x < descriptor.grid_x; ++x)
+        {
+            EXPECT_EQ(get_cluster_lights(clusters, x, y, 0), std::vector<u32>{0});
+        }
+    }
+}
+
+TEST(LightClustersTest, Budgets)
+{
+    LightClustersDescriptor descriptor;
+    descriptor.max_lights        = 2;
+    descriptor.max_light_indices = 10;
+
+    LightClusters clusters;
+    clusters.init(descriptor);
+
+    // Both lights cover the whole view, so the index lists run out.
+    ClusterLight light;
+    light.radius = 2000.0f;
+    EXPECT_TRUE(clusters.add_light(light));
+    EXPECT_TRUE(clusters.add_light(light));
+    EXPECT_FALSE(clusters.add_light(light));
+
+    clusters.build(glm::mat4(1.0f), FOV, 1.0f, NEAR, FAR);
+    EXPECT_EQ(clusters.get_light_indices().size(), 10u);
+
+    u32 total = 0;
+    for (const auto& range : clusters.get_clusters())
+    {
+        EXPECT_LE(range.offset + range.count, 10u);
+        total += range.count;
+    }
+    EXPECT_EQ(total, 10u);
+
+    clusters.clear();
+    clusters.build(glm::mat4(1.0f), FOV, 1.0f, NEAR, FAR);
+    EXPECT_TRUE(clusters.get_light_indices().empty());
+}
@@ -0,0 +1,223 @@
+#include "pch.h"
+
+#include <memory_tracker.h>
+#include <null/null_device.h>
+#include <resources/pipeline.h>
+#include <resources/renderpass.h>
+#include <resources/shader_state.h>
+#include <resources/texture.h>
+
+using namespace pinut;
+using namespace pinut::null;
+using namespace pinut::resources;
+
+class NullDeviceTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        device = static_cast<NullDevice*>(GPUDevice::create(GraphicsAPI::Null));
+        ASSERT_NE(device, nullptr);
+        device->init({});
+    }
+
+    void TearDown() override
+    {
+        device->shutdown();
+        delete device;
+    }
+
+    NullDevice* device = nullptr;
+};
+
+TEST_F(NullDeviceTest, BuffersKeepTheirData)
+{
+    u32        values[4] = {1, 2, 3, 4};
+    const auto source    = device->create_buffer({sizeof(values), BufferType::VERTEX, values});
+    const auto target    = device->create_buffer({sizeof(values), BufferType::STORAGE});
+    ASSERT_NE(source.id, INVALID_ID);
+    ASSERT_NE(target.id, INVALID_ID);
+
+    auto mapped = static_cast<u32*>(device->map_buffer(source, sizeof(u32), sizeof(u32)));
+    EXPECT_EQ(*mapped, 2u);
+    *mapped = 20;
+    device->unmap_buffer(source);
+
+    device->copy_buffer(source, target, sizeof(values));
+    auto copied = static_cast<u32*>(device->map_buffer(target, sizeof(values)));
+    EXPECT_EQ(copied[0], 1u);
+    EXPECT_EQ(copied[1], 20u);
+    EXPECT_EQ(copied[3], 4u);
+    device->unmap_buffer(target);
+
+    device->destroy_buffer(source);
+    device->destroy_buffer(target);
+}
+
+TEST_F(NullDeviceTest, ShutdownFreesLiveBuffers)
+{
+    const u64 allocations = sogas::get_memory_stats(sogas::MemoryTag::GPU_MEMORY).allocations;
+
+    const auto first  = device->create_buffer({16, BufferType::UNIFORM});
+    const auto second = device->create_buffer({16, BufferType::UNIFORM});
+    const auto third  = device->create_buffer({16, BufferType::UNIFORM});
+    ASSERT_NE(third.id, INVALID_ID);
+
+    // Out of creation order, the free list no longer tells which buffers are alive.
+    device->destroy_buffer(first);
+    device->destroy_buffer(third);
+    EXPECT_EQ(device->access_buffer(first.id)->data, nullptr);
+    EXPECT_NE(device->access_buffer(second.id)->data, nullptr);
+
+    device->shutdown();
+    EXPECT_EQ(sogas::get_memory_stats(sogas::MemoryTag::GPU_MEMORY).allocations, allocations);
+}
+
+TEST_F(NullDeviceTest, RecordsCommands)
+{
+    PipelineDescriptor pipeline;
+    pipeline.add_name("null_pipeline");
+    device->create_pipeline(pipeline);
+
+    auto cmd = device->get_command_buffer(true);
+    cmd->begin_gpu_zone("Frame");
+    cmd->bind_pass("Swapchain_renderpass");
+    cmd->bind_pipeline("null_pipeline");
+    EXPECT_THROW(cmd->bind_pipeline("missing_pipeline"), std::runtime_error);
+    EXPECT_THROW(cmd->bind_pass("missing_pass"), std::runtime_error);
+
+    for (u32 i = 0; i < 3; ++i)
+    {
+        f32 model[16] = {static_cast<f32>(i)};
+        cmd->set_push_constant(ShaderStageType::VERTEX, sizeof(model), 0, model);
+        cmd->draw_indexed(0, 36, 0, 1, 0);
+    }
+    cmd->end_gpu_zone();
+    device->end_frame();
+
+    const auto& frame = device->get_last_frame_commands();
+    EXPECT_EQ(device->get_frame_count(), 1u);
+    EXPECT_EQ(frame.get_command_count(NullCommandType::DRAW_INDEXED), 3u);
+    EXPECT_EQ(frame.get_command_count(NullCommandType::PUSH_CONSTANT), 3u);
+    // end_frame ends the pass still bound.
+    EXPECT_EQ(frame.commands.back().type, NullCommandType::END_PASS);
+    EXPECT_TRUE(device->get_gpu_zones().empty());
+
+    // Push constant data is kept in order, the command holds its offset.
+    const auto& push_constant = frame.commands.at(5);
+    ASSERT_EQ(push_constant.type, NullCommandType::PUSH_CONSTANT);
+    f32 model[16];
+    memcpy(model, frame.push_constant_data.data() + push_constant.args[3], sizeof(model));
+    EXPECT_EQ(model[0], 1.0f);
+    EXPECT_EQ(model[15], 0.0f);
+
+    // The next frame records from scratch.
+    device->get_command_buffer(true)->draw(0, 3, 0, 1);
+    device->end_frame();
+    EXPECT_EQ(device->get_last_frame_commands().commands.size(), 1u);
+}
+
+TEST_F(NullDeviceTest, DescriptorSets)
+{
+    const auto layout = device->create_descriptor_set_layout({});
+
+    DescriptorSetDescriptor descriptor;
+    descriptor.set_layout(layout);
+    const auto set       = device->create_descriptor_set(descriptor);
+    const auto same_set  = device->create_descriptor_set(descriptor);
+    const auto transient = device->create_descriptor_set(descriptor.set_transient());
+    EXPECT_EQ(set.id, same_set.id);
+    EXPECT_NE(set.id, transient.id);
+
+    // Transient sets go back at the start of the next frame.
+    device->begin_frame();
+    const auto reused = device->create_descriptor_set(descriptor);
+    EXPECT_EQ(reused.id, transient.id);
+    device->begin_frame();
+
+    device->destroy_descriptor_set(set);
+    device->destroy_descriptor_set(same_set);
+    device->destroy_descriptor_set_layout(layout);
+}
+
+TEST_F(NullDeviceTest, RecycledResourceMissesSetCache)
+{
+    DescriptorSetLayoutDescriptor layout_descriptor;
+    layout_descriptor.add_binding({0, 1, ShaderStageType::VERTEX, DescriptorType::UNIFORM});
+    const auto layout = device->create_descriptor_set_layout(layout_descriptor);
+
+    const auto first = device->create_buffer({16, BufferType::UNIFORM});
+    DescriptorSetDescriptor descriptor;
+    descriptor.set_layout(layout).add_buffer(first, 0);
+    const auto first_set = device->create_descriptor_set(descriptor);
+
+    // The new buffer gets the id of the destroyed one, the set written with the old one is stale.
+    device->destroy_buffer(first);
+    const auto second = device->create_buffer({16, BufferType::UNIFORM});
+    ASSERT_EQ(second.id, first.id);
+    descriptor.reset().set_layout(layout).add_buffer(second, 0);
+    const auto second_set = device->create_descriptor_set(descriptor);
+    EXPECT_NE(second_set.id, first_set.id);
+    EXPECT_EQ(device->create_descriptor_set(descriptor).id, second_set.id);
+
+    device->destroy_descriptor_set(first_set);
+    device->destroy_descriptor_set(second_set);
+    device->destroy_descriptor_set(second_set);
+    device->destroy_buffer(second);
+    device->destroy_descriptor_set_layout(layout);
+}
+
+TEST_F(NullDeviceTest, OffscreenRenderPasses)
+{
+    TextureDescriptor target;
+    target.set_size(320, 180)
+      .set_format(TextureFormat::R16G16B16A16_SFLOAT)
+      .set_render_target(true);
+    const auto albedo = device->create_texture(target);
+    const auto normal = device->create_texture(target);
+    const auto depth  = device->create_texture(target.set_format(TextureFormat::D32_SFLOAT));
+
+    RenderPassDescriptor gbuffer;
+    gbuffer.name = "gbuffer";
+    gbuffer.add_color_attachment(albedo).add_color_attachment(normal).set_depth_attachment(depth);
+    const auto gbuffer_pass = device->create_renderpass(gbuffer);
+    ASSERT_NE(gbuffer_pass.id, INVALID_ID);
+    EXPECT_TRUE(device->has_render_pass("gbuffer"));
+
+    // The framebuffer is made with the pass and sized by its attachments.
+    const auto pass = device->access_render_pass(gbuffer_pass.id);
+    EXPECT_EQ(pass->width, 320u);
+    EXPECT_EQ(pass->height, 180u);
+    EXPECT_EQ(pass->color_attachment_count, 2u);
+    EXPECT_TRUE(pass->has_depth);
+    EXPECT_EQ(pass->attachments[2].id, depth.id);
+    EXPECT_EQ(device->get_framebuffer_count(), 1u);
+
+    // Creating it again returns the existing pass and its framebuffer.
+    EXPECT_EQ(device->create_renderpass(gbuffer).id, gbuffer_pass.id);
+    EXPECT_EQ(device->get_framebuffer_count(), 1u);
+
+    // Same formats and operations share the render pass, other operations do not.
+    const u32 layouts = device->get_render_pass_layout_count();
+    gbuffer.name      = "decals";
+    const auto decals = device->create_renderpass(gbuffer);
+    EXPECT_EQ(device->access_render_pass(decals.id)->layout, pass->layout);
+    EXPECT_EQ(device->get_render_pass_layout_count(), layouts);
+
+    gbuffer.name = "gbuffer_load";
+    gbuffer.set_operations(RenderPassOperation::LOAD, RenderPassOperation::LOAD);
+    const auto load = device->create_renderpass(gbuffer);
+    EXPECT_NE(device->access_render_pass(load.id)->layout, pass->layout);
+    EXPECT_EQ(device->get_render_pass_layout_count(), layouts + 1);
+    EXPECT_EQ(device->get_framebuffer_count(), 3u);
+
+    auto cmd = device->get_command_buffer(true);
+    cmd->bind_pass("gbuffer");
+    cmd->bind_pass("Swapchain_renderpass");
+    device->end_frame();
+    EXPECT_EQ(device->get_last_frame_commands().get_command_count(NullCommandType::END_PASS), 2u);
+
+    device->destroy_texture(albedo);
+    device->destroy_texture(normal);
+    device->destroy_texture(depth);
+}
@@ -0,0 +1,166 @@
+#include "pch.h"
+
+#include <null/null_device.h>
+#include <resources/hash.h>
+#include <resources/pipeline_library.h>
+
+using namespace sogas;
+
+static const char* cull_modes[] = {"none", "front", "back", "both"};
+static const char* topologies[] = {"point", "line", "line_strip", "triangle", "triangle_strip"};
+
+// Every spec gets its own name, but only 4 cull modes x 5 topologies = 20 distinct states.
+static json make_variant_spec(u32 index)
+{
+    json j;
+    j["name"]     = "variant_" + std::to_string(index);
+    j["topology"] = topologies[(index / 4) % 5];
+    j["shaders"]  = {{"vertex", "forward.vert.spv"}, {"fragment", "forward.frag.spv"}};
+    j["rasterization"] = {{"cull_mode", cull_modes[index % 4]}, {"line_width", 1.0f}};
+    j["vertex_input"]  = {
+      {"streams", {{{"binding", 0}, {"stride", 44}, {"input_rate", "vertex"}}}},
+      {"attributes", {{{"location", 0}, {"binding", 0}, {"offset", 0}, {"format", "vec3"}}}}};
+    j["set_layouts"] = {
+      {{"name", "global"},
+       {"bindings", {{{"binding", 0}, {"count", 1}, {"stage", "vertex"}, {"type", "uniform"}}}}}};
+    j["push_constants"] = {{{"stage", "vertex"}, {"size", 64}, {"offset", 0}}};
+    return j;
+}
+
+TEST(PipelineSpecTest, ParseSpec)
+{
+    PipelineSpec spec;
+    ASSERT_TRUE(parse_pipeline_spec(make_variant_spec(6), spec));
+
+    EXPECT_EQ(spec.name, "variant_6");
+    EXPECT_EQ(spec.topology, pinut::resources::TopologyType::LINE);
+    EXPECT_EQ(spec.rasterization.cull_mode, pinut::resources::CullMode::BACK);
+    EXPECT_EQ(spec.vertex_input.stream_count, 1u);
+    EXPECT_EQ(spec.vertex_input.streams[0].stride, 44u);
+    EXPECT_EQ(spec.vertex_input.attribute_count, 1u);
+    ASSERT_EQ(spec.set_layouts.size(), 1u);
+    EXPECT_EQ(spec.set_layouts[0].binding_count, 1u);
+    ASSERT_EQ(spec.push_constants.size(), 1u);
+    EXPECT_EQ(spec.push_constants[0].size, 64u);
+}
+
+TEST(PipelineSpecTest, UnknownEnumFails)
+{
+    auto j                          = make_variant_spec(0);
+    j["rasterization"]["cull_mode"] = "sideways";
+
+    PipelineSpec spec;
+    EXPECT_FALSE(parse_pipeline_spec(j, spec));
+}
+
+TEST(PipelineSpecTest, NameDoesNotChangeHash)
+{
+    PipelineSpec a, b;
+    ASSERT_TRUE(parse_pipeline_spec(make_variant_spec(3), a));
+    ASSERT_TRUE(parse_pipeline_spec(make_variant_spec(23), b));
+
+    EXPECT_NE(a.name, b.name);
+    EXPECT_EQ(hash_pipeline_spec(a), hash_pipeline_spec(b));
+}
+
+TEST(PipelineSpecTest, ShaderCodeChangesHash)
+{
+    PipelineSpec spec;
+    ASSERT_TRUE(parse_pipeline_spec(make_variant_spec(0), spec));
+
+    spec.shader_state.add_shader_stage({{1, 2, 3}, pinut::resources::ShaderStageType::VERTEX});
+    const u64 first = pinut::resources::hash_pipeline(spec.get_descriptor());
+
+    spec.shader_state.add_shader_stage({{1, 2, 4}, pinut::resources::ShaderStageType::VERTEX});
+    const u64 second = pinut::resources::hash_pipeline(spec.get_descriptor());
+
+    EXPECT_NE(first, second);
+}
+
+TEST(PipelineSpecTest, RenderPassChangesHash)
+{
+    auto j = make_variant_spec(0);
+
+    PipelineSpec swapchain, offscreen;
+    ASSERT_TRUE(parse_pipeline_spec(j, swapchain));
+    j["render_pass"] = "gbuffer";
+    ASSERT_TRUE(parse_pipeline_spec(j, offscreen));
+
+    EXPECT_EQ(offscreen.render_pass, "gbuffer");
+    EXPECT_STREQ(offscreen.get_descriptor().render_pass, "gbuffer");
+    EXPECT_EQ(swapchain.get_descriptor().render_pass, nullptr);
+    EXPECT_NE(hash_pipeline_spec(swapchain), hash_pipeline_spec(offscreen));
+}
+
+TEST(PipelineSpecTest, DeduplicateVariantSpecs)
+{
+    const u32 spec_count = 100;
+
+    auto device =
+      static_cast<pinut::null::NullDevice*>(pinut::GPUDevice::create(pinut::GraphicsAPI::Null));
+    device->init({});
+
+    // Descriptors point into their spec, which has to outlive the pipeline creation.
+    std::vector<PipelineSpec> specs(spec_count);
+    for (u32 i = 0; i < spec_count; ++i)
+    {
+        ASSERT_TRUE(parse_pipeline_spec(make_variant_spec(i), specs.at(i)));
+        device->create_pipeline(specs.at(i).get_descriptor());
+    }
+
+    for (const auto& spec : specs)
+    {
+        EXPECT_TRUE(device->has_pipeline(spec.name));
+    }
+    EXPECT_EQ(device->get_unique_pipeline_count(), 20u);
+
+    device->shutdown();
+    delete device;
+}
+
+TEST(PipelineSpecTest, ParseBindlessSet)
+{
+    PipelineSpec spec;
+    auto         j = make_variant_spec(0);
+    ASSERT_TRUE(parse_pipeline_spec(j, spec));
+    EXPECT_EQ(spec.bindless_set, -1);
+
+    j["bindless_set"] = 1;
+    ASSERT_TRUE(parse_pipeline_spec(j, spec));
+    EXPECT_EQ(spec.bindless_set, 1);
+}
+
+TEST(PipelineSpecTest, BindlessChangesLayoutHash)
+{
+    PipelineSpec spec;
+    ASSERT_TRUE(parse_pipeline_spec(make_variant_spec(0), spec));
+
+    auto      layout  = spec.set_layouts[0];
+    const u64 regular = pinut::resources::hash_descriptor_set_layout(layout);
+    layout.set_bindless();
+
+    EXPECT_NE(regular, pinut::resources::hash_descriptor_set_layout(layout));
+}
+
+TEST(PipelineSpecTest, ParseDepthStencil)
+{
+    auto j = make_variant_spec(0);
+
+    PipelineSpec spec;
+    ASSERT_TRUE(parse_pipeline_spec(j, spec));
+    EXPECT_TRUE(spec.depth_stencil.depth_test);
+    EXPECT_TRUE(spec.depth_stencil.depth_write);
+    EXPECT_EQ(spec.depth_stencil.depth_compare, pinut::resources::CompareOperation::LESS);
+    const u64 less = hash_pipeline_spec(spec);
+
+    // The forward pass after a depth pre-pass only shades what the pre-pass left visible.
+    j["depth_stencil"] = {{"depth_write", false}, {"depth_compare", "equal"}};
+    ASSERT_TRUE(parse_pipeline_spec(j, spec));
+    EXPECT_TRUE(spec.depth_stencil.depth_test);
+    EXPECT_FALSE(spec.depth_stencil.depth_write);
+    EXPECT_EQ(spec.depth_stencil.depth_compare, pinut::resources::CompareOperation::EQUAL);
+    EXPECT_NE(hash_pipeline_spec(spec), less);
+
+    j["depth_stencil"]["depth_compare"] = "sometimes";
+    EXPECT_FALSE(parse_pipeline_spec(j, spec));
+}
@@ -0,0 +1,33 @@
+#include "pch.h"
+
+#include <resources/hash.h>
+#include <resources/texture.h>
+
+using namespace pinut::resources;
+
+TEST(SamplerTest, IdenticalDescriptorsShareHash)
+{
+    TextureDescriptor albedo, normal;
+    albedo.set_size(1024, 1024).add_name("albedo");
+    normal.set_size(4, 4).add_name("normal");
+
+    EXPECT_EQ(hash_sampler(albedo.sampler), hash_sampler(normal.sampler));
+}
+
+TEST(SamplerTest, SamplerStateChangesHash)
+{
+    SamplerDescriptor linear;
+    SamplerDescriptor nearest = linear;
+    nearest.set_filter(SamplerFilter::NEAREST, SamplerFilter::NEAREST, SamplerMipmapMode::NEAREST);
+
+    SamplerDescriptor clamped = linear;
+    clamped.set_address_mode(SamplerAddressMode::CLAMP_TO_EDGE, SamplerAddressMode::CLAMP_TO_EDGE);
+
+    SamplerDescriptor single_mip = linear;
+    single_mip.set_lod(0.0f, 0.0f);
+
+    const u64 hash = hash_sampler(linear);
+    EXPECT_NE(hash, hash_sampler(nearest));
+    EXPECT_NE(hash, hash_sampler(clamped));
+    EXPECT_NE(hash, hash_sampler(single_mip));
+}
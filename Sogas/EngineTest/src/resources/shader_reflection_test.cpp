@@ -0,0 +1,128 @@
+#include "pch.h"
+
+#include <filesystem>
+
+#include <resources/pipeline_library.h>
+#include <resources/shader_reflection.h>
+
+using namespace pinut::resources;
+
+// The build only compiles the shaders when glslc is found.
+#define SKIP_WITHOUT_SHADERS()                                                       \
+    if (!std::filesystem::exists(sogas::get_shader_binary_path("forward.vert.spv"))) \
+    {                                                                                \
+        GTEST_SKIP() << "Shaders were not compiled, glslc was not found.";           \
+    }
+
+static ShaderStage load_stage(const std::string& filename, ShaderStageType type)
+{
+    ShaderStage stage = {};
+    stage.type        = type;
+
+    std::ifstream file(sogas::get_shader_binary_path(filename), std::ios::ate | std::ios::binary);
+    if (file.is_open())
+    {
+        const auto file_size = static_cast<size_t>(file.tellg());
+        stage.code.resize(file_size / sizeof(u32));
+        file.seekg(0);
+        file.read((char*)stage.code.data(), file_size);
+    }
+
+    return stage;
+}
+
+TEST(ShaderReflectionTest, InvalidModule)
+{
+    ShaderStage stage = {{0xDEADBEEF, 0, 0, 0, 0}, ShaderStageType::VERTEX};
+
+    ShaderReflection reflection;
+    EXPECT_FALSE(reflect_shader(stage, reflection));
+}
+
+TEST(ShaderReflectionTest, ForwardVertexShader)
+{
+    SKIP_WITHOUT_SHADERS();
+
+    const auto stage = load_stage("forward.vert.spv", ShaderStageType::VERTEX);
+    ASSERT_FALSE(stage.code.empty());
+
+    ShaderReflection reflection;
+    ASSERT_TRUE(reflect_shader(stage, reflection));
+
+    ASSERT_EQ(reflection.set_count, 1u);
+    ASSERT_EQ(reflection.set_layouts[0].binding_count, 1u);
+    EXPECT_EQ(reflection.set_layouts[0].bindings[0].binding, 0u);
+    EXPECT_EQ(reflection.set_layouts[0].bindings[0].descriptor_type, DescriptorType::UNIFORM);
+    EXPECT_EQ(reflection.set_layouts[0].bindings[0].shader_stage, ShaderStageType::VERTEX);
+
+    EXPECT_EQ(reflection.push_constant.stage, ShaderStageType::VERTEX);
+    EXPECT_EQ(reflection.push_constant.size, 64u);
+
+    // Matches the interleaved sogas::Vertex layout.
+    const auto& vertex_input = reflection.vertex_input;
+    ASSERT_EQ(vertex_input.stream_count, 1u);
+    EXPECT_EQ(vertex_input.streams[0].stride, 44u);
+    ASSERT_EQ(vertex_input.attribute_count, 4u);
+
+    const u32                   offsets[] = {0, 12, 24, 36};
+    const VertexInputFormatType formats[] = {VertexInputFormatType::VEC3,
+                                             VertexInputFormatType::VEC3,
+                                             VertexInputFormatType::VEC3,
+                                             VertexInputFormatType::VEC2};
+    for (u32 i = 0; i < 4; ++i)
+    {
+        EXPECT_EQ(vertex_input.attributes[i].location, i);
+        EXPECT_EQ(vertex_input.attributes[i].offset, offsets[i]);
+        EXPECT_EQ(vertex_input.attributes[i].format_type, formats[i]);
+    }
+}
+
+TEST(ShaderReflectionTest, ForwardShaderStateMergesStages)
+{
+    SKIP_WITHOUT_SHADERS();
+
+    ShaderStateDescriptor shader_state = {};
+    shader_state.add_shader_stage(load_stage("forward.vert.spv", ShaderStageType::VERTEX))
+      .add_shader_stage(load_stage("forward.frag.spv", ShaderStageType::FRAGMENT));
+
+    ShaderReflection reflection;
+    ASSERT_TRUE(reflect_shader_state(shader_state, reflection));
+    ASSERT_EQ(reflection.set_count, 2u);
+
+    // Camera from the vertex stage, clustered lighting and shadows from the fragment stage.
+    const auto& global = reflection.set_layouts[0];
+    ASSERT_EQ(global.binding_count, 7u);
+    EXPECT_EQ(global.bindings[0].shader_stage, ShaderStageType::VERTEX);
+    EXPECT_EQ(global.bindings[1].shader_stage, ShaderStageType::FRAGMENT);
+    EXPECT_EQ(global.bindings[1].descriptor_type, DescriptorType::STORAGE);
+    EXPECT_EQ(global.bindings[4].descriptor_type, DescriptorType::UNIFORM);
+    EXPECT_EQ(global.bindings[5].descriptor_type, DescriptorType::COMBINED_IMAGE_SAMPLER);
+    EXPECT_EQ(global.bindings[6].descriptor_type, DescriptorType::STORAGE);
+
+    const auto& instance = reflection.set_layouts[1];
+    ASSERT_EQ(instance.binding_count, 3u);
+    EXPECT_EQ(instance.bindings[0].descriptor_type, DescriptorType::UNIFORM);
+    EXPECT_EQ(instance.bindings[1].descriptor_type, DescriptorType::COMBINED_IMAGE_SAMPLER);
+    EXPECT_EQ(instance.bindings[2].descriptor_type, DescriptorType::COMBINED_IMAGE_SAMPLER);
+}
+
+TEST(ShaderReflectionTest, SpecKeepsDeclaredStride)
+{
+    SKIP_WITHOUT_SHADERS();
+
+    json j;
+    j["name"]         = "wireframe";
+    j["shaders"]      = {{"vertex", "wireframe.vert.spv"}, {"fragment", "wireframe.frag.spv"}};
+    j["vertex_input"] = {{"streams", {{{"binding", 0}, {"stride", 44}}}}};
+
+    sogas::PipelineSpec spec;
+    ASSERT_TRUE(sogas::parse_pipeline_spec(j, spec));
+    ASSERT_TRUE(sogas::load_pipeline_shaders(spec));
+    ASSERT_TRUE(sogas::reflect_pipeline_spec(spec));
+
+    EXPECT_EQ(spec.vertex_input.streams[0].stride, 44u);
+    EXPECT_EQ(spec.vertex_input.attribute_count, 1u);
+    EXPECT_EQ(spec.set_layouts.size(), 1u);
+    ASSERT_EQ(spec.push_constants.size(), 1u);
+    EXPECT_EQ(spec.push_constants[0].size, 64u);
+}
@@ -0,0 +1,148 @@
+#include "pch.h"
+
+#include <resources/shadow_atlas.h>
+
+using namespace sogas;
+
+static ShadowLight make_spot_light(const glm::vec3& position)
+{
+    ShadowLight light;
+    light.position  = position;
+    light.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+    light.radius    = 10.0f;
+    light.cone      = glm::radians(60.0f);
+    return light;
+}
+
+static ShadowLight make_point_light(const glm::vec3& position)
+{
+    ShadowLight light;
+    light.position = position;
+    light.radius   = 10.0f;
+    return light;
+}
+
+static BoundingSphere make_caster(const glm::vec3& center)
+{
+    BoundingSphere sphere;
+    sphere.center = center;
+    sphere.radius = 1.0f;
+    return sphere;
+}
+
+// 4 tiles per row, 16 tiles in total.
+static ShadowAtlasDescriptor small_atlas = {2048, 512};
+
+TEST(ShadowAtlasTest, SpotShadowMatrix)
+{
+    const auto light  = make_spot_light(glm::vec3(0.0f, 10.0f, 0.0f));
+    const auto matrix = get_spot_shadow_matrix(light);
+
+    // Straight below the light lands in the middle of the tile, deeper as it gets further.
+    const auto near_point = matrix * glm::vec4(0.0f, 5.0f, 0.0f, 1.0f);
+    const auto far_point  = matrix * glm::vec4(0.0f, 1.0f, 0.0f, 1.0f);
+    EXPECT_NEAR(near_point.x / near_point.w, 0.0f, 1e-5f);
+    EXPECT_NEAR(near_point.y / near_point.w, 0.0f, 1e-5f);
+    EXPECT_GT(near_point.z / near_point.w, 0.0f);
+    EXPECT_LT(near_point.z / near_point.w, far_point.z / far_point.w);
+    EXPECT_LT(far_point.z / far_point.w, 1.0f);
+}
+
+TEST(ShadowAtlasTest, PointShadowFaces)
+{
+    const auto light = make_point_light(glm::vec3(0.0f));
+
+    // Each face only sees the points along its own axis.
+    const glm::vec3 points[POINT_SHADOW_FACES] = {{5.0f, 0.0f, 0.0f},
+                                                  {-5.0f, 0.0f, 0.0f},
+                                                  {0.0f, 5.0f, 0.0f},
+                                                  {0.0f, -5.0f, 0.0f},
+                                                  {0.0f, 0.0f, 5.0f},
+                                                  {0.0f, 0.0f, -5.0f}};
+    for (u32 face = 0; face < POINT_SHADOW_FACES; ++face)
+    {
+        const auto matrix = get_point_shadow_matrix(light, face);
+        for (u32 i = 0; i < POINT_SHADOW_FACES; ++i)
+        {
+            const auto clip    = matrix * glm::vec4(points[i], 1.0f);
+            const bool visible = clip.w > 0.0f && std::abs(clip.x) <= clip.w &&
+                                 std::abs(clip.y) <= clip.w && clip.z >= 0.0f && clip.z <= clip.w;
+            EXPECT_EQ(visible, i == face) << "face " << face << " point " << i;
+        }
+    }
+}
+
+TEST(ShadowAtlasTest, AllocateTiles)
+{
+    ShadowAtlas atlas;
+    atlas.init(small_atlas);
+    EXPECT_EQ(atlas.get_views().size(), 16u);
+
+    atlas.begin_frame();
+    EXPECT_EQ(atlas.add_light(1, make_spot_light(glm::vec3(0.0f))), 0);
+    EXPECT_EQ(atlas.add_light(2, make_point_light(glm::vec3(0.0f))), 1);
+    EXPECT_EQ(atlas.add_light(3, make_point_light(glm::vec3(0.0f))), 7);
+    EXPECT_EQ(atlas.add_light(4, make_spot_light(glm::vec3(0.0f))), 13);
+    EXPECT_EQ(atlas.add_light(5, make_point_light(glm::vec3(0.0f))), -1);
+
+    // Adding the same light again keeps its tiles.
+    EXPECT_EQ(atlas.add_light(2, make_point_light(glm::vec3(0.0f))), 1);
+    atlas.end_frame();
+
+    EXPECT_EQ(atlas.get_view_rect(7), glm::uvec4(1536, 512, 512, 512));
+    EXPECT_EQ(atlas.get_views().at(7).atlas_rect, glm::vec4(0.75f, 0.25f, 0.25f, 0.25f));
+
+    // Lights missing from a frame give their tiles back.
+    atlas.begin_frame();
+    atlas.add_light(1, make_spot_light(glm::vec3(0.0f)));
+    atlas.add_light(3, make_point_light(glm::vec3(0.0f)));
+    atlas.end_frame();
+
+    atlas.begin_frame();
+    EXPECT_EQ(atlas.add_light(5, make_point_light(glm::vec3(0.0f))), 1);
+}
+
+TEST(ShadowAtlasTest, CachedUntilChanged)
+{
+    ShadowAtlas atlas;
+    atlas.init(small_atlas);
+
+    const auto spot  = make_spot_light(glm::vec3(0.0f, 10.0f, 0.0f));
+    const auto point = make_point_light(glm::vec3(50.0f, 0.0f, 0.0f));
+
+    atlas.begin_frame();
+    atlas.add_light(1, spot);
+    atlas.add_light(2, point);
+    atlas.end_frame();
+    EXPECT_EQ(atlas.get_dirty_views().size(), 7u);
+    atlas.mark_rendered();
+
+    // Nothing moved.
+    atlas.begin_frame();
+    atlas.add_light(1, spot);
+    atlas.add_light(2, point);
+    atlas.end_frame();
+    EXPECT_TRUE(atlas.get_dirty_views().empty());
+
+    // A caster moving far from both lights changes nothing either.
+    atlas.invalidate(make_caster(glm::vec3(-50.0f, 0.0f, 0.0f)));
+    EXPECT_TRUE(atlas.get_dirty_views().empty());
+
+    // Only the light reached by the caster is rendered again.
+    atlas.invalidate(make_caster(glm::vec3(50.0f, 10.5f, 0.0f)));
+    EXPECT_EQ(atlas.get_dirty_views(), (std::vector<u32>{1, 2, 3, 4, 5, 6}));
+    atlas.mark_rendered();
+
+    // So is a light that moved.
+    auto moved_spot = spot;
+    moved_spot.position.x += 1.0f;
+    atlas.begin_frame();
+    atlas.add_light(1, moved_spot);
+    atlas.add_light(2, point);
+    atlas.end_frame();
+    EXPECT_EQ(atlas.get_dirty_views(), std::vector<u32>{0});
+
+    BoundingSphere bounds = atlas.get_view_bounds(0);
+    EXPECT_EQ(bounds.center, moved_spot.position);
+    EXPECT_EQ(bounds.radius, moved_spot.radius);
+}
@@ -0,0 +1,139 @@
+#include "pch.h"
+
+#include <resources/cooked_texture.h>
+#include <resources/texture_compression.h>
+
+using namespace pinut::resources;
+
+namespace
+{
+void decode_565(u16 color, i32* out_rgb)
+{
+    const i32 r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+    out_rgb[0]  = (r << 3) | (r >> 2);
+    out_rgb[1]  = (g << 2) | (g >> 4);
+    out_rgb[2]  = (b << 3) | (b >> 2);
+}
+
+// Reference decoders, only the four colour and eight value modes the encoder emits.
+void decode_bc1(const u8* block, u8* out_rgb)
+{
+    const u16 color0 = static_cast<u16>(block[0] | (block[1] << 8));
+    const u16 color1 = static_cast<u16>(block[2] | (block[3] << 8));
+    u32       indices;
+    memcpy(&indices, block + 4, sizeof(indices));
+
+    i32 palette[4][3];
+    decode_565(color0, palette[0]);
+    decode_565(color1, palette[1]);
+    for (u32 c = 0; c < 3; ++c)
+    {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    for (u32 i = 0; i < 16; ++i)
+    {
+        const u32 index = (indices >> (i * 2)) & 3;
+        for (u32 c = 0; c < 3; ++c)
+        {
+            out_rgb[i * 3 + c] = static_cast<u8>(palette[index][c]);
+        }
+    }
+}
+
+void decode_bc4(const u8* block, u8* out_values)
+{
+    const i32 value0 = block[0], value1 = block[1];
+    u64       indices = 0;
+    for (u32 i = 0; i < 6; ++i)
+    {
+        indices |= static_cast<u64>(block[2 + i]) << (i * 8);
+    }
+
+    for (u32 i = 0; i < 16; ++i)
+    {
+        const i32 index        = static_cast<i32>((indices >> (i * 3)) & 7);
+        const i32 interpolated = ((8 - index) * value0 + (index - 1) * value1 + 3) / 7;
+        out_values[i] = static_cast<u8>(index == 0 ? value0 : (index == 1 ? value1 : interpolated));
+    }
+}
+} // namespace
+
+TEST(TextureCompressionTest, SolidBlockRoundTrip)
+{
+    u8 block[64];
+    for (u32 i = 0; i < 16; ++i)
+    {
+        block[i * 4 + 0] = 200;
+        block[i * 4 + 1] = 100;
+        block[i * 4 + 2] = 50;
+        block[i * 4 + 3] = 255;
+    }
+
+    u8 encoded[8];
+    encode_bc1_block(block, encoded);
+
+    u8 decoded[48];
+    decode_bc1(encoded, decoded);
+    for (u32 i = 0; i < 16; ++i)
+    {
+        // Within the 565 quantization step.
+        EXPECT_NEAR(decoded[i * 3 + 0], 200, 4);
+        EXPECT_NEAR(decoded[i * 3 + 1], 100, 2);
+        EXPECT_NEAR(decoded[i * 3 + 2], 50, 4);
+    }
+}
+
+TEST(TextureCompressionTest, GradientBlockError)
+{
+    // Opposite trends on red and green need the flipped diagonal.
+    u8 block[64];
+    for (u32 i = 0; i < 16; ++i)
+    {
+        block[i * 4 + 0] = static_cast<u8>(i * 16);
+        block[i * 4 + 1] = static_cast<u8>(255 - i * 16);
+        block[i * 4 + 2] = 128;
+        block[i * 4 + 3] = static_cast<u8>(i * 17);
+    }
+
+    u8 encoded[16];
+    encode_bc3_block(block, encoded);
+
+    u8 alpha[16];
+    u8 color[48];
+    decode_bc4(encoded, alpha);
+    decode_bc1(encoded + 8, color);
+    for (u32 i = 0; i < 16; ++i)
+    {
+        EXPECT_NEAR(alpha[i], block[i * 4 + 3], 19);
+        EXPECT_NEAR(color[i * 3 + 0], block[i * 4 + 0], 48);
+        EXPECT_NEAR(color[i * 3 + 1], block[i * 4 + 1], 48);
+        EXPECT_NEAR(color[i * 3 + 2], block[i * 4 + 2], 4);
+    }
+}
+
+TEST(TextureCompressionTest, ParallelMatchesSerial)
+{
+    const u32       width = 37, height = 21, mip_levels = 3;
+    std::vector<u8> chain(get_mip_chain_size(TextureFormat::R8G8B8A8_UNORM, width, height, 3));
+    for (size_t i = 0; i < chain.size(); ++i)
+    {
+        chain[i] = static_cast<u8>((i * 131 + i / 7) & 0xFF);
+    }
+
+    std::vector<u8> serial, parallel;
+    ASSERT_TRUE(compress_mip_chain(
+      TextureFormat::BC3_UNORM, chain.data(), width, height, mip_levels, serial, 1));
+    ASSERT_TRUE(compress_mip_chain(
+      TextureFormat::BC3_UNORM, chain.data(), width, height, mip_levels, parallel, 4));
+
+    const auto header = make_cooked_texture_header(TextureFormat::BC3_UNORM, width, height, 3);
+    EXPECT_EQ(serial.size(), header.data_size);
+    EXPECT_EQ(serial, parallel);
+
+    std::vector<u8> unsupported;
+    EXPECT_FALSE(is_compression_supported(TextureFormat::BC7_UNORM));
+    EXPECT_FALSE(compress_mip_chain(
+      TextureFormat::BC7_UNORM, chain.data(), width, height, mip_levels, unsupported));
+}
@@ -0,0 +1,169 @@
+#include "pch.h"
+
+#include <chrono>
+#include <thread>
+
+#include <render_device.h>
+#include <resources/cooked_texture.h>
+#include <resources/texture_streamer.h>
+
+using namespace sogas;
+using namespace pinut::resources;
+
+TEST(TextureStreamerTest, ProjectedDiameter)
+{
+    BoundingSphere sphere;
+    sphere.center = glm::vec3(0.0f, 0.0f, -10.0f);
+    sphere.radius = 1.0f;
+
+    // tan(45) = 1, the unit sphere at distance 10 covers a tenth of the view height.
+    const f32 fov = glm::radians(90.0f);
+    EXPECT_NEAR(get_projected_diameter(sphere, glm::vec3(0.0f), fov, 1000.0f), 100.0f, 0.01f);
+
+    sphere.center.z = -20.0f;
+    EXPECT_NEAR(get_projected_diameter(sphere, glm::vec3(0.0f), fov, 1000.0f), 50.0f, 0.01f);
+
+    // Inside the sphere everything is covered.
+    EXPECT_GT(get_projected_diameter(sphere, sphere.center, fov, 1000.0f), 1000.0f);
+}
+
+TEST(TextureStreamerTest, RequestedMip)
+{
+    // 1024 texels over 1024 pixels or more needs the full resolution.
+    EXPECT_EQ(get_requested_mip(1024, 1024, 11, 1024.0f), 0u);
+    EXPECT_EQ(get_requested_mip(1024, 512, 11, 4096.0f), 0u);
+
+    // Every halving of the screen size drops one level, rounding towards the finer one.
+    EXPECT_EQ(get_requested_mip(1024, 1024, 11, 512.0f), 1u);
+    EXPECT_EQ(get_requested_mip(1024, 1024, 11, 300.0f), 1u);
+    EXPECT_EQ(get_requested_mip(1024, 1024, 11, 256.0f), 2u);
+
+    // Clamped to the coarsest level, which is also used for objects off screen.
+    EXPECT_EQ(get_requested_mip(1024, 1024, 11, 0.5f), 10u);
+    EXPECT_EQ(get_requested_mip(1024, 1024, 4, 16.0f), 3u);
+    EXPECT_EQ(get_requested_mip(1024, 1024, 11, 0.0f), 10u);
+}
+
+// 64x64 RGBA8 with 7 levels, levels 3 and coarser are the 340 byte tail. Level 2 and coarser take
+// 1364 bytes, level 1 5460 and the whole chain 21844.
+class TextureStreamerUpdateTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        device = pinut::GPUDevice::create(pinut::GraphicsAPI::Null);
+        ASSERT_NE(device, nullptr);
+        device->init({});
+
+        const auto header = make_cooked_texture_header(TextureFormat::R8G8B8A8_UNORM, 64, 64, 7);
+        const std::vector<u8> data(header.data_size, 0xff);
+        ASSERT_TRUE(write_cooked_texture(filename, header, data.data()));
+    }
+
+    void TearDown() override
+    {
+        streamer.shutdown();
+        device->shutdown();
+        delete device;
+        std::remove(filename.c_str());
+    }
+
+    void init(u64 budget_bytes)
+    {
+        TextureStreamerDescriptor descriptor;
+        descriptor.budget_bytes = budget_bytes;
+        descriptor.tail_size    = 8;
+        streamer.init(device, descriptor);
+    }
+
+    // Loads finish on the worker threads, the requests are repeated every frame until it lands.
+    bool stream(std::initializer_list<std::pair<StreamedTextureId, u32>> requests,
+                StreamedTextureId                                        id,
+                u32                                                      mip)
+    {
+        for (u32 i = 0; i < 1000; ++i)
+        {
+            for (const auto& [request_id, request_mip] : requests)
+            {
+                streamer.request_mip(request_id, request_mip);
+            }
+
+            streamer.update();
+            if (streamer.get_resident_mip(id) == mip)
+            {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        return false;
+    }
+
+    const std::string filename = "texture_streamer_test.ptex";
+    pinut::GPUDevice* device   = nullptr;
+    TextureStreamer   streamer;
+};
+
+TEST_F(TextureStreamerUpdateTest, LoadsStayInBudget)
+{
+    init(2000);
+    const auto first  = streamer.add_texture(filename);
+    const auto second = streamer.add_texture(filename);
+    ASSERT_NE(second, INVALID_ID);
+    EXPECT_EQ(streamer.get_resident_mip(first), 3u);
+    EXPECT_EQ(streamer.get_resident_bytes(), 680u);
+
+    // The full chain of the first one never fits, the second one still loads.
+    ASSERT_TRUE(stream({{first, 0}, {second, 2}}, second, 2));
+    EXPECT_EQ(streamer.get_resident_mip(first), 3u);
+    EXPECT_EQ(streamer.get_resident_bytes(), 1704u);
+}
+
+TEST_F(TextureStreamerUpdateTest, EvictsLeastRecentlyUsed)
+{
+    init(3000);
+    const auto first  = streamer.add_texture(filename);
+    const auto second = streamer.add_texture(filename);
+    ASSERT_TRUE(stream({{first, 2}}, first, 2));
+    ASSERT_TRUE(stream({{second, 2}}, second, 2));
+    EXPECT_EQ(streamer.get_resident_bytes(), 2728u);
+
+    // The tail of a new texture goes over budget, the texture requested longest ago drops first.
+    const auto third = streamer.add_texture(filename);
+    EXPECT_TRUE(streamer.update());
+    EXPECT_EQ(streamer.get_resident_mip(first), 3u);
+    EXPECT_EQ(streamer.get_resident_mip(second), 2u);
+    EXPECT_EQ(streamer.get_resident_mip(third), 3u);
+    EXPECT_EQ(streamer.get_resident_bytes(), 2044u);
+}
+
+TEST_F(TextureStreamerUpdateTest, EvictsEveryLevelAtOnce)
+{
+    init(5500);
+    const auto first = streamer.add_texture(filename);
+    ASSERT_TRUE(stream({{first, 1}}, first, 1));
+
+    // Dropping level 1 alone is not enough, the texture goes straight back to its tail.
+    for (u32 i = 0; i < 16; ++i)
+    {
+        streamer.add_texture(filename);
+    }
+    const auto handle = streamer.get_texture(first);
+    EXPECT_TRUE(streamer.update());
+    EXPECT_EQ(streamer.get_resident_mip(first), 3u);
+    // Texture ids are recycled last in first out, a second upload would get the old one back.
+    EXPECT_NE(streamer.get_texture(first).id, handle.id);
+    EXPECT_EQ(streamer.get_resident_bytes(), 17u * 340u);
+}
+
+TEST_F(TextureStreamerUpdateTest, LargestDeficitLoadsFirst)
+{
+    init(6000);
+    const auto first  = streamer.add_texture(filename);
+    const auto second = streamer.add_texture(filename);
+
+    // Both fit on their own but not together, the second one is further from its request.
+    ASSERT_TRUE(stream({{first, 2}, {second, 1}}, second, 1));
+    EXPECT_EQ(streamer.get_resident_mip(first), 3u);
+    EXPECT_EQ(streamer.get_resident_bytes(), 5800u);
+}
@@ -0,0 +1,91 @@
+#include "pch.h"
+
+#include <resources/cooked_texture.h>
+#include <resources/texture_utils.h>
+
+using namespace pinut::resources;
+
+TEST(TextureUtilsTest, FormatSizes)
+{
+    EXPECT_EQ(get_format_block_size(TextureFormat::R8_UNORM), 1u);
+    EXPECT_EQ(get_format_block_size(TextureFormat::R8G8B8A8_SRGB), 4u);
+    EXPECT_EQ(get_format_block_size(TextureFormat::R16G16_SFLOAT), 4u);
+    EXPECT_EQ(get_format_block_size(TextureFormat::R32G32B32A32_SFLOAT), 16u);
+    EXPECT_EQ(get_format_block_size(TextureFormat::R64_UINT), 8u);
+    EXPECT_EQ(get_format_block_size(TextureFormat::BC1_RGBA_SRGB), 8u);
+    EXPECT_EQ(get_format_block_size(TextureFormat::BC7_UNORM), 16u);
+    EXPECT_TRUE(is_block_compressed(TextureFormat::BC5_UNORM));
+    EXPECT_FALSE(is_block_compressed(TextureFormat::D32_SFLOAT));
+}
+
+TEST(TextureUtilsTest, MipChainSizes)
+{
+    EXPECT_EQ(get_mip_count(1, 1), 1u);
+    EXPECT_EQ(get_mip_count(256, 64), 9u);
+    EXPECT_EQ(get_mip_count(300, 5), 9u);
+
+    // 4x4 + 2x2 + 1x1 texels.
+    EXPECT_EQ(get_mip_chain_size(TextureFormat::R8G8B8A8_UNORM, 4, 4, 3), 84u);
+    // Levels below 4x4 still take a whole block.
+    EXPECT_EQ(get_mip_chain_size(TextureFormat::BC1_RGBA_UNORM, 8, 8, 4), 56u);
+    EXPECT_EQ(get_mip_size(TextureFormat::BC7_SRGB, 5, 5), 64u);
+}
+
+TEST(TextureUtilsTest, BoxFilterMatchesReference)
+{
+    // Odd sizes exercise both the vector loop and the clamped edges.
+    const u32       width = 13, height = 7;
+    std::vector<u8> source(width * height * 4);
+    for (size_t i = 0; i < source.size(); ++i)
+    {
+        source[i] = static_cast<u8>((i * 37 + i / 5) & 0xFF);
+    }
+
+    std::vector<u8> chain;
+    generate_mip_chain_rgba8(source.data(), width, height, get_mip_count(width, height), chain);
+    ASSERT_EQ(chain.size(),
+              get_mip_chain_size(TextureFormat::R8G8B8A8_UNORM, width, height, 4));
+    EXPECT_EQ(memcmp(chain.data(), source.data(), source.size()), 0);
+
+    const u8* level1 = chain.data() + source.size();
+    for (u32 y = 0; y < 3; ++y)
+    {
+        for (u32 x = 0; x < 6; ++x)
+        {
+            for (u32 c = 0; c < 4; ++c)
+            {
+                const auto texel = [&](u32 tx, u32 ty) -> u32 {
+                    const u32 index = std::min(ty, height - 1) * width + std::min(tx, width - 1);
+                    return source[index * 4 + c];
+                };
+                const u32 sum = texel(2 * x, 2 * y) + texel(2 * x + 1, 2 * y) +
+                                texel(2 * x, 2 * y + 1) + texel(2 * x + 1, 2 * y + 1);
+                ASSERT_EQ(level1[(y * 6 + x) * 4 + c], (sum + 2) / 4);
+            }
+        }
+    }
+}
+
+TEST(TextureUtilsTest, CookedTextureRoundTrip)
+{
+    const auto header = make_cooked_texture_header(TextureFormat::BC3_SRGB, 16, 8, 5);
+    EXPECT_EQ(header.level_offsets[1], 128u);
+    EXPECT_EQ(header.data_size, get_mip_chain_size(TextureFormat::BC3_SRGB, 16, 8, 5));
+
+    std::vector<u8> blob(sizeof(CookedTextureHeader) + header.data_size, 0xAB);
+    memcpy(blob.data(), &header, sizeof(header));
+
+    CookedTextureHeader parsed;
+    const u8*           data = nullptr;
+    ASSERT_TRUE(parse_cooked_texture(blob.data(), blob.size(), parsed, data));
+    EXPECT_EQ(data, blob.data() + sizeof(CookedTextureHeader));
+    EXPECT_EQ(parsed.mip_levels, 5u);
+
+    const auto descriptor = get_cooked_texture_descriptor(parsed, data);
+    EXPECT_EQ(descriptor.format, TextureFormat::BC3_SRGB);
+    EXPECT_EQ(descriptor.mip_levels, 5u);
+    EXPECT_FALSE(descriptor.generate_mips);
+
+    // Truncated blobs are rejected.
+    EXPECT_FALSE(parse_cooked_texture(blob.data(), blob.size() - 1, parsed, data));
+}
@@ -1,6 +1,13 @@
-
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
 namespace sogas
 {
 namespace log
@@ -14,15 +21,225 @@ enum class Logger_types
     DEBUG // Grey
 };
 
+// Levels above it are compiled out, their arguments are never evaluated.
+#define SOGAS_LOG_LEVEL_FATAL   0
+#define SOGAS_LOG_LEVEL_ERROR   1
+#define SOGAS_LOG_LEVEL_WARNING 2
+#define SOGAS_LOG_LEVEL_INFO    3
+#define SOGAS_LOG_LEVEL_DEBUG   4
+
+#ifndef SOGAS_LOG_LEVEL
+#ifdef NDEBUG
+#define SOGAS_LOG_LEVEL SOGAS_LOG_LEVEL_INFO
+#else
+#define SOGAS_LOG_LEVEL SOGAS_LOG_LEVEL_DEBUG
+#endif
+#endif
+
+// Areas that can be filtered at runtime.
+enum class Log_category
+{
+    GENERAL,
+    RENDER,
+    RESOURCES,
+    ENTITIES,
+    MEMORY,
+    COUNT
+};
+
 constexpr auto char_buffer_size = 1024 * 4;
 
-void output(sogas::log::Logger_types type, const char* message, ...);
+// Receives every formatted line, "[TYPE]: message\n". Called from the writer thread once the
+// logger runs, one line at a time.
+struct LogSink
+{
+    virtual ~LogSink() = default;
+
+    virtual void write(Logger_types type, const char* text, std::uint32_t length) = 0;
+    virtual void flush(){};
+};
+
+struct ConsoleSink : public LogSink
+{
+    void write(Logger_types type, const char* text, std::uint32_t length) override;
+    void flush() override;
+};
+
+struct FileSink : public LogSink
+{
+    FileSink(const char* filename);
+    ~FileSink();
+
+    void write(Logger_types type, const char* text, std::uint32_t length) override;
+    void flush() override;
+
+    std::FILE* file = nullptr;
+};
+
+// Starts the writer thread. Before init and after shutdown lines are formatted and written on
+// the calling thread.
+void init();
+// Writes everything still queued and stops the writer thread.
+void shutdown();
+// Blocks until every line logged before the call reached the sinks.
+void flush();
+
+// There is always a console sink.
+void add_sink(std::unique_ptr<LogSink> sink);
+void remove_sink(LogSink* sink);
+
+// One bit per Logger_types, every level is enabled by default.
+void set_category_mask(Log_category category, std::uint32_t mask);
+// Enables the given level and every more severe one.
+void set_category_level(Log_category category, Logger_types level);
+
+namespace detail
+{
+constexpr std::uint32_t record_size  = 256;
+constexpr std::uint32_t payload_size = record_size - 2 * sizeof(std::uint64_t);
+
+enum class ArgumentType : std::uint8_t
+{
+    SIGNED,
+    UNSIGNED,
+    FLOAT,
+    POINTER,
+    STRING
+};
+
+// A log call before formatting. The format string is only referenced, so it must be a literal.
+// Arguments are packed one after the other, each behind its type. Strings are copied with a
+// 16 bit length and truncated when the record is full.
+struct Record
+{
+    const char*   format;
+    Logger_types  type;
+    std::uint16_t size;
+    std::uint8_t  payload[payload_size];
+};
+static_assert(sizeof(Record) <= record_size);
+
+extern std::atomic<std::uint32_t> category_masks[static_cast<std::uint32_t>(Log_category::COUNT)];
+
+// Claims a slot in the queue, or a thread local record when the writer thread is not running.
+Record* begin_record(Logger_types type, const char* format);
+// Publishes the record to the writer thread, or writes it right away.
+void    end_record(Record* record);
+
+inline void encode_value(Record* record, ArgumentType type, const void* value, std::uint32_t size)
+{
+    if (record->size + 1 + size > payload_size)
+    {
+        return;
+    }
+
+    record->payload[record->size] = static_cast<std::uint8_t>(type);
+    std::memcpy(record->payload + record->size + 1, value, size);
+    record->size += static_cast<std::uint16_t>(1 + size);
+}
+
+inline void encode_string(Record* record, const char* value)
+{
+    if (value == nullptr)
+    {
+        value = "(null)";
+    }
+
+    const std::uint32_t header_size = 1 + sizeof(std::uint16_t);
+    if (record->size + header_size > payload_size)
+    {
+        return;
+    }
+
+    const std::uint32_t available = payload_size - record->size - header_size;
+    const std::uint16_t length =
+      static_cast<std::uint16_t>(std::min<std::size_t>(std::strlen(value), available));
+
+    record->payload[record->size] = static_cast<std::uint8_t>(ArgumentType::STRING);
+    std::memcpy(record->payload + record->size + 1, &length, sizeof(length));
+    std::memcpy(record->payload + record->size + header_size, value, length);
+    record->size += static_cast<std::uint16_t>(header_size + length);
+}
+
+template <typename T>
+void encode(Record* record, T value)
+{
+    if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>)
+    {
+        encode_string(record, value);
+    }
+    else if constexpr (std::is_enum_v<T>)
+    {
+        encode(record, static_cast<std::underlying_type_t<T>>(value));
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+        const double converted = value;
+        encode_value(record, ArgumentType::FLOAT, &converted, sizeof(converted));
+    }
+    else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+    {
+        const std::int64_t converted = value;
+        encode_value(record, ArgumentType::SIGNED, &converted, sizeof(converted));
+    }
+    else if constexpr (std::is_integral_v<T>)
+    {
+        const std::uint64_t converted = value;
+        encode_value(record, ArgumentType::UNSIGNED, &converted, sizeof(converted));
+    }
+    else if constexpr (std::is_pointer_v<T>)
+    {
+        const void* converted = value;
+        encode_value(record, ArgumentType::POINTER, &converted, sizeof(converted));
+    }
+    else
+    {
+        static_assert(std::is_pointer_v<T>, "Unsupported log argument type.");
+    }
+}
+} // namespace detail
+
+inline bool is_enabled(Log_category category, Logger_types type)
+{
+    const auto mask = detail::category_masks[static_cast<std::uint32_t>(category)].load(
+      std::memory_order_relaxed);
+    return (mask & (1u << static_cast<std::uint32_t>(type))) != 0;
+}
+
+// printf style. Arguments are copied into a record at the call, formatting and writing happen
+// later on the writer thread.
+template <typename... Args>
+void output(Logger_types type, const char* message, Args... args)
+{
+    auto record = detail::begin_record(type, message);
+    (detail::encode(record, args), ...);
+    detail::end_record(record);
+
+    if (type == Logger_types::FATAL)
+    {
+        flush();
+    }
+}
+
+// Arguments are only evaluated once the level and category are known to be enabled.
+#define PLOG(level, category, message, ...)                                                       \
+    do                                                                                            \
+    {                                                                                             \
+        if constexpr (static_cast<int>(sogas::log::Logger_types::level) <= SOGAS_LOG_LEVEL)       \
+        {                                                                                         \
+            if (sogas::log::is_enabled(sogas::log::Log_category::category,                       \
+                                       sogas::log::Logger_types::level))                          \
+            {                                                                                     \
+                sogas::log::output(sogas::log::Logger_types::level, message, ##__VA_ARGS__);      \
+            }                                                                                     \
+        }                                                                                         \
+    } while (0)
 
-#define PFATAL(message, ...) output(sogas::log::Logger_types::FATAL, message, ##__VA_ARGS__);
-#define PERROR(message, ...) output(sogas::log::Logger_types::ERROR, message, ##__VA_ARGS__);
-#define PWARN(message, ...) output(sogas::log::Logger_types::WARNING, message, ##__VA_ARGS__);
-#define PINFO(message, ...) output(sogas::log::Logger_types::INFO, message, ##__VA_ARGS__);
-#define PDEBUG(message, ...) output(sogas::log::Logger_types::DEBUG, message, ##__VA_ARGS__);
+#define PFATAL(message, ...) PLOG(FATAL, GENERAL, message, ##__VA_ARGS__)
+#define PERROR(message, ...) PLOG(ERROR, GENERAL, message, ##__VA_ARGS__)
+#define PWARN(message, ...) PLOG(WARNING, GENERAL, message, ##__VA_ARGS__)
+#define PINFO(message, ...) PLOG(INFO, GENERAL, message, ##__VA_ARGS__)
+#define PDEBUG(message, ...) PLOG(DEBUG, GENERAL, message, ##__VA_ARGS__)
 
 } // namespace log
 } // namespace sogas
@@ -0,0 +1,36 @@
+#pragma once
+
+namespace sogas
+{
+// Subsystems memory is accounted to. Keep get_memory_tag_name in sync.
+enum class MemoryTag : u8
+{
+    ENGINE, // Engine wide allocators.
+    ENTITIES,
+    COMPONENTS,
+    MESHES, // Cpu side vertex and index data.
+    GPU_RESOURCES, // Resource pools holding the device objects.
+    GPU_MEMORY, // Device memory behind buffers and textures.
+    LOGGER,
+    COUNT
+};
+
+struct MemoryStats
+{
+    u64 current     = 0;
+    u64 peak        = 0;
+    u64 allocations = 0; // Live allocations.
+    u64 budget      = 0; // Zero when the tag has no budget.
+};
+
+// Only counts, memory is still allocated by the caller. Safe to call from any thread.
+void track_allocation(MemoryTag tag, u64 size);
+void track_deallocation(MemoryTag tag, u64 size);
+
+// Warns once every time the tag goes over budget. Zero removes the budget.
+void set_memory_budget(MemoryTag tag, u64 budget);
+
+MemoryStats get_memory_stats(MemoryTag tag);
+void        reset_memory_peak(MemoryTag tag);
+const char* get_memory_tag_name(MemoryTag tag);
+} // namespace sogas
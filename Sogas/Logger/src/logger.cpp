@@ -1,85 +1,513 @@
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include <defines.h>
 #include <logger.h>
+#include <memory_tracker.h>
 
 namespace sogas
 {
 namespace log
 {
+using detail::ArgumentType;
+using detail::Record;
+
+// Power of two, producers wait for the writer thread when every slot is taken.
+static constexpr u64 queue_capacity = 4096;
 
-static i32 string_format(char* dest, const char* format, va_list va_args)
+// Bounded multi producer queue, each slot has a sequence telling whether it is free to write
+// (sequence == position) or ready to read (sequence == position + 1). Producers only race on
+// the enqueue position, the single writer thread owns the dequeue position.
+struct LogQueue
 {
-    if (dest != nullptr)
+    LogQueue()
     {
-        char       buffer[char_buffer_size];
-        const auto number_written =
-          _vsnprintf_s(buffer, sizeof(buffer), (size_t)char_buffer_size, format, va_args);
-        memcpy(dest, buffer, static_cast<u64>(number_written) + 1);
-        return number_written;
+        sinks.push_back(std::make_unique<ConsoleSink>());
     }
 
-    return -1;
+    Record*                               records   = nullptr;
+    std::atomic<u64>*                     sequences = nullptr;
+    std::atomic<u64>                      enqueue_position{0};
+    std::atomic<u64>                      dequeue_position{0};
+    std::atomic<bool>                     is_accepting{false}; // Producers use the queue.
+    std::atomic<bool>                     is_writing{false}; // The writer thread keeps polling.
+    std::thread                           writer;
+    std::mutex                            sinks_mutex;
+    std::vector<std::unique_ptr<LogSink>> sinks;
+};
+
+static LogQueue& get_queue()
+{
+    static LogQueue queue;
+    return queue;
+}
+
+static const char* level_type_strings[] = {
+  "[FATAL]: ", "[ERROR]: ", "[WARN]: ", "[INFO]: ", "[DEBUG]: "};
+
+// Copies text to the line, always leaving room for the trailing new line.
+static void append(char* line, u32& length, const u32 capacity, const char* text, u32 size)
+{
+    size = std::min(size, capacity - 1 - length);
+    memcpy(line + length, text, size);
+    length += size;
 }
 
-static i32 string_format(char* dest, const char* format, ...)
+// Reads the next packed argument, false once there are no more.
+static bool read_argument(const Record& record, u32& offset, ArgumentType& type, u64& value,
+                          const char*& text, u16& text_length)
 {
-    if (dest != nullptr)
+    if (offset >= record.size)
     {
-        va_list argptr;
-        va_start(argptr, format);
-        const auto number_written = string_format(dest, format, argptr);
-        va_end(argptr);
-        return number_written;
+        return false;
     }
 
-    return -1;
+    type = static_cast<ArgumentType>(record.payload[offset++]);
+    if (type == ArgumentType::STRING)
+    {
+        memcpy(&text_length, record.payload + offset, sizeof(text_length));
+        text = reinterpret_cast<const char*>(record.payload + offset + sizeof(text_length));
+        offset += sizeof(text_length) + text_length;
+    }
+    else
+    {
+        memcpy(&value, record.payload + offset, sizeof(value));
+        offset += sizeof(value);
+    }
+    return true;
 }
 
-void output(Logger_types type, const char* message, ...)
+// printf formatting, one conversion at a time. Arguments were widened when packed, so length
+// modifiers are replaced to match what was stored.
+static u32 format_record(const Record& record, char* line, const u32 capacity)
 {
-    // TODO: This is only supported in windows right now.
-    // Writing to console should be handled by platform specific code. See platform folder.
+    u32 length = 0;
 
-    // TODO: Add the log type at the beginning of the sentence. Eg. [ERROR] ...
+    const char* prefix = level_type_strings[static_cast<u32>(record.type)];
+    append(line, length, capacity, prefix, static_cast<u32>(strlen(prefix)));
 
-    // Windows only code ...
-    auto handle = GetStdHandle(STD_OUTPUT_HANDLE);
+    u32         offset = 0;
+    const char* cursor = record.format;
+    while (*cursor)
+    {
+        if (*cursor != '%')
+        {
+            const char* next = strchr(cursor, '%');
+            const u32   size = static_cast<u32>(next ? next - cursor : strlen(cursor));
+            append(line, length, capacity, cursor, size);
+            cursor += size;
+            continue;
+        }
+
+        if (cursor[1] == '%')
+        {
+            append(line, length, capacity, "%", 1);
+            cursor += 2;
+            continue;
+        }
+
+        // Flags, width and precision are kept as written.
+        const char* start = cursor++;
+        while (*cursor && strchr("-+ #0123456789.", *cursor))
+        {
+            ++cursor;
+        }
+        while (*cursor && strchr("hljztL", *cursor))
+        {
+            ++cursor;
+        }
+        const char conversion = *cursor;
+        if (conversion == '\0')
+        {
+            break;
+        }
+        ++cursor;
+
+        char spec[32];
+        u32  spec_length = 0;
+        for (const char* c = start; c < cursor - 1 && spec_length < sizeof(spec) - 5; ++c)
+        {
+            if (!strchr("hljztL", *c))
+            {
+                spec[spec_length++] = *c;
+            }
+        }
+
+        ArgumentType type;
+        u64          value       = 0;
+        const char*  text        = nullptr;
+        u16          text_length = 0;
+        if (!read_argument(record, offset, type, value, text, text_length))
+        {
+            append(line, length, capacity, start, static_cast<u32>(cursor - start));
+            continue;
+        }
+
+        // Enough for any number or string in a record.
+        char number[detail::payload_size + 16];
+        i32  written = 0;
+        switch (conversion)
+        {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            case 'c':
+            {
+                if (conversion != 'c')
+                {
+                    spec[spec_length++] = 'l';
+                    spec[spec_length++] = 'l';
+                }
+                spec[spec_length++] = conversion;
+                spec[spec_length]   = '\0';
+
+                f64 real;
+                memcpy(&real, &value, sizeof(real));
+                const i64 integer = type == ArgumentType::FLOAT ? static_cast<i64>(real) :
+                                                                  static_cast<i64>(value);
+                written = conversion == 'c' ?
+                            snprintf(number, sizeof(number), spec, static_cast<i32>(integer)) :
+                            snprintf(number, sizeof(number), spec, static_cast<long long>(integer));
+                break;
+            }
+            case 's':
+            {
+                if (type != ArgumentType::STRING)
+                {
+                    continue;
+                }
+
+                // Without width or precision there is nothing to format.
+                if (spec_length == 1)
+                {
+                    append(line, length, capacity, text, text_length);
+                    continue;
+                }
+
+                char string[detail::payload_size + 1];
+                memcpy(string, text, text_length);
+                string[text_length] = '\0';
+
+                spec[spec_length++] = conversion;
+                spec[spec_length]   = '\0';
+                written             = snprintf(number, sizeof(number), spec, string);
+                break;
+            }
+            case 'p':
+            {
+                spec[spec_length++] = conversion;
+                spec[spec_length]   = '\0';
+
+                const void* pointer = nullptr;
+                memcpy(&pointer, &value, sizeof(pointer));
+                written = snprintf(number, sizeof(number), spec, pointer);
+                break;
+            }
+            default:
+            {
+                spec[spec_length++] = conversion;
+                spec[spec_length]   = '\0';
+
+                f64 real;
+                memcpy(&real, &value, sizeof(real));
+                if (type == ArgumentType::SIGNED)
+                {
+                    real = static_cast<f64>(static_cast<i64>(value));
+                }
+                else if (type == ArgumentType::UNSIGNED)
+                {
+                    real = static_cast<f64>(value);
+                }
+                written = snprintf(number, sizeof(number), spec, real);
+                break;
+            }
+        }
+
+        if (written > 0)
+        {
+            const u32 size =
+              std::min(static_cast<u32>(written), static_cast<u32>(sizeof(number) - 1));
+            append(line, length, capacity, number, size);
+        }
+    }
+
+    line[length++] = '\n';
+    return length;
+}
+
+static void write_record(LogQueue& queue, const Record& record)
+{
+    char      line[char_buffer_size];
+    const u32 length = format_record(record, line, sizeof(line));
+
+    std::lock_guard lock(queue.sinks_mutex);
+    for (auto& sink : queue.sinks)
+    {
+        sink->write(record.type, line, length);
+    }
+}
+
+static void flush_sinks(LogQueue& queue)
+{
+    std::lock_guard lock(queue.sinks_mutex);
+    for (auto& sink : queue.sinks)
+    {
+        sink->flush();
+    }
+}
+
+// Writes every record already published, returns how many.
+static u64 drain_queue(LogQueue& queue)
+{
+    u64 count    = 0;
+    u64 position = queue.dequeue_position.load(std::memory_order_relaxed);
+    while (true)
+    {
+        const u64 index = position & (queue_capacity - 1);
+        if (queue.sequences[index].load(std::memory_order_acquire) != position + 1)
+        {
+            break;
+        }
+
+        write_record(queue, queue.records[index]);
+
+        queue.sequences[index].store(position + queue_capacity, std::memory_order_release);
+        queue.dequeue_position.store(++position, std::memory_order_release);
+        ++count;
+    }
+    return count;
+}
+
+static void writer_thread(LogQueue& queue)
+{
+    while (queue.is_writing.load(std::memory_order_acquire))
+    {
+        if (drain_queue(queue) == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    }
+    drain_queue(queue);
+    flush_sinks(queue);
+}
+
+namespace detail
+{
+std::atomic<u32> category_masks[static_cast<u32>(Log_category::COUNT)] = {
+  0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF};
+
+static thread_local Record immediate_record;
+
+Record* begin_record(Logger_types type, const char* format)
+{
+    auto& queue = get_queue();
+
+    Record* record = &immediate_record;
+    if (queue.is_accepting.load(std::memory_order_acquire))
+    {
+        u64 position = queue.enqueue_position.load(std::memory_order_relaxed);
+        while (true)
+        {
+            const u64 index    = position & (queue_capacity - 1);
+            const u64 sequence = queue.sequences[index].load(std::memory_order_acquire);
+            const i64 distance = static_cast<i64>(sequence - position);
+
+            if (distance == 0)
+            {
+                if (queue.enqueue_position.compare_exchange_weak(
+                      position, position + 1, std::memory_order_relaxed))
+                {
+                    record = &queue.records[index];
+                    break;
+                }
+            }
+            else if (distance < 0)
+            {
+                // Full, wait for the writer thread to catch up.
+                std::this_thread::yield();
+                position = queue.enqueue_position.load(std::memory_order_relaxed);
+            }
+            else
+            {
+                position = queue.enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+    }
 
-    // FATAL, ERROR, WARNING, INFO, DEBUG, TRACE
-    static u8   reset_color = 7;
-    static u8   levels[6]   = {64, 4, 6, 2, reset_color, 8};
-    const char* level_type_strings[6] =
-      {"[FATAL]: ", "[ERROR]: ", "[WARN]: ", "[INFO]: ", "[DEBUG]: ", "[TRACE]: "};
+    record->format = format;
+    record->type   = type;
+    record->size   = 0;
+    return record;
+}
+
+void end_record(Record* record)
+{
+    auto& queue = get_queue();
 
-    auto level_index = static_cast<u8>(type);
+    if (record == &immediate_record)
+    {
+        write_record(queue, *record);
+        return;
+    }
 
-    char* buffer = (char*)malloc(char_buffer_size);
+    const u64 index    = static_cast<u64>(record - queue.records);
+    const u64 sequence = queue.sequences[index].load(std::memory_order_relaxed);
+    queue.sequences[index].store(sequence + 1, std::memory_order_release);
+}
+} // namespace detail
 
-    if (!buffer)
+void init()
+{
+    auto& queue = get_queue();
+    if (queue.is_writing.load())
+    {
         return;
+    }
 
-    memset(buffer, 0, char_buffer_size);
+    // Value initialized so the pages are touched here and not by the first lines logged.
+    queue.records   = new Record[queue_capacity]();
+    queue.sequences = new std::atomic<u64>[queue_capacity];
+    for (u64 i = 0; i < queue_capacity; ++i)
+    {
+        queue.sequences[i].store(i, std::memory_order_relaxed);
+    }
+    queue.enqueue_position.store(0);
+    queue.dequeue_position.store(0);
+    track_allocation(MemoryTag::LOGGER, queue_capacity * (sizeof(Record) + sizeof(u64)));
 
-    va_list argptr;
-    va_start(argptr, message);
-    const auto length = string_format(buffer, message, argptr);
-    UNUSED(length); // TODO Check if that can be removed in release build.
-    va_end(argptr);
+    queue.is_writing.store(true, std::memory_order_release);
+    queue.writer = std::thread(writer_thread, std::ref(queue));
+    queue.is_accepting.store(true, std::memory_order_release);
+}
 
-    ASSERT(length >= 0); // In case we want to print an empty line.
+void shutdown()
+{
+    auto& queue = get_queue();
+    if (!queue.is_writing.load())
+    {
+        return;
+    }
 
-    char       whole_content[char_buffer_size];
-    const auto number_written =
-      string_format(whole_content, "%s%s\n", level_type_strings[level_index], buffer);
+    // New lines are written on the calling thread from now on. Other threads are expected to be
+    // done logging, records they already claimed are still waited for.
+    queue.is_accepting.store(false, std::memory_order_release);
+    while (queue.dequeue_position.load() < queue.enqueue_position.load())
+    {
+        std::this_thread::yield();
+    }
 
-    ASSERT(number_written > 0);
+    queue.is_writing.store(false, std::memory_order_release);
+    queue.writer.join();
 
-    free(buffer);
+    delete[] queue.records;
+    delete[] queue.sequences;
+    queue.records   = nullptr;
+    queue.sequences = nullptr;
+    track_deallocation(MemoryTag::LOGGER, queue_capacity * (sizeof(Record) + sizeof(u64)));
+}
 
-    SetConsoleTextAttribute(handle, levels[level_index]);
-    WriteConsoleA(handle, &whole_content, number_written, nullptr, 0);
+void flush()
+{
+    auto& queue = get_queue();
+    if (queue.is_accepting.load(std::memory_order_acquire))
+    {
+        const u64 claimed = queue.enqueue_position.load();
+        while (queue.dequeue_position.load(std::memory_order_acquire) < claimed)
+        {
+            std::this_thread::yield();
+        }
+    }
+    flush_sinks(queue);
+}
+
+void add_sink(std::unique_ptr<LogSink> sink)
+{
+    auto&           queue = get_queue();
+    std::lock_guard lock(queue.sinks_mutex);
+    queue.sinks.push_back(std::move(sink));
+}
+
+void remove_sink(LogSink* sink)
+{
+    auto&           queue = get_queue();
+    std::lock_guard lock(queue.sinks_mutex);
+    std::erase_if(queue.sinks, [sink](const auto& item) { return item.get() == sink; });
+}
+
+void set_category_mask(Log_category category, u32 mask)
+{
+    detail::category_masks[static_cast<u32>(category)].store(mask, std::memory_order_relaxed);
+}
+
+void set_category_level(Log_category category, Logger_types level)
+{
+    // Levels are ordered from the most severe.
+    set_category_mask(category, (2u << static_cast<u32>(level)) - 1);
+}
+
+void ConsoleSink::write(Logger_types type, const char* text, u32 length)
+{
+#ifdef _WIN64
+    // FATAL, ERROR, WARNING, INFO, DEBUG
+    static u8 reset_color = 7;
+    static u8 levels[5]   = {64, 4, 6, 2, reset_color};
+
+    auto handle = GetStdHandle(STD_OUTPUT_HANDLE);
+    SetConsoleTextAttribute(handle, levels[static_cast<u8>(type)]);
+    WriteConsoleA(handle, text, length, nullptr, 0);
 
     // Reset to default colour.
     SetConsoleTextAttribute(handle, reset_color);
+#else
+    UNUSED(type);
+    fwrite(text, 1, length, stdout);
+#endif
+}
+
+void ConsoleSink::flush()
+{
+#ifndef _WIN64
+    fflush(stdout);
+#endif
+}
+
+FileSink::FileSink(const char* filename)
+{
+#ifdef _WIN64
+    fopen_s(&file, filename, "w");
+#else
+    file = fopen(filename, "w");
+#endif
+}
+
+FileSink::~FileSink()
+{
+    if (file)
+    {
+        fclose(file);
+    }
+}
+
+void FileSink::write(Logger_types /*type*/, const char* text, u32 length)
+{
+    if (file)
+    {
+        fwrite(text, 1, length, file);
+    }
+}
+
+void FileSink::flush()
+{
+    if (file)
+    {
+        fflush(file);
+    }
 }
 } // namespace log
 } // namespace sogas
@@ -0,0 +1,98 @@
+#include <atomic>
+
+#include <defines.h>
+#include <logger.h>
+#include <memory_tracker.h>
+
+namespace sogas
+{
+struct TagCounters
+{
+    std::atomic<u64> current     = 0;
+    std::atomic<u64> peak        = 0;
+    std::atomic<u64> allocations = 0;
+    std::atomic<u64> budget      = 0;
+};
+
+static TagCounters counters[static_cast<u32>(MemoryTag::COUNT)];
+
+static void warn_over_budget(MemoryTag tag, u64 current, u64 budget)
+{
+    PLOG(WARNING,
+         MEMORY,
+         "Memory budget of %s exceeded, %llu of %llu bytes.",
+         get_memory_tag_name(tag),
+         current,
+         budget);
+}
+
+void track_allocation(MemoryTag tag, u64 size)
+{
+    auto& tag_counters = counters[static_cast<u32>(tag)];
+
+    const u64 current = tag_counters.current.fetch_add(size) + size;
+    tag_counters.allocations.fetch_add(1);
+
+    u64 peak = tag_counters.peak.load();
+    while (current > peak && !tag_counters.peak.compare_exchange_weak(peak, current))
+    {
+    }
+
+    // Only when crossing the budget, not on every allocation past it.
+    const u64 budget = tag_counters.budget.load();
+    if (budget > 0 && current > budget && current - size <= budget)
+    {
+        warn_over_budget(tag, current, budget);
+    }
+}
+
+void track_deallocation(MemoryTag tag, u64 size)
+{
+    auto& tag_counters = counters[static_cast<u32>(tag)];
+
+    ASSERT(tag_counters.current.load() >= size);
+    ASSERT(tag_counters.allocations.load() > 0);
+
+    tag_counters.current.fetch_sub(size);
+    tag_counters.allocations.fetch_sub(1);
+}
+
+void set_memory_budget(MemoryTag tag, u64 budget)
+{
+    auto& tag_counters = counters[static_cast<u32>(tag)];
+    tag_counters.budget.store(budget);
+
+    const u64 current = tag_counters.current.load();
+    if (budget > 0 && current > budget)
+    {
+        warn_over_budget(tag, current, budget);
+    }
+}
+
+MemoryStats get_memory_stats(MemoryTag tag)
+{
+    const auto& tag_counters = counters[static_cast<u32>(tag)];
+
+    MemoryStats stats;
+    stats.current     = tag_counters.current.load();
+    stats.peak        = tag_counters.peak.load();
+    stats.allocations = tag_counters.allocations.load();
+    stats.budget      = tag_counters.budget.load();
+    return stats;
+}
+
+void reset_memory_peak(MemoryTag tag)
+{
+    auto& tag_counters = counters[static_cast<u32>(tag)];
+    tag_counters.peak.store(tag_counters.current.load());
+}
+
+const char* get_memory_tag_name(MemoryTag tag)
+{
+    static const char* names[] = {
+      "engine", "entities", "components", "meshes", "gpu_resources", "gpu_memory", "logger"};
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<u32>(MemoryTag::COUNT));
+
+    return names[static_cast<u32>(tag)];
+}
+} // namespace sogas
@@ -0,0 +1,280 @@
+#pragma once
+
+#include <render_device.h>
+#include <resources/commandbuffer.h>
+#include <resources/renderpass.h>
+#include <resources/resource_pool.h>
+#include <resources/resources.h>
+
+namespace pinut
+{
+namespace null
+{
+enum class NullCommandType : u8
+{
+    BIND_PASS,
+    END_PASS,
+    BIND_PIPELINE,
+    SET_VIEWPORT,
+    SET_SCISSORS,
+    PUSH_CONSTANT,
+    CLEAR,
+    CLEAR_DEPTH,
+    DRAW,
+    DRAW_INDEXED,
+    BIND_DESCRIPTOR_SET,
+    BIND_VERTEX_BUFFER,
+    BIND_INDEX_BUFFER,
+    BEGIN_GPU_ZONE,
+    END_GPU_ZONE,
+    COUNT
+};
+
+// Arguments in the order the command buffer call takes them. Pass and pipeline names are kept as
+// their 64 bit hash over the first two arguments, push constants as the offset of their data in
+// the command buffer and their size.
+struct NullCommand
+{
+    NullCommandType type;
+    u32             args[5];
+};
+
+// Records the commands instead of executing them, so the CPU side of rendering can be measured
+// and tested without a GPU.
+class NullCommandBuffer : public resources::CommandBuffer
+{
+  public:
+    void bind_pass(std::string pass) override;
+    void end_pass() override;
+    void bind_pipeline(std::string pipeline) override;
+
+    void set_viewport(const resources::Viewport* viewport) override;
+    void set_scissors(const resources::Rect* scissors) override;
+
+    void set_push_constant(resources::ShaderStageType stage,
+                           u32                        size,
+                           u32                        offset,
+                           void*                      data) override;
+
+    void clear(f32 red, f32 green, f32 blue, f32 alpha) override;
+    void clear_depth(const resources::Rect& rect) override;
+
+    void draw(u32 first_vertex, u32 vertex_count, u32 first_instance, u32 instance_count) override;
+    void draw_indexed(u32 first_index,
+                      u32 index_count,
+                      u32 first_instance,
+                      u32 instance_count,
+                      u32 vertex_offset) override;
+
+    void bind_descriptor_set(const resources::DescriptorSetHandle& handle, u32 set = 0) override;
+
+    void bind_vertex_buffer(const resources::BufferHandle& handle,
+                            const u32                      binding,
+                            const u32                      offset) override;
+    void bind_index_buffer(const resources::BufferHandle& handle,
+                           resources::BufferIndexType     index_type) override;
+
+    void begin_gpu_zone(const char* name) override;
+    void end_gpu_zone() override;
+
+    // Drops the commands, keeping their memory for the next frame.
+    void reset();
+
+    u32 get_command_count(NullCommandType type) const
+    {
+        return command_counts[static_cast<u32>(type)];
+    }
+
+    std::vector<NullCommand> commands;
+    std::vector<u8>          push_constant_data;
+
+  private:
+    void record(NullCommandType type,
+                u32             arg0 = 0,
+                u32             arg1 = 0,
+                u32             arg2 = 0,
+                u32             arg3 = 0,
+                u32             arg4 = 0);
+
+    u32  command_counts[static_cast<u32>(NullCommandType::COUNT)] = {};
+    bool pass_in_progress                                        = false;
+};
+
+struct NullBuffer
+{
+    u8*                   data;
+    u32                   size;
+    resources::BufferType type;
+};
+
+struct NullTexture
+{
+    u16                      width;
+    u16                      height;
+    u16                      depth;
+    u8                       mip_levels;
+    resources::TextureFormat format;
+    bool                     render_target;
+};
+
+struct NullRenderPass
+{
+    resources::RenderPassType type;
+    // Formats and operations of the attachments, passes with the same one share a render pass
+    // object on the other devices.
+    u64  layout;
+    u16  width;
+    u16  height;
+    u32  color_attachment_count;
+    bool has_depth;
+    // Framebuffer of an offscreen pass, created once with it.
+    resources::TextureHandle attachments[resources::MAX_COLOR_ATTACHMENTS + 1];
+};
+
+struct NullDescriptorSet
+{
+    resources::DescriptorSetKey key;
+    u64                         hash;
+    u32                         reference_count;
+    bool                        transient;
+};
+
+struct NullDescriptorSetLayout
+{
+    resources::DescriptorSetBindingDescriptor bindings[16];
+    u32                                       binding_count;
+    u32                                       reference_count;
+};
+
+// Device without any graphics API behind it. Resources only keep their description, buffers keep
+// their data in system memory so uploads and mapped writes still round trip. Nothing is ever in
+// flight, destruction is always immediate.
+class NullDevice : public GPUDevice
+{
+  public:
+    NullDevice() = default;
+    ~NullDevice() override;
+
+    void init(const DeviceDescriptor& descriptor) override;
+    void shutdown() override;
+    void resize(u32 width, u32 height) override;
+
+    resources::BufferHandle  create_buffer(const resources::BufferDescriptor& descriptor) override;
+    resources::TextureHandle create_texture(
+      const resources::TextureDescriptor& descriptor) override;
+    resources::RenderPassHandle create_renderpass(
+      const resources::RenderPassDescriptor& descriptor) override;
+    resources::DescriptorSetLayoutHandle create_descriptor_set_layout(
+      const resources::DescriptorSetLayoutDescriptor& descriptor) override;
+    resources::DescriptorSetHandle create_descriptor_set(
+      const resources::DescriptorSetDescriptor& descriptor) override;
+
+    void create_pipeline(const resources::PipelineDescriptor& descriptor) override;
+    void create_pipelines(std::span<const resources::PipelineDescriptor> descriptors) override;
+
+    void begin_frame() override;
+    void end_frame() override;
+    // Cycles like on a device with frames in flight, although none ever is.
+    u32  get_frame_index() const override;
+
+    bool                                 is_bindless_supported() const override;
+    resources::DescriptorSetLayoutHandle get_bindless_set_layout() const override;
+    resources::DescriptorSetHandle       get_bindless_set() const override;
+
+    resources::CommandBuffer* get_command_buffer(bool begin) override;
+
+    // Always empty, there are no timestamps to read.
+    const std::vector<resources::GPUZone>& get_gpu_zones() const override;
+
+    void* map_buffer(const resources::BufferHandle buffer_id,
+                     const u32                     size,
+                     const u32                     offset = 0) override;
+    void  unmap_buffer(const resources::BufferHandle buffer_id) override;
+
+    void copy_buffer(const resources::BufferHandle src_buffer_id,
+                     const resources::BufferHandle dst_buffer_id,
+                     const u32                     size,
+                     const u32                     src_offset = 0,
+                     const u32                     dst_offset = 0) override;
+
+    void copy_buffer_to_image(const resources::BufferHandle  buffer_handle,
+                              const resources::TextureHandle texture_handle,
+                              const u32                      width,
+                              const u32                      height) override;
+
+    void destroy_buffer(resources::BufferHandle handle) override;
+    void destroy_texture(resources::TextureHandle handle) override;
+    void destroy_descriptor_set(resources::DescriptorSetHandle handle) override;
+    void destroy_descriptor_set_layout(resources::DescriptorSetLayoutHandle handle) override;
+
+    void destroy_buffer_immediate(resources::ResourceHandle handle) override;
+    void destroy_texture_immediate(resources::ResourceHandle handle) override;
+    void destroy_descriptor_set_immediate(resources::ResourceHandle handle) override;
+    void destroy_descriptor_set_layout_immediate(resources::ResourceHandle handle) override;
+
+    // Commands of the last ended frame.
+    const NullCommandBuffer& get_last_frame_commands() const
+    {
+        return last_frame_commands;
+    }
+    u64 get_frame_count() const
+    {
+        return frame_count;
+    }
+
+    // Binding a pass or pipeline never created throws, as it does on the other devices.
+    bool has_render_pass(const std::string& name) const;
+    bool has_pipeline(const std::string& name) const;
+    // Pipelines are deduplicated by descriptor hash like on the other devices, named pipelines
+    // with the same state share one.
+    u32 get_unique_pipeline_count() const
+    {
+        return static_cast<u32>(pipeline_hashes.size());
+    }
+    u32 get_render_pass_layout_count() const
+    {
+        return static_cast<u32>(render_pass_cache.size());
+    }
+    u32 get_framebuffer_count() const
+    {
+        return framebuffer_count;
+    }
+
+    NullBuffer*              access_buffer(resources::ResourceHandle handle);
+    NullTexture*             access_texture(resources::ResourceHandle handle);
+    NullRenderPass*          access_render_pass(resources::ResourceHandle handle);
+    NullDescriptorSet*       access_descriptor_set(resources::ResourceHandle handle);
+    NullDescriptorSetLayout* access_descriptor_set_layout(resources::ResourceHandle handle);
+
+    static const u16 DEFAULT_RESOURCES_COUNT = 128;
+
+  private:
+    // Render pass layouts are cached like on the other devices.
+    u64 get_render_pass(const resources::RenderPassDescriptor& descriptor);
+
+    resources::ResourcePool buffers;
+    resources::ResourcePool textures;
+    resources::ResourcePool descriptor_sets;
+    resources::ResourcePool descriptor_set_layouts;
+    resources::ResourcePool renderpasses;
+
+    std::map<std::string, resources::RenderPassHandle> render_passes;
+    std::set<u64>                                      render_pass_cache;
+    std::set<std::string>                              pipelines;
+    std::set<u64>                                      pipeline_hashes;
+    std::map<u64, resources::DescriptorSetHandle>      descriptor_set_cache;
+    // Given back at the start of the next frame, like the ones of a device with frames in flight.
+    std::vector<resources::ResourceHandle>             transient_descriptor_sets;
+
+    NullCommandBuffer               command_buffer;
+    NullCommandBuffer               last_frame_commands;
+    std::vector<resources::GPUZone> gpu_zones;
+
+    u32  framebuffer_count = 0;
+    u64  frame_count       = 0;
+    u64  total_commands    = 0;
+    u64  total_draws       = 0;
+    bool is_initialized    = false;
+};
+} // namespace null
+} // namespace pinut
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <span>
+
 #include <render_types.h>
 #include <resources/buffer.h>
 #include <resources/commandbuffer.h>
@@ -12,11 +14,13 @@ namespace pinut
 {
 struct DeviceDescriptor
 {
-    void* window = nullptr;
-    u16   width  = 0;
-    u16   height = 0;
+    void*       window              = nullptr;
+    u16         width               = 0;
+    u16         height              = 0;
+    const char* pipeline_cache_path = nullptr;
 
     DeviceDescriptor& set_window(u32 width, u32 height, void* handle);
+    DeviceDescriptor& set_pipeline_cache(const char* path);
 };
 
 class GPUDevice
@@ -44,12 +48,31 @@ class GPUDevice
 
     // TODO return handle for future reference outside backend.
     virtual void create_pipeline(const resources::PipelineDescriptor& descriptor) = 0;
+    // Creates all the given pipelines at once, compiling them in parallel when possible.
+    virtual void create_pipelines(std::span<const resources::PipelineDescriptor> descriptors) = 0;
 
     virtual void begin_frame() = 0;
     virtual void end_frame()   = 0;
 
+    // Frames the CPU records ahead of the GPU. Data the CPU writes every frame needs one copy per
+    // frame in flight, picked by get_frame_index.
+    static constexpr u32 MAX_FRAMES_IN_FLIGHT = 3;
+    // Slot of the frame being recorded. The GPU is done with its previous use once begin_frame
+    // returns.
+    virtual u32 get_frame_index() const = 0;
+
+    // Bindless tables: every texture and storage buffer is reachable from a single set, indexed
+    // by its handle id. The set layout is only valid when bindless is supported.
+    virtual bool                                 is_bindless_supported() const   = 0;
+    virtual resources::DescriptorSetLayoutHandle get_bindless_set_layout() const = 0;
+    virtual resources::DescriptorSetHandle       get_bindless_set() const        = 0;
+
     virtual resources::CommandBuffer* get_command_buffer(bool begin) = 0;
 
+    // Zones of the last frame the GPU finished, a few frames behind the one being recorded. Empty
+    // when the device has no timestamp support.
+    virtual const std::vector<resources::GPUZone>& get_gpu_zones() const = 0;
+
     virtual void* map_buffer(const resources::BufferHandle buffer_index,
                              const u32                     size,
                              const u32                     offset = 0)                         = 0;
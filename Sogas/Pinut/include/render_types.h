@@ -7,6 +7,7 @@ enum class GraphicsAPI
     Vulkan = 0,
     OpenGL = 1,
     Dx11   = 2,
-    Dx12   = 3
+    Dx12   = 3,
+    Null   = 4 // No API behind it, commands are only recorded. For headless runs and tests.
 };
 }
@@ -19,6 +19,23 @@ struct BufferDescriptor
     u32        size = 0;
     BufferType type = BufferType::VERTEX;
     void*      data = nullptr;
+    // Storage buffers read by bindless shaders through their handle id. Ignored when the device
+    // has no bindless support.
+    bool       bindless = false;
+    // Storage buffers are device local unless the CPU maps them to write their contents.
+    bool       host_visible = false;
+
+    BufferDescriptor& set_bindless()
+    {
+        bindless = true;
+        return *this;
+    }
+
+    BufferDescriptor& set_host_visible()
+    {
+        host_visible = true;
+        return *this;
+    }
 };
 } // namespace resources
 } // namespace pinut
@@ -9,10 +9,23 @@ namespace resources
 {
 struct Rect;
 struct Viewport;
+
+// GPU time spent between begin_gpu_zone and end_gpu_zone, in nanoseconds of
+// std::chrono::steady_clock so it lines up with CPU timings.
+struct GPUZone
+{
+    const char* name;
+    u64         start;
+    u64         end;
+    u32         depth;
+};
+
 class CommandBuffer
 {
   public:
+    // Binding a pass ends the one in progress, end_frame ends the last one.
     virtual void bind_pass(std::string pass)         = 0;
+    virtual void end_pass()                          = 0;
     virtual void bind_pipeline(std::string pipeline) = 0;
 
     virtual void set_viewport(const Viewport* viewport) = 0;
@@ -21,6 +34,8 @@ class CommandBuffer
     virtual void set_push_constant(ShaderStageType stage, u32 size, u32 offset, void* data) = 0;
 
     virtual void clear(f32 red, f32 green, f32 blue, f32 alpha) = 0;
+    // Clears a region of the depth attachment of the bound pass to the far plane.
+    virtual void clear_depth(const Rect& rect)                  = 0;
 
     virtual void draw(u32 first_vertex,
                       u32 vertex_count,
@@ -38,6 +53,11 @@ class CommandBuffer
                                     const u32           offset)                                      = 0;
     virtual void bind_index_buffer(const BufferHandle& handle, BufferIndexType index_type) = 0;
 
+    // Zones nest and the name must outlive the frame. Timings come back once the GPU finished the
+    // frame, through GPUDevice::get_gpu_zones.
+    virtual void begin_gpu_zone(const char* name) = 0;
+    virtual void end_gpu_zone()                   = 0;
+
     GPUDevice* device = nullptr;
 };
 } // namespace resources
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <resources/texture.h>
+#include <resources/texture_utils.h>
+
+namespace pinut
+{
+namespace resources
+{
+// Header of a cooked texture blob. Every mip level follows it, largest first and tightly packed,
+// so the whole payload is uploaded with a single staging copy.
+struct CookedTextureHeader
+{
+    static constexpr u32 MAGIC   = 0x58455450; // "PTEX"
+    static constexpr u32 VERSION = 1;
+
+    u32           magic      = MAGIC;
+    u32           version    = VERSION;
+    TextureFormat format     = TextureFormat::UNDEFINED;
+    u32           width      = 0;
+    u32           height     = 0;
+    u32           mip_levels = 0;
+    u64           data_size  = 0;
+    // Relative to the end of the header.
+    u64 level_offsets[MAX_TEXTURE_MIPS] = {};
+    u64 level_sizes[MAX_TEXTURE_MIPS]   = {};
+};
+
+CookedTextureHeader make_cooked_texture_header(TextureFormat format,
+                                               u32           width,
+                                               u32           height,
+                                               u32           mip_levels);
+
+bool write_cooked_texture(const std::string&         filename,
+                          const CookedTextureHeader& header,
+                          const void*                data);
+
+// Validates a blob already in memory, out_data points inside it so a mapped file can be used
+// without copies.
+bool parse_cooked_texture(const void*          blob,
+                          u64                  blob_size,
+                          CookedTextureHeader& out_header,
+                          const u8*&           out_data);
+
+// Descriptor uploading every cooked level, data must outlive the texture creation.
+TextureDescriptor get_cooked_texture_descriptor(const CookedTextureHeader& header,
+                                                const u8*                  data);
+} // namespace resources
+} // namespace pinut
@@ -0,0 +1,41 @@
+#pragma once
+
+namespace pinut
+{
+namespace resources
+{
+struct DescriptorSetBindingDescriptor;
+struct DescriptorSetDescriptor;
+struct DescriptorSetKey;
+struct DescriptorSetLayoutDescriptor;
+struct ResourcePool;
+struct PipelineDescriptor;
+struct SamplerDescriptor;
+struct ShaderStateDescriptor;
+
+// FNV-1a offset basis, used as the seed for every hash chain.
+static const u64 HASH_SEED = 0xcbf29ce484222325;
+
+u64 hash_bytes(const void* data, const u64 size, const u64 seed = HASH_SEED);
+u64 hash_combine(const u64 seed, const u64 value);
+
+// Names are ignored, only the state that ends up in the API objects is hashed.
+u64 hash_shader_state(const ShaderStateDescriptor& descriptor, const u64 seed = HASH_SEED);
+u64 hash_descriptor_set_layout(const DescriptorSetLayoutDescriptor& descriptor,
+                               const u64                            seed = HASH_SEED);
+// Layout handle plus every bound resource, its binding and its generation.
+u64 hash_descriptor_set(const DescriptorSetKey& key);
+// Bindings of the layout pick the pool every resource generation is read from.
+DescriptorSetKey get_descriptor_set_key(const DescriptorSetDescriptor&        descriptor,
+                                        const DescriptorSetBindingDescriptor* layout_bindings,
+                                        u32                                   layout_binding_count,
+                                        const ResourcePool&                   buffers,
+                                        const ResourcePool&                   textures);
+// Set layouts and push constants, everything a pipeline layout is built from.
+u64 hash_pipeline_layout(const PipelineDescriptor& descriptor);
+// Viewport and scissor are dynamic states so they are not part of the hash. The render pass name
+// is, as it picks the attachments the pipeline is built for.
+u64 hash_pipeline(const PipelineDescriptor& descriptor);
+u64 hash_sampler(const SamplerDescriptor& descriptor);
+} // namespace resources
+} // namespace pinut
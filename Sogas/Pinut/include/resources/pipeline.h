@@ -37,6 +37,13 @@ struct RasterizationDescriptor
     float     line_width = 1.0f;
 };
 
+struct DepthStencilDescriptor
+{
+    bool             depth_test    = true;
+    bool             depth_write   = true;
+    CompareOperation depth_compare = CompareOperation::LESS;
+};
+
 struct Viewport
 {
     f32 x;
@@ -116,6 +123,7 @@ struct PipelineDescriptor
     const char*               name = nullptr;
     ShaderStateDescriptor     shader_state;
     RasterizationDescriptor   rasterization;
+    DepthStencilDescriptor    depth_stencil;
     VertexInputDescriptor     vertex_input;
     ViewportDescriptor        viewport;
     TopologyType              topology = TopologyType::TRIANGLE;
@@ -123,6 +131,8 @@ struct PipelineDescriptor
     u32                       layouts_count{0};
     PushConstantDescriptor    push_constants[8];
     u32                       push_constant_count{0};
+    // Name of the render pass it draws in, the swapchain pass when not set.
+    const char*               render_pass = nullptr;
 
     PipelineDescriptor& add_name(const char* new_name)
     {
@@ -147,12 +157,24 @@ struct PipelineDescriptor
         return *this;
     }
 
+    PipelineDescriptor& add_depth_stencil(DepthStencilDescriptor& new_depth_stencil)
+    {
+        depth_stencil = new_depth_stencil;
+        return *this;
+    }
+
     PipelineDescriptor& add_viewport(ViewportDescriptor& new_viewport)
     {
         viewport = new_viewport;
         return *this;
     }
 
+    PipelineDescriptor& set_render_pass(const char* new_render_pass)
+    {
+        render_pass = new_render_pass;
+        return *this;
+    }
+
     PipelineDescriptor& set_topology(TopologyType new_topology)
     {
         topology = new_topology;
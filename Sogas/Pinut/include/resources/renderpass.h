@@ -1,9 +1,12 @@
 #pragma once
 
+#include <resources/resources.h>
+
 namespace pinut
 {
 namespace resources
 {
+static const u32 MAX_COLOR_ATTACHMENTS = 8;
 
 enum class RenderPassType
 {
@@ -13,11 +16,47 @@ enum class RenderPassType
     MAX_TYPE
 };
 
+enum class RenderPassOperation
+{
+    DONT_CARE = 0,
+    LOAD,
+    CLEAR
+};
+
+// Offscreen pass over render target textures, all of them the size of the first attachment.
+// Attachments end the pass ready to be sampled, and must be in that layout when loaded.
 struct RenderPassDescriptor
 {
     std::string name;
 
     RenderPassType type = RenderPassType::GEOMETRY;
+
+    TextureHandle       color_attachments[MAX_COLOR_ATTACHMENTS];
+    u32                 color_attachment_count = 0;
+    TextureHandle       depth_attachment{INVALID_ID};
+    RenderPassOperation color_operation = RenderPassOperation::CLEAR;
+    RenderPassOperation depth_operation = RenderPassOperation::CLEAR;
+
+    RenderPassDescriptor& add_color_attachment(const TextureHandle& handle)
+    {
+        ASSERT(color_attachment_count < MAX_COLOR_ATTACHMENTS);
+
+        color_attachments[color_attachment_count++] = handle;
+        return *this;
+    }
+
+    RenderPassDescriptor& set_depth_attachment(const TextureHandle& handle)
+    {
+        depth_attachment = handle;
+        return *this;
+    }
+
+    RenderPassDescriptor& set_operations(RenderPassOperation color, RenderPassOperation depth)
+    {
+        color_operation = color;
+        depth_operation = depth;
+        return *this;
+    }
 };
 } // namespace resources
 } // namespace pinut
@@ -16,8 +16,12 @@ struct ResourcePool
     void*       access_resource(u32 index);
     const void* access_resource(u32 index) const;
 
+    // Bumped every time the index is given back, so a recycled id can be told apart.
+    u32 get_generation(u32 index) const;
+
     u8*  memory       = nullptr;
     u32* free_indices = nullptr;
+    u32* generations  = nullptr;
 
     u32 free_indices_head = 0;
     u64 pool_size         = 0;
@@ -90,6 +90,19 @@ enum class TopologyType
     COUNT
 };
 
+enum class CompareOperation
+{
+    NEVER,
+    LESS,
+    EQUAL,
+    LESS_OR_EQUAL,
+    GREATER,
+    NOT_EQUAL,
+    GREATER_OR_EQUAL,
+    ALWAYS,
+    COUNT
+};
+
 enum class BufferIndexType
 {
     UINT16,
@@ -117,7 +130,8 @@ enum class ShaderStageType
     GEOMETRY,
     FRAGMENT,
     COMPUTE,
-    MAX_SHADER_TYPE
+    MAX_SHADER_TYPE,
+    ALL_GRAPHICS // Resources shared by several graphic stages.
 };
 } // namespace resources
 } // namespace pinut
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <resources/pipeline.h>
+#include <resources/shader_state.h>
+
+namespace pinut
+{
+namespace resources
+{
+static const u32 MAX_REFLECTED_SETS = 8;
+
+// Interface of one or more shader stages, read back from the SPIR-V words.
+struct ShaderReflection
+{
+    DescriptorSetLayoutDescriptor set_layouts[MAX_REFLECTED_SETS] = {};
+    u32                           set_count                       = 0;
+    PushConstantDescriptor        push_constant;
+    // Vertex inputs of the vertex stage, tightly packed in location order on stream 0.
+    VertexInputDescriptor vertex_input;
+};
+
+bool reflect_shader(const ShaderStage& stage, ShaderReflection& out_reflection);
+// Merges all the used stages, bindings seen by several stages become visible to all of them.
+bool reflect_shader_state(const ShaderStateDescriptor& shader_state,
+                          ShaderReflection&            out_reflection);
+} // namespace resources
+} // namespace pinut
@@ -53,18 +53,33 @@ struct DescriptorSetBindingDescriptor
     DescriptorType  descriptor_type = DescriptorType::COUNT;
 };
 
+// Descriptors in a bindless array are indexed by the handle id of the resource.
+static const u32 MAX_BINDLESS_RESOURCES   = 1024;
+static const u32 BINDLESS_TEXTURE_BINDING = 0;
+static const u32 BINDLESS_BUFFER_BINDING  = 1;
+
 struct DescriptorSetLayoutDescriptor
 {
     u32                            binding_count = 0;
     DescriptorSetBindingDescriptor bindings[16];
     const char*                    name;
 
+    // Bindings are update-after-bind and partially bound, unsized ones hold
+    // MAX_BINDLESS_RESOURCES descriptors.
+    bool bindless = false;
+
     DescriptorSetLayoutDescriptor& add_name(const char* new_name)
     {
         name = new_name;
         return *this;
     }
 
+    DescriptorSetLayoutDescriptor& set_bindless()
+    {
+        bindless = true;
+        return *this;
+    }
+
     DescriptorSetLayoutDescriptor& add_binding(const DescriptorSetBindingDescriptor& binding)
     {
         bindings[binding_count++] = binding;
@@ -86,10 +101,21 @@ struct DescriptorSetDescriptor
 
     std::string name;
 
+    // Transient sets live for the current frame only and are released by the device. Creating
+    // one returns an invalid handle when it does not fit in the frame's descriptor pools.
+    bool transient = false;
+
     DescriptorSetDescriptor& reset()
     {
         resources_used = 0;
         name           = "";
+        transient      = false;
+        return *this;
+    }
+
+    DescriptorSetDescriptor& set_transient()
+    {
+        transient = true;
         return *this;
     }
 
@@ -128,6 +154,19 @@ struct DescriptorSetDescriptor
     }
 };
 
+// What a cached descriptor set was written from. Resource ids are recycled, the generation of
+// every resource tells a new one apart from a destroyed one that had the same id.
+struct DescriptorSetKey
+{
+    ResourceHandle layout                              = INVALID_ID;
+    u16            resources_used                      = 0;
+    u16            bindings[MAX_DESCRIPTOR_PER_SET]    = {};
+    ResourceHandle resources[MAX_DESCRIPTOR_PER_SET]   = {};
+    u32            generations[MAX_DESCRIPTOR_PER_SET] = {};
+
+    bool operator==(const DescriptorSetKey& other) const = default;
+};
+
 struct PushConstantDescriptor
 {
     ShaderStageType stage  = ShaderStageType::MAX_SHADER_TYPE;
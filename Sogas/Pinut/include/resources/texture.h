@@ -117,9 +117,92 @@ enum class TextureFormat
     D24_UNORM_S8_UINT,
     D32_SFLOAT_S8_UINT,
 
+    // Block compressed, 4x4 texel blocks.
+    BC1_RGBA_UNORM,
+    BC1_RGBA_SRGB,
+    BC3_UNORM,
+    BC3_SRGB,
+    BC5_UNORM,
+    BC5_SNORM,
+    BC7_UNORM,
+    BC7_SRGB,
+
+    COUNT
+};
+
+enum class SamplerFilter
+{
+    NEAREST,
+    LINEAR,
+    COUNT
+};
+
+enum class SamplerMipmapMode
+{
+    NEAREST,
+    LINEAR,
+    COUNT
+};
+
+enum class SamplerAddressMode
+{
+    REPEAT,
+    MIRRORED_REPEAT,
+    CLAMP_TO_EDGE,
+    CLAMP_TO_BORDER,
     COUNT
 };
 
+// Samplers are cached by the device, textures with the same descriptor share the same sampler.
+struct SamplerDescriptor
+{
+    // Same as VK_LOD_CLAMP_NONE, every mip level of the texture can be sampled.
+    static constexpr f32 LOD_CLAMP_NONE = 1000.0f;
+
+    SamplerFilter      min_filter   = SamplerFilter::LINEAR;
+    SamplerFilter      mag_filter   = SamplerFilter::LINEAR;
+    SamplerMipmapMode  mip_filter   = SamplerMipmapMode::LINEAR;
+    SamplerAddressMode address_u    = SamplerAddressMode::REPEAT;
+    SamplerAddressMode address_v    = SamplerAddressMode::REPEAT;
+    SamplerAddressMode address_w    = SamplerAddressMode::REPEAT;
+    bool               anisotropy   = true;
+    f32                mip_lod_bias = 0.0f;
+    f32                min_lod      = 0.0f;
+    f32                max_lod      = LOD_CLAMP_NONE;
+
+    SamplerDescriptor& set_filter(SamplerFilter min, SamplerFilter mag, SamplerMipmapMode mip)
+    {
+        min_filter = min;
+        mag_filter = mag;
+        mip_filter = mip;
+        return *this;
+    }
+
+    SamplerDescriptor& set_address_mode(SamplerAddressMode u,
+                                        SamplerAddressMode v,
+                                        SamplerAddressMode w = SamplerAddressMode::REPEAT)
+    {
+        address_u = u;
+        address_v = v;
+        address_w = w;
+        return *this;
+    }
+
+    SamplerDescriptor& set_lod(f32 min, f32 max, f32 bias = 0.0f)
+    {
+        min_lod      = min;
+        max_lod      = max;
+        mip_lod_bias = bias;
+        return *this;
+    }
+
+    SamplerDescriptor& set_anisotropy(bool enabled)
+    {
+        anisotropy = enabled;
+        return *this;
+    }
+};
+
 struct TextureDescriptor
 {
     void*         data          = nullptr;
@@ -132,6 +215,14 @@ struct TextureDescriptor
     u8            mip_levels    = 1;
     const char*   name          = nullptr;
 
+    SamplerDescriptor sampler;
+
+    // When set, data only holds level 0 and the rest of the chain is generated on the GPU.
+    // Otherwise data holds every mip level, largest first and tightly packed.
+    bool generate_mips = false;
+    // Can be an attachment of an offscreen render pass, depth formats can then be sampled too.
+    bool render_target = false;
+
     TextureDescriptor& set_size(const u16 texture_width,
                                 const u16 texture_height,
                                 const u16 texture_depth = 1)
@@ -160,9 +251,29 @@ struct TextureDescriptor
         return *this;
     }
 
+    TextureDescriptor& set_mips(u8 mipmaps, bool generate)
+    {
+        this->mip_levels    = mipmaps;
+        this->generate_mips = generate;
+        return *this;
+    }
+
+    TextureDescriptor& set_render_target(bool enabled)
+    {
+        this->render_target = enabled;
+        return *this;
+    }
+
     TextureDescriptor& add_name(const char* texture_name)
     {
         this->name = texture_name;
+        return *this;
+    }
+
+    TextureDescriptor& set_sampler(const SamplerDescriptor& sampler_descriptor)
+    {
+        this->sampler = sampler_descriptor;
+        return *this;
     }
 
     TextureDescriptor& set_data(void* initial_data)
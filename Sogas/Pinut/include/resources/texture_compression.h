@@ -0,0 +1,31 @@
+#pragma once
+
+#include <resources/texture.h>
+
+namespace pinut
+{
+namespace resources
+{
+// Block rows handed to a worker at a time when compressing in parallel.
+static const u32 COMPRESSION_TILE_BLOCK_ROWS = 8;
+
+// BC1, BC3 and BC5 are encoded, BC7 needs a mode search that is left to external tools.
+bool is_compression_supported(TextureFormat format);
+
+// Encode one 4x4 block of 8 bit RGBA texels, row major.
+void encode_bc1_block(const u8* rgba_block, u8* out_block);
+void encode_bc3_block(const u8* rgba_block, u8* out_block);
+void encode_bc5_block(const u8* rgba_block, u8* out_block);
+
+// Compresses a packed 8 bit RGBA mip chain, as generate_mip_chain_rgba8 produces it, into a chain
+// laid out like make_cooked_texture_header expects. Tiles of every level are spread across
+// thread_count workers, 0 uses one per hardware thread.
+bool compress_mip_chain(TextureFormat    format,
+                        const u8*        rgba_chain,
+                        u32              width,
+                        u32              height,
+                        u32              mip_levels,
+                        std::vector<u8>& out_chain,
+                        u32              thread_count = 0);
+} // namespace resources
+} // namespace pinut
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <resources/texture.h>
+
+namespace pinut
+{
+namespace resources
+{
+static const u32 MAX_TEXTURE_MIPS = 16;
+
+bool is_block_compressed(TextureFormat format);
+// Bytes of a texel, or of a 4x4 block for compressed formats.
+u32 get_format_block_size(TextureFormat format);
+
+// Full chain down to 1x1.
+u32 get_mip_count(u32 width, u32 height);
+u32 get_mip_dimension(u32 dimension, u32 level);
+u64 get_mip_size(TextureFormat format, u32 width, u32 height);
+u64 get_mip_chain_size(TextureFormat format, u32 width, u32 height, u32 mip_levels);
+
+// Box filters 8 bit RGBA level 0 into out_chain, which receives every level packed largest first.
+// Meant for offline cooking, rows are filtered with SSE2 when available.
+void generate_mip_chain_rgba8(const u8*        source,
+                              u32              width,
+                              u32              height,
+                              u32              mip_levels,
+                              std::vector<u8>& out_chain);
+} // namespace resources
+} // namespace pinut
@@ -12,6 +12,7 @@ class VulkanCommandBuffer : public resources::CommandBuffer
 {
   public:
     void bind_pass(std::string pass) override;
+    void end_pass() override;
     void bind_pipeline(std::string pipeline) override;
 
     void set_viewport(const resources::Viewport* viewport) override;
@@ -23,6 +24,7 @@ class VulkanCommandBuffer : public resources::CommandBuffer
                            void*                      data) override;
 
     void clear(f32 red, f32 green, f32 blue, f32 alpha) override;
+    void clear_depth(const resources::Rect& rect) override;
 
     void draw(u32 first_vertex, u32 vertex_count, u32 first_instance, u32 instance_count) override;
     void draw_indexed(u32 first_index,
@@ -39,11 +41,30 @@ class VulkanCommandBuffer : public resources::CommandBuffer
     void bind_index_buffer(const resources::BufferHandle& handle,
                            resources::BufferIndexType     index_type) override;
 
+    void begin_gpu_zone(const char* name) override;
+    void end_gpu_zone() override;
+
+    // Starts a new set of zones, the command buffer must be recording outside a pass.
+    void reset_gpu_zones();
+
+    static const u32 MAX_GPU_ZONES = 64;
+
     VkCommandBuffer cmd = VK_NULL_HANDLE;
 
+    // Two queries per zone, null without timestamp support. Start and end of the zones are filled
+    // in when the device reads the queries back.
+    VkQueryPool                     timestamp_pool       = VK_NULL_HANDLE;
+    std::vector<resources::GPUZone> gpu_zones;
+    bool                            timestamps_submitted = false;
+
   private:
     VkClearValue     clear_values[2]         = {{0.0f}, {1.0f, 0}};
     VkPipelineLayout current_pipeline_layout = VK_NULL_HANDLE;
+    bool             pass_in_progress        = false;
+    // Default viewport and scissor, the size of the bound pass.
+    VkExtent2D       current_extent          = {0, 0};
+    // Index in gpu_zones of every zone not ended yet, INVALID_ID for the ones over the limit.
+    std::vector<u32> open_gpu_zones;
 };
 } // namespace vulkan
 } // namespace pinut
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+namespace pinut
+{
+namespace vulkan
+{
+// Hands out descriptor sets from pools sized for a single layout, so a pool never fragments and
+// freed sets are recycled without going back to the driver. Transient sets come from per-frame
+// pools that are reset in bulk once the frame is no longer in flight.
+class VulkanDescriptorAllocator
+{
+  public:
+    void init(VkDevice new_device, u32 new_frame_count);
+    void shutdown();
+
+    // Descriptor counts needed by one set of the layout. Update-after-bind layouts need the
+    // matching pool flag, their pools start with a single set since they tend to be huge.
+    void register_layout(VkDescriptorSetLayout                    layout,
+                         const std::vector<VkDescriptorPoolSize>& sizes_per_set,
+                         VkDescriptorPoolCreateFlags              flags = 0);
+    // Destroys the pools of the layout, all its sets become invalid.
+    void unregister_layout(VkDescriptorSetLayout layout);
+
+    VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+    void            free(VkDescriptorSetLayout layout, VkDescriptorSet set);
+
+    // Only valid until the frame index comes around again. Returns VK_NULL_HANDLE when the set
+    // does not fit in a transient pool.
+    VkDescriptorSet allocate_transient(VkDescriptorSetLayout layout, u32 frame);
+    void            reset_frame(u32 frame);
+
+  private:
+    static constexpr u32 INITIAL_SETS_PER_POOL = 16;
+    static constexpr u32 MAX_SETS_PER_POOL     = 1024;
+    static constexpr u32 TRANSIENT_SETS        = 256;
+
+    struct LayoutPools
+    {
+        std::vector<VkDescriptorPoolSize> sizes_per_set;
+        std::vector<VkDescriptorPool>     pools;
+        std::vector<VkDescriptorSet>      free_sets;
+        VkDescriptorPoolCreateFlags       flags         = 0;
+        u32                               sets_per_pool = INITIAL_SETS_PER_POOL;
+        u32                               sets_left     = 0;
+    };
+
+    struct FramePools
+    {
+        std::vector<VkDescriptorPool> pools;
+        u32                           current       = 0;
+        u32                           sizes_version = 0;
+    };
+
+    VkDescriptorPool create_pool(const std::vector<VkDescriptorPoolSize>& sizes_per_set,
+                                 u32                                      max_sets,
+                                 VkDescriptorPoolCreateFlags              flags = 0) const;
+    VkDescriptorPool get_transient_pool(FramePools& pools, bool next);
+
+    VkDevice                                     device      = VK_NULL_HANDLE;
+    u32                                          frame_count = 0;
+    std::map<VkDescriptorSetLayout, LayoutPools> layout_pools;
+    std::vector<FramePools>                      frame_pools;
+    // Largest count of each descriptor type in one set of any registered layout, so a transient
+    // pool fits a set of every layout. Bumping the version retires the smaller pools.
+    std::vector<VkDescriptorPoolSize>            transient_sizes_per_set;
+    u32                                          transient_sizes_version = 0;
+};
+} // namespace vulkan
+} // namespace pinut
@@ -11,10 +11,15 @@ class VulkanRenderPass
 {
   public:
     VkRenderPass handle;
+    // Offscreen passes own theirs, the swapchain pass uses the one of the acquired image.
+    VkFramebuffer framebuffer;
 
     u16 width  = 0;
     u16 height = 0;
 
+    u32  color_attachment_count = 0;
+    bool has_depth              = false;
+
     resources::RenderPassType type;
 
     const char* name = nullptr;
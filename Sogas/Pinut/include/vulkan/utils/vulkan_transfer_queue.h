@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+namespace pinut
+{
+namespace vulkan
+{
+// Records uploads on the transfer queue and tracks every submit with a timeline semaphore value.
+// When the transfer queue is from another family, uploaded resources are released by it and the
+// matching acquires are recorded on the graphics queue before the frame that first uses them.
+class VulkanTransferQueue
+{
+  public:
+    void init(VkDevice new_device, VkQueue new_queue, u32 new_family, u32 new_graphics_family);
+    void shutdown();
+
+    bool is_dedicated() const
+    {
+        return family != graphics_family;
+    }
+
+    // Commands are batched until flush, the batch signals get_pending_value once done.
+    VkCommandBuffer get_command_buffer();
+    u64             get_pending_value() const;
+
+    // Last barrier of an upload, hands the resource to the graphics queue ready to be read.
+    void release_image(VkImage image, u32 mip_levels);
+    void release_buffer(VkBuffer buffer);
+
+    // Submits the batch being recorded, if any.
+    void flush();
+    // Records the acquires of every flushed release, returns false when there are none.
+    bool record_acquires(VkCommandBuffer graphics_cmd);
+
+    u64         get_submitted_value() const;
+    u64         get_completed_value() const;
+    bool        is_complete(u64 value) const;
+    // Flushes first when the value belongs to the batch still being recorded.
+    void        wait(u64 value);
+    VkSemaphore get_semaphore() const;
+
+    // Graphics stages that wait on the timeline, covering everything that reads uploads.
+    static constexpr VkPipelineStageFlags GRAPHICS_WAIT_STAGES =
+      VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+  private:
+    struct Batch
+    {
+        VkCommandBuffer cmd   = VK_NULL_HANDLE;
+        u64             value = 0;
+    };
+
+    VkDevice      device          = VK_NULL_HANDLE;
+    VkQueue       queue           = VK_NULL_HANDLE;
+    u32           family          = VK_QUEUE_FAMILY_IGNORED;
+    u32           graphics_family = VK_QUEUE_FAMILY_IGNORED;
+    VkCommandPool command_pool    = VK_NULL_HANDLE;
+    VkSemaphore   timeline        = VK_NULL_HANDLE;
+
+    u64                          submitted_value = 0;
+    VkCommandBuffer              recording       = VK_NULL_HANDLE;
+    std::vector<Batch>           in_flight;
+    std::vector<VkCommandBuffer> free_command_buffers;
+
+    std::vector<VkImageMemoryBarrier>  pending_image_acquires;
+    std::vector<VkBufferMemoryBarrier> pending_buffer_acquires;
+    std::vector<VkImageMemoryBarrier>  flushed_image_acquires;
+    std::vector<VkBufferMemoryBarrier> flushed_buffer_acquires;
+};
+} // namespace vulkan
+} // namespace pinut
@@ -2,6 +2,7 @@
 
 #include <resources/buffer.h>
 #include <resources/pipeline.h>
+#include <resources/renderpass.h>
 #include <resources/resources.h>
 #include <resources/texture.h>
 
@@ -35,6 +36,16 @@ VkImageType get_texture_type(resources::TextureType type);
 
 VkImageViewType get_texture_view_type(resources::TextureViewType type);
 
+VkFilter get_sampler_filter(resources::SamplerFilter filter);
+
+VkSamplerMipmapMode get_sampler_mipmap_mode(resources::SamplerMipmapMode mode);
+
+VkSamplerAddressMode get_sampler_address_mode(resources::SamplerAddressMode mode);
+
+VkAttachmentLoadOp get_attachment_load_op(resources::RenderPassOperation operation);
+
+VkCompareOp get_compare_op(resources::CompareOperation operation);
+
 inline bool has_depth_or_stencil(VkFormat format)
 {
     return format >= VK_FORMAT_D16_UNORM && format <= VK_FORMAT_D32_SFLOAT_S8_UINT;
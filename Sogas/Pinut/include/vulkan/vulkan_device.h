@@ -6,9 +6,11 @@
 #include <resources/resources.h>
 #include <resources/shader_state.h>
 #include <vulkan/utils/vulkan_commandbuffer.h>
+#include <vulkan/utils/vulkan_descriptor_allocator.h>
 #include <vulkan/utils/vulkan_render_pass.h>
 #include <vulkan/utils/vulkan_shader_loader.h>
 #include <vulkan/utils/vulkan_swapchain.h>
+#include <vulkan/utils/vulkan_transfer_queue.h>
 
 namespace sogas
 {
@@ -23,6 +25,8 @@ struct VulkanBuffer
 {
     VkBuffer       buffer;
     VkDeviceMemory memory;
+    u64            memory_size;
+    u64            transfer_value; // Timeline value of the last upload reading or writing it.
 };
 
 struct VulkanTexture
@@ -30,13 +34,30 @@ struct VulkanTexture
     VkImage        image;
     VkImageView    image_view;
     VkFormat       format;
-    VkSampler      sampler;
+    u16            width;
+    u16            height;
+    VkSampler      sampler; // Shared, owned by the device sampler cache.
+    u64            sampler_hash;
     VkDeviceMemory memory;
+    u64            memory_size;
+    u64            transfer_value; // Timeline value of the upload writing it.
+};
+
+struct VulkanSampler
+{
+    VkSampler sampler         = VK_NULL_HANDLE;
+    u32       reference_count = 0;
 };
 
 struct VulkanDescriptorSet
 {
-    VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+    VkDescriptorSet       descriptor_set = VK_NULL_HANDLE;
+    VkDescriptorSetLayout layout         = VK_NULL_HANDLE;
+
+    resources::DescriptorSetKey key;
+    u64                         hash            = 0;
+    u32                         reference_count = 0;
+    bool                        transient       = false;
 };
 
 struct VulkanDescriptorSetLayout
@@ -46,6 +67,9 @@ struct VulkanDescriptorSetLayout
     resources::DescriptorSetBindingDescriptor* bindings             = nullptr;
     u16                                        bindings_count       = 0;
     u8                                         descriptor_set_index = 0;
+
+    u64 hash            = 0;
+    u32 reference_count = 0;
 };
 
 struct VulkanPipeline
@@ -77,12 +101,20 @@ class VulkanDevice : public GPUDevice
 
     // TODO should return a handle for future references outside.
     void create_pipeline(const resources::PipelineDescriptor& descriptor) override;
+    void create_pipelines(std::span<const resources::PipelineDescriptor> descriptors) override;
 
     void begin_frame() override;
     void end_frame() override;
+    u32  get_frame_index() const override;
+
+    bool                                 is_bindless_supported() const override;
+    resources::DescriptorSetLayoutHandle get_bindless_set_layout() const override;
+    resources::DescriptorSetHandle       get_bindless_set() const override;
 
     resources::CommandBuffer* get_command_buffer(bool begin) override;
 
+    const std::vector<resources::GPUZone>& get_gpu_zones() const override;
+
     void* map_buffer(const resources::BufferHandle buffer_id,
                      const u32                     size,
                      const u32                     offset = 0) override;
@@ -109,7 +141,8 @@ class VulkanDevice : public GPUDevice
     void destroy_descriptor_set_immediate(resources::ResourceHandle handle) override;
     void destroy_descriptor_set_layout_immediate(resources::ResourceHandle handle) override;
 
-    void destroy_pending_resources();
+    // Destroys what the frame slot released, once the GPU is done with its last submit.
+    void destroy_pending_resources(u32 frame);
 
     static VkCommandBuffer begin_single_use_command_buffer(const VkDevice&      device,
                                                            const VkCommandPool& command_pool);
@@ -118,11 +151,15 @@ class VulkanDevice : public GPUDevice
                                                          const VkQueue&       queue,
                                                          VkCommandBuffer      cmd);
 
-    static std::map<std::string, VulkanShaderState> shaders;
-    static std::map<std::string, VulkanPipeline>    pipelines;
-    static std::map<std::string, VulkanRenderPass>  render_passes;
+    // Shader modules keyed by the hash of their code, specs sharing a name may differ in it.
+    static std::map<u64, VulkanShaderState>                   shaders;
+    static std::map<std::string, VulkanPipeline>              pipelines;
+    static std::map<std::string, resources::RenderPassHandle> render_passes;
+    // Unique API objects keyed by descriptor hash, named pipelines may alias the same entry.
+    static std::map<u64, VulkanPipeline>   pipelines_by_hash;
+    static std::map<u64, VkPipelineLayout> pipeline_layouts;
 
-    static const u32 MAX_SWAPCHAIN_IMAGES = 3;
+    static const u32 MAX_SWAPCHAIN_IMAGES = MAX_FRAMES_IN_FLIGHT;
 
     VkDevice      device                             = VK_NULL_HANDLE;
     VkFramebuffer framebuffers[MAX_SWAPCHAIN_IMAGES] = {VK_NULL_HANDLE};
@@ -144,6 +181,7 @@ class VulkanDevice : public GPUDevice
     VulkanTexture*             access_texture(resources::ResourceHandle handle);
     VulkanDescriptorSet*       access_descriptor_set(resources::ResourceHandle handle);
     VulkanDescriptorSetLayout* access_descriptor_set_layout(resources::ResourceHandle handle);
+    VulkanRenderPass*          access_render_pass(resources::ResourceHandle handle);
 
   private:
     bool                                 create_instance();
@@ -155,12 +193,45 @@ class VulkanDevice : public GPUDevice
 
     u32 find_memory_type(const u32 type_filter, const VkMemoryPropertyFlags property_flags);
 
+    // Pipeline functions
+    void              load_pipeline_cache();
+    void              save_pipeline_cache();
+    VulkanShaderState get_shader_state(const resources::ShaderStateDescriptor& descriptor);
+    VkPipelineLayout  get_pipeline_layout(const resources::PipelineDescriptor& descriptor);
+    VkResult          build_pipeline(const resources::PipelineDescriptor& descriptor,
+                                     const VulkanShaderState&              shader_state,
+                                     VulkanPipeline&                       pipeline);
+
+    VkRenderPass get_render_pass(const VkAttachmentDescription* attachments,
+                                 u32                            color_attachment_count,
+                                 bool                           has_depth);
+
+    // Sampler functions
+    VkSampler acquire_sampler(const resources::SamplerDescriptor& descriptor, u64& out_hash);
+    void      release_sampler(u64 hash);
+
+    void wait_for_frame(u64 value);
+
+    // Timestamp functions
+    void create_timestamp_queries();
+    void calibrate_timestamps();
+    void read_gpu_zones(u32 frame);
+    u64  get_timestamp_time(u64 ticks) const;
+
+    // Bindless functions
+    void create_bindless_set();
+    void update_bindless_set();
+
     // Swapchain functions
     void create_swapchain();
     void destroy_swapchain();
     void recreate_swapchain();
 
     // internals
+    void upload_texture(const resources::TextureHandle      handle,
+                        const resources::TextureDescriptor& descriptor,
+                        const u32                           mip_levels,
+                        const bool                          generate_mips);
     void create_vulkan_buffer(const u32             size,
                               VkBufferUsageFlags    usage_flags,
                               VkMemoryPropertyFlags memory_property_flags,
@@ -175,6 +246,7 @@ class VulkanDevice : public GPUDevice
     VkSurfaceKHR     vulkan_surface  = VK_NULL_HANDLE;
 
     VkPhysicalDeviceProperties           physical_device_properties;
+    VkPhysicalDeviceFeatures             physical_device_features;
     VkPhysicalDeviceMemoryProperties     physical_device_memory_properties;
     VkFormatProperties                   physical_device_format_properties;
     std::vector<VkQueueFamilyProperties> queue_family_properties;
@@ -192,7 +264,13 @@ class VulkanDevice : public GPUDevice
     VkQueue present_queue  = VK_NULL_HANDLE;
     VkQueue transfer_queue = VK_NULL_HANDLE;
 
+    // Uploads run on the transfer queue, frames wait on its timeline and acquire what it released.
+    VulkanTransferQueue transfer;
+    VkCommandBuffer     acquire_command_buffers[MAX_SWAPCHAIN_IMAGES] = {VK_NULL_HANDLE};
+
+    // Deletions since the last submit, moved into the bin of the frame submitted next.
     std::vector<resources::ResourceDeletion> deletion_queue;
+    std::vector<resources::ResourceDeletion> deletion_bins[MAX_SWAPCHAIN_IMAGES];
 
     // Swapchain variables
     Swapchain swapchain;
@@ -204,7 +282,22 @@ class VulkanDevice : public GPUDevice
 
     VulkanCommandBuffer command_buffers[MAX_SWAPCHAIN_IMAGES];
 
-    VkDescriptorPool descriptor_pool;
+    VulkanDescriptorAllocator descriptor_allocator;
+
+    // Persistent sets with the same layout and resources are shared, keyed by their hash.
+    std::map<u64, resources::DescriptorSetHandle> descriptor_set_cache;
+    std::vector<resources::ResourceHandle>        transient_descriptor_sets[MAX_SWAPCHAIN_IMAGES];
+
+    // Single bindless set, new resources are written to it before the next submit.
+    bool                                   bindless_supported = false;
+    resources::DescriptorSetLayoutHandle   bindless_set_layout{INVALID_ID};
+    resources::DescriptorSetHandle         bindless_set{INVALID_ID};
+    std::vector<resources::ResourceHandle> bindless_textures_to_update;
+    std::vector<resources::ResourceHandle> bindless_buffers_to_update;
+
+    // Persisted between runs, keyed by the device UUID and driver version.
+    VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
+    std::string     pipeline_cache_path;
 
     static const u16 DEFAULT_RESOURCES_COUNT = 128;
 
@@ -212,6 +305,16 @@ class VulkanDevice : public GPUDevice
     resources::ResourcePool textures;
     resources::ResourcePool descriptor_sets;
     resources::ResourcePool descriptor_set_layouts;
+    resources::ResourcePool renderpasses;
+
+    // Offscreen passes with the same attachment formats and operations share one render pass.
+    std::map<u64, VkRenderPass> render_pass_cache;
+
+    // Live samplers are capped by the device, textures share them by descriptor hash.
+    std::map<u64, VulkanSampler> sampler_cache;
+
+    // Identical layouts are created once and shared, keyed by their bindings hash.
+    std::map<u64, resources::DescriptorSetLayoutHandle> descriptor_set_layout_cache;
 
 #ifdef _DEBUG
     VkDebugUtilsMessengerEXT debug_messenger = VK_NULL_HANDLE;
@@ -225,7 +328,19 @@ class VulkanDevice : public GPUDevice
 
     VkSemaphore present_semaphores[MAX_SWAPCHAIN_IMAGES];
     VkSemaphore render_semaphores[MAX_SWAPCHAIN_IMAGES];
-    VkFence     render_fences[MAX_SWAPCHAIN_IMAGES];
+
+    // Every frame submit signals the next value, each slot remembers the value of its last one.
+    VkSemaphore frame_timeline                     = VK_NULL_HANDLE;
+    u64         submitted_frames                   = 0;
+    u64         frame_values[MAX_SWAPCHAIN_IMAGES] = {0};
+
+    // Timestamps convert to steady clock nanoseconds through a pair of GPU and CPU times taken
+    // together. Zero period when the graphics queue has no timestamps.
+    f64                             timestamp_period  = 0.0;
+    u64                             timestamp_mask    = 0;
+    u64                             calibration_ticks = 0;
+    u64                             calibration_time  = 0;
+    std::vector<resources::GPUZone> gpu_zones;
 
     VkRenderPass render_pass;
     //! End temporal block
@@ -0,0 +1,686 @@
+#include "pch.hpp"
+
+#include <bit>
+#include <cstring>
+
+#include <null/null_device.h>
+#include <resources/hash.h>
+#include <resources/pipeline.h>
+#include <resources/renderpass.h>
+#include <resources/shader_state.h>
+#include <resources/texture.h>
+
+namespace pinut
+{
+namespace null
+{
+static u64 hash_name(const std::string& name)
+{
+    return resources::hash_bytes(name.data(), name.size());
+}
+
+static u32 low_bits(u64 value)
+{
+    return static_cast<u32>(value);
+}
+
+static u32 high_bits(u64 value)
+{
+    return static_cast<u32>(value >> 32);
+}
+
+void NullCommandBuffer::bind_pass(std::string pass)
+{
+    ASSERT(device != nullptr);
+
+    if (!static_cast<NullDevice*>(device)->has_render_pass(pass))
+    {
+        throw std::runtime_error("Failed to find desired render pass.");
+    }
+
+    end_pass();
+
+    const u64 hash = hash_name(pass);
+    record(NullCommandType::BIND_PASS, low_bits(hash), high_bits(hash));
+    pass_in_progress = true;
+}
+
+void NullCommandBuffer::end_pass()
+{
+    if (pass_in_progress)
+    {
+        record(NullCommandType::END_PASS);
+        pass_in_progress = false;
+    }
+}
+
+void NullCommandBuffer::bind_pipeline(std::string pipeline)
+{
+    ASSERT(device != nullptr);
+
+    if (!static_cast<NullDevice*>(device)->has_pipeline(pipeline))
+    {
+        throw std::runtime_error("Failed to find desired pipeline");
+    }
+
+    const u64 hash = hash_name(pipeline);
+    record(NullCommandType::BIND_PIPELINE, low_bits(hash), high_bits(hash));
+}
+
+// Null viewport and scissors are the size of the bound pass, the first argument tells them apart.
+void NullCommandBuffer::set_viewport(const resources::Viewport* viewport)
+{
+    if (viewport == nullptr)
+    {
+        record(NullCommandType::SET_VIEWPORT);
+        return;
+    }
+
+    record(NullCommandType::SET_VIEWPORT,
+           1,
+           std::bit_cast<u32>(viewport->x),
+           std::bit_cast<u32>(viewport->y),
+           std::bit_cast<u32>(viewport->width),
+           std::bit_cast<u32>(viewport->height));
+}
+
+void NullCommandBuffer::set_scissors(const resources::Rect* scissors)
+{
+    if (scissors == nullptr)
+    {
+        record(NullCommandType::SET_SCISSORS);
+        return;
+    }
+
+    record(NullCommandType::SET_SCISSORS,
+           1,
+           std::bit_cast<u32>(scissors->offset_x),
+           std::bit_cast<u32>(scissors->offset_y),
+           scissors->w,
+           scissors->h);
+}
+
+void NullCommandBuffer::set_push_constant(resources::ShaderStageType stage,
+                                          u32                        size,
+                                          u32                        offset,
+                                          void*                      data)
+{
+    const u32 data_offset = static_cast<u32>(push_constant_data.size());
+    push_constant_data.resize(data_offset + size);
+    memcpy(push_constant_data.data() + data_offset, data, size);
+
+    record(NullCommandType::PUSH_CONSTANT, static_cast<u32>(stage), size, offset, data_offset);
+}
+
+void NullCommandBuffer::clear(f32 red, f32 green, f32 blue, f32 alpha)
+{
+    record(NullCommandType::CLEAR,
+           std::bit_cast<u32>(red),
+           std::bit_cast<u32>(green),
+           std::bit_cast<u32>(blue),
+           std::bit_cast<u32>(alpha));
+}
+
+void NullCommandBuffer::clear_depth(const resources::Rect& rect)
+{
+    record(NullCommandType::CLEAR_DEPTH,
+           std::bit_cast<u32>(rect.offset_x),
+           std::bit_cast<u32>(rect.offset_y),
+           rect.w,
+           rect.h);
+}
+
+void NullCommandBuffer::draw(u32 first_vertex,
+                             u32 vertex_count,
+                             u32 first_instance,
+                             u32 instance_count)
+{
+    record(NullCommandType::DRAW, first_vertex, vertex_count, first_instance, instance_count);
+}
+
+void NullCommandBuffer::draw_indexed(u32 first_index,
+                                     u32 index_count,
+                                     u32 first_instance,
+                                     u32 instance_count,
+                                     u32 vertex_offset)
+{
+    record(NullCommandType::DRAW_INDEXED,
+           first_index,
+           index_count,
+           first_instance,
+           instance_count,
+           vertex_offset);
+}
+
+void NullCommandBuffer::bind_descriptor_set(const resources::DescriptorSetHandle& handle, u32 set)
+{
+    record(NullCommandType::BIND_DESCRIPTOR_SET, handle.id, set);
+}
+
+void NullCommandBuffer::bind_vertex_buffer(const resources::BufferHandle& handle,
+                                           const u32                      binding,
+                                           const u32                      offset)
+{
+    record(NullCommandType::BIND_VERTEX_BUFFER, handle.id, binding, offset);
+}
+
+void NullCommandBuffer::bind_index_buffer(const resources::BufferHandle& handle,
+                                          resources::BufferIndexType     index_type)
+{
+    record(NullCommandType::BIND_INDEX_BUFFER, handle.id, static_cast<u32>(index_type));
+}
+
+void NullCommandBuffer::begin_gpu_zone(const char* name)
+{
+    const u64 hash = hash_name(name);
+    record(NullCommandType::BEGIN_GPU_ZONE, low_bits(hash), high_bits(hash));
+}
+
+void NullCommandBuffer::end_gpu_zone()
+{
+    record(NullCommandType::END_GPU_ZONE);
+}
+
+void NullCommandBuffer::reset()
+{
+    commands.clear();
+    push_constant_data.clear();
+    memset(command_counts, 0, sizeof(command_counts));
+    pass_in_progress = false;
+}
+
+void NullCommandBuffer::record(NullCommandType type,
+                               u32             arg0,
+                               u32             arg1,
+                               u32             arg2,
+                               u32             arg3,
+                               u32             arg4)
+{
+    commands.push_back({type, {arg0, arg1, arg2, arg3, arg4}});
+    command_counts[static_cast<u32>(type)]++;
+}
+
+NullDevice::~NullDevice()
+{
+    shutdown();
+}
+
+void NullDevice::init(const DeviceDescriptor& /*descriptor*/)
+{
+    buffers.init(DEFAULT_RESOURCES_COUNT, sizeof(NullBuffer));
+    // A slot with data owns it, shutdown frees what was never destroyed.
+    memset(buffers.memory, 0, DEFAULT_RESOURCES_COUNT * sizeof(NullBuffer));
+    textures.init(DEFAULT_RESOURCES_COUNT, sizeof(NullTexture));
+    descriptor_sets.init(DEFAULT_RESOURCES_COUNT, sizeof(NullDescriptorSet));
+    descriptor_set_layouts.init(DEFAULT_RESOURCES_COUNT, sizeof(NullDescriptorSetLayout));
+    renderpasses.init(DEFAULT_RESOURCES_COUNT, sizeof(NullRenderPass));
+
+    // Same name the other devices give the pass drawing to the window.
+    const resources::RenderPassHandle swapchain_pass{renderpasses.get_resource()};
+    render_passes.insert({"Swapchain_renderpass", swapchain_pass});
+
+    auto swapchain  = access_render_pass(swapchain_pass.id);
+    *swapchain      = {};
+    swapchain->type = resources::RenderPassType::SWAPCHAIN;
+
+    command_buffer.device      = this;
+    last_frame_commands.device = this;
+    is_initialized             = true;
+
+    PINFO("Null device created, commands are recorded but nothing is rendered.");
+}
+
+void NullDevice::shutdown()
+{
+    if (!is_initialized)
+    {
+        return;
+    }
+
+    PINFO("Null device recorded %llu commands and %llu draws over %llu frames.",
+          total_commands,
+          total_draws,
+          frame_count);
+
+    // Only the buffers own memory. The free list is no record of the live ones once resources are
+    // released out of order, the data pointer is.
+    for (u32 i = 0; i < DEFAULT_RESOURCES_COUNT; ++i)
+    {
+        if (access_buffer(i)->data)
+        {
+            PWARN("Buffer %u not destroyed.", i);
+            destroy_buffer_immediate(i);
+        }
+    }
+
+    buffers.shutdown();
+    textures.shutdown();
+    descriptor_sets.shutdown();
+    descriptor_set_layouts.shutdown();
+
+    for (const auto& it : render_passes)
+    {
+        renderpasses.remove_resource(it.second.id);
+    }
+    renderpasses.shutdown();
+
+    render_passes.clear();
+    render_pass_cache.clear();
+    framebuffer_count = 0;
+    pipelines.clear();
+    pipeline_hashes.clear();
+    descriptor_set_cache.clear();
+    transient_descriptor_sets.clear();
+    is_initialized = false;
+}
+
+void NullDevice::resize(u32 /*width*/, u32 /*height*/)
+{
+}
+
+resources::BufferHandle NullDevice::create_buffer(const resources::BufferDescriptor& descriptor)
+{
+    resources::BufferHandle handle{buffers.get_resource()};
+    if (handle.id == INVALID_ID)
+    {
+        return handle;
+    }
+
+    auto buffer  = access_buffer(handle.id);
+    buffer->data = static_cast<u8*>(malloc(descriptor.size));
+    buffer->size = descriptor.size;
+    buffer->type = descriptor.type;
+
+    if (descriptor.data)
+    {
+        memcpy(buffer->data, descriptor.data, descriptor.size);
+    }
+    else
+    {
+        memset(buffer->data, 0, descriptor.size);
+    }
+
+    sogas::track_allocation(sogas::MemoryTag::GPU_MEMORY, buffer->size);
+    return handle;
+}
+
+resources::TextureHandle NullDevice::create_texture(const resources::TextureDescriptor& descriptor)
+{
+    resources::TextureHandle handle{textures.get_resource()};
+    if (handle.id == INVALID_ID)
+    {
+        return handle;
+    }
+
+    auto texture        = access_texture(handle.id);
+    texture->width      = descriptor.width;
+    texture->height     = descriptor.height;
+    texture->depth      = descriptor.depth;
+    texture->mip_levels    = descriptor.mip_levels;
+    texture->format        = descriptor.format;
+    texture->render_target = descriptor.render_target;
+    return handle;
+}
+
+resources::RenderPassHandle NullDevice::create_renderpass(
+  const resources::RenderPassDescriptor& descriptor)
+{
+    const bool has_depth = descriptor.depth_attachment.id != INVALID_ID;
+    ASSERT(descriptor.color_attachment_count > 0 || has_depth);
+
+    if (render_passes.contains(descriptor.name))
+    {
+        PWARN("Render pass %s already exists.", descriptor.name.c_str());
+        return render_passes.at(descriptor.name);
+    }
+
+    resources::RenderPassHandle handle{renderpasses.get_resource()};
+    if (handle.id == INVALID_ID)
+    {
+        return handle;
+    }
+
+    auto pass                    = access_render_pass(handle.id);
+    *pass                        = {};
+    pass->type                   = descriptor.type;
+    pass->layout                 = get_render_pass(descriptor);
+    pass->color_attachment_count = descriptor.color_attachment_count;
+    pass->has_depth              = has_depth;
+
+    // Every attachment is a render target the size of the first one.
+    const u32 attachment_count = descriptor.color_attachment_count + (has_depth ? 1 : 0);
+    for (u32 i = 0; i < attachment_count; ++i)
+    {
+        const bool is_depth = i == descriptor.color_attachment_count;
+        const auto attachment =
+          is_depth ? descriptor.depth_attachment : descriptor.color_attachments[i];
+        const auto texture = access_texture(attachment.id);
+        ASSERT(texture->render_target);
+
+        if (i == 0)
+        {
+            pass->width  = texture->width;
+            pass->height = texture->height;
+        }
+        ASSERT(texture->width == pass->width && texture->height == pass->height);
+
+        pass->attachments[i] = attachment;
+    }
+    framebuffer_count++;
+
+    render_passes.insert({descriptor.name, handle});
+    return handle;
+}
+
+resources::DescriptorSetLayoutHandle NullDevice::create_descriptor_set_layout(
+  const resources::DescriptorSetLayoutDescriptor& descriptor)
+{
+    resources::DescriptorSetLayoutHandle handle{descriptor_set_layouts.get_resource()};
+    if (handle.id != INVALID_ID)
+    {
+        auto layout             = access_descriptor_set_layout(handle.id);
+        layout->binding_count   = descriptor.binding_count;
+        layout->reference_count = 1;
+        for (u32 i = 0; i < descriptor.binding_count; ++i)
+        {
+            layout->bindings[i] = descriptor.bindings[i];
+        }
+    }
+
+    return handle;
+}
+
+resources::DescriptorSetHandle NullDevice::create_descriptor_set(
+  const resources::DescriptorSetDescriptor& descriptor)
+{
+    // Cached like on the other devices, so the handles and reference counts match theirs.
+    const auto layout = access_descriptor_set_layout(descriptor.layout_handle.id);
+    const auto key    = resources::get_descriptor_set_key(
+      descriptor, layout->bindings, layout->binding_count, buffers, textures);
+    const u64  hash   = resources::hash_descriptor_set(key);
+
+    const auto cached = descriptor_set_cache.find(hash);
+    if (!descriptor.transient && cached != descriptor_set_cache.end() &&
+        access_descriptor_set(cached->second.id)->key == key)
+    {
+        access_descriptor_set(cached->second.id)->reference_count++;
+        return cached->second;
+    }
+
+    const resources::DescriptorSetHandle handle{descriptor_sets.get_resource()};
+    if (handle.id == INVALID_ID)
+    {
+        return handle;
+    }
+
+    auto descriptor_set             = access_descriptor_set(handle.id);
+    descriptor_set->key             = key;
+    descriptor_set->hash            = hash;
+    descriptor_set->reference_count = 1;
+    descriptor_set->transient       = descriptor.transient;
+
+    if (descriptor.transient)
+    {
+        transient_descriptor_sets.push_back(handle.id);
+    }
+    else
+    {
+        descriptor_set_cache.insert({hash, handle});
+    }
+
+    return handle;
+}
+
+void NullDevice::create_pipeline(const resources::PipelineDescriptor& descriptor)
+{
+    create_pipelines({&descriptor, 1});
+}
+
+void NullDevice::create_pipelines(std::span<const resources::PipelineDescriptor> descriptors)
+{
+    for (const auto& descriptor : descriptors)
+    {
+        pipeline_hashes.insert(resources::hash_pipeline(descriptor));
+        if (descriptor.name)
+        {
+            pipelines.insert(descriptor.name);
+        }
+    }
+}
+
+void NullDevice::begin_frame()
+{
+    for (auto handle : transient_descriptor_sets)
+    {
+        descriptor_sets.remove_resource(handle);
+    }
+    transient_descriptor_sets.clear();
+}
+
+void NullDevice::end_frame()
+{
+    command_buffer.end_pass();
+
+    total_commands += command_buffer.commands.size();
+    total_draws += command_buffer.get_command_count(NullCommandType::DRAW) +
+                   command_buffer.get_command_count(NullCommandType::DRAW_INDEXED);
+    frame_count++;
+
+    // Keeps the frame readable until the next one ends, recording reuses the older buffer.
+    std::swap(command_buffer, last_frame_commands);
+    command_buffer.reset();
+}
+
+u32 NullDevice::get_frame_index() const
+{
+    return static_cast<u32>(frame_count % MAX_FRAMES_IN_FLIGHT);
+}
+
+bool NullDevice::is_bindless_supported() const
+{
+    return false;
+}
+
+resources::DescriptorSetLayoutHandle NullDevice::get_bindless_set_layout() const
+{
+    return resources::invalid_descriptor_set_layout;
+}
+
+resources::DescriptorSetHandle NullDevice::get_bindless_set() const
+{
+    return resources::invalid_descriptor_set;
+}
+
+resources::CommandBuffer* NullDevice::get_command_buffer(bool begin)
+{
+    if (begin)
+    {
+        command_buffer.reset();
+    }
+
+    return &command_buffer;
+}
+
+const std::vector<resources::GPUZone>& NullDevice::get_gpu_zones() const
+{
+    return gpu_zones;
+}
+
+void* NullDevice::map_buffer(const resources::BufferHandle handle,
+                             const u32                     size,
+                             const u32                     offset)
+{
+    ASSERT(handle.id != INVALID_ID);
+    ASSERT(size > 0);
+
+    auto buffer = access_buffer(handle.id);
+    ASSERT(offset + size <= buffer->size);
+    UNUSED(size);
+
+    return buffer->data + offset;
+}
+
+void NullDevice::unmap_buffer(const resources::BufferHandle handle)
+{
+    ASSERT(handle.id != INVALID_ID);
+    UNUSED(handle);
+}
+
+void NullDevice::copy_buffer(const resources::BufferHandle src_buffer_handle,
+                             const resources::BufferHandle dst_buffer_handle,
+                             const u32                     size,
+                             const u32                     src_offset,
+                             const u32                     dst_offset)
+{
+    const auto src_buffer = access_buffer(src_buffer_handle.id);
+    const auto dst_buffer = access_buffer(dst_buffer_handle.id);
+    ASSERT(src_offset + size <= src_buffer->size);
+    ASSERT(dst_offset + size <= dst_buffer->size);
+
+    memcpy(dst_buffer->data + dst_offset, src_buffer->data + src_offset, size);
+}
+
+void NullDevice::copy_buffer_to_image(const resources::BufferHandle  buffer_handle,
+                                      const resources::TextureHandle texture_handle,
+                                      const u32                      width,
+                                      const u32                      height)
+{
+    ASSERT(buffer_handle.id != INVALID_ID);
+    ASSERT(texture_handle.id != INVALID_ID);
+    UNUSED(buffer_handle);
+    UNUSED(texture_handle);
+    UNUSED(width);
+    UNUSED(height);
+}
+
+void NullDevice::destroy_buffer(resources::BufferHandle handle)
+{
+    destroy_buffer_immediate(handle.id);
+}
+
+void NullDevice::destroy_texture(resources::TextureHandle handle)
+{
+    destroy_texture_immediate(handle.id);
+}
+
+void NullDevice::destroy_descriptor_set(resources::DescriptorSetHandle handle)
+{
+    auto descriptor_set = access_descriptor_set(handle.id);
+    if (descriptor_set->transient)
+    {
+        return;
+    }
+
+    ASSERT(descriptor_set->reference_count > 0);
+    if (--descriptor_set->reference_count > 0)
+    {
+        return;
+    }
+
+    const auto cached = descriptor_set_cache.find(descriptor_set->hash);
+    if (cached != descriptor_set_cache.end() && cached->second.id == handle.id)
+    {
+        descriptor_set_cache.erase(cached);
+    }
+    destroy_descriptor_set_immediate(handle.id);
+}
+
+void NullDevice::destroy_descriptor_set_layout(resources::DescriptorSetLayoutHandle handle)
+{
+    auto layout = access_descriptor_set_layout(handle.id);
+    ASSERT(layout->reference_count > 0);
+
+    if (--layout->reference_count > 0)
+    {
+        return;
+    }
+
+    destroy_descriptor_set_layout_immediate(handle.id);
+}
+
+void NullDevice::destroy_buffer_immediate(resources::ResourceHandle handle)
+{
+    const auto buffer = access_buffer(handle);
+
+    free(buffer->data);
+    buffer->data = nullptr;
+    sogas::track_deallocation(sogas::MemoryTag::GPU_MEMORY, buffer->size);
+
+    buffers.remove_resource(handle);
+}
+
+void NullDevice::destroy_texture_immediate(resources::ResourceHandle handle)
+{
+    textures.remove_resource(handle);
+}
+
+void NullDevice::destroy_descriptor_set_immediate(resources::ResourceHandle handle)
+{
+    descriptor_sets.remove_resource(handle);
+}
+
+void NullDevice::destroy_descriptor_set_layout_immediate(resources::ResourceHandle handle)
+{
+    descriptor_set_layouts.remove_resource(handle);
+}
+
+bool NullDevice::has_render_pass(const std::string& name) const
+{
+    return render_passes.contains(name);
+}
+
+bool NullDevice::has_pipeline(const std::string& name) const
+{
+    return pipelines.contains(name);
+}
+
+NullBuffer* NullDevice::access_buffer(resources::ResourceHandle handle)
+{
+    return static_cast<NullBuffer*>(buffers.access_resource(handle));
+}
+
+NullTexture* NullDevice::access_texture(resources::ResourceHandle handle)
+{
+    return static_cast<NullTexture*>(textures.access_resource(handle));
+}
+
+NullRenderPass* NullDevice::access_render_pass(resources::ResourceHandle handle)
+{
+    return static_cast<NullRenderPass*>(renderpasses.access_resource(handle));
+}
+
+u64 NullDevice::get_render_pass(const resources::RenderPassDescriptor& descriptor)
+{
+    const bool has_depth = descriptor.depth_attachment.id != INVALID_ID;
+
+    u64 hash = resources::hash_combine(resources::HASH_SEED, descriptor.color_attachment_count);
+    hash     = resources::hash_combine(hash, has_depth);
+
+    const u32 attachment_count = descriptor.color_attachment_count + (has_depth ? 1 : 0);
+    for (u32 i = 0; i < attachment_count; ++i)
+    {
+        const bool is_depth  = i == descriptor.color_attachment_count;
+        const auto texture   = access_texture(is_depth ? descriptor.depth_attachment.id :
+                                                         descriptor.color_attachments[i].id);
+        const auto operation = is_depth ? descriptor.depth_operation : descriptor.color_operation;
+
+        hash = resources::hash_combine(hash, static_cast<u64>(texture->format));
+        hash = resources::hash_combine(hash, static_cast<u64>(operation));
+    }
+
+    render_pass_cache.insert(hash);
+    return hash;
+}
+
+NullDescriptorSet* NullDevice::access_descriptor_set(resources::ResourceHandle handle)
+{
+    return static_cast<NullDescriptorSet*>(descriptor_sets.access_resource(handle));
+}
+
+NullDescriptorSetLayout* NullDevice::access_descriptor_set_layout(
+  resources::ResourceHandle handle)
+{
+    return static_cast<NullDescriptorSetLayout*>(descriptor_set_layouts.access_resource(handle));
+}
+} // namespace null
+} // namespace pinut
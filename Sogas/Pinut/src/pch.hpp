@@ -14,5 +14,6 @@
 // Project
 #include <defines.h>
 #include <logger.h>
+#include <memory_tracker.h>
 
-#endif PCH_HPP //PCH_HPP
+#endif //PCH_HPP
@@ -1,7 +1,10 @@
 #include "pch.hpp"
 
+#include <null/null_device.h>
 #include <render_device.h>
+#ifdef PINUT_VULKAN
 #include <vulkan/vulkan_device.h>
+#endif
 
 namespace pinut
 {
@@ -14,18 +17,38 @@ DeviceDescriptor& DeviceDescriptor::set_window(u32 width_, u32 height_, void* wi
     return *this;
 }
 
+DeviceDescriptor& DeviceDescriptor::set_pipeline_cache(const char* path)
+{
+    pipeline_cache_path = path;
+
+    return *this;
+}
+
+#ifdef PINUT_VULKAN
 static GPUDevice* create_vulkan_device()
 {
     return new vulkan::VulkanDevice();
 }
+#endif
+
+static GPUDevice* create_null_device()
+{
+    return new null::NullDevice();
+}
 
 GPUDevice* GPUDevice::create(GraphicsAPI api)
 {
     switch (api)
     {
+#ifdef PINUT_VULKAN
         case GraphicsAPI::Vulkan:
             return create_vulkan_device();
             break;
+#endif
+
+        case GraphicsAPI::Null:
+            return create_null_device();
+            break;
 
         default:
             PFATAL("No valid graphics API.");
@@ -0,0 +1,106 @@
+#include "pch.hpp"
+
+#include <resources/cooked_texture.h>
+
+#include <cstring>
+#include <fstream>
+
+namespace pinut
+{
+namespace resources
+{
+CookedTextureHeader make_cooked_texture_header(TextureFormat format,
+                                               u32           width,
+                                               u32           height,
+                                               u32           mip_levels)
+{
+    ASSERT(mip_levels > 0 && mip_levels <= MAX_TEXTURE_MIPS);
+
+    CookedTextureHeader header = {};
+    header.format              = format;
+    header.width               = width;
+    header.height              = height;
+    header.mip_levels          = mip_levels;
+
+    for (u32 level = 0; level < mip_levels; ++level)
+    {
+        header.level_offsets[level] = header.data_size;
+        header.level_sizes[level]   = get_mip_size(format,
+                                                 get_mip_dimension(width, level),
+                                                 get_mip_dimension(height, level));
+        header.data_size += header.level_sizes[level];
+    }
+
+    return header;
+}
+
+bool write_cooked_texture(const std::string&         filename,
+                          const CookedTextureHeader& header,
+                          const void*                data)
+{
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        PERROR("Failed to open %s for writing.", filename.c_str());
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(static_cast<const char*>(data), static_cast<std::streamsize>(header.data_size));
+    return file.good();
+}
+
+bool parse_cooked_texture(const void*          blob,
+                          u64                  blob_size,
+                          CookedTextureHeader& out_header,
+                          const u8*&           out_data)
+{
+    if (blob == nullptr || blob_size < sizeof(CookedTextureHeader))
+    {
+        PERROR("Cooked texture blob too small.");
+        return false;
+    }
+
+    memcpy(&out_header, blob, sizeof(CookedTextureHeader));
+
+    if (out_header.magic != CookedTextureHeader::MAGIC ||
+        out_header.version != CookedTextureHeader::VERSION)
+    {
+        PERROR("Not a cooked texture or unsupported version.");
+        return false;
+    }
+
+    if (out_header.mip_levels == 0 || out_header.mip_levels > MAX_TEXTURE_MIPS ||
+        out_header.format >= TextureFormat::COUNT)
+    {
+        PERROR("Malformed cooked texture header.");
+        return false;
+    }
+
+    const auto expected = make_cooked_texture_header(out_header.format,
+                                                     out_header.width,
+                                                     out_header.height,
+                                                     out_header.mip_levels);
+    if (expected.data_size != out_header.data_size ||
+        blob_size < sizeof(CookedTextureHeader) + out_header.data_size)
+    {
+        PERROR("Cooked texture data size mismatch.");
+        return false;
+    }
+
+    out_data = static_cast<const u8*>(blob) + sizeof(CookedTextureHeader);
+    return true;
+}
+
+TextureDescriptor get_cooked_texture_descriptor(const CookedTextureHeader& header,
+                                                const u8*                  data)
+{
+    TextureDescriptor descriptor = {};
+    descriptor.set_size(static_cast<u16>(header.width), static_cast<u16>(header.height))
+      .set_format(header.format)
+      .set_mips(static_cast<u8>(header.mip_levels), false);
+    descriptor.data = const_cast<u8*>(data);
+    return descriptor;
+}
+} // namespace resources
+} // namespace pinut
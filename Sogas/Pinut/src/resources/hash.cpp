@@ -0,0 +1,208 @@
+#include "pch.hpp"
+
+#include <cstring>
+
+#include <resources/hash.h>
+#include <resources/pipeline.h>
+#include <resources/resource_pool.h>
+#include <resources/shader_state.h>
+#include <resources/texture.h>
+
+namespace pinut
+{
+namespace resources
+{
+static const u64 HASH_PRIME = 0x100000001b3;
+
+template <typename T>
+static u64 hash_value(const T& value, const u64 seed)
+{
+    return hash_bytes(&value, sizeof(T), seed);
+}
+
+u64 hash_bytes(const void* data, const u64 size, const u64 seed)
+{
+    const u8* bytes = static_cast<const u8*>(data);
+    u64       hash  = seed;
+
+    for (u64 i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= HASH_PRIME;
+    }
+
+    return hash;
+}
+
+u64 hash_combine(const u64 seed, const u64 value)
+{
+    return hash_value(value, seed);
+}
+
+u64 hash_shader_state(const ShaderStateDescriptor& descriptor, const u64 seed)
+{
+    u64 hash = seed;
+    for (u32 i = 0; i < static_cast<u32>(ShaderStageType::MAX_SHADER_TYPE); ++i)
+    {
+        const auto& stage = descriptor.shader_stages[i];
+        hash              = hash_value(i, hash);
+        hash              = hash_value(stage.code.size(), hash);
+        hash              = hash_bytes(stage.code.data(), stage.code.size() * sizeof(u32), hash);
+    }
+
+    return hash;
+}
+
+u64 hash_descriptor_set_layout(const DescriptorSetLayoutDescriptor& descriptor, const u64 seed)
+{
+    u64 hash = hash_value(descriptor.binding_count, seed);
+    hash     = hash_value(descriptor.bindless, hash);
+    for (u32 i = 0; i < descriptor.binding_count; ++i)
+    {
+        const auto& binding = descriptor.bindings[i];
+        hash                = hash_value(binding.binding, hash);
+        hash                = hash_value(binding.count, hash);
+        hash                = hash_value(binding.shader_stage, hash);
+        hash                = hash_value(binding.descriptor_type, hash);
+    }
+
+    return hash;
+}
+
+u64 hash_descriptor_set(const DescriptorSetKey& key)
+{
+    u64 hash = hash_value(key.layout, HASH_SEED);
+    hash     = hash_value(key.resources_used, hash);
+    for (u32 i = 0; i < key.resources_used; ++i)
+    {
+        hash = hash_value(key.bindings[i], hash);
+        hash = hash_value(key.resources[i], hash);
+        hash = hash_value(key.generations[i], hash);
+    }
+
+    return hash;
+}
+
+static bool is_image_descriptor(DescriptorType type)
+{
+    switch (type)
+    {
+        case DescriptorType::COMBINED_IMAGE_SAMPLER:
+        case DescriptorType::SAMPLED_IMAGE:
+        case DescriptorType::STORAGE_IMAGE:
+        case DescriptorType::INPUT_ATTACHMENT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+DescriptorSetKey get_descriptor_set_key(const DescriptorSetDescriptor&        descriptor,
+                                        const DescriptorSetBindingDescriptor* layout_bindings,
+                                        u32                                   layout_binding_count,
+                                        const ResourcePool&                   buffers,
+                                        const ResourcePool&                   textures)
+{
+    DescriptorSetKey key = {};
+    key.layout           = descriptor.layout_handle.id;
+    key.resources_used   = descriptor.resources_used;
+
+    for (u32 i = 0; i < descriptor.resources_used; ++i)
+    {
+        key.bindings[i]  = descriptor.bindings[i];
+        key.resources[i] = descriptor.resources[i];
+
+        for (u32 j = 0; j < layout_binding_count; ++j)
+        {
+            if (layout_bindings[j].binding != descriptor.bindings[i])
+            {
+                continue;
+            }
+
+            const auto  type   = layout_bindings[j].descriptor_type;
+            const auto& pool   = is_image_descriptor(type) ? textures : buffers;
+            key.generations[i] = pool.get_generation(descriptor.resources[i]);
+            break;
+        }
+    }
+
+    return key;
+}
+
+u64 hash_pipeline_layout(const PipelineDescriptor& descriptor)
+{
+    u64 hash = hash_value(descriptor.layouts_count, HASH_SEED);
+    for (u32 i = 0; i < descriptor.layouts_count; ++i)
+    {
+        hash = hash_value(descriptor.descriptor_set_layouts[i].id, hash);
+    }
+
+    hash = hash_value(descriptor.push_constant_count, hash);
+    for (u32 i = 0; i < descriptor.push_constant_count; ++i)
+    {
+        const auto& push_constant = descriptor.push_constants[i];
+        hash                      = hash_value(push_constant.stage, hash);
+        hash                      = hash_value(push_constant.size, hash);
+        hash                      = hash_value(push_constant.offset, hash);
+    }
+
+    return hash;
+}
+
+u64 hash_pipeline(const PipelineDescriptor& descriptor)
+{
+    u64 hash = hash_shader_state(descriptor.shader_state, hash_pipeline_layout(descriptor));
+
+    const auto& raster = descriptor.rasterization;
+    hash               = hash_value(raster.cull_mode, hash);
+    hash               = hash_value(raster.front_face, hash);
+    hash               = hash_value(raster.fill_mode, hash);
+    hash               = hash_value(raster.line_width, hash);
+
+    const auto& depth_stencil = descriptor.depth_stencil;
+    hash                      = hash_value(depth_stencil.depth_test, hash);
+    hash                      = hash_value(depth_stencil.depth_write, hash);
+    hash                      = hash_value(depth_stencil.depth_compare, hash);
+
+    const auto& vertex_input = descriptor.vertex_input;
+    hash                     = hash_value(vertex_input.stream_count, hash);
+    for (u32 i = 0; i < vertex_input.stream_count; ++i)
+    {
+        hash = hash_value(vertex_input.streams[i].binding, hash);
+        hash = hash_value(vertex_input.streams[i].stride, hash);
+        hash = hash_value(vertex_input.streams[i].input_rate, hash);
+    }
+
+    hash = hash_value(vertex_input.attribute_count, hash);
+    for (u32 i = 0; i < vertex_input.attribute_count; ++i)
+    {
+        hash = hash_value(vertex_input.attributes[i].location, hash);
+        hash = hash_value(vertex_input.attributes[i].binding, hash);
+        hash = hash_value(vertex_input.attributes[i].offset, hash);
+        hash = hash_value(vertex_input.attributes[i].format_type, hash);
+    }
+
+    // Attachment formats are only known to the device, the pass name stands for them.
+    if (descriptor.render_pass)
+    {
+        hash = hash_bytes(descriptor.render_pass, strlen(descriptor.render_pass), hash);
+    }
+
+    return hash_value(descriptor.topology, hash);
+}
+
+u64 hash_sampler(const SamplerDescriptor& descriptor)
+{
+    u64 hash = hash_value(descriptor.min_filter, HASH_SEED);
+    hash     = hash_value(descriptor.mag_filter, hash);
+    hash     = hash_value(descriptor.mip_filter, hash);
+    hash     = hash_value(descriptor.address_u, hash);
+    hash     = hash_value(descriptor.address_v, hash);
+    hash     = hash_value(descriptor.address_w, hash);
+    hash     = hash_value(descriptor.anisotropy, hash);
+    hash     = hash_value(descriptor.mip_lod_bias, hash);
+    hash     = hash_value(descriptor.min_lod, hash);
+    return hash_value(descriptor.max_lod, hash);
+}
+} // namespace resources
+} // namespace pinut
@@ -11,7 +11,7 @@ void ResourcePool::init(const u64 new_pool_size, const u64 new_resource_size)
     pool_size     = new_pool_size;
     resource_size = new_resource_size;
 
-    const u64 allocation_size = pool_size * (resource_size + sizeof(u32));
+    const u64 allocation_size = pool_size * (resource_size + 2 * sizeof(u32));
     memory                    = (u8*)malloc(allocation_size);
 
     if (!memory)
@@ -19,12 +19,16 @@ void ResourcePool::init(const u64 new_pool_size, const u64 new_resource_size)
         throw std::runtime_error("Not enought memory in resource pool.");
     }
 
+    track_allocation(sogas::MemoryTag::GPU_RESOURCES, allocation_size);
+
     free_indices      = (u32*)(memory + pool_size * resource_size);
+    generations       = free_indices + pool_size;
     free_indices_head = 0;
 
     for (u32 i = 0; i < pool_size; ++i)
     {
         free_indices[i] = i;
+        generations[i]  = 0;
     }
 
     used_indices = 0;
@@ -44,6 +48,8 @@ void ResourcePool::shutdown()
     ASSERT(used_indices == 0);
 
     free(memory);
+    track_deallocation(sogas::MemoryTag::GPU_RESOURCES,
+                       pool_size * (resource_size + 2 * sizeof(u32)));
 }
 
 u32 ResourcePool::get_resource()
@@ -62,6 +68,7 @@ void ResourcePool::remove_resource(const u32 resource)
 {
     free_indices[--free_indices_head] = resource;
     --used_indices;
+    ++generations[resource];
 }
 
 void ResourcePool::remove_all()
@@ -72,6 +79,7 @@ void ResourcePool::remove_all()
     for (u32 i = 0; i < pool_size; ++i)
     {
         free_indices[i] = i;
+        ++generations[i];
     }
 }
 
@@ -98,5 +106,11 @@ const void* ResourcePool::access_resource(u32 index) const
 
     return nullptr;
 }
+
+u32 ResourcePool::get_generation(u32 index) const
+{
+    ASSERT(index < pool_size);
+    return generations[index];
+}
 } // namespace resources
 } // namespace pinut
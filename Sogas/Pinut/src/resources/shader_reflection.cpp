@@ -0,0 +1,502 @@
+#include "pch.hpp"
+
+#include <resources/shader_reflection.h>
+
+namespace pinut
+{
+namespace resources
+{
+// Subset of the SPIR-V specification needed to read a shader interface.
+namespace spirv
+{
+static const u32 MAGIC_NUMBER = 0x07230203;
+
+static const u32 OP_TYPE_BOOL        = 20;
+static const u32 OP_TYPE_INT         = 21;
+static const u32 OP_TYPE_FLOAT       = 22;
+static const u32 OP_TYPE_VECTOR      = 23;
+static const u32 OP_TYPE_MATRIX      = 24;
+static const u32 OP_TYPE_IMAGE       = 25;
+static const u32 OP_TYPE_SAMPLER     = 26;
+static const u32 OP_TYPE_SAMPLED_IMG = 27;
+static const u32 OP_TYPE_ARRAY       = 28;
+static const u32 OP_TYPE_RUNTIME_ARR = 29;
+static const u32 OP_TYPE_STRUCT      = 30;
+static const u32 OP_TYPE_POINTER     = 32;
+static const u32 OP_CONSTANT         = 43;
+static const u32 OP_FUNCTION         = 54;
+static const u32 OP_VARIABLE         = 59;
+static const u32 OP_DECORATE         = 71;
+static const u32 OP_MEMBER_DECORATE  = 72;
+
+static const u32 DECORATION_BLOCK         = 2;
+static const u32 DECORATION_BUFFER_BLOCK  = 3;
+static const u32 DECORATION_ARRAY_STRIDE  = 6;
+static const u32 DECORATION_MATRIX_STRIDE = 7;
+static const u32 DECORATION_BUILTIN       = 11;
+static const u32 DECORATION_LOCATION      = 30;
+static const u32 DECORATION_BINDING       = 33;
+static const u32 DECORATION_SET           = 34;
+static const u32 DECORATION_OFFSET        = 35;
+
+static const u32 STORAGE_UNIFORM_CONSTANT = 0;
+static const u32 STORAGE_INPUT            = 1;
+static const u32 STORAGE_UNIFORM          = 2;
+static const u32 STORAGE_PUSH_CONSTANT    = 9;
+static const u32 STORAGE_STORAGE_BUFFER   = 12;
+
+struct Id
+{
+    u32  opcode        = 0;
+    u32  type          = 0; // Pointee, element, component or column type.
+    u32  storage_class = 0;
+    u32  count         = 0; // Vector or matrix size, array length id or scalar width.
+    u32  value         = 0; // Constants, image sampled flag and int signedness.
+    u32  set           = INVALID_ID;
+    u32  binding       = INVALID_ID;
+    u32  location      = INVALID_ID;
+    u32  array_stride  = 0;
+    bool builtin       = false;
+    bool block         = false;
+    bool buffer_block  = false;
+
+    std::vector<u32> members;
+    std::vector<u32> member_offsets;
+    std::vector<u32> member_matrix_strides;
+};
+} // namespace spirv
+
+using SpirvIds = std::vector<spirv::Id>;
+
+static u32 get_type_size(const SpirvIds& ids, u32 type_id, u32 matrix_stride = 0)
+{
+    const auto& type = ids.at(type_id);
+    switch (type.opcode)
+    {
+        case spirv::OP_TYPE_BOOL:
+            return 4;
+        case spirv::OP_TYPE_INT:
+        case spirv::OP_TYPE_FLOAT:
+            return type.count / 8;
+        case spirv::OP_TYPE_VECTOR:
+            return type.count * get_type_size(ids, type.type);
+        case spirv::OP_TYPE_MATRIX:
+            return type.count * (matrix_stride ? matrix_stride : get_type_size(ids, type.type));
+        case spirv::OP_TYPE_ARRAY:
+        {
+            const u32 element_size =
+              type.array_stride ? type.array_stride : get_type_size(ids, type.type);
+            return ids.at(type.count).value * element_size;
+        }
+        case spirv::OP_TYPE_STRUCT:
+        {
+            u32 size = 0;
+            for (size_t i = 0; i < type.members.size(); ++i)
+            {
+                const u32 member_size =
+                  get_type_size(ids, type.members.at(i), type.member_matrix_strides.at(i));
+                size = std::max(size, type.member_offsets.at(i) + member_size);
+            }
+            return size;
+        }
+        default:
+            return 0;
+    }
+}
+
+static bool get_vertex_format(const SpirvIds& ids, u32 type_id, VertexInputFormatType& out_format)
+{
+    const auto& type = ids.at(type_id);
+    switch (type.opcode)
+    {
+        case spirv::OP_TYPE_FLOAT:
+            out_format = VertexInputFormatType::FLOAT;
+            return true;
+        case spirv::OP_TYPE_INT:
+            out_format = type.value ? VertexInputFormatType::INT : VertexInputFormatType::UINT;
+            return true;
+        case spirv::OP_TYPE_BOOL:
+            out_format = VertexInputFormatType::BOOL;
+            return true;
+        case spirv::OP_TYPE_VECTOR:
+            if (ids.at(type.type).opcode == spirv::OP_TYPE_FLOAT && type.count >= 2)
+            {
+                static const VertexInputFormatType vector_formats[] = {VertexInputFormatType::VEC2,
+                                                                       VertexInputFormatType::VEC3,
+                                                                       VertexInputFormatType::VEC4};
+                out_format = vector_formats[type.count - 2];
+                return true;
+            }
+            [[fallthrough]];
+        default:
+            return false;
+    }
+}
+
+static bool get_descriptor_type(const SpirvIds&  ids,
+                                const spirv::Id& variable,
+                                u32&             out_count,
+                                DescriptorType&  out_type)
+{
+    u32 type_id = ids.at(variable.type).type;
+    out_count   = 1;
+
+    // Arrays of resources become a single binding with several descriptors.
+    while (ids.at(type_id).opcode == spirv::OP_TYPE_ARRAY ||
+           ids.at(type_id).opcode == spirv::OP_TYPE_RUNTIME_ARR)
+    {
+        const auto& array = ids.at(type_id);
+        // Unsized arrays report a count of 0, the size is decided when creating the layout.
+        out_count =
+          array.opcode == spirv::OP_TYPE_ARRAY ? out_count * ids.at(array.count).value : 0;
+        type_id = array.type;
+    }
+
+    const auto& type = ids.at(type_id);
+    switch (variable.storage_class)
+    {
+        case spirv::STORAGE_UNIFORM:
+            out_type = type.buffer_block ? DescriptorType::STORAGE : DescriptorType::UNIFORM;
+            return true;
+        case spirv::STORAGE_STORAGE_BUFFER:
+            out_type = DescriptorType::STORAGE;
+            return true;
+        case spirv::STORAGE_UNIFORM_CONSTANT:
+            switch (type.opcode)
+            {
+                case spirv::OP_TYPE_SAMPLED_IMG:
+                    out_type = DescriptorType::COMBINED_IMAGE_SAMPLER;
+                    return true;
+                case spirv::OP_TYPE_SAMPLER:
+                    out_type = DescriptorType::SAMPLER;
+                    return true;
+                case spirv::OP_TYPE_IMAGE:
+                    out_type = type.value == 2 ? DescriptorType::STORAGE_IMAGE :
+                                                 DescriptorType::SAMPLED_IMAGE;
+                    return true;
+                default:
+                    return false;
+            }
+        default:
+            return false;
+    }
+}
+
+static bool add_binding(ShaderReflection&                     reflection,
+                        u32                                   set,
+                        const DescriptorSetBindingDescriptor& binding)
+{
+    if (set >= MAX_REFLECTED_SETS)
+    {
+        PERROR("Descriptor set %u out of reflection range.", set);
+        return false;
+    }
+
+    reflection.set_count = std::max(reflection.set_count, set + 1);
+    auto& layout         = reflection.set_layouts[set];
+
+    for (u32 i = 0; i < layout.binding_count; ++i)
+    {
+        auto& existing = layout.bindings[i];
+        if (existing.binding != binding.binding)
+        {
+            continue;
+        }
+
+        if (existing.descriptor_type != binding.descriptor_type)
+        {
+            PERROR("Binding %u of set %u declared with different types.", binding.binding, set);
+            return false;
+        }
+
+        if (existing.shader_stage != binding.shader_stage)
+        {
+            existing.shader_stage = ShaderStageType::ALL_GRAPHICS;
+        }
+        existing.count = std::max(existing.count, binding.count);
+        return true;
+    }
+
+    layout.add_binding(binding);
+
+    // Keep bindings sorted so the same interface always produces the same layout hash.
+    std::sort(layout.bindings,
+              layout.bindings + layout.binding_count,
+              [](const auto& a, const auto& b) { return a.binding < b.binding; });
+    return true;
+}
+
+static void add_push_constant(ShaderReflection& reflection, const PushConstantDescriptor& range)
+{
+    auto& push_constant = reflection.push_constant;
+    if (push_constant.size == 0)
+    {
+        push_constant = range;
+        return;
+    }
+
+    const u32 end =
+      std::max(push_constant.offset + push_constant.size, range.offset + range.size);
+    push_constant.offset = std::min(push_constant.offset, range.offset);
+    push_constant.size   = end - push_constant.offset;
+    if (push_constant.stage != range.stage)
+    {
+        push_constant.stage = ShaderStageType::ALL_GRAPHICS;
+    }
+}
+
+bool reflect_shader(const ShaderStage& stage, ShaderReflection& out_reflection)
+{
+    const auto& code = stage.code;
+    if (code.size() < 5 || code.at(0) != spirv::MAGIC_NUMBER)
+    {
+        PERROR("Invalid SPIR-V module.");
+        return false;
+    }
+
+    SpirvIds ids(code.at(3));
+
+    // Declarations always come before the first function, no need to look further.
+    for (size_t word = 5; word < code.size();)
+    {
+        const u32  opcode     = code.at(word) & 0xFFFF;
+        const u32  word_count = code.at(word) >> 16;
+        const u32* args       = &code.at(word);
+
+        if (word_count == 0 || word + word_count > code.size())
+        {
+            PERROR("Malformed SPIR-V instruction at word %zu.", word);
+            return false;
+        }
+
+        if (opcode == spirv::OP_FUNCTION)
+        {
+            break;
+        }
+
+        switch (opcode)
+        {
+            case spirv::OP_DECORATE:
+            {
+                auto& id = ids.at(args[1]);
+                switch (args[2])
+                {
+                    case spirv::DECORATION_BLOCK:
+                        id.block = true;
+                        break;
+                    case spirv::DECORATION_BUFFER_BLOCK:
+                        id.buffer_block = true;
+                        break;
+                    case spirv::DECORATION_ARRAY_STRIDE:
+                        id.array_stride = args[3];
+                        break;
+                    case spirv::DECORATION_BUILTIN:
+                        id.builtin = true;
+                        break;
+                    case spirv::DECORATION_LOCATION:
+                        id.location = args[3];
+                        break;
+                    case spirv::DECORATION_BINDING:
+                        id.binding = args[3];
+                        break;
+                    case spirv::DECORATION_SET:
+                        id.set = args[3];
+                        break;
+                }
+                break;
+            }
+            case spirv::OP_MEMBER_DECORATE:
+            {
+                auto&     id     = ids.at(args[1]);
+                const u32 member = args[2];
+                if (id.member_offsets.size() <= member)
+                {
+                    id.member_offsets.resize(member + 1, 0);
+                    id.member_matrix_strides.resize(member + 1, 0);
+                }
+
+                if (args[3] == spirv::DECORATION_OFFSET)
+                {
+                    id.member_offsets.at(member) = args[4];
+                }
+                else if (args[3] == spirv::DECORATION_MATRIX_STRIDE)
+                {
+                    id.member_matrix_strides.at(member) = args[4];
+                }
+                else if (args[3] == spirv::DECORATION_BUILTIN)
+                {
+                    id.builtin = true;
+                }
+                break;
+            }
+            case spirv::OP_TYPE_BOOL:
+            case spirv::OP_TYPE_SAMPLER:
+                ids.at(args[1]).opcode = opcode;
+                break;
+            case spirv::OP_TYPE_INT:
+                ids.at(args[1]).opcode = opcode;
+                ids.at(args[1]).count  = args[2];
+                ids.at(args[1]).value  = args[3];
+                break;
+            case spirv::OP_TYPE_FLOAT:
+                ids.at(args[1]).opcode = opcode;
+                ids.at(args[1]).count  = args[2];
+                break;
+            case spirv::OP_TYPE_VECTOR:
+            case spirv::OP_TYPE_MATRIX:
+            case spirv::OP_TYPE_ARRAY:
+                ids.at(args[1]).opcode = opcode;
+                ids.at(args[1]).type   = args[2];
+                ids.at(args[1]).count  = args[3];
+                break;
+            case spirv::OP_TYPE_IMAGE:
+                ids.at(args[1]).opcode = opcode;
+                ids.at(args[1]).type   = args[2];
+                ids.at(args[1]).value  = args[7];
+                break;
+            case spirv::OP_TYPE_SAMPLED_IMG:
+            case spirv::OP_TYPE_RUNTIME_ARR:
+                ids.at(args[1]).opcode = opcode;
+                ids.at(args[1]).type   = args[2];
+                break;
+            case spirv::OP_TYPE_STRUCT:
+            {
+                auto& id  = ids.at(args[1]);
+                id.opcode = opcode;
+                id.members.assign(args + 2, args + word_count);
+                id.member_offsets.resize(id.members.size(), 0);
+                id.member_matrix_strides.resize(id.members.size(), 0);
+                break;
+            }
+            case spirv::OP_TYPE_POINTER:
+                ids.at(args[1]).opcode        = opcode;
+                ids.at(args[1]).storage_class = args[2];
+                ids.at(args[1]).type          = args[3];
+                break;
+            case spirv::OP_CONSTANT:
+                ids.at(args[2]).opcode = opcode;
+                ids.at(args[2]).type   = args[1];
+                ids.at(args[2]).value  = args[3];
+                break;
+            case spirv::OP_VARIABLE:
+                ids.at(args[2]).opcode        = opcode;
+                ids.at(args[2]).type          = args[1];
+                ids.at(args[2]).storage_class = args[3];
+                break;
+        }
+
+        word += word_count;
+    }
+
+    struct VertexInput
+    {
+        u32                   location;
+        VertexInputFormatType format;
+        u32                   size;
+    };
+    std::vector<VertexInput> vertex_inputs;
+
+    for (const auto& id : ids)
+    {
+        if (id.opcode != spirv::OP_VARIABLE)
+        {
+            continue;
+        }
+
+        const u32 pointee = ids.at(id.type).type;
+        switch (id.storage_class)
+        {
+            case spirv::STORAGE_INPUT:
+            {
+                if (stage.type != ShaderStageType::VERTEX || id.builtin ||
+                    id.location == INVALID_ID)
+                {
+                    break;
+                }
+
+                VertexInput input = {id.location, VertexInputFormatType::FLOAT, 0};
+                if (!get_vertex_format(ids, pointee, input.format))
+                {
+                    PERROR("Unsupported vertex input type at location %u.", id.location);
+                    return false;
+                }
+
+                input.size = get_type_size(ids, pointee);
+                vertex_inputs.push_back(input);
+                break;
+            }
+            case spirv::STORAGE_PUSH_CONSTANT:
+                add_push_constant(out_reflection, {stage.type, get_type_size(ids, pointee), 0});
+                break;
+            case spirv::STORAGE_UNIFORM:
+            case spirv::STORAGE_UNIFORM_CONSTANT:
+            case spirv::STORAGE_STORAGE_BUFFER:
+            {
+                if (id.set == INVALID_ID || id.binding == INVALID_ID)
+                {
+                    break;
+                }
+
+                DescriptorSetBindingDescriptor binding = {};
+                binding.binding                        = id.binding;
+                binding.shader_stage                   = stage.type;
+                if (!get_descriptor_type(ids, id, binding.count, binding.descriptor_type))
+                {
+                    PERROR("Unsupported resource at set %u binding %u.", id.set, id.binding);
+                    return false;
+                }
+
+                if (!add_binding(out_reflection, id.set, binding))
+                {
+                    return false;
+                }
+                break;
+            }
+        }
+    }
+
+    if (!vertex_inputs.empty())
+    {
+        std::sort(vertex_inputs.begin(), vertex_inputs.end(), [](const auto& a, const auto& b) {
+            return a.location < b.location;
+        });
+
+        auto& vertex_input = out_reflection.vertex_input;
+        vertex_input.reset();
+
+        u32 offset = 0;
+        for (const auto& input : vertex_inputs)
+        {
+            vertex_input.add_vertex_attribute(
+              {static_cast<u16>(input.location), 0, offset, input.format});
+            offset += input.size;
+        }
+
+        vertex_input.add_vertex_stream({0, static_cast<u16>(offset), VertexInputRate::PER_VERTEX});
+    }
+
+    return true;
+}
+
+bool reflect_shader_state(const ShaderStateDescriptor& shader_state,
+                          ShaderReflection&            out_reflection)
+{
+    out_reflection = {};
+
+    for (const auto& stage : shader_state.shader_stages)
+    {
+        if (stage.code.empty())
+        {
+            continue;
+        }
+
+        if (!reflect_shader(stage, out_reflection))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+} // namespace resources
+} // namespace pinut
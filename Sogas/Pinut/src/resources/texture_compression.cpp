@@ -0,0 +1,349 @@
+#include "pch.hpp"
+
+#include <resources/cooked_texture.h>
+#include <resources/texture_compression.h>
+#include <resources/texture_utils.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace pinut
+{
+namespace resources
+{
+static const u32 BLOCK_TEXELS = 16;
+
+static u16 pack_565(const i32* rgb)
+{
+    const u32 r = (static_cast<u32>(rgb[0]) * 31 + 127) / 255;
+    const u32 g = (static_cast<u32>(rgb[1]) * 63 + 127) / 255;
+    const u32 b = (static_cast<u32>(rgb[2]) * 31 + 127) / 255;
+    return static_cast<u16>((r << 11) | (g << 5) | b);
+}
+
+static void unpack_565(const u16 color, i32* out_rgb)
+{
+    const i32 r = (color >> 11) & 31;
+    const i32 g = (color >> 5) & 63;
+    const i32 b = color & 31;
+    out_rgb[0]  = (r << 3) | (r >> 2);
+    out_rgb[1]  = (g << 2) | (g >> 4);
+    out_rgb[2]  = (b << 3) | (b >> 2);
+}
+
+// Bounding box endpoints, with the box diagonal flipped per channel to follow the colour trend of
+// the block and inset by 1/16 of its extent to reduce the error at the extremes.
+static void encode_color_block(const u8* rgba_block, u8* out_block)
+{
+    i32 min_color[3] = {255, 255, 255};
+    i32 max_color[3] = {0, 0, 0};
+    i32 mean[3]      = {0, 0, 0};
+
+    for (u32 i = 0; i < BLOCK_TEXELS; ++i)
+    {
+        for (u32 c = 0; c < 3; ++c)
+        {
+            const i32 value = rgba_block[i * 4 + c];
+            min_color[c]    = std::min(min_color[c], value);
+            max_color[c]    = std::max(max_color[c], value);
+            mean[c] += value;
+        }
+    }
+
+    u32 reference = 0;
+    for (u32 c = 0; c < 3; ++c)
+    {
+        mean[c] /= BLOCK_TEXELS;
+        if (max_color[c] - min_color[c] > max_color[reference] - min_color[reference])
+        {
+            reference = c;
+        }
+    }
+
+    for (u32 c = 0; c < 3; ++c)
+    {
+        if (c == reference)
+        {
+            continue;
+        }
+
+        i32 covariance = 0;
+        for (u32 i = 0; i < BLOCK_TEXELS; ++i)
+        {
+            covariance += (rgba_block[i * 4 + reference] - mean[reference]) *
+                          (rgba_block[i * 4 + c] - mean[c]);
+        }
+
+        if (covariance < 0)
+        {
+            std::swap(min_color[c], max_color[c]);
+        }
+    }
+
+    for (u32 c = 0; c < 3; ++c)
+    {
+        const i32 inset = (max_color[c] - min_color[c]) / 16;
+        max_color[c] -= inset;
+        min_color[c] += inset;
+    }
+
+    u16 color0 = pack_565(max_color);
+    u16 color1 = pack_565(min_color);
+    if (color0 < color1)
+    {
+        std::swap(color0, color1);
+    }
+
+    // Equal endpoints select the three colour mode, index 0 still decodes to color0 there.
+    u32 indices = 0;
+    if (color0 != color1)
+    {
+        i32 palette[4][3];
+        unpack_565(color0, palette[0]);
+        unpack_565(color1, palette[1]);
+        for (u32 c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (u32 i = 0; i < BLOCK_TEXELS; ++i)
+        {
+            u32 best_index    = 0;
+            i32 best_distance = INT32_MAX;
+            for (u32 p = 0; p < 4; ++p)
+            {
+                i32 distance = 0;
+                for (u32 c = 0; c < 3; ++c)
+                {
+                    const i32 delta = rgba_block[i * 4 + c] - palette[p][c];
+                    distance += delta * delta;
+                }
+
+                if (distance < best_distance)
+                {
+                    best_distance = distance;
+                    best_index    = p;
+                }
+            }
+
+            indices |= best_index << (i * 2);
+        }
+    }
+
+    out_block[0] = static_cast<u8>(color0 & 0xFF);
+    out_block[1] = static_cast<u8>(color0 >> 8);
+    out_block[2] = static_cast<u8>(color1 & 0xFF);
+    out_block[3] = static_cast<u8>(color1 >> 8);
+    memcpy(out_block + 4, &indices, sizeof(indices));
+}
+
+// Single channel block in the eight value mode, shared by the BC3 alpha and both BC5 channels.
+static void encode_channel_block(const u8* rgba_block, const u32 channel, u8* out_block)
+{
+    i32 min_value = 255;
+    i32 max_value = 0;
+    for (u32 i = 0; i < BLOCK_TEXELS; ++i)
+    {
+        min_value = std::min<i32>(min_value, rgba_block[i * 4 + channel]);
+        max_value = std::max<i32>(max_value, rgba_block[i * 4 + channel]);
+    }
+
+    i32 palette[8] = {max_value, min_value};
+    for (i32 p = 2; p < 8; ++p)
+    {
+        palette[p] = ((8 - p) * max_value + (p - 1) * min_value + 3) / 7;
+    }
+
+    u64 indices = 0;
+    if (max_value != min_value)
+    {
+        for (u32 i = 0; i < BLOCK_TEXELS; ++i)
+        {
+            u64 best_index    = 0;
+            i32 best_distance = INT32_MAX;
+            for (u32 p = 0; p < 8; ++p)
+            {
+                const i32 distance = std::abs(rgba_block[i * 4 + channel] - palette[p]);
+                if (distance < best_distance)
+                {
+                    best_distance = distance;
+                    best_index    = p;
+                }
+            }
+
+            indices |= best_index << (i * 3);
+        }
+    }
+
+    out_block[0] = static_cast<u8>(max_value);
+    out_block[1] = static_cast<u8>(min_value);
+    for (u32 i = 0; i < 6; ++i)
+    {
+        out_block[2 + i] = static_cast<u8>((indices >> (i * 8)) & 0xFF);
+    }
+}
+
+// Texels past the edge of the level repeat the last row and column.
+static void fetch_block(const u8* level,
+                        u32       width,
+                        u32       height,
+                        u32       block_x,
+                        u32       block_y,
+                        u8*       out_block)
+{
+    for (u32 y = 0; y < 4; ++y)
+    {
+        const u32 source_y = std::min(block_y * 4 + y, height - 1);
+        for (u32 x = 0; x < 4; ++x)
+        {
+            const u32 source_x = std::min(block_x * 4 + x, width - 1);
+            memcpy(out_block + (y * 4 + x) * 4, level + (source_y * width + source_x) * 4, 4);
+        }
+    }
+}
+
+void encode_bc1_block(const u8* rgba_block, u8* out_block)
+{
+    encode_color_block(rgba_block, out_block);
+}
+
+void encode_bc3_block(const u8* rgba_block, u8* out_block)
+{
+    encode_channel_block(rgba_block, 3, out_block);
+    encode_color_block(rgba_block, out_block + 8);
+}
+
+void encode_bc5_block(const u8* rgba_block, u8* out_block)
+{
+    encode_channel_block(rgba_block, 0, out_block);
+    encode_channel_block(rgba_block, 1, out_block + 8);
+}
+
+using BlockEncoder = void (*)(const u8*, u8*);
+
+static BlockEncoder get_block_encoder(TextureFormat format)
+{
+    switch (format)
+    {
+        case TextureFormat::BC1_RGBA_UNORM:
+        case TextureFormat::BC1_RGBA_SRGB:
+            return encode_bc1_block;
+        case TextureFormat::BC3_UNORM:
+        case TextureFormat::BC3_SRGB:
+            return encode_bc3_block;
+        case TextureFormat::BC5_UNORM:
+            return encode_bc5_block;
+        default:
+            return nullptr;
+    }
+}
+
+bool is_compression_supported(TextureFormat format)
+{
+    return get_block_encoder(format) != nullptr;
+}
+
+bool compress_mip_chain(TextureFormat    format,
+                        const u8*        rgba_chain,
+                        u32              width,
+                        u32              height,
+                        u32              mip_levels,
+                        std::vector<u8>& out_chain,
+                        u32              thread_count)
+{
+    const BlockEncoder encoder = get_block_encoder(format);
+    if (encoder == nullptr)
+    {
+        PERROR("Texture format %u can not be compressed.", static_cast<u32>(format));
+        return false;
+    }
+
+    const auto header     = make_cooked_texture_header(format, width, height, mip_levels);
+    const u32  block_size = get_format_block_size(format);
+    out_chain.resize(header.data_size);
+
+    struct Tile
+    {
+        u32 level;
+        u32 first_row;
+        u32 row_count;
+    };
+
+    std::vector<Tile> tiles;
+    std::vector<u64>  source_offsets(mip_levels);
+    u64               source_offset = 0;
+    for (u32 level = 0; level < mip_levels; ++level)
+    {
+        const u32 level_width  = get_mip_dimension(width, level);
+        const u32 level_height = get_mip_dimension(height, level);
+        const u32 block_rows   = (level_height + 3) / 4;
+
+        for (u32 row = 0; row < block_rows; row += COMPRESSION_TILE_BLOCK_ROWS)
+        {
+            tiles.push_back(
+              {level, row, std::min(COMPRESSION_TILE_BLOCK_ROWS, block_rows - row)});
+        }
+
+        source_offsets.at(level) = source_offset;
+        source_offset += get_mip_size(TextureFormat::R8G8B8A8_UNORM, level_width, level_height);
+    }
+
+    const u32        tile_count = static_cast<u32>(tiles.size());
+    std::atomic<u32> next_tile  = 0;
+
+    auto worker = [&]() {
+        u8 block[BLOCK_TEXELS * 4];
+        for (u32 i = next_tile++; i < tile_count; i = next_tile++)
+        {
+            const auto& tile         = tiles.at(i);
+            const u32   level_width  = get_mip_dimension(width, tile.level);
+            const u32   level_height = get_mip_dimension(height, tile.level);
+            const u32   blocks_x     = (level_width + 3) / 4;
+            const u8*   source       = rgba_chain + source_offsets.at(tile.level);
+            u8*         destination  = out_chain.data() + header.level_offsets[tile.level];
+
+            for (u32 row = tile.first_row; row < tile.first_row + tile.row_count; ++row)
+            {
+                for (u32 column = 0; column < blocks_x; ++column)
+                {
+                    fetch_block(source, level_width, level_height, column, row, block);
+                    encoder(block, destination + (row * blocks_x + column) * block_size);
+                }
+            }
+        }
+    };
+
+    if (thread_count == 0)
+    {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    thread_count = std::min(thread_count, tile_count);
+
+    if (thread_count <= 1)
+    {
+        worker();
+    }
+    else
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count - 1);
+        for (u32 i = 0; i < thread_count - 1; ++i)
+        {
+            threads.emplace_back(worker);
+        }
+
+        worker();
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    return true;
+}
+} // namespace resources
+} // namespace pinut
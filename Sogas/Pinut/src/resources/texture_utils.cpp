@@ -0,0 +1,196 @@
+#include "pch.hpp"
+
+#include <resources/texture_utils.h>
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PINUT_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace pinut
+{
+namespace resources
+{
+bool is_block_compressed(TextureFormat format)
+{
+    return format >= TextureFormat::BC1_RGBA_UNORM && format <= TextureFormat::BC7_SRGB;
+}
+
+u32 get_format_block_size(TextureFormat format)
+{
+    // Uncompressed formats are grouped by component size, each group ordered by channel count.
+    const auto channel_group = [format](TextureFormat first, u32 group_size) {
+        return 1 + (static_cast<u32>(format) - static_cast<u32>(first)) / group_size;
+    };
+
+    if (format >= TextureFormat::R8_UNORM && format <= TextureFormat::R8G8B8A8_SRGB)
+    {
+        return channel_group(TextureFormat::R8_UNORM, 7);
+    }
+
+    if (format >= TextureFormat::R16_UNORM && format <= TextureFormat::R16G16B16A16_SFLOAT)
+    {
+        return 2 * channel_group(TextureFormat::R16_UNORM, 7);
+    }
+
+    if (format >= TextureFormat::R32_UINT && format <= TextureFormat::R32G32B32A32_SFLOAT)
+    {
+        return 4 * channel_group(TextureFormat::R32_UINT, 3);
+    }
+
+    if (format >= TextureFormat::R64_UINT && format <= TextureFormat::R64G64B64A64_SFLOAT)
+    {
+        return 8 * channel_group(TextureFormat::R64_UINT, 3);
+    }
+
+    switch (format)
+    {
+        case TextureFormat::D32_SFLOAT:
+        case TextureFormat::D24_UNORM_S8_UINT:
+            return 4;
+        case TextureFormat::D16_UNORM_S8_UINT:
+            return 3;
+        case TextureFormat::D32_SFLOAT_S8_UINT:
+            return 8;
+        case TextureFormat::BC1_RGBA_UNORM:
+        case TextureFormat::BC1_RGBA_SRGB:
+            return 8;
+        case TextureFormat::BC3_UNORM:
+        case TextureFormat::BC3_SRGB:
+        case TextureFormat::BC5_UNORM:
+        case TextureFormat::BC5_SNORM:
+        case TextureFormat::BC7_UNORM:
+        case TextureFormat::BC7_SRGB:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+u32 get_mip_count(u32 width, u32 height)
+{
+    u32 levels = 1;
+    for (u32 size = std::max(width, height); size > 1; size >>= 1)
+    {
+        levels++;
+    }
+    return levels;
+}
+
+u32 get_mip_dimension(u32 dimension, u32 level)
+{
+    return std::max(1u, dimension >> level);
+}
+
+u64 get_mip_size(TextureFormat format, u32 width, u32 height)
+{
+    if (is_block_compressed(format))
+    {
+        const u64 blocks_x = (width + 3) / 4;
+        const u64 blocks_y = (height + 3) / 4;
+        return blocks_x * blocks_y * get_format_block_size(format);
+    }
+
+    return static_cast<u64>(width) * height * get_format_block_size(format);
+}
+
+u64 get_mip_chain_size(TextureFormat format, u32 width, u32 height, u32 mip_levels)
+{
+    u64 size = 0;
+    for (u32 level = 0; level < mip_levels; ++level)
+    {
+        size += get_mip_size(format,
+                             get_mip_dimension(width, level),
+                             get_mip_dimension(height, level));
+    }
+    return size;
+}
+
+// 2x2 box filter, odd dimensions clamp the last row and column.
+static void downsample_rgba8(const u8* source,
+                             u32       source_width,
+                             u32       source_height,
+                             u8*       destination,
+                             u32       width,
+                             u32       height)
+{
+    for (u32 y = 0; y < height; ++y)
+    {
+        const u8* row0 = source + static_cast<u64>(std::min(2 * y, source_height - 1)) *
+                                    source_width * 4;
+        const u8* row1 = source + static_cast<u64>(std::min(2 * y + 1, source_height - 1)) *
+                                    source_width * 4;
+        u8*       out  = destination + static_cast<u64>(y) * width * 4;
+
+        u32 x = 0;
+#ifdef PINUT_SSE2
+        // Two output texels per iteration from four source texels of each row.
+        const __m128i zero     = _mm_setzero_si128();
+        const __m128i rounding = _mm_set1_epi16(2);
+        for (; x + 2 <= width && 2 * x + 4 <= source_width; x += 2)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+
+            const __m128i low  = _mm_add_epi16(_mm_unpacklo_epi8(a, zero),
+                                               _mm_unpacklo_epi8(b, zero));
+            const __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(a, zero),
+                                               _mm_unpackhi_epi8(b, zero));
+
+            const __m128i sum_low  = _mm_add_epi16(low, _mm_srli_si128(low, 8));
+            const __m128i sum_high = _mm_add_epi16(high, _mm_srli_si128(high, 8));
+
+            __m128i texels = _mm_unpacklo_epi64(sum_low, sum_high);
+            texels         = _mm_srli_epi16(_mm_add_epi16(texels, rounding), 2);
+
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 4),
+                             _mm_packus_epi16(texels, zero));
+        }
+#endif
+        for (; x < width; ++x)
+        {
+            const u32 x0 = std::min(2 * x, source_width - 1) * 4;
+            const u32 x1 = std::min(2 * x + 1, source_width - 1) * 4;
+            for (u32 c = 0; c < 4; ++c)
+            {
+                const u32 sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                out[x * 4 + c] = static_cast<u8>((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+void generate_mip_chain_rgba8(const u8*        source,
+                              u32              width,
+                              u32              height,
+                              u32              mip_levels,
+                              std::vector<u8>& out_chain)
+{
+    ASSERT(source != nullptr);
+    ASSERT(mip_levels > 0 && mip_levels <= get_mip_count(width, height));
+
+    const auto format = TextureFormat::R8G8B8A8_UNORM;
+    out_chain.resize(get_mip_chain_size(format, width, height, mip_levels));
+    memcpy(out_chain.data(), source, get_mip_size(format, width, height));
+
+    u64 offset = 0;
+    for (u32 level = 1; level < mip_levels; ++level)
+    {
+        const u32 source_width  = get_mip_dimension(width, level - 1);
+        const u32 source_height = get_mip_dimension(height, level - 1);
+        const u64 next_offset   = offset + get_mip_size(format, source_width, source_height);
+
+        downsample_rgba8(out_chain.data() + offset,
+                         source_width,
+                         source_height,
+                         out_chain.data() + next_offset,
+                         get_mip_dimension(width, level),
+                         get_mip_dimension(height, level));
+
+        offset = next_offset;
+    }
+}
+} // namespace resources
+} // namespace pinut
@@ -21,20 +21,49 @@ void VulkanCommandBuffer::bind_pass(std::string pass)
         throw std::runtime_error("Failed to find desired render pass.");
     }
 
-    auto render_pass = VulkanDevice::render_passes.at(pass);
+    const auto render_pass =
+      vulkan_device->access_render_pass(VulkanDevice::render_passes.at(pass).id);
+
+    end_pass();
+
+    // Swapchain framebuffers follow the window, offscreen ones keep the size of their targets.
+    const bool is_swapchain = render_pass->type == resources::RenderPassType::SWAPCHAIN;
+    current_extent          = is_swapchain ? vulkan_device->get_swapchain_extent() :
+                                             VkExtent2D{render_pass->width, render_pass->height};
+
+    // Every color attachment clears to the same color.
+    VkClearValue pass_clear_values[resources::MAX_COLOR_ATTACHMENTS + 1];
+    u32          clear_value_count = 0;
+    for (u32 i = 0; i < render_pass->color_attachment_count; ++i)
+    {
+        pass_clear_values[clear_value_count++] = clear_values[0];
+    }
+    if (render_pass->has_depth)
+    {
+        pass_clear_values[clear_value_count++] = clear_values[1];
+    }
 
     VkRenderPassBeginInfo render_pass_begin_info = {VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
-    render_pass_begin_info.clearValueCount       = 2;
-    render_pass_begin_info.pClearValues          = clear_values;
+    render_pass_begin_info.clearValueCount       = clear_value_count;
+    render_pass_begin_info.pClearValues          = pass_clear_values;
     render_pass_begin_info.framebuffer =
-      render_pass.type == resources::RenderPassType::SWAPCHAIN ?
-        vulkan_device->framebuffers[vulkan_device->current_frame] :
-        nullptr;
-    render_pass_begin_info.renderPass        = render_pass.handle;
+      is_swapchain ? vulkan_device->framebuffers[vulkan_device->current_frame] :
+                     render_pass->framebuffer;
+    render_pass_begin_info.renderPass        = render_pass->handle;
     render_pass_begin_info.renderArea.offset = {0, 0};
-    render_pass_begin_info.renderArea.extent = {render_pass.width, render_pass.height};
+    render_pass_begin_info.renderArea.extent = current_extent;
 
     vkCmdBeginRenderPass(cmd, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+    pass_in_progress = true;
+}
+
+void VulkanCommandBuffer::end_pass()
+{
+    if (pass_in_progress)
+    {
+        vkCmdEndRenderPass(cmd);
+        pass_in_progress = false;
+    }
 }
 
 void VulkanCommandBuffer::bind_pipeline(std::string pipeline_name)
@@ -66,12 +95,10 @@ void VulkanCommandBuffer::set_viewport(const resources::Viewport* viewport)
     }
     else
     {
-        auto vulkan_device = dynamic_cast<VulkanDevice*>(device);
-
         vulkan_viewport.x        = 0.0f;
         vulkan_viewport.y        = 0.0f;
-        vulkan_viewport.width    = static_cast<f32>(vulkan_device->get_swapchain_extent().width);
-        vulkan_viewport.height   = static_cast<f32>(vulkan_device->get_swapchain_extent().height);
+        vulkan_viewport.width    = static_cast<f32>(current_extent.width);
+        vulkan_viewport.height   = static_cast<f32>(current_extent.height);
         vulkan_viewport.minDepth = 0.0f;
         vulkan_viewport.maxDepth = 1.0f;
     }
@@ -91,9 +118,8 @@ void VulkanCommandBuffer::set_scissors(const resources::Rect* new_scissor)
     }
     else
     {
-        auto vulkan_device = dynamic_cast<VulkanDevice*>(device);
-        scissor.extent     = vulkan_device->get_swapchain_extent();
-        scissor.offset     = {0, 0};
+        scissor.extent = current_extent;
+        scissor.offset = {0, 0};
     }
 
     vkCmdSetScissor(cmd, 0, 1, &scissor);
@@ -118,6 +144,23 @@ void VulkanCommandBuffer::clear(f32 red, f32 green, f32 blue, f32 alpha)
     clear_values[1].depthStencil = {1.0f, 0};
 }
 
+void VulkanCommandBuffer::clear_depth(const resources::Rect& rect)
+{
+    ASSERT(pass_in_progress);
+
+    VkClearAttachment attachment       = {};
+    attachment.aspectMask              = VK_IMAGE_ASPECT_DEPTH_BIT;
+    attachment.clearValue.depthStencil = {1.0f, 0};
+
+    VkClearRect clear_rect    = {};
+    clear_rect.rect.offset    = {static_cast<i32>(rect.offset_x), static_cast<i32>(rect.offset_y)};
+    clear_rect.rect.extent    = {rect.w, rect.h};
+    clear_rect.baseArrayLayer = 0;
+    clear_rect.layerCount     = 1;
+
+    vkCmdClearAttachments(cmd, 1, &attachment, 1, &clear_rect);
+}
+
 void VulkanCommandBuffer::draw(u32 first_vertex,
                                u32 vertex_count,
                                u32 first_instance,
@@ -184,5 +227,47 @@ void VulkanCommandBuffer::bind_index_buffer(const resources::BufferHandle& handl
 
     vkCmdBindIndexBuffer(cmd, buffer->buffer, 0, get_buffer_index_type(index_type));
 }
+
+void VulkanCommandBuffer::begin_gpu_zone(const char* name)
+{
+    if (timestamp_pool == VK_NULL_HANDLE || gpu_zones.size() == MAX_GPU_ZONES)
+    {
+        open_gpu_zones.push_back(INVALID_ID);
+        return;
+    }
+
+    const u32 index = static_cast<u32>(gpu_zones.size());
+    gpu_zones.push_back({name, 0, 0, static_cast<u32>(open_gpu_zones.size())});
+    open_gpu_zones.push_back(index);
+
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestamp_pool, 2 * index);
+}
+
+void VulkanCommandBuffer::end_gpu_zone()
+{
+    ASSERT(!open_gpu_zones.empty());
+
+    const u32 index = open_gpu_zones.back();
+    open_gpu_zones.pop_back();
+    if (index == INVALID_ID)
+    {
+        return;
+    }
+
+    // Written once every command before it finished.
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestamp_pool, 2 * index + 1);
+}
+
+void VulkanCommandBuffer::reset_gpu_zones()
+{
+    gpu_zones.clear();
+    open_gpu_zones.clear();
+    timestamps_submitted = false;
+
+    if (timestamp_pool != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(cmd, timestamp_pool, 0, 2 * MAX_GPU_ZONES);
+    }
+}
 } // namespace vulkan
 } // namespace pinut
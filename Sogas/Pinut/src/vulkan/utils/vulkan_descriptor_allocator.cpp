@@ -0,0 +1,247 @@
+#include "pch.hpp"
+
+#include <vulkan/utils/vulkan_descriptor_allocator.h>
+
+namespace pinut
+{
+namespace vulkan
+{
+void VulkanDescriptorAllocator::init(VkDevice new_device, u32 new_frame_count)
+{
+    device      = new_device;
+    frame_count = new_frame_count;
+    frame_pools.resize(frame_count);
+
+    transient_sizes_per_set.clear();
+    transient_sizes_version = 0;
+}
+
+void VulkanDescriptorAllocator::shutdown()
+{
+    for (auto& it : layout_pools)
+    {
+        for (auto pool : it.second.pools)
+        {
+            vkDestroyDescriptorPool(device, pool, nullptr);
+        }
+    }
+
+    for (auto& frame : frame_pools)
+    {
+        for (auto pool : frame.pools)
+        {
+            vkDestroyDescriptorPool(device, pool, nullptr);
+        }
+    }
+
+    layout_pools.clear();
+    frame_pools.clear();
+}
+
+void VulkanDescriptorAllocator::register_layout(
+  VkDescriptorSetLayout                    layout,
+  const std::vector<VkDescriptorPoolSize>& sizes_per_set,
+  VkDescriptorPoolCreateFlags              flags)
+{
+    ASSERT(!layout_pools.contains(layout));
+    auto& pools         = layout_pools[layout];
+    pools.sizes_per_set = sizes_per_set;
+    pools.flags         = flags;
+
+    if (flags & VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT)
+    {
+        pools.sets_per_pool = 1;
+        // Update-after-bind sets need their own pool flag, they are never transient.
+        return;
+    }
+
+    bool grown = false;
+    for (const auto& size : sizes_per_set)
+    {
+        auto it = std::find_if(transient_sizes_per_set.begin(),
+                               transient_sizes_per_set.end(),
+                               [&](const auto& transient) { return transient.type == size.type; });
+
+        if (it == transient_sizes_per_set.end())
+        {
+            transient_sizes_per_set.push_back(size);
+            grown = true;
+        }
+        else if (it->descriptorCount < size.descriptorCount)
+        {
+            it->descriptorCount = size.descriptorCount;
+            grown               = true;
+        }
+    }
+
+    if (grown)
+    {
+        transient_sizes_version++;
+    }
+}
+
+void VulkanDescriptorAllocator::unregister_layout(VkDescriptorSetLayout layout)
+{
+    auto it = layout_pools.find(layout);
+    if (it == layout_pools.end())
+    {
+        return;
+    }
+
+    for (auto pool : it->second.pools)
+    {
+        vkDestroyDescriptorPool(device, pool, nullptr);
+    }
+
+    layout_pools.erase(it);
+}
+
+VkDescriptorSet VulkanDescriptorAllocator::allocate(VkDescriptorSetLayout layout)
+{
+    ASSERT(layout_pools.contains(layout));
+    auto& pools = layout_pools.at(layout);
+
+    if (!pools.free_sets.empty())
+    {
+        const auto set = pools.free_sets.back();
+        pools.free_sets.pop_back();
+        return set;
+    }
+
+    // Pools hold exactly sets_left more sets of this layout, grow geometrically when exhausted.
+    if (pools.sets_left == 0)
+    {
+        if (!pools.pools.empty())
+        {
+            pools.sets_per_pool = std::min(pools.sets_per_pool * 2, MAX_SETS_PER_POOL);
+        }
+
+        pools.pools.push_back(
+          create_pool(pools.sizes_per_set, pools.sets_per_pool, pools.flags));
+        pools.sets_left = pools.sets_per_pool;
+    }
+
+    VkDescriptorSetAllocateInfo info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    info.descriptorPool              = pools.pools.back();
+    info.descriptorSetCount          = 1;
+    info.pSetLayouts                 = &layout;
+
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    VK_CHECK(vkAllocateDescriptorSets(device, &info, &set));
+    pools.sets_left--;
+
+    return set;
+}
+
+void VulkanDescriptorAllocator::free(VkDescriptorSetLayout layout, VkDescriptorSet set)
+{
+    // The layout may be gone already, its pools took the set with them.
+    auto it = layout_pools.find(layout);
+    if (it != layout_pools.end())
+    {
+        it->second.free_sets.push_back(set);
+    }
+}
+
+VkDescriptorSet VulkanDescriptorAllocator::allocate_transient(VkDescriptorSetLayout layout,
+                                                              u32                   frame)
+{
+    ASSERT(frame < frame_count);
+    auto& pools = frame_pools.at(frame);
+
+    bool is_new_pool = pools.current >= pools.pools.size();
+
+    VkDescriptorSetAllocateInfo info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    info.descriptorPool              = get_transient_pool(pools, false);
+    info.descriptorSetCount          = 1;
+    info.pSetLayouts                 = &layout;
+
+    VkDescriptorSet set    = VK_NULL_HANDLE;
+    VkResult        result = vkAllocateDescriptorSets(device, &info, &set);
+
+    // A new pool fits a set of any registered layout, older ones may be full or too small. When
+    // even a new pool fails the set can never fit.
+    while (!is_new_pool &&
+           (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL))
+    {
+        is_new_pool         = pools.current + 1 >= pools.pools.size();
+        info.descriptorPool = get_transient_pool(pools, true);
+        result              = vkAllocateDescriptorSets(device, &info, &set);
+    }
+
+    if (result != VK_SUCCESS)
+    {
+        PERROR("Failed to allocate a transient descriptor set, error %d.", result);
+        return VK_NULL_HANDLE;
+    }
+
+    return set;
+}
+
+void VulkanDescriptorAllocator::reset_frame(u32 frame)
+{
+    ASSERT(frame < frame_count);
+    auto& pools = frame_pools.at(frame);
+
+    // A layout with more descriptors was registered, the pools of this frame are recreated on use.
+    if (pools.sizes_version != transient_sizes_version)
+    {
+        for (auto pool : pools.pools)
+        {
+            vkDestroyDescriptorPool(device, pool, nullptr);
+        }
+        pools.pools.clear();
+        pools.sizes_version = transient_sizes_version;
+    }
+
+    for (auto pool : pools.pools)
+    {
+        VK_CHECK(vkResetDescriptorPool(device, pool, 0));
+    }
+
+    pools.current = 0;
+}
+
+VkDescriptorPool VulkanDescriptorAllocator::create_pool(
+  const std::vector<VkDescriptorPoolSize>& sizes_per_set,
+  u32                                      max_sets,
+  VkDescriptorPoolCreateFlags              flags) const
+{
+    std::vector<VkDescriptorPoolSize> pool_sizes = sizes_per_set;
+    for (auto& size : pool_sizes)
+    {
+        size.descriptorCount *= max_sets;
+    }
+
+    VkDescriptorPoolCreateInfo pool_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    pool_info.poolSizeCount              = static_cast<u32>(pool_sizes.size());
+    pool_info.pPoolSizes                 = pool_sizes.data();
+    pool_info.maxSets                    = max_sets;
+    pool_info.flags                      = flags;
+
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    VK_CHECK(vkCreateDescriptorPool(device, &pool_info, nullptr, &pool));
+    return pool;
+}
+
+VkDescriptorPool VulkanDescriptorAllocator::get_transient_pool(FramePools& pools, bool next)
+{
+    if (next)
+    {
+        pools.current++;
+    }
+
+    if (pools.current >= pools.pools.size())
+    {
+        if (pools.pools.empty())
+        {
+            pools.sizes_version = transient_sizes_version;
+        }
+        pools.pools.push_back(create_pool(transient_sizes_per_set, TRANSIENT_SETS));
+        pools.current = static_cast<u32>(pools.pools.size()) - 1;
+    }
+
+    return pools.pools.at(pools.current);
+}
+} // namespace vulkan
+} // namespace pinut
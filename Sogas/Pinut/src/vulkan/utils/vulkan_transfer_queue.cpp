@@ -0,0 +1,296 @@
+#include "pch.hpp"
+
+#include <vulkan/utils/vulkan_initializers.h>
+#include <vulkan/utils/vulkan_transfer_queue.h>
+
+namespace pinut
+{
+namespace vulkan
+{
+static const VkAccessFlags BUFFER_READ_ACCESS =
+  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT |
+  VK_ACCESS_SHADER_READ_BIT;
+
+void VulkanTransferQueue::init(VkDevice new_device,
+                               VkQueue  new_queue,
+                               u32      new_family,
+                               u32      new_graphics_family)
+{
+    device          = new_device;
+    queue           = new_queue;
+    family          = new_family;
+    graphics_family = new_graphics_family;
+
+    VkCommandPoolCreateInfo pool_info =
+      vkinit::command_pool_create_info(family, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+    VK_CHECK(vkCreateCommandPool(device, &pool_info, nullptr, &command_pool));
+
+    VkSemaphoreTypeCreateInfo type_info = {VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+    type_info.semaphoreType             = VK_SEMAPHORE_TYPE_TIMELINE;
+    type_info.initialValue              = 0;
+
+    VkSemaphoreCreateInfo semaphore_info = vkinit::semaphore_create_info();
+    semaphore_info.pNext                 = &type_info;
+    VK_CHECK(vkCreateSemaphore(device, &semaphore_info, nullptr, &timeline));
+}
+
+void VulkanTransferQueue::shutdown()
+{
+    // Command buffers go with their pool.
+    vkDestroyCommandPool(device, command_pool, nullptr);
+    vkDestroySemaphore(device, timeline, nullptr);
+
+    in_flight.clear();
+    free_command_buffers.clear();
+    pending_image_acquires.clear();
+    pending_buffer_acquires.clear();
+    flushed_image_acquires.clear();
+    flushed_buffer_acquires.clear();
+
+    recording       = VK_NULL_HANDLE;
+    submitted_value = 0;
+}
+
+VkCommandBuffer VulkanTransferQueue::get_command_buffer()
+{
+    if (recording != VK_NULL_HANDLE)
+    {
+        return recording;
+    }
+
+    const u64 completed = get_completed_value();
+    for (i32 i = static_cast<i32>(in_flight.size()) - 1; i >= 0; --i)
+    {
+        if (in_flight.at(i).value <= completed)
+        {
+            free_command_buffers.push_back(in_flight.at(i).cmd);
+            in_flight.erase(in_flight.begin() + i);
+        }
+    }
+
+    if (free_command_buffers.empty())
+    {
+        auto alloc_info = vkinit::command_buffer_allocate_info(command_pool);
+        VK_CHECK(vkAllocateCommandBuffers(device, &alloc_info, &recording));
+    }
+    else
+    {
+        recording = free_command_buffers.back();
+        free_command_buffers.pop_back();
+        VK_CHECK(vkResetCommandBuffer(recording, 0));
+    }
+
+    VkCommandBufferBeginInfo begin_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    begin_info.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK(vkBeginCommandBuffer(recording, &begin_info));
+
+    return recording;
+}
+
+u64 VulkanTransferQueue::get_pending_value() const
+{
+    return submitted_value + 1;
+}
+
+void VulkanTransferQueue::release_image(VkImage image, u32 mip_levels)
+{
+    ASSERT(recording != VK_NULL_HANDLE);
+
+    VkImageMemoryBarrier barrier            = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    barrier.image                           = image;
+    barrier.oldLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout                       = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel   = 0;
+    barrier.subresourceRange.levelCount     = mip_levels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount     = 1;
+
+    if (!is_dedicated())
+    {
+        // Same family, a plain transition already makes the data visible to the shaders.
+        barrier.dstAccessMask       = VK_ACCESS_SHADER_READ_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        vkCmdPipelineBarrier(recording,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             GRAPHICS_WAIT_STAGES,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             1,
+                             &barrier);
+        return;
+    }
+
+    // The layout change happens once, across the release and acquire pair.
+    barrier.dstAccessMask       = 0;
+    barrier.srcQueueFamilyIndex = family;
+    barrier.dstQueueFamilyIndex = graphics_family;
+    vkCmdPipelineBarrier(recording,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         1,
+                         &barrier);
+
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    pending_image_acquires.push_back(barrier);
+}
+
+void VulkanTransferQueue::release_buffer(VkBuffer buffer)
+{
+    ASSERT(recording != VK_NULL_HANDLE);
+
+    VkBufferMemoryBarrier barrier = {VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+    barrier.buffer                = buffer;
+    barrier.offset                = 0;
+    barrier.size                  = VK_WHOLE_SIZE;
+    barrier.srcAccessMask         = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    if (!is_dedicated())
+    {
+        barrier.dstAccessMask       = BUFFER_READ_ACCESS;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        vkCmdPipelineBarrier(recording,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             GRAPHICS_WAIT_STAGES,
+                             0,
+                             0,
+                             nullptr,
+                             1,
+                             &barrier,
+                             0,
+                             nullptr);
+        return;
+    }
+
+    barrier.dstAccessMask       = 0;
+    barrier.srcQueueFamilyIndex = family;
+    barrier.dstQueueFamilyIndex = graphics_family;
+    vkCmdPipelineBarrier(recording,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         1,
+                         &barrier,
+                         0,
+                         nullptr);
+
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = BUFFER_READ_ACCESS;
+    pending_buffer_acquires.push_back(barrier);
+}
+
+void VulkanTransferQueue::flush()
+{
+    if (recording == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    VK_CHECK(vkEndCommandBuffer(recording));
+
+    const u64 signal_value = ++submitted_value;
+
+    VkTimelineSemaphoreSubmitInfo timeline_info = {
+      VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+    timeline_info.signalSemaphoreValueCount = 1;
+    timeline_info.pSignalSemaphoreValues    = &signal_value;
+
+    VkSubmitInfo submit         = vkinit::submit_info(&recording);
+    submit.pNext                = &timeline_info;
+    submit.signalSemaphoreCount = 1;
+    submit.pSignalSemaphores    = &timeline;
+    VK_CHECK(vkQueueSubmit(queue, 1, &submit, VK_NULL_HANDLE));
+
+    in_flight.push_back({recording, signal_value});
+    recording = VK_NULL_HANDLE;
+
+    flushed_image_acquires.insert(flushed_image_acquires.end(),
+                                  pending_image_acquires.begin(),
+                                  pending_image_acquires.end());
+    flushed_buffer_acquires.insert(flushed_buffer_acquires.end(),
+                                   pending_buffer_acquires.begin(),
+                                   pending_buffer_acquires.end());
+    pending_image_acquires.clear();
+    pending_buffer_acquires.clear();
+}
+
+bool VulkanTransferQueue::record_acquires(VkCommandBuffer graphics_cmd)
+{
+    if (flushed_image_acquires.empty() && flushed_buffer_acquires.empty())
+    {
+        return false;
+    }
+
+    // Chained to the timeline wait of the submit, which uses the same stages.
+    vkCmdPipelineBarrier(graphics_cmd,
+                         GRAPHICS_WAIT_STAGES,
+                         GRAPHICS_WAIT_STAGES,
+                         0,
+                         0,
+                         nullptr,
+                         static_cast<u32>(flushed_buffer_acquires.size()),
+                         flushed_buffer_acquires.data(),
+                         static_cast<u32>(flushed_image_acquires.size()),
+                         flushed_image_acquires.data());
+
+    flushed_image_acquires.clear();
+    flushed_buffer_acquires.clear();
+    return true;
+}
+
+u64 VulkanTransferQueue::get_submitted_value() const
+{
+    return submitted_value;
+}
+
+u64 VulkanTransferQueue::get_completed_value() const
+{
+    u64 value = 0;
+    VK_CHECK(vkGetSemaphoreCounterValue(device, timeline, &value));
+    return value;
+}
+
+bool VulkanTransferQueue::is_complete(u64 value) const
+{
+    return value <= get_completed_value();
+}
+
+void VulkanTransferQueue::wait(u64 value)
+{
+    if (value > submitted_value)
+    {
+        flush();
+    }
+
+    if (value > submitted_value)
+    {
+        return;
+    }
+
+    VkSemaphoreWaitInfo wait_info = {VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+    wait_info.semaphoreCount      = 1;
+    wait_info.pSemaphores         = &timeline;
+    wait_info.pValues             = &value;
+    VK_CHECK(vkWaitSemaphores(device, &wait_info, UINT64_MAX));
+}
+
+VkSemaphore VulkanTransferQueue::get_semaphore() const
+{
+    return timeline;
+}
+} // namespace vulkan
+} // namespace pinut
@@ -211,6 +211,9 @@ VkShaderStageFlags get_shader_stage_flag(resources::ShaderStageType shader_stage
         case pinut::resources::ShaderStageType::COMPUTE:
             return VK_SHADER_STAGE_COMPUTE_BIT;
             break;
+        case pinut::resources::ShaderStageType::ALL_GRAPHICS:
+            return VK_SHADER_STAGE_ALL_GRAPHICS;
+            break;
         default:
         case pinut::resources::ShaderStageType::MAX_SHADER_TYPE:
             PWARN("Undefined shader stage provided. Binding to all shader stages.");
@@ -495,6 +498,30 @@ VkFormat get_texture_format(resources::TextureFormat format)
         case pinut::resources::TextureFormat::D32_SFLOAT_S8_UINT:
             return VK_FORMAT_D32_SFLOAT_S8_UINT;
             break;
+        case pinut::resources::TextureFormat::BC1_RGBA_UNORM:
+            return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+            break;
+        case pinut::resources::TextureFormat::BC1_RGBA_SRGB:
+            return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+            break;
+        case pinut::resources::TextureFormat::BC3_UNORM:
+            return VK_FORMAT_BC3_UNORM_BLOCK;
+            break;
+        case pinut::resources::TextureFormat::BC3_SRGB:
+            return VK_FORMAT_BC3_SRGB_BLOCK;
+            break;
+        case pinut::resources::TextureFormat::BC5_UNORM:
+            return VK_FORMAT_BC5_UNORM_BLOCK;
+            break;
+        case pinut::resources::TextureFormat::BC5_SNORM:
+            return VK_FORMAT_BC5_SNORM_BLOCK;
+            break;
+        case pinut::resources::TextureFormat::BC7_UNORM:
+            return VK_FORMAT_BC7_UNORM_BLOCK;
+            break;
+        case pinut::resources::TextureFormat::BC7_SRGB:
+            return VK_FORMAT_BC7_SRGB_BLOCK;
+            break;
         default:
         case pinut::resources::TextureFormat::COUNT:
             return VK_FORMAT_UNDEFINED;
@@ -551,5 +578,102 @@ VkImageViewType get_texture_view_type(resources::TextureViewType type)
             break;
     }
 }
+
+VkFilter get_sampler_filter(resources::SamplerFilter filter)
+{
+    switch (filter)
+    {
+        case pinut::resources::SamplerFilter::NEAREST:
+            return VK_FILTER_NEAREST;
+            break;
+        default:
+        case pinut::resources::SamplerFilter::LINEAR:
+            return VK_FILTER_LINEAR;
+            break;
+    }
+}
+
+VkSamplerMipmapMode get_sampler_mipmap_mode(resources::SamplerMipmapMode mode)
+{
+    switch (mode)
+    {
+        case pinut::resources::SamplerMipmapMode::NEAREST:
+            return VK_SAMPLER_MIPMAP_MODE_NEAREST;
+            break;
+        default:
+        case pinut::resources::SamplerMipmapMode::LINEAR:
+            return VK_SAMPLER_MIPMAP_MODE_LINEAR;
+            break;
+    }
+}
+
+VkSamplerAddressMode get_sampler_address_mode(resources::SamplerAddressMode mode)
+{
+    switch (mode)
+    {
+        default:
+        case pinut::resources::SamplerAddressMode::REPEAT:
+            return VK_SAMPLER_ADDRESS_MODE_REPEAT;
+            break;
+        case pinut::resources::SamplerAddressMode::MIRRORED_REPEAT:
+            return VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+            break;
+        case pinut::resources::SamplerAddressMode::CLAMP_TO_EDGE:
+            return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+            break;
+        case pinut::resources::SamplerAddressMode::CLAMP_TO_BORDER:
+            return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+            break;
+    }
+}
+
+VkAttachmentLoadOp get_attachment_load_op(resources::RenderPassOperation operation)
+{
+    switch (operation)
+    {
+        case pinut::resources::RenderPassOperation::LOAD:
+            return VK_ATTACHMENT_LOAD_OP_LOAD;
+            break;
+        case pinut::resources::RenderPassOperation::CLEAR:
+            return VK_ATTACHMENT_LOAD_OP_CLEAR;
+            break;
+        default:
+        case pinut::resources::RenderPassOperation::DONT_CARE:
+            return VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            break;
+    }
+}
+
+VkCompareOp get_compare_op(resources::CompareOperation operation)
+{
+    switch (operation)
+    {
+        case pinut::resources::CompareOperation::NEVER:
+            return VK_COMPARE_OP_NEVER;
+            break;
+        case pinut::resources::CompareOperation::EQUAL:
+            return VK_COMPARE_OP_EQUAL;
+            break;
+        case pinut::resources::CompareOperation::LESS_OR_EQUAL:
+            return VK_COMPARE_OP_LESS_OR_EQUAL;
+            break;
+        case pinut::resources::CompareOperation::GREATER:
+            return VK_COMPARE_OP_GREATER;
+            break;
+        case pinut::resources::CompareOperation::NOT_EQUAL:
+            return VK_COMPARE_OP_NOT_EQUAL;
+            break;
+        case pinut::resources::CompareOperation::GREATER_OR_EQUAL:
+            return VK_COMPARE_OP_GREATER_OR_EQUAL;
+            break;
+        case pinut::resources::CompareOperation::ALWAYS:
+            return VK_COMPARE_OP_ALWAYS;
+            break;
+        default:
+        case pinut::resources::CompareOperation::LESS:
+            return VK_COMPARE_OP_LESS;
+            break;
+    }
+}
 } // namespace vulkan
 } // namespace pinut
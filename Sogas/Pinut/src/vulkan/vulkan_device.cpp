@@ -7,9 +7,17 @@
 #include <vulkan/vulkan_device.h>
 #include <vulkan/vulkan_imgui.h>
 
+#include <resources/hash.h>
 #include <resources/pipeline.h>
 #include <resources/renderpass.h>
 #include <resources/shader_state.h>
+#include <resources/texture_utils.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
 
 // clang-format off
 #ifdef WIN32
@@ -28,6 +36,26 @@ static const std::vector<const char*> required_instance_extensions = {
 static const std::vector<const char*> required_device_extensions = {
   VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
+// Same clock as the engine profiler, GPU timestamps are converted to it.
+static u64 get_steady_time()
+{
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now().time_since_epoch())
+                              .count());
+}
+
+// Prefixed to the driver blob so a cache from another GPU or driver is never fed back.
+static constexpr u32 PIPELINE_CACHE_MAGIC = 0x50435348; // "PCSH"
+struct PipelineCacheHeader
+{
+    u32 magic;
+    u32 vendor_id;
+    u32 device_id;
+    u32 driver_version;
+    u8  uuid[VK_UUID_SIZE];
+    u64 data_size;
+};
+
 static bool check_required_extensions_available(
   const std::vector<VkExtensionProperties>& available_extensions)
 {
@@ -136,7 +164,8 @@ static void transition_image_layout(VkCommandBuffer cmd,
                                     VkImage         image,
                                     VkFormat /*format*/,
                                     VkImageLayout old_layout,
-                                    VkImageLayout new_layout)
+                                    VkImageLayout new_layout,
+                                    u32           mip_levels = 1)
 {
     // TODO Format parameter will be used to check if depth image has stencil.
 
@@ -149,7 +178,7 @@ static void transition_image_layout(VkCommandBuffer cmd,
     barrier.subresourceRange.baseMipLevel   = 0;
     barrier.subresourceRange.layerCount     = 1;
     barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.levelCount     = 1;
+    barrier.subresourceRange.levelCount     = mip_levels;
     barrier.srcAccessMask                   = 0;
     barrier.dstAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
 
@@ -212,6 +241,109 @@ static void transition_image_layout(VkCommandBuffer cmd,
                          &barrier);
 }
 
+// Blits every level from the previous one. Level 0 must be in transfer dst layout, the whole chain
+// ends up in shader read layout.
+static void record_mip_chain(VkCommandBuffer cmd,
+                             VkImage         image,
+                             u32             width,
+                             u32             height,
+                             u32             mip_levels)
+{
+    VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    barrier.image                           = image;
+    barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount     = 1;
+    barrier.subresourceRange.levelCount     = 1;
+
+    i32 mip_width  = static_cast<i32>(width);
+    i32 mip_height = static_cast<i32>(height);
+
+    for (u32 level = 1; level < mip_levels; ++level)
+    {
+        barrier.subresourceRange.baseMipLevel = level - 1;
+        barrier.oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout                     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask                 = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask                 = VK_ACCESS_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier(cmd,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             1,
+                             &barrier);
+
+        const i32 next_width  = std::max(1, mip_width / 2);
+        const i32 next_height = std::max(1, mip_height / 2);
+
+        VkImageBlit blit                   = {};
+        blit.srcOffsets[1]                 = {mip_width, mip_height, 1};
+        blit.srcSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel       = level - 1;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount     = 1;
+        blit.dstOffsets[1]                 = {next_width, next_height, 1};
+        blit.dstSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.dstSubresource.mipLevel       = level;
+        blit.dstSubresource.baseArrayLayer = 0;
+        blit.dstSubresource.layerCount     = 1;
+
+        vkCmdBlitImage(cmd,
+                       image,
+                       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       image,
+                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       1,
+                       &blit,
+                       VK_FILTER_LINEAR);
+
+        // The previous level is final once it has been read.
+        barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(cmd,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             1,
+                             &barrier);
+
+        mip_width  = next_width;
+        mip_height = next_height;
+    }
+
+    // The last level was only written.
+    barrier.subresourceRange.baseMipLevel = mip_levels - 1;
+    barrier.oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout                     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask                 = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask                 = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(cmd,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         1,
+                         &barrier);
+}
+
 static bool create_shader_module(VkDevice                             device,
                                  const pinut::resources::ShaderStage& shader_stage,
                                  VkShaderModule&                      shader_module)
@@ -241,9 +373,11 @@ static constexpr bool enable_validation_layers = true;
 static constexpr bool enable_validation_layers = false;
 #endif
 
-std::map<std::string, VulkanShaderState> VulkanDevice::shaders;
-std::map<std::string, VulkanPipeline>    VulkanDevice::pipelines;
-std::map<std::string, VulkanRenderPass>  VulkanDevice::render_passes;
+std::map<u64, VulkanShaderState>                   VulkanDevice::shaders;
+std::map<std::string, VulkanPipeline>              VulkanDevice::pipelines;
+std::map<std::string, resources::RenderPassHandle> VulkanDevice::render_passes;
+std::map<u64, VulkanPipeline>                      VulkanDevice::pipelines_by_hash;
+std::map<u64, VkPipelineLayout>                    VulkanDevice::pipeline_layouts;
 
 VulkanDevice::~VulkanDevice()
 {
@@ -256,11 +390,22 @@ void VulkanDevice::init(const DeviceDescriptor& descriptor)
     extent        = {descriptor.width, descriptor.height};
 
     deletion_queue.reserve(32);
+    for (auto& bin : deletion_bins)
+    {
+        bin.reserve(32);
+    }
 
     PDEBUG("GPU Device init.");
     create_instance();
     create_surface(window_handle);
     create_device();
+
+    if (descriptor.pipeline_cache_path)
+    {
+        pipeline_cache_path = descriptor.pipeline_cache_path;
+    }
+    load_pipeline_cache();
+
     create_swapchain();
 
     // Create command pool
@@ -270,10 +415,15 @@ void VulkanDevice::init(const DeviceDescriptor& descriptor)
 
     VK_CHECK(vkCreateCommandPool(device, &cmd_pool_info, nullptr, &command_pool));
 
+    transfer.init(device, transfer_queue, transfer_family, graphics_family);
+    PINFO("Uploads run on %s queue.",
+          transfer.is_dedicated() ? "a dedicated transfer" : "the graphics");
+
     buffers.init(DEFAULT_RESOURCES_COUNT, sizeof(VulkanBuffer));
     textures.init(DEFAULT_RESOURCES_COUNT, sizeof(VulkanTexture));
     descriptor_sets.init(DEFAULT_RESOURCES_COUNT, sizeof(VulkanDescriptorSet));
     descriptor_set_layouts.init(DEFAULT_RESOURCES_COUNT, sizeof(VulkanDescriptorSetLayout));
+    renderpasses.init(DEFAULT_RESOURCES_COUNT, sizeof(VulkanRenderPass));
 
     depth_texture = create_texture({nullptr,
                                     descriptor.width,
@@ -361,13 +511,18 @@ void VulkanDevice::init(const DeviceDescriptor& descriptor)
 
     VK_CHECK(vkCreateRenderPass(device, &render_pass_info, nullptr, &render_pass));
 
-    VulkanRenderPass vulkan_renderpass = {};
-    vulkan_renderpass.type             = resources::RenderPassType::SWAPCHAIN;
-    vulkan_renderpass.handle           = render_pass;
-    vulkan_renderpass.width            = static_cast<u16>(extent.width);
-    vulkan_renderpass.height           = static_cast<u16>(extent.height);
+    resources::RenderPassHandle swapchain_pass_handle{renderpasses.get_resource()};
+    auto swapchain_pass = access_render_pass(swapchain_pass_handle.id);
+    swapchain_pass->type                   = resources::RenderPassType::SWAPCHAIN;
+    swapchain_pass->handle                 = render_pass;
+    swapchain_pass->framebuffer            = VK_NULL_HANDLE;
+    swapchain_pass->width                  = static_cast<u16>(extent.width);
+    swapchain_pass->height                 = static_cast<u16>(extent.height);
+    swapchain_pass->color_attachment_count = 1;
+    swapchain_pass->has_depth              = true;
 
-    VulkanDevice::render_passes.insert({"Swapchain_renderpass", vulkan_renderpass});
+    auto it = VulkanDevice::render_passes.insert({get_swapchain_pass(), swapchain_pass_handle});
+    swapchain_pass->name = it.first->first.c_str();
 
     // Init imgui
     VulkanContext imgui_context;
@@ -404,42 +559,64 @@ void VulkanDevice::init(const DeviceDescriptor& descriptor)
         command_buffers[i].device = this;
         auto cmd_alloc_info       = vkinit::command_buffer_allocate_info(command_pool);
         VK_CHECK(vkAllocateCommandBuffers(device, &cmd_alloc_info, &command_buffers[i].cmd));
+        VK_CHECK(vkAllocateCommandBuffers(device, &cmd_alloc_info, &acquire_command_buffers[i]));
     }
 
-    // Create semaphores and fences
+    create_timestamp_queries();
+
+    // Create semaphores
     for (i32 i = 0; i < MAX_SWAPCHAIN_IMAGES; ++i)
     {
         VkSemaphoreCreateInfo semaphore_info = vkinit::semaphore_create_info();
         VK_CHECK(vkCreateSemaphore(device, &semaphore_info, nullptr, &render_semaphores[i]));
         VK_CHECK(vkCreateSemaphore(device, &semaphore_info, nullptr, &present_semaphores[i]));
-
-        VkFenceCreateInfo fence_info = vkinit::fence_create_info(VK_FENCE_CREATE_SIGNALED_BIT);
-        VK_CHECK(vkCreateFence(device, &fence_info, nullptr, &render_fences[i]));
     }
 
-    // Create Descriptor pool
-    VkDescriptorPoolSize pool_sizes[] = {
-      {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, MAX_SWAPCHAIN_IMAGES},
-      {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_SWAPCHAIN_IMAGES}};
+    VkSemaphoreTypeCreateInfo timeline_type_info = {VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+    timeline_type_info.semaphoreType             = VK_SEMAPHORE_TYPE_TIMELINE;
+    timeline_type_info.initialValue              = 0;
+
+    VkSemaphoreCreateInfo timeline_info = vkinit::semaphore_create_info();
+    timeline_info.pNext                 = &timeline_type_info;
+    VK_CHECK(vkCreateSemaphore(device, &timeline_info, nullptr, &frame_timeline));
 
-    VkDescriptorPoolCreateInfo pool_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
-    pool_info.poolSizeCount              = 2;
-    pool_info.pPoolSizes                 = pool_sizes;
-    pool_info.maxSets                    = static_cast<u32>(MAX_SWAPCHAIN_IMAGES);
-    pool_info.flags                      = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    descriptor_allocator.init(device, MAX_SWAPCHAIN_IMAGES);
 
-    VK_CHECK(vkCreateDescriptorPool(device, &pool_info, nullptr, &descriptor_pool));
+    if (bindless_supported)
+    {
+        create_bindless_set();
+    }
 }
 
 void VulkanDevice::shutdown()
 {
-    VK_CHECK(vkWaitForFences(device, MAX_SWAPCHAIN_IMAGES, render_fences, VK_TRUE, UINT64_MAX));
+    wait_for_frame(submitted_frames);
+
+    // Resources of an upload still being recorded would never leave the deletion bins.
+    transfer.flush();
+    transfer.wait(transfer.get_submitted_value());
     VK_CHECK(vkDeviceWaitIdle(device));
 
     destroy_texture_immediate(depth_texture.id);
 
-    destroy_pending_resources();
+    if (bindless_supported)
+    {
+        destroy_descriptor_set_immediate(bindless_set.id);
+        destroy_descriptor_set_layout_immediate(bindless_set_layout.id);
+    }
+
+    // Nothing is in flight anymore, every bin goes.
+    deletion_bins[current_frame].insert(deletion_bins[current_frame].end(),
+                                        deletion_queue.begin(),
+                                        deletion_queue.end());
     deletion_queue.clear();
+    for (u32 i = 0; i < MAX_SWAPCHAIN_IMAGES; ++i)
+    {
+        destroy_pending_resources(i);
+        ASSERT(deletion_bins[i].empty());
+    }
+
+    transfer.shutdown();
 
     buffers.shutdown();
     textures.shutdown();
@@ -448,7 +625,13 @@ void VulkanDevice::shutdown()
 
     shutdown_imgui();
 
-    vkDestroyDescriptorPool(device, descriptor_pool, nullptr);
+    descriptor_allocator.shutdown();
+
+    for (auto& it : sampler_cache)
+    {
+        vkDestroySampler(device, it.second.sampler, nullptr);
+    }
+    sampler_cache.clear();
 
     // Clear shaders
     for (auto& shader : shaders)
@@ -459,22 +642,53 @@ void VulkanDevice::shutdown()
         }
     }
 
-    for (auto& it : pipelines)
+    for (auto& it : pipelines_by_hash)
     {
         vkDestroyPipeline(device, it.second.pipeline, nullptr);
-        vkDestroyPipelineLayout(device, it.second.pipeline_layout, nullptr);
+    }
+
+    for (auto& it : pipeline_layouts)
+    {
+        vkDestroyPipelineLayout(device, it.second, nullptr);
     }
 
     for (u32 i = 0; i < MAX_SWAPCHAIN_IMAGES; ++i)
     {
-        vkDestroyFence(device, render_fences[i], nullptr);
         vkDestroySemaphore(device, present_semaphores[i], nullptr);
         vkDestroySemaphore(device, render_semaphores[i], nullptr);
     }
+    vkDestroySemaphore(device, frame_timeline, nullptr);
+
+    for (u32 i = 0; i < MAX_SWAPCHAIN_IMAGES; ++i)
+    {
+        if (command_buffers[i].timestamp_pool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(device, command_buffers[i].timestamp_pool, nullptr);
+        }
+    }
 
     vkDestroyCommandPool(device, command_pool, nullptr);
     destroy_swapchain();
     vkDestroyRenderPass(device, render_pass, nullptr);
+
+    for (auto& it : render_passes)
+    {
+        const auto pass = access_render_pass(it.second.id);
+        if (pass->framebuffer != VK_NULL_HANDLE)
+        {
+            vkDestroyFramebuffer(device, pass->framebuffer, nullptr);
+        }
+        renderpasses.remove_resource(it.second.id);
+    }
+    render_passes.clear();
+    renderpasses.shutdown();
+
+    for (auto& it : render_pass_cache)
+    {
+        vkDestroyRenderPass(device, it.second, nullptr);
+    }
+    render_pass_cache.clear();
+    save_pipeline_cache();
     vkDestroySurfaceKHR(vulkan_instance, vulkan_surface, nullptr);
     vkDestroyDevice(device, nullptr);
     vkDestroyInstance(vulkan_instance, nullptr);
@@ -498,7 +712,8 @@ resources::BufferHandle VulkanDevice::create_buffer(const resources::BufferDescr
         return handle;
     }
 
-    auto buffer = access_buffer(handle.id);
+    auto buffer            = access_buffer(handle.id);
+    buffer->transfer_value = 0;
 
     VkBufferUsageFlags    usage_flags  = VK_BUFFER_USAGE_FLAG_BITS_MAX_ENUM;
     VkMemoryPropertyFlags memory_flags = VK_MEMORY_PROPERTY_FLAG_BITS_MAX_ENUM;
@@ -524,9 +739,17 @@ resources::BufferHandle VulkanDevice::create_buffer(const resources::BufferDescr
               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
             break;
         case resources::BufferType::STORAGE:
-            // TODO review storage usage flags.
-            usage_flags  = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+            usage_flags  = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
             memory_flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+            if (descriptor.host_visible)
+            {
+                memory_flags =
+                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+            }
+            if (bindless_supported && descriptor.bindless)
+            {
+                bindless_buffers_to_update.push_back(handle.id);
+            }
             break;
         default:
             break;
@@ -536,6 +759,8 @@ resources::BufferHandle VulkanDevice::create_buffer(const resources::BufferDescr
 
     if (descriptor.data)
     {
+        // Initial data is written through a mapping, device local buffers go through staging.
+        ASSERT(memory_flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
         // TODO Descriptor should provide offset. Data may not be at position 0.
         void* data;
         vkMapMemory(device, buffer->memory, 0, descriptor.size, 0, &data);
@@ -555,13 +780,34 @@ resources::TextureHandle VulkanDevice::create_texture(
         return handle;
     }
 
-    VulkanTexture* texture = access_texture(handle.id);
-    texture->format        = get_texture_format(descriptor.format);
+    VulkanTexture* texture  = access_texture(handle.id);
+    texture->format         = get_texture_format(descriptor.format);
+    texture->width          = descriptor.width;
+    texture->height         = descriptor.height;
+    texture->transfer_value = 0;
 
     VkImageType texture_type = get_texture_type(descriptor.type);
 
+    u32  mip_levels    = std::max<u32>(descriptor.mip_levels, 1);
+    bool generate_mips = descriptor.generate_mips && mip_levels > 1;
+
+    // Every level is blitted from the previous one with linear filtering, block compressed formats
+    // never support it. Without it only the first level is uploaded.
+    const VkFormatFeatureFlags mip_features = VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+                                              VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                              VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    VkFormatProperties format_properties;
+    vkGetPhysicalDeviceFormatProperties(physical_device, texture->format, &format_properties);
+    if (generate_mips && (format_properties.optimalTilingFeatures & mip_features) != mip_features)
+    {
+        PWARN("Mips can not be generated for texture %s.",
+              descriptor.name ? descriptor.name : "unnamed");
+        generate_mips = false;
+        mip_levels    = 1;
+    }
+
     VkImageCreateInfo info = {VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
-    info.mipLevels         = descriptor.mip_levels;
+    info.mipLevels         = mip_levels;
     info.imageType         = texture_type;
     info.extent            = {descriptor.width, descriptor.height, 1};
     info.arrayLayers       = 1;
@@ -575,10 +821,22 @@ resources::TextureHandle VulkanDevice::create_texture(
     if (has_depth)
     {
         info.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        if (descriptor.render_target)
+        {
+            info.usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+        }
     }
     else
     {
         info.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        if (descriptor.render_target)
+        {
+            info.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        }
+        if (generate_mips)
+        {
+            info.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        }
     }
 
     auto ok = vkCreateImage(device, &info, nullptr, &texture->image);
@@ -593,19 +851,14 @@ resources::TextureHandle VulkanDevice::create_texture(
       find_memory_type(memory_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
     VK_CHECK(vkAllocateMemory(device, &allocate_info, nullptr, &texture->memory));
+    texture->memory_size = memory_requirements.size;
+    sogas::track_allocation(sogas::MemoryTag::GPU_MEMORY, texture->memory_size);
 
     vkBindImageMemory(device, texture->image, texture->memory, 0);
 
     if (descriptor.data != nullptr)
     {
-        // TODO channels? hardcoded to 4.
-        const u32 texture_size = descriptor.width * descriptor.height * 4;
-        auto      staging_buffer_handle =
-          create_buffer({texture_size, resources::BufferType::STAGING, descriptor.data});
-
-        copy_buffer_to_image(staging_buffer_handle, handle, descriptor.width, descriptor.height);
-
-        destroy_buffer(staging_buffer_handle);
+        upload_texture(handle, descriptor, mip_levels, generate_mips);
     }
 
     VkImageViewCreateInfo image_view_info = {VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
@@ -617,39 +870,90 @@ resources::TextureHandle VulkanDevice::create_texture(
     image_view_info.subresourceRange.baseArrayLayer = 0;
     image_view_info.subresourceRange.layerCount     = 1;
     image_view_info.subresourceRange.baseMipLevel   = 0;
-    image_view_info.subresourceRange.levelCount     = 1;
+    image_view_info.subresourceRange.levelCount     = mip_levels;
 
     VK_CHECK(vkCreateImageView(device, &image_view_info, nullptr, &texture->image_view));
 
-    //! TODO Make sampler global, not per image.
-    VkSamplerCreateInfo sampler_info{};
-    sampler_info.sType                   = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    sampler_info.magFilter               = VK_FILTER_LINEAR;
-    sampler_info.minFilter               = VK_FILTER_LINEAR;
-    sampler_info.addressModeU            = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_info.addressModeV            = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_info.addressModeW            = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_info.anisotropyEnable        = VK_TRUE;
-    sampler_info.maxAnisotropy           = physical_device_properties.limits.maxSamplerAnisotropy;
-    sampler_info.borderColor             = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-    sampler_info.unnormalizedCoordinates = VK_FALSE;
-    sampler_info.compareEnable           = VK_FALSE;
-    sampler_info.compareOp               = VK_COMPARE_OP_ALWAYS;
-    sampler_info.mipmapMode              = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-    sampler_info.mipLodBias              = 0.0f;
-    sampler_info.minLod                  = 0.0f;
-    sampler_info.maxLod                  = 0.0f;
+    texture->sampler = acquire_sampler(descriptor.sampler, texture->sampler_hash);
 
-    VK_CHECK(vkCreateSampler(device, &sampler_info, nullptr, &texture->sampler))
+    if (!has_depth)
+    {
+        bindless_textures_to_update.push_back(handle.id);
+    }
 
     return handle;
 }
 
 resources::RenderPassHandle VulkanDevice::create_renderpass(
-  const resources::RenderPassDescriptor& /*descriptor*/
-)
+  const resources::RenderPassDescriptor& descriptor)
 {
-    return {};
+    const bool has_depth = descriptor.depth_attachment.id != INVALID_ID;
+    ASSERT(descriptor.color_attachment_count > 0 || has_depth);
+
+    if (render_passes.contains(descriptor.name))
+    {
+        PWARN("Render pass %s already exists.", descriptor.name.c_str());
+        return render_passes.at(descriptor.name);
+    }
+
+    resources::RenderPassHandle handle{renderpasses.get_resource()};
+    if (handle.id == INVALID_ID)
+    {
+        return handle;
+    }
+
+    VkAttachmentDescription attachments[resources::MAX_COLOR_ATTACHMENTS + 1] = {};
+    VkImageView             views[resources::MAX_COLOR_ATTACHMENTS + 1]       = {};
+    const VulkanTexture*    first_texture                                     = nullptr;
+
+    const u32 attachment_count = descriptor.color_attachment_count + (has_depth ? 1 : 0);
+    for (u32 i = 0; i < attachment_count; ++i)
+    {
+        const bool is_depth  = i == descriptor.color_attachment_count;
+        const auto texture   = access_texture(is_depth ? descriptor.depth_attachment.id :
+                                                         descriptor.color_attachments[i].id);
+        const auto operation = is_depth ? descriptor.depth_operation : descriptor.color_operation;
+
+        // Targets are always left ready to be sampled.
+        const auto ready_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        auto& attachment          = attachments[i];
+        attachment.format         = texture->format;
+        attachment.samples        = VK_SAMPLE_COUNT_1_BIT;
+        attachment.loadOp         = get_attachment_load_op(operation);
+        attachment.storeOp        = VK_ATTACHMENT_STORE_OP_STORE;
+        attachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachment.initialLayout  = operation == resources::RenderPassOperation::LOAD ?
+                                      ready_layout :
+                                      VK_IMAGE_LAYOUT_UNDEFINED;
+        attachment.finalLayout    = ready_layout;
+
+        views[i]      = texture->image_view;
+        first_texture = first_texture ? first_texture : texture;
+    }
+
+    auto pass                    = access_render_pass(handle.id);
+    pass->type                   = descriptor.type;
+    pass->handle                 = get_render_pass(attachments,
+                                                   descriptor.color_attachment_count,
+                                                   has_depth);
+    pass->width                  = first_texture->width;
+    pass->height                 = first_texture->height;
+    pass->color_attachment_count = descriptor.color_attachment_count;
+    pass->has_depth              = has_depth;
+
+    // Created once, targets are not expected to change for the lifetime of the pass.
+    VkFramebufferCreateInfo framebuffer_info =
+      vkinit::framebuffer_create_info(pass->handle, {pass->width, pass->height});
+    framebuffer_info.attachmentCount = attachment_count;
+    framebuffer_info.pAttachments    = views;
+    VK_CHECK(vkCreateFramebuffer(device, &framebuffer_info, nullptr, &pass->framebuffer));
+
+    auto it    = render_passes.insert({descriptor.name, handle});
+    pass->name = it.first->first.c_str();
+
+    return handle;
 }
 
 resources::DescriptorSetLayoutHandle VulkanDevice::create_descriptor_set_layout(
@@ -657,6 +961,14 @@ resources::DescriptorSetLayoutHandle VulkanDevice::create_descriptor_set_layout(
 {
     ASSERT(descriptor.binding_count > 0);
 
+    const u64 hash = resources::hash_descriptor_set_layout(descriptor);
+    if (descriptor_set_layout_cache.contains(hash))
+    {
+        const auto cached_handle = descriptor_set_layout_cache.at(hash);
+        access_descriptor_set_layout(cached_handle.id)->reference_count++;
+        return cached_handle;
+    }
+
     resources::DescriptorSetLayoutHandle layout_handle = {descriptor_set_layouts.get_resource()};
     if (layout_handle.id == resources::invalid_descriptor_set_layout.id)
     {
@@ -666,6 +978,10 @@ resources::DescriptorSetLayoutHandle VulkanDevice::create_descriptor_set_layout(
     auto descriptor_set_layout = access_descriptor_set_layout(layout_handle.id);
     ASSERT(descriptor_set_layout != nullptr);
 
+    descriptor_set_layout->hash            = hash;
+    descriptor_set_layout->reference_count = 1;
+    descriptor_set_layout->bindings_count  = 0;
+
     descriptor_set_layout->bindings = (resources::DescriptorSetBindingDescriptor*)malloc(
       sizeof(resources::DescriptorSetBindingDescriptor) * descriptor.binding_count);
 
@@ -678,10 +994,26 @@ resources::DescriptorSetLayoutHandle VulkanDevice::create_descriptor_set_layout(
            {},
            sizeof(resources::DescriptorSetBindingDescriptor) * descriptor.binding_count);
 
+    ASSERT(!descriptor.bindless || bindless_supported);
+
     std::vector<VkDescriptorSetLayoutBinding> bindings(descriptor.binding_count);
+    std::vector<VkDescriptorBindingFlags>     binding_flags(descriptor.binding_count, 0);
     for (u32 i = 0; i < descriptor.binding_count; ++i)
     {
-        auto& in_binding = descriptor.bindings[i];
+        auto in_binding = descriptor.bindings[i];
+
+        if (descriptor.bindless)
+        {
+            // Unsized arrays in the shader get the whole bindless range.
+            if (in_binding.count == 0)
+            {
+                in_binding.count = resources::MAX_BINDLESS_RESOURCES;
+            }
+
+            binding_flags.at(i) = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                  VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                  VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+        }
 
         descriptor_set_layout->bindings[i] = in_binding;
         descriptor_set_layout->bindings_count++;
@@ -692,145 +1024,755 @@ resources::DescriptorSetLayoutHandle VulkanDevice::create_descriptor_set_layout(
         binding.descriptorType               = get_descriptor_type(in_binding.descriptor_type);
         binding.stageFlags                   = get_shader_stage_flag(in_binding.shader_stage);
 
-        bindings.at(i) = binding;
+        bindings.at(i) = binding;
+    }
+
+    VkDescriptorSetLayoutCreateInfo descriptor_set_layout_info = {
+      VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+    descriptor_set_layout_info.bindingCount = static_cast<u32>(bindings.size());
+    descriptor_set_layout_info.pBindings    = bindings.data();
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info = {
+      VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO};
+    binding_flags_info.bindingCount  = static_cast<u32>(binding_flags.size());
+    binding_flags_info.pBindingFlags = binding_flags.data();
+
+    if (descriptor.bindless)
+    {
+        descriptor_set_layout_info.flags =
+          VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        descriptor_set_layout_info.pNext = &binding_flags_info;
+    }
+
+    VK_CHECK(vkCreateDescriptorSetLayout(device,
+                                         &descriptor_set_layout_info,
+                                         nullptr,
+                                         &descriptor_set_layout->layout));
+
+    // Descriptor counts of one set, the allocator sizes its pools from them.
+    std::vector<VkDescriptorPoolSize> sizes_per_set;
+    for (const auto& binding : bindings)
+    {
+        auto it = std::find_if(sizes_per_set.begin(), sizes_per_set.end(), [&](const auto& size) {
+            return size.type == binding.descriptorType;
+        });
+
+        if (it == sizes_per_set.end())
+        {
+            sizes_per_set.push_back({binding.descriptorType, binding.descriptorCount});
+        }
+        else
+        {
+            it->descriptorCount += binding.descriptorCount;
+        }
+    }
+
+    descriptor_allocator.register_layout(
+      descriptor_set_layout->layout,
+      sizes_per_set,
+      descriptor.bindless ? VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT : 0);
+    descriptor_set_layout_cache.insert({hash, layout_handle});
+
+    return layout_handle;
+}
+
+resources::DescriptorSetHandle VulkanDevice::create_descriptor_set(
+  const resources::DescriptorSetDescriptor& descriptor)
+{
+    const auto layout = access_descriptor_set_layout(descriptor.layout_handle.id);
+    const auto key    = resources::get_descriptor_set_key(
+      descriptor, layout->bindings, layout->bindings_count, buffers, textures);
+    const u64  hash   = resources::hash_descriptor_set(key);
+
+    // A hash collision misses the cache, the new set is just not cached.
+    const auto cached = descriptor_set_cache.find(hash);
+    if (!descriptor.transient && cached != descriptor_set_cache.end() &&
+        access_descriptor_set(cached->second.id)->key == key)
+    {
+        access_descriptor_set(cached->second.id)->reference_count++;
+        return cached->second;
+    }
+
+    const resources::DescriptorSetHandle handle{descriptor_sets.get_resource()};
+    if (handle.id == resources::invalid_descriptor_set.id)
+    {
+        return handle;
+    }
+
+    const auto descriptor_set = access_descriptor_set(handle.id);
+
+    descriptor_set->layout          = layout->layout;
+    descriptor_set->key             = key;
+    descriptor_set->hash            = hash;
+    descriptor_set->reference_count = 1;
+    descriptor_set->transient       = descriptor.transient;
+
+    if (descriptor.transient)
+    {
+        descriptor_set->descriptor_set =
+          descriptor_allocator.allocate_transient(layout->layout, current_frame);
+        if (descriptor_set->descriptor_set == VK_NULL_HANDLE)
+        {
+            descriptor_sets.remove_resource(handle.id);
+            return resources::invalid_descriptor_set;
+        }
+        transient_descriptor_sets[current_frame].push_back(handle.id);
+    }
+    else
+    {
+        descriptor_set->descriptor_set = descriptor_allocator.allocate(layout->layout);
+        descriptor_set_cache.insert({hash, handle});
+    }
+
+    const u32 resources_count = descriptor.resources_used;
+
+    std::vector<VkWriteDescriptorSet>   write(resources_count);
+    std::vector<VkDescriptorImageInfo>  image_info(resources_count);
+    std::vector<VkDescriptorBufferInfo> buffer_info(resources_count);
+
+    for (u32 i = 0; i < resources_count; ++i)
+    {
+        const resources::DescriptorSetBindingDescriptor* binding = nullptr;
+        for (u32 j = 0; j < layout->bindings_count; ++j)
+        {
+            if (layout->bindings[j].binding == descriptor.bindings[i])
+            {
+                binding = &layout->bindings[j];
+                break;
+            }
+        }
+
+        if (binding == nullptr)
+        {
+            PFATAL("Binding %d not found in descriptor set layout.", descriptor.bindings[i]);
+            throw std::runtime_error("Descriptor set binding not found in layout.");
+        }
+
+        write[i]                 = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+        write[i].descriptorCount = 1;
+        write[i].dstSet          = descriptor_set->descriptor_set;
+        write[i].dstBinding      = binding->binding;
+        write[i].dstArrayElement = 0;
+        write[i].descriptorType  = get_descriptor_type(binding->descriptor_type);
+
+        switch (binding->descriptor_type)
+        {
+            case resources::DescriptorType::COMBINED_IMAGE_SAMPLER:
+            {
+                resources::TextureHandle texture_handle{descriptor.resources[i]};
+                const auto               texture = access_texture(texture_handle.id);
+
+                image_info[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                image_info[i].imageView   = texture->image_view;
+                image_info[i].sampler     = texture->sampler;
+
+                write[i].pImageInfo = &image_info[i];
+                break;
+            }
+            case resources::DescriptorType::UNIFORM:
+            case resources::DescriptorType::STORAGE:
+            {
+                resources::BufferHandle buffer_handle{descriptor.resources[i]};
+                const auto              buffer = access_buffer(buffer_handle.id);
+                ASSERT(buffer != nullptr);
+
+                buffer_info[i].buffer = buffer->buffer;
+                buffer_info[i].range  = VK_WHOLE_SIZE;
+                buffer_info[i].offset = 0;
+
+                write[i].pBufferInfo = &buffer_info[i];
+                break;
+            }
+            default:
+                ASSERT(false);
+                break;
+        }
+    }
+
+    vkUpdateDescriptorSets(device, resources_count, write.data(), 0, nullptr);
+
+    return handle;
+}
+
+void VulkanDevice::wait_for_frame(u64 value)
+{
+    VkSemaphoreWaitInfo wait_info = {VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+    wait_info.semaphoreCount      = 1;
+    wait_info.pSemaphores         = &frame_timeline;
+    wait_info.pValues             = &value;
+    VK_CHECK(vkWaitSemaphores(device, &wait_info, UINT64_MAX));
+}
+
+void VulkanDevice::begin_frame()
+{
+    wait_for_frame(frame_values[current_frame]);
+
+    read_gpu_zones(current_frame);
+
+    // Released before or while this slot was last recorded, nothing in flight uses them.
+    destroy_pending_resources(current_frame);
+
+    // The GPU is done with this frame, its transient descriptor sets can go back in bulk.
+    for (auto handle : transient_descriptor_sets[current_frame])
+    {
+        descriptor_sets.remove_resource(handle);
+    }
+    transient_descriptor_sets[current_frame].clear();
+    descriptor_allocator.reset_frame(current_frame);
+}
+
+u32 VulkanDevice::get_frame_index() const
+{
+    return current_frame;
+}
+
+void VulkanDevice::create_timestamp_queries()
+{
+    const u32 valid_bits = queue_family_properties.at(graphics_family).timestampValidBits;
+    if (valid_bits == 0 || physical_device_properties.limits.timestampPeriod <= 0.0f)
+    {
+        PWARN("The graphics queue has no timestamps, GPU zones are disabled.");
+        return;
+    }
+
+    timestamp_period = physical_device_properties.limits.timestampPeriod;
+    timestamp_mask   = valid_bits >= 64 ? ~0ull : (1ull << valid_bits) - 1;
+
+    VkQueryPoolCreateInfo pool_info = {VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    pool_info.queryType             = VK_QUERY_TYPE_TIMESTAMP;
+    pool_info.queryCount            = 2 * VulkanCommandBuffer::MAX_GPU_ZONES;
+    for (u32 i = 0; i < MAX_SWAPCHAIN_IMAGES; ++i)
+    {
+        VK_CHECK(
+          vkCreateQueryPool(device, &pool_info, nullptr, &command_buffers[i].timestamp_pool));
+    }
+
+    calibrate_timestamps();
+}
+
+void VulkanDevice::calibrate_timestamps()
+{
+    if (timestamp_period == 0.0)
+    {
+        return;
+    }
+
+    // A lone timestamp on an idle queue is written right when the submit reaches the GPU, it is
+    // paired with the CPU time halfway through the submit.
+    VkQueryPoolCreateInfo pool_info = {VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    pool_info.queryType             = VK_QUERY_TYPE_TIMESTAMP;
+    pool_info.queryCount            = 1;
+
+    VkQueryPool pool = VK_NULL_HANDLE;
+    VK_CHECK(vkCreateQueryPool(device, &pool_info, nullptr, &pool));
+
+    auto cmd = begin_single_use_command_buffer(device, command_pool);
+    vkCmdResetQueryPool(cmd, pool, 0, 1);
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, pool, 0);
+
+    const u64 before = get_steady_time();
+    end_single_use_command_buffer(device, command_pool, graphics_queue, cmd);
+    const u64 after = get_steady_time();
+
+    u64 ticks = 0;
+    VK_CHECK(vkGetQueryPoolResults(device,
+                                   pool,
+                                   0,
+                                   1,
+                                   sizeof(ticks),
+                                   &ticks,
+                                   sizeof(ticks),
+                                   VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+    vkDestroyQueryPool(device, pool, nullptr);
+
+    calibration_ticks = ticks & timestamp_mask;
+    calibration_time  = before + (after - before) / 2;
+}
+
+void VulkanDevice::read_gpu_zones(u32 frame)
+{
+    auto& cmd = command_buffers[frame];
+    if (!cmd.timestamps_submitted)
+    {
+        return;
+    }
+    cmd.timestamps_submitted = false;
+
+    gpu_zones.clear();
+
+    const u32 query_count = 2 * static_cast<u32>(cmd.gpu_zones.size());
+    if (query_count == 0)
+    {
+        return;
+    }
+
+    // The slot waited for its last submit, every query is written.
+    u64 ticks[2 * VulkanCommandBuffer::MAX_GPU_ZONES];
+    VK_CHECK(vkGetQueryPoolResults(device,
+                                   cmd.timestamp_pool,
+                                   0,
+                                   query_count,
+                                   query_count * sizeof(u64),
+                                   ticks,
+                                   sizeof(u64),
+                                   VK_QUERY_RESULT_64_BIT));
+
+    for (u32 i = 0; i < cmd.gpu_zones.size(); ++i)
+    {
+        auto zone  = cmd.gpu_zones.at(i);
+        zone.start = get_timestamp_time(ticks[2 * i]);
+        zone.end   = get_timestamp_time(ticks[2 * i + 1]);
+        gpu_zones.push_back(zone);
+    }
+}
+
+u64 VulkanDevice::get_timestamp_time(u64 ticks) const
+{
+    // Zones recorded before the calibration come out negative from it.
+    const i64 gpu_ticks = static_cast<i64>(ticks & timestamp_mask);
+    const i64 delta     = gpu_ticks - static_cast<i64>(calibration_ticks);
+    const f64 offset    = static_cast<f64>(delta) * timestamp_period;
+    return static_cast<u64>(static_cast<i64>(calibration_time) + static_cast<i64>(offset));
+}
+
+VkSampler VulkanDevice::acquire_sampler(const resources::SamplerDescriptor& descriptor,
+                                        u64&                                out_hash)
+{
+    out_hash = resources::hash_sampler(descriptor);
+
+    auto it = sampler_cache.find(out_hash);
+    if (it != sampler_cache.end())
+    {
+        it->second.reference_count++;
+        return it->second.sampler;
+    }
+
+    const bool anisotropy = descriptor.anisotropy && physical_device_features.samplerAnisotropy;
+
+    VkSamplerCreateInfo sampler_info     = {VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+    sampler_info.magFilter               = get_sampler_filter(descriptor.mag_filter);
+    sampler_info.minFilter               = get_sampler_filter(descriptor.min_filter);
+    sampler_info.mipmapMode              = get_sampler_mipmap_mode(descriptor.mip_filter);
+    sampler_info.addressModeU            = get_sampler_address_mode(descriptor.address_u);
+    sampler_info.addressModeV            = get_sampler_address_mode(descriptor.address_v);
+    sampler_info.addressModeW            = get_sampler_address_mode(descriptor.address_w);
+    sampler_info.anisotropyEnable        = anisotropy ? VK_TRUE : VK_FALSE;
+    sampler_info.maxAnisotropy           = physical_device_properties.limits.maxSamplerAnisotropy;
+    sampler_info.borderColor             = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    sampler_info.unnormalizedCoordinates = VK_FALSE;
+    sampler_info.compareEnable           = VK_FALSE;
+    sampler_info.compareOp               = VK_COMPARE_OP_ALWAYS;
+    sampler_info.mipLodBias              = descriptor.mip_lod_bias;
+    sampler_info.minLod                  = descriptor.min_lod;
+    sampler_info.maxLod                  = descriptor.max_lod;
+
+    VulkanSampler sampler   = {};
+    sampler.reference_count = 1;
+    VK_CHECK(vkCreateSampler(device, &sampler_info, nullptr, &sampler.sampler));
+
+    sampler_cache.insert({out_hash, sampler});
+    return sampler.sampler;
+}
+
+void VulkanDevice::release_sampler(u64 hash)
+{
+    auto it = sampler_cache.find(hash);
+    ASSERT(it != sampler_cache.end());
+
+    if (--it->second.reference_count == 0)
+    {
+        vkDestroySampler(device, it->second.sampler, nullptr);
+        sampler_cache.erase(it);
+    }
+}
+
+bool VulkanDevice::is_bindless_supported() const
+{
+    return bindless_supported;
+}
+
+resources::DescriptorSetLayoutHandle VulkanDevice::get_bindless_set_layout() const
+{
+    return bindless_set_layout;
+}
+
+resources::DescriptorSetHandle VulkanDevice::get_bindless_set() const
+{
+    return bindless_set;
+}
+
+void VulkanDevice::create_bindless_set()
+{
+    resources::DescriptorSetLayoutDescriptor layout_descriptor = {};
+    layout_descriptor.add_name("bindless_set_layout")
+      .set_bindless()
+      .add_binding({resources::BINDLESS_TEXTURE_BINDING,
+                    0,
+                    resources::ShaderStageType::ALL_GRAPHICS,
+                    resources::DescriptorType::COMBINED_IMAGE_SAMPLER})
+      .add_binding({resources::BINDLESS_BUFFER_BINDING,
+                    0,
+                    resources::ShaderStageType::ALL_GRAPHICS,
+                    resources::DescriptorType::STORAGE});
+
+    bindless_set_layout = create_descriptor_set_layout(layout_descriptor);
+    bindless_set        = {descriptor_sets.get_resource()};
+    ASSERT(bindless_set.id != INVALID_ID);
+
+    const auto layout         = access_descriptor_set_layout(bindless_set_layout.id);
+    const auto descriptor_set = access_descriptor_set(bindless_set.id);
+
+    descriptor_set->layout          = layout->layout;
+    descriptor_set->key             = {};
+    descriptor_set->hash            = 0;
+    descriptor_set->reference_count = 1;
+    descriptor_set->transient       = false;
+    descriptor_set->descriptor_set  = descriptor_allocator.allocate(layout->layout);
+}
+
+void VulkanDevice::update_bindless_set()
+{
+    if (!bindless_supported)
+    {
+        bindless_textures_to_update.clear();
+        bindless_buffers_to_update.clear();
+        return;
+    }
+
+    const u32 textures_count = static_cast<u32>(bindless_textures_to_update.size());
+    const u32 buffers_count  = static_cast<u32>(bindless_buffers_to_update.size());
+    if (textures_count + buffers_count == 0)
+    {
+        return;
+    }
+
+    const auto set = access_descriptor_set(bindless_set.id)->descriptor_set;
+
+    std::vector<VkWriteDescriptorSet>   write(textures_count + buffers_count);
+    std::vector<VkDescriptorImageInfo>  image_info(textures_count);
+    std::vector<VkDescriptorBufferInfo> buffer_info(buffers_count);
+
+    for (u32 i = 0; i < textures_count; ++i)
+    {
+        const auto handle = bindless_textures_to_update.at(i);
+        ASSERT(handle < resources::MAX_BINDLESS_RESOURCES);
+        const auto texture = access_texture(handle);
+
+        image_info[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        image_info[i].imageView   = texture->image_view;
+        image_info[i].sampler     = texture->sampler;
+
+        write[i]                 = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+        write[i].dstSet          = set;
+        write[i].dstBinding      = resources::BINDLESS_TEXTURE_BINDING;
+        write[i].dstArrayElement = handle;
+        write[i].descriptorCount = 1;
+        write[i].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write[i].pImageInfo      = &image_info[i];
+    }
+
+    for (u32 i = 0; i < buffers_count; ++i)
+    {
+        const auto handle = bindless_buffers_to_update.at(i);
+        ASSERT(handle < resources::MAX_BINDLESS_RESOURCES);
+
+        buffer_info[i].buffer = access_buffer(handle)->buffer;
+        buffer_info[i].offset = 0;
+        buffer_info[i].range  = VK_WHOLE_SIZE;
+
+        auto& buffer_write           = write[textures_count + i];
+        buffer_write                 = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+        buffer_write.dstSet          = set;
+        buffer_write.dstBinding      = resources::BINDLESS_BUFFER_BINDING;
+        buffer_write.dstArrayElement = handle;
+        buffer_write.descriptorCount = 1;
+        buffer_write.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        buffer_write.pBufferInfo     = &buffer_info[i];
+    }
+
+    vkUpdateDescriptorSets(device, static_cast<u32>(write.size()), write.data(), 0, nullptr);
+
+    bindless_textures_to_update.clear();
+    bindless_buffers_to_update.clear();
+}
+
+void VulkanDevice::create_pipeline(const resources::PipelineDescriptor& descriptor)
+{
+    create_pipelines({&descriptor, 1});
+}
+
+void VulkanDevice::create_pipelines(std::span<const resources::PipelineDescriptor> descriptors)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    const u32  count = static_cast<u32>(descriptors.size());
+
+    // Only descriptors whose hash is not known yet, nor repeated in this batch, get compiled.
+    std::vector<u64> hashes(count);
+    std::vector<u32> pending;
+    std::set<u64>    pending_hashes;
+    for (u32 i = 0; i < count; ++i)
+    {
+        hashes.at(i) = resources::hash_pipeline(descriptors[i]);
+        if (!pipelines_by_hash.contains(hashes.at(i)) && pending_hashes.insert(hashes.at(i)).second)
+        {
+            pending.push_back(i);
+        }
+    }
+
+    const u32 pending_count = static_cast<u32>(pending.size());
+
+    // Shader modules and layouts are shared through the static maps, so resolve them before
+    // going wide.
+    std::vector<VulkanShaderState> shader_states(pending_count);
+    std::vector<VulkanPipeline>    results(pending_count);
+    std::vector<u64>               new_layout_hashes;
+    for (u32 i = 0; i < pending_count; ++i)
+    {
+        const auto& descriptor  = descriptors[pending.at(i)];
+        const u64   layout_hash = resources::hash_pipeline_layout(descriptor);
+        if (!VulkanDevice::pipeline_layouts.contains(layout_hash))
+        {
+            new_layout_hashes.push_back(layout_hash);
+        }
+
+        shader_states.at(i)           = get_shader_state(descriptor.shader_state);
+        results.at(i).pipeline_layout = get_pipeline_layout(descriptor);
+    }
+
+    std::vector<VkResult> result_codes(pending_count, VK_SUCCESS);
+    std::atomic<u32>      next_pipeline = 0;
+
+    auto worker = [&]() {
+        for (u32 i = next_pipeline++; i < pending_count; i = next_pipeline++)
+        {
+            result_codes.at(i) =
+              build_pipeline(descriptors[pending.at(i)], shader_states.at(i), results.at(i));
+        }
+    };
+
+    const u32 hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    const u32 thread_count     = std::min(hardware_threads, pending_count);
+
+    if (thread_count <= 1)
+    {
+        worker();
+    }
+    else
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count - 1);
+        for (u32 i = 0; i < thread_count - 1; ++i)
+        {
+            threads.emplace_back(worker);
+        }
+
+        worker();
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    const auto failed = std::find_if(
+      result_codes.begin(), result_codes.end(), [](VkResult code) { return code != VK_SUCCESS; });
+    if (failed != result_codes.end())
+    {
+        // Nothing of the batch has been published yet, so whatever it created can go.
+        for (const auto& result : results)
+        {
+            vkDestroyPipeline(device, result.pipeline, nullptr);
+        }
+        for (const auto layout_hash : new_layout_hashes)
+        {
+            vkDestroyPipelineLayout(
+              device, VulkanDevice::pipeline_layouts.at(layout_hash), nullptr);
+            VulkanDevice::pipeline_layouts.erase(layout_hash);
+        }
+
+        const auto& descriptor = descriptors[pending.at(failed - result_codes.begin())];
+        PFATAL("Failed to create pipeline %s.", descriptor.name);
+        throw std::runtime_error("Failed to create pipeline handle.");
     }
 
-    VkDescriptorSetLayoutCreateInfo descriptor_set_layout_info = {
-      VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
-    descriptor_set_layout_info.bindingCount = static_cast<u32>(bindings.size());
-    descriptor_set_layout_info.pBindings    = bindings.data();
+    for (u32 i = 0; i < pending_count; ++i)
+    {
+        VulkanDevice::pipelines_by_hash.insert({hashes.at(pending.at(i)), results.at(i)});
+    }
 
-    VK_CHECK(vkCreateDescriptorSetLayout(device,
-                                         &descriptor_set_layout_info,
-                                         nullptr,
-                                         &descriptor_set_layout->layout));
+    for (u32 i = 0; i < count; ++i)
+    {
+        VulkanDevice::pipelines.insert(
+          {descriptors[i].name, VulkanDevice::pipelines_by_hash.at(hashes.at(i))});
+    }
 
-    return layout_handle;
+    const auto elapsed = std::chrono::duration<f64, std::milli>(
+                           std::chrono::high_resolution_clock::now() - start)
+                           .count();
+    PINFO("Created %u pipelines (%u unique) in %.2f ms using %u threads.",
+          count,
+          pending_count,
+          elapsed,
+          thread_count);
 }
 
-resources::DescriptorSetHandle VulkanDevice::create_descriptor_set(
-  const resources::DescriptorSetDescriptor& descriptor)
+VkPipelineLayout VulkanDevice::get_pipeline_layout(const resources::PipelineDescriptor& descriptor)
 {
-    const resources::DescriptorSetHandle handle{descriptor_sets.get_resource()};
-    if (handle.id == resources::invalid_descriptor_set.id)
+    const u64 hash = resources::hash_pipeline_layout(descriptor);
+    if (VulkanDevice::pipeline_layouts.contains(hash))
     {
-        return handle;
+        return VulkanDevice::pipeline_layouts.at(hash);
     }
 
-    const auto descriptor_set = access_descriptor_set(handle.id);
-    const auto layout         = access_descriptor_set_layout(descriptor.layout_handle.id);
+    VkDescriptorSetLayout set_layouts[8];
 
-    VkDescriptorSetAllocateInfo info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
-    info.descriptorPool              = descriptor_pool;
-    info.descriptorSetCount          = 1;
-    info.pSetLayouts                 = &layout->layout;
+    for (u32 i = 0; i < descriptor.layouts_count; ++i)
+    {
+        const auto layout = access_descriptor_set_layout(descriptor.descriptor_set_layouts[i].id);
 
-    VK_CHECK(vkAllocateDescriptorSets(device, &info, &descriptor_set->descriptor_set));
+        set_layouts[i] = layout->layout;
+    }
 
-    // TODO Why 8??
-    VkWriteDescriptorSet   write[8]       = {};
-    VkDescriptorImageInfo  image_info[8]  = {};
-    VkDescriptorBufferInfo buffer_info[8] = {};
+    VkPipelineLayoutCreateInfo pipeline_layout_info = {
+      VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+    pipeline_layout_info.setLayoutCount = descriptor.layouts_count;
+    pipeline_layout_info.pSetLayouts    = set_layouts;
 
-    for (u32 i = 0; i < descriptor.resources_used; ++i)
+    VkPushConstantRange push_constants[8] = {};
+    for (u32 i = 0; i < descriptor.push_constant_count; ++i)
     {
-        auto binding     = &layout->bindings[i];
-        binding->binding = descriptor.bindings[i];
+        push_constants[i].stageFlags = get_shader_stage_flag(descriptor.push_constants[i].stage);
+        push_constants[i].size       = descriptor.push_constants[i].size;
+        push_constants[i].offset     = descriptor.push_constants[i].offset;
+    }
 
-        write[i]                 = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-        write[i].descriptorCount = binding->count;
-        write[i].dstSet          = descriptor_set->descriptor_set;
-        write[i].dstBinding      = binding->binding;
-        write[i].dstArrayElement = 0;
+    pipeline_layout_info.pushConstantRangeCount = descriptor.push_constant_count;
+    pipeline_layout_info.pPushConstantRanges    = push_constants;
 
-        switch (binding->descriptor_type)
-        {
-            case resources::DescriptorType::COMBINED_IMAGE_SAMPLER:
-            {
-                resources::TextureHandle texture_handle{descriptor.resources[i]};
-                const auto               texture = access_texture(texture_handle.id);
+    VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
+    VK_CHECK(vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr, &pipeline_layout));
 
-                image_info[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                image_info[i].imageView   = texture->image_view;
-                image_info[i].sampler     = texture->sampler;
+    VulkanDevice::pipeline_layouts.insert({hash, pipeline_layout});
+    return pipeline_layout;
+}
 
-                write[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                write[i].pImageInfo     = &image_info[i];
-                break;
-            }
-            case resources::DescriptorType::UNIFORM:
-            {
-                resources::BufferHandle buffer_handle{descriptor.resources[i]};
-                const auto              buffer = access_buffer(buffer_handle.id);
-                ASSERT(buffer != nullptr);
+VulkanShaderState VulkanDevice::get_shader_state(
+  const resources::ShaderStateDescriptor& descriptor)
+{
+    const u64 hash = resources::hash_shader_state(descriptor);
+    if (VulkanDevice::shaders.contains(hash))
+    {
+        return VulkanDevice::shaders.at(hash);
+    }
 
-                buffer_info[i].buffer = buffer->buffer;
-                buffer_info[i].range  = VK_WHOLE_SIZE;
-                buffer_info[i].offset = 0;
+    VulkanShaderState pipeline_shader_stages_info;
+    const u32 shader_stages_count = static_cast<u32>(descriptor.number_used_stages);
+    pipeline_shader_stages_info.resize(shader_stages_count);
 
-                write[i].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                write[i].pBufferInfo    = &buffer_info[i];
-                break;
-            }
-            default:
-                ASSERT(false);
-                break;
+    u32 index = 0;
+    for (u32 i = 0; i < static_cast<u32>(resources::ShaderStageType::MAX_SHADER_TYPE); ++i)
+    {
+        if (descriptor.shader_stages[i].code.empty())
+        {
+            continue;
+        }
+
+        const auto&    shader_stage = descriptor.shader_stages[i];
+        VkShaderModule module;
+        if (!create_shader_module(device, shader_stage, module))
+        {
+            PFATAL("Failed to create shader module!");
+            throw std::runtime_error("Failed to create shader module");
         }
-    }
 
-    vkUpdateDescriptorSets(device, descriptor.resources_used, write, 0, nullptr);
+        VkPipelineShaderStageCreateInfo info = {
+          VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+        info.stage  = shader_stage.type == resources::ShaderStageType::VERTEX ?
+                        VK_SHADER_STAGE_VERTEX_BIT :
+                        VK_SHADER_STAGE_FRAGMENT_BIT;
+        info.module = module;
+        info.pName  = "main";
 
-    return handle;
-}
-void VulkanDevice::begin_frame()
-{
-    VK_CHECK(vkWaitForFences(device, 1, &render_fences[current_frame], VK_TRUE, UINT64_MAX));
+        pipeline_shader_stages_info.at(index) = info;
+        index++;
+    }
+
+    VulkanDevice::shaders.insert({hash, pipeline_shader_stages_info});
+    return pipeline_shader_stages_info;
 }
 
-void VulkanDevice::create_pipeline(const resources::PipelineDescriptor& descriptor)
+// Main thread only, it inserts into render_pass_cache.
+VkRenderPass VulkanDevice::get_render_pass(const VkAttachmentDescription* attachments,
+                                           u32                            color_attachment_count,
+                                           bool                           has_depth)
 {
-    VulkanShaderState pipeline_shader_stages_info;
-    if (VulkanDevice::shaders.contains(descriptor.shader_state.name))
+    const u32 attachment_count = color_attachment_count + (has_depth ? 1 : 0);
+
+    u64 hash = resources::hash_combine(resources::HASH_SEED, color_attachment_count);
+    hash     = resources::hash_combine(hash, has_depth);
+    hash     = resources::hash_bytes(attachments, attachment_count * sizeof(*attachments), hash);
+    if (render_pass_cache.contains(hash))
     {
-        pipeline_shader_stages_info = VulkanDevice::shaders.at(descriptor.shader_state.name);
+        return render_pass_cache.at(hash);
     }
-    else
-    {
-        const u32 shader_stages_count =
-          static_cast<u32>(descriptor.shader_state.number_used_stages);
-        pipeline_shader_stages_info.resize(shader_stages_count);
 
-        u32 index = 0;
-        for (u32 i = 0; i < static_cast<u32>(resources::ShaderStageType::MAX_SHADER_TYPE); ++i)
-        {
-            if (descriptor.shader_state.shader_stages[i].code.empty())
-            {
-                continue;
-            }
+    VkAttachmentReference color_references[resources::MAX_COLOR_ATTACHMENTS];
+    for (u32 i = 0; i < color_attachment_count; ++i)
+    {
+        color_references[i] = {i, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+    }
+    VkAttachmentReference depth_reference = {color_attachment_count,
+                                             VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
 
-            const auto&    shader_stage = descriptor.shader_state.shader_stages[i];
-            VkShaderModule module;
-            if (!create_shader_module(device, shader_stage, module))
-            {
-                PFATAL("Failed to create shader module!");
-                throw std::runtime_error("Failed to create shader module");
-            }
+    VkSubpassDescription subpass    = {};
+    subpass.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount    = color_attachment_count;
+    subpass.pColorAttachments       = color_references;
+    subpass.pDepthStencilAttachment = has_depth ? &depth_reference : nullptr;
+
+    const VkPipelineStageFlags attachment_stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                                   VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+                                                   VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    const VkAccessFlags attachment_writes =
+      VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    // Targets were sampled or written by an earlier pass, and are sampled after this one.
+    VkSubpassDependency dependencies[2] = {};
+    dependencies[0].srcSubpass          = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass          = 0;
+    dependencies[0].srcStageMask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | attachment_stages;
+    dependencies[0].srcAccessMask = attachment_writes;
+    dependencies[0].dstStageMask  = attachment_stages;
+    dependencies[0].dstAccessMask = attachment_writes | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+
+    dependencies[1].srcSubpass    = 0;
+    dependencies[1].dstSubpass    = VK_SUBPASS_EXTERNAL;
+    dependencies[1].srcStageMask  = attachment_stages;
+    dependencies[1].srcAccessMask = attachment_writes;
+    dependencies[1].dstStageMask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-            VkPipelineShaderStageCreateInfo info = {
-              VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
-            info.stage  = shader_stage.type == resources::ShaderStageType::VERTEX ?
-                            VK_SHADER_STAGE_VERTEX_BIT :
-                            VK_SHADER_STAGE_FRAGMENT_BIT;
-            info.module = module;
-            info.pName  = "main";
+    VkRenderPassCreateInfo render_pass_info = {VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
+    render_pass_info.attachmentCount        = attachment_count;
+    render_pass_info.pAttachments           = attachments;
+    render_pass_info.subpassCount           = 1;
+    render_pass_info.pSubpasses             = &subpass;
+    render_pass_info.dependencyCount        = 2;
+    render_pass_info.pDependencies          = dependencies;
 
-            pipeline_shader_stages_info.at(index) = info;
-            index++;
-        }
+    VkRenderPass new_render_pass = VK_NULL_HANDLE;
+    VK_CHECK(vkCreateRenderPass(device, &render_pass_info, nullptr, &new_render_pass));
 
-        VulkanDevice::shaders.insert({descriptor.shader_state.name, pipeline_shader_stages_info});
-    }
+    render_pass_cache.insert({hash, new_render_pass});
+    return new_render_pass;
+}
 
+// Safe to call from several threads at once, it only reads device state.
+VkResult VulkanDevice::build_pipeline(const resources::PipelineDescriptor& descriptor,
+                                      const VulkanShaderState&              shader_state,
+                                      VulkanPipeline&                       pipeline)
+{
     VkPipelineRasterizationStateCreateInfo rasterization_info = {
       VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO};
     rasterization_info.cullMode  = vulkan::get_cull_mode_flag(descriptor.rasterization.cull_mode);
@@ -899,11 +1841,13 @@ void VulkanDevice::create_pipeline(const resources::PipelineDescriptor& descript
         vertex_input_info.pVertexBindingDescriptions    = nullptr;
     }
 
+    const auto& depth_stencil = descriptor.depth_stencil;
+
     VkPipelineDepthStencilStateCreateInfo depth_stencil_info = {
       VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO};
-    depth_stencil_info.depthTestEnable       = VK_TRUE;
-    depth_stencil_info.depthWriteEnable      = VK_TRUE;
-    depth_stencil_info.depthCompareOp        = VK_COMPARE_OP_LESS;
+    depth_stencil_info.depthTestEnable       = depth_stencil.depth_test ? VK_TRUE : VK_FALSE;
+    depth_stencil_info.depthWriteEnable      = depth_stencil.depth_write ? VK_TRUE : VK_FALSE;
+    depth_stencil_info.depthCompareOp        = get_compare_op(depth_stencil.depth_compare);
     depth_stencil_info.depthBoundsTestEnable = VK_FALSE;
     depth_stencil_info.stencilTestEnable     = VK_FALSE;
 
@@ -916,12 +1860,36 @@ void VulkanDevice::create_pipeline(const resources::PipelineDescriptor& descript
     multisampling_info.alphaToCoverageEnable = VK_FALSE;
     multisampling_info.alphaToOneEnable      = VK_FALSE;
 
+    // Offscreen pipelines are built against their pass, any pass with the same formats can use it.
+    const auto pass_name = descriptor.render_pass ? descriptor.render_pass : get_swapchain_pass();
+    if (!render_passes.contains(pass_name))
+    {
+        PERROR("Render pass %s not found for pipeline %s.",
+               pass_name.c_str(),
+               descriptor.name ? descriptor.name : "unnamed");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+    const auto pass = access_render_pass(render_passes.at(pass_name).id);
+
     VkPipelineColorBlendAttachmentState color_blend_attachment = {
       VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO};
     color_blend_attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
                                             VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
     color_blend_attachment.blendEnable = VK_FALSE;
 
+    // Without a fragment shader the color outputs are undefined, depth only pipelines mask them.
+    const auto fragment_stage = static_cast<u32>(resources::ShaderStageType::FRAGMENT);
+    if (descriptor.shader_state.shader_stages[fragment_stage].code.empty())
+    {
+        color_blend_attachment.colorWriteMask = 0;
+    }
+
+    VkPipelineColorBlendAttachmentState color_blend_attachments[resources::MAX_COLOR_ATTACHMENTS];
+    for (u32 i = 0; i < pass->color_attachment_count; ++i)
+    {
+        color_blend_attachments[i] = color_blend_attachment;
+    }
+
     VkViewport viewport;
     viewport.x        = descriptor.viewport.viewport.x;
     viewport.y        = descriptor.viewport.viewport.y;
@@ -953,42 +1921,12 @@ void VulkanDevice::create_pipeline(const resources::PipelineDescriptor& descript
       VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO};
     color_blend_info.logicOpEnable   = VK_FALSE;
     color_blend_info.logicOp         = VK_LOGIC_OP_COPY;
-    color_blend_info.attachmentCount = 1;
-    color_blend_info.pAttachments    = &color_blend_attachment;
-
-    VulkanPipeline pipeline;
-
-    VkDescriptorSetLayout set_layouts[8];
-
-    for (u32 i = 0; i < descriptor.layouts_count; ++i)
-    {
-        const auto layout = access_descriptor_set_layout(descriptor.descriptor_set_layouts[i].id);
-
-        set_layouts[i] = layout->layout;
-    }
-
-    VkPipelineLayoutCreateInfo pipeline_layout_info = {
-      VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
-    pipeline_layout_info.setLayoutCount = descriptor.layouts_count;
-    pipeline_layout_info.pSetLayouts    = set_layouts;
-
-    VkPushConstantRange push_constants[8] = {};
-    for (u32 i = 0; i < descriptor.push_constant_count; ++i)
-    {
-        push_constants[i].stageFlags = get_shader_stage_flag(descriptor.push_constants[i].stage);
-        push_constants[i].size       = descriptor.push_constants[i].size;
-        push_constants[i].offset     = descriptor.push_constants[i].offset;
-    }
-
-    pipeline_layout_info.pushConstantRangeCount = descriptor.push_constant_count;
-    pipeline_layout_info.pPushConstantRanges    = push_constants;
-
-    VK_CHECK(
-      vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr, &pipeline.pipeline_layout));
+    color_blend_info.attachmentCount = pass->color_attachment_count;
+    color_blend_info.pAttachments    = color_blend_attachments;
 
     VkGraphicsPipelineCreateInfo info = {VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
-    info.stageCount                   = static_cast<u32>(pipeline_shader_stages_info.size());
-    info.pStages                      = pipeline_shader_stages_info.data();
+    info.stageCount                   = static_cast<u32>(shader_state.size());
+    info.pStages                      = shader_state.data();
     info.pVertexInputState            = &vertex_input_info;
     info.pInputAssemblyState          = &assembly_info;
     info.pViewportState               = &viewport_info;
@@ -997,24 +1935,108 @@ void VulkanDevice::create_pipeline(const resources::PipelineDescriptor& descript
     info.pMultisampleState            = &multisampling_info;
     info.pColorBlendState             = &color_blend_info;
     info.layout                       = pipeline.pipeline_layout;
-    info.renderPass                   = render_pass;
+    info.renderPass                   = pass->handle;
     info.subpass                      = 0;
     info.pDynamicState                = &dynamic_state_info;
     info.basePipelineHandle           = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &info, nullptr, &pipeline.pipeline) !=
-        VK_SUCCESS)
+    return vkCreateGraphicsPipelines(device, pipeline_cache, 1, &info, nullptr, &pipeline.pipeline);
+}
+
+void VulkanDevice::load_pipeline_cache()
+{
+    VkPipelineCacheCreateInfo cache_info = {VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+
+    std::vector<u8> cache_data;
+    if (!pipeline_cache_path.empty())
     {
-        PFATAL("Failed to create pipeline.");
-        throw std::runtime_error("Failed to create pipeline handle.");
+        std::ifstream file(pipeline_cache_path, std::ios::binary | std::ios::ate);
+        if (file.is_open())
+        {
+            const auto file_size = static_cast<size_t>(file.tellg());
+            file.seekg(0);
+
+            PipelineCacheHeader header = {};
+            if (file_size >= sizeof(PipelineCacheHeader))
+            {
+                file.read(reinterpret_cast<char*>(&header), sizeof(PipelineCacheHeader));
+            }
+
+            const bool valid = file_size >= sizeof(PipelineCacheHeader) &&
+                               header.magic == PIPELINE_CACHE_MAGIC &&
+                               header.vendor_id == physical_device_properties.vendorID &&
+                               header.device_id == physical_device_properties.deviceID &&
+                               header.driver_version == physical_device_properties.driverVersion &&
+                               memcmp(header.uuid,
+                                      physical_device_properties.pipelineCacheUUID,
+                                      VK_UUID_SIZE) == 0 &&
+                               header.data_size == file_size - sizeof(PipelineCacheHeader);
+
+            if (valid)
+            {
+                cache_data.resize(header.data_size);
+                file.read(reinterpret_cast<char*>(cache_data.data()), header.data_size);
+                cache_info.initialDataSize = cache_data.size();
+                cache_info.pInitialData    = cache_data.data();
+                PINFO("Loaded pipeline cache %s (%llu bytes).",
+                      pipeline_cache_path.c_str(),
+                      header.data_size);
+            }
+            else
+            {
+                PWARN("Discarding stale pipeline cache %s.", pipeline_cache_path.c_str());
+            }
+        }
+    }
+
+    VK_CHECK(vkCreatePipelineCache(device, &cache_info, nullptr, &pipeline_cache));
+}
+
+void VulkanDevice::save_pipeline_cache()
+{
+    if (pipeline_cache == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    if (!pipeline_cache_path.empty())
+    {
+        size_t data_size = 0;
+        VK_CHECK(vkGetPipelineCacheData(device, pipeline_cache, &data_size, nullptr));
+
+        std::vector<u8> cache_data(data_size);
+        VK_CHECK(vkGetPipelineCacheData(device, pipeline_cache, &data_size, cache_data.data()));
+
+        PipelineCacheHeader header = {};
+        header.magic               = PIPELINE_CACHE_MAGIC;
+        header.vendor_id           = physical_device_properties.vendorID;
+        header.device_id           = physical_device_properties.deviceID;
+        header.driver_version      = physical_device_properties.driverVersion;
+        header.data_size           = data_size;
+        memcpy(header.uuid, physical_device_properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+        std::ofstream file(pipeline_cache_path, std::ios::binary | std::ios::trunc);
+        if (file.is_open())
+        {
+            file.write(reinterpret_cast<const char*>(&header), sizeof(PipelineCacheHeader));
+            file.write(reinterpret_cast<const char*>(cache_data.data()), data_size);
+        }
+        else
+        {
+            PWARN("Could not write pipeline cache %s.", pipeline_cache_path.c_str());
+        }
     }
 
-    VulkanDevice::pipelines.insert({descriptor.name, pipeline});
+    vkDestroyPipelineCache(device, pipeline_cache, nullptr);
+    pipeline_cache = VK_NULL_HANDLE;
 }
 
 void VulkanDevice::end_frame()
 {
-        // Acquire swapchain image.
+    // Update-after-bind, the set may already be bound in the commands being recorded.
+    update_bindless_set();
+
+    // Acquire swapchain image.
     auto ok = vkAcquireNextImageKHR(device,
                                     swapchain.swapchain,
                                     UINT64_MAX,
@@ -1033,25 +2055,63 @@ void VulkanDevice::end_frame()
         PFATAL("Failed to acquire swapchain image!");
     }
 
-    // Reset fence only when we know we are submitting work to the gpu.
-    VK_CHECK(vkResetFences(device, 1, &render_fences[current_frame]));
-
     // Record commands.
-    vkCmdEndRenderPass(command_buffers[current_frame].cmd);
+    command_buffers[current_frame].end_pass();
 
     VK_CHECK(vkEndCommandBuffer(command_buffers[current_frame].cmd));
 
-    // Submit commands
-    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    // Uploads recorded this frame start now, the frame only waits for them where it reads.
+    transfer.flush();
+
+    const auto acquire_cmd = acquire_command_buffers[current_frame];
+    VK_CHECK(vkResetCommandBuffer(acquire_cmd, 0));
 
-    VkSubmitInfo submit         = vkinit::submit_info(&command_buffers[current_frame].cmd);
-    submit.pWaitDstStageMask    = &waitStage;
-    submit.waitSemaphoreCount   = 1;
-    submit.pWaitSemaphores      = &present_semaphores[current_frame];
-    submit.signalSemaphoreCount = 1;
-    submit.pSignalSemaphores    = &render_semaphores[current_frame];
+    VkCommandBufferBeginInfo acquire_begin_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    acquire_begin_info.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK(vkBeginCommandBuffer(acquire_cmd, &acquire_begin_info));
+    transfer.record_acquires(acquire_cmd);
+    VK_CHECK(vkEndCommandBuffer(acquire_cmd));
 
-    VK_CHECK(vkQueueSubmit(graphics_queue, 1, &submit, render_fences[current_frame]));
+    // Submit commands
+    VkCommandBuffer submit_cmds[] = {acquire_cmd, command_buffers[current_frame].cmd};
+
+    const VkSemaphore          wait_semaphores[] = {present_semaphores[current_frame],
+                                                    transfer.get_semaphore()};
+    const VkPipelineStageFlags wait_stages[]     = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                                    VulkanTransferQueue::GRAPHICS_WAIT_STAGES};
+    const VkSemaphore signal_semaphores[] = {render_semaphores[current_frame], frame_timeline};
+
+    // Binary semaphore values are ignored.
+    const u64 frame_value     = submitted_frames + 1;
+    const u64 wait_values[]   = {0, transfer.get_submitted_value()};
+    const u64 signal_values[] = {0, frame_value};
+
+    VkTimelineSemaphoreSubmitInfo timeline_info = {
+      VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+    timeline_info.waitSemaphoreValueCount   = 2;
+    timeline_info.pWaitSemaphoreValues      = wait_values;
+    timeline_info.signalSemaphoreValueCount = 2;
+    timeline_info.pSignalSemaphoreValues    = signal_values;
+
+    VkSubmitInfo submit         = vkinit::submit_info(submit_cmds);
+    submit.pNext                = &timeline_info;
+    submit.commandBufferCount   = 2;
+    submit.pWaitDstStageMask    = wait_stages;
+    submit.waitSemaphoreCount   = 2;
+    submit.pWaitSemaphores      = wait_semaphores;
+    submit.signalSemaphoreCount = 2;
+    submit.pSignalSemaphores    = signal_semaphores;
+
+    VK_CHECK(vkQueueSubmit(graphics_queue, 1, &submit, VK_NULL_HANDLE));
+    command_buffers[current_frame].timestamps_submitted = true;
+
+    // Whatever was released until now may be used by this submit at the latest.
+    submitted_frames            = frame_value;
+    frame_values[current_frame] = frame_value;
+    deletion_bins[current_frame].insert(deletion_bins[current_frame].end(),
+                                        deletion_queue.begin(),
+                                        deletion_queue.end());
+    deletion_queue.clear();
 
     // Present image.
     VkPresentInfoKHR present_info   = vkinit::present_info();
@@ -1071,8 +2131,6 @@ void VulkanDevice::end_frame()
         PFATAL("Failed to present swapchain image!");
     }
 
-    destroy_pending_resources();
-
     current_frame = (current_frame + 1) % MAX_SWAPCHAIN_IMAGES;
 }
 
@@ -1083,11 +2141,17 @@ resources::CommandBuffer* VulkanDevice::get_command_buffer(bool begin)
         VkCommandBufferBeginInfo cmd_begin_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
         cmd_begin_info.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
         vkBeginCommandBuffer(command_buffers[current_frame].cmd, &cmd_begin_info);
+        command_buffers[current_frame].reset_gpu_zones();
     }
 
     return &command_buffers[current_frame];
 }
 
+const std::vector<resources::GPUZone>& VulkanDevice::get_gpu_zones() const
+{
+    return gpu_zones;
+}
+
 void* VulkanDevice::map_buffer(const resources::BufferHandle handle,
                                const u32                     size,
                                const u32                     offset)
@@ -1134,16 +2198,8 @@ void VulkanDevice::copy_buffer(const resources::BufferHandle src_buffer_handle,
         return;
     }
 
-    // Copy logic
-    VkCommandBufferAllocateInfo cmd_alloc_info = vkinit::command_buffer_allocate_info(command_pool);
-
-    VkCommandBuffer copy_cmd;
-    VK_CHECK(vkAllocateCommandBuffers(device, &cmd_alloc_info, &copy_cmd));
-
-    VkCommandBufferBeginInfo begin_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
-    begin_info.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    vkBeginCommandBuffer(copy_cmd, &begin_info);
+    // Recorded on the transfer queue, the frame that first reads the destination waits for it.
+    auto copy_cmd = transfer.get_command_buffer();
 
     VkBufferCopy region = {};
     region.size         = size;
@@ -1151,16 +2207,11 @@ void VulkanDevice::copy_buffer(const resources::BufferHandle src_buffer_handle,
     region.srcOffset    = src_offset;
     vkCmdCopyBuffer(copy_cmd, src_buffer->buffer, dst_buffer->buffer, 1, &region);
 
-    vkEndCommandBuffer(copy_cmd);
-
-    VkSubmitInfo submit_info       = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers    = &copy_cmd;
-
-    VK_CHECK(vkQueueSubmit(graphics_queue, 1, &submit_info, VK_NULL_HANDLE));
-    vkQueueWaitIdle(graphics_queue);
+    transfer.release_buffer(dst_buffer->buffer);
 
-    vkFreeCommandBuffers(device, command_pool, 1, &copy_cmd);
+    // Neither can be destroyed before the copy is done.
+    src_buffer->transfer_value = transfer.get_pending_value();
+    dst_buffer->transfer_value = transfer.get_pending_value();
 }
 
 void VulkanDevice::copy_buffer_to_image(const resources::BufferHandle  buffer_handle,
@@ -1184,7 +2235,7 @@ void VulkanDevice::copy_buffer_to_image(const resources::BufferHandle  buffer_ha
     region.imageOffset = {0, 0, 0};
     region.imageExtent = {width, height, 1};
 
-    auto cmd = begin_single_use_command_buffer(device, command_pool);
+    auto cmd = transfer.get_command_buffer();
 
     transition_image_layout(cmd,
                             texture->image,
@@ -1199,13 +2250,81 @@ void VulkanDevice::copy_buffer_to_image(const resources::BufferHandle  buffer_ha
                            1,
                            &region);
 
+    transfer.release_image(texture->image, 1);
+
+    buffer->transfer_value  = transfer.get_pending_value();
+    texture->transfer_value = transfer.get_pending_value();
+}
+
+void VulkanDevice::upload_texture(const resources::TextureHandle      handle,
+                                  const resources::TextureDescriptor& descriptor,
+                                  const u32                           mip_levels,
+                                  const bool                          generate_mips)
+{
+    // Every level the data holds goes in one staging buffer and one copy command.
+    const u32 data_levels = generate_mips ? 1 : mip_levels;
+    const u64 data_size   = resources::get_mip_chain_size(descriptor.format,
+                                                        descriptor.width,
+                                                        descriptor.height,
+                                                        data_levels);
+
+    auto staging_buffer_handle = create_buffer(
+      {static_cast<u32>(data_size), resources::BufferType::STAGING, descriptor.data});
+
+    const auto buffer  = access_buffer(staging_buffer_handle.id);
+    const auto texture = access_texture(handle.id);
+
+    std::vector<VkBufferImageCopy> regions(data_levels);
+    u64                            offset = 0;
+    for (u32 level = 0; level < data_levels; ++level)
+    {
+        const u32 width  = resources::get_mip_dimension(descriptor.width, level);
+        const u32 height = resources::get_mip_dimension(descriptor.height, level);
+
+        auto& region                           = regions.at(level);
+        region                                 = {};
+        region.bufferOffset                    = offset;
+        region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel       = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount     = 1;
+        region.imageExtent                     = {width, height, 1};
+
+        offset += resources::get_mip_size(descriptor.format, width, height);
+    }
+
+    // Blits need a graphics queue, only uploads of the whole chain go through the transfer queue.
+    auto cmd = generate_mips ? begin_single_use_command_buffer(device, command_pool)
+                             : transfer.get_command_buffer();
+
     transition_image_layout(cmd,
                             texture->image,
                             texture->format,
+                            VK_IMAGE_LAYOUT_UNDEFINED,
                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+                            mip_levels);
 
-    end_single_use_command_buffer(device, command_pool, graphics_queue, cmd);
+    vkCmdCopyBufferToImage(cmd,
+                           buffer->buffer,
+                           texture->image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           data_levels,
+                           regions.data());
+
+    if (generate_mips)
+    {
+        record_mip_chain(cmd, texture->image, descriptor.width, descriptor.height, mip_levels);
+        end_single_use_command_buffer(device, command_pool, graphics_queue, cmd);
+    }
+    else
+    {
+        transfer.release_image(texture->image, mip_levels);
+
+        buffer->transfer_value  = transfer.get_pending_value();
+        texture->transfer_value = transfer.get_pending_value();
+    }
+
+    destroy_buffer(staging_buffer_handle);
 }
 
 void VulkanDevice::destroy_buffer(resources::BufferHandle handle)
@@ -1220,11 +2339,37 @@ void VulkanDevice::destroy_texture(resources::TextureHandle handle)
 
 void VulkanDevice::destroy_descriptor_set(resources::DescriptorSetHandle handle)
 {
+    auto descriptor_set = access_descriptor_set(handle.id);
+    if (descriptor_set->transient)
+    {
+        return;
+    }
+
+    ASSERT(descriptor_set->reference_count > 0);
+    if (--descriptor_set->reference_count > 0)
+    {
+        return;
+    }
+
+    const auto cached = descriptor_set_cache.find(descriptor_set->hash);
+    if (cached != descriptor_set_cache.end() && cached->second.id == handle.id)
+    {
+        descriptor_set_cache.erase(cached);
+    }
     deletion_queue.push_back({resources::ResourceDestroyType::DESCRIPTOR_SET, handle.id});
 }
 
 void VulkanDevice::destroy_descriptor_set_layout(resources::DescriptorSetLayoutHandle handle)
 {
+    auto layout = access_descriptor_set_layout(handle.id);
+    ASSERT(layout->reference_count > 0);
+
+    if (--layout->reference_count > 0)
+    {
+        return;
+    }
+
+    descriptor_set_layout_cache.erase(layout->hash);
     deletion_queue.push_back({resources::ResourceDestroyType::DESCRIPTOR_SET_LAYOUT, handle.id});
 }
 
@@ -1234,7 +2379,9 @@ void VulkanDevice::destroy_buffer_immediate(resources::ResourceHandle handle)
 
     vkDestroyBuffer(device, buffer->buffer, nullptr);
     vkFreeMemory(device, buffer->memory, nullptr);
+    sogas::track_deallocation(sogas::MemoryTag::GPU_MEMORY, buffer->memory_size);
 
+    std::erase(bindless_buffers_to_update, handle);
     buffers.remove_resource(handle);
 }
 
@@ -1242,11 +2389,13 @@ void VulkanDevice::destroy_texture_immediate(resources::ResourceHandle handle)
 {
     const auto texture = access_texture(handle);
 
-    vkDestroySampler(device, texture->sampler, nullptr);
+    release_sampler(texture->sampler_hash);
     vkDestroyImageView(device, texture->image_view, nullptr);
     vkDestroyImage(device, texture->image, nullptr);
     vkFreeMemory(device, texture->memory, nullptr);
+    sogas::track_deallocation(sogas::MemoryTag::GPU_MEMORY, texture->memory_size);
 
+    std::erase(bindless_textures_to_update, handle);
     textures.remove_resource(handle);
 }
 
@@ -1254,7 +2403,7 @@ void VulkanDevice::destroy_descriptor_set_immediate(resources::ResourceHandle ha
 {
     auto descriptor_set = access_descriptor_set(handle);
 
-    vkFreeDescriptorSets(device, descriptor_pool, 1, &descriptor_set->descriptor_set);
+    descriptor_allocator.free(descriptor_set->layout, descriptor_set->descriptor_set);
 
     descriptor_sets.remove_resource(handle);
 }
@@ -1263,27 +2412,45 @@ void VulkanDevice::destroy_descriptor_set_layout_immediate(resources::ResourceHa
 {
     auto layout = access_descriptor_set_layout(handle);
 
+    descriptor_allocator.unregister_layout(layout->layout);
     vkDestroyDescriptorSetLayout(device, layout->layout, nullptr);
+    free(layout->bindings);
+    layout->bindings = nullptr;
 
     descriptor_set_layouts.remove_resource(handle);
 }
 
-void VulkanDevice::destroy_pending_resources()
+void VulkanDevice::destroy_pending_resources(u32 frame)
 {
-    if (deletion_queue.empty())
+    auto& bin = deletion_bins[frame];
+    if (bin.empty())
     {
         return;
     }
 
-    for (i32 i = (i32)deletion_queue.size() - 1; i >= 0; --i)
+    const u64 completed_transfer = transfer.get_completed_value();
+
+    // Entries still read or written by an upload are kept for the next time the slot comes around.
+    u32 kept = 0;
+    for (const auto& deletion : bin)
     {
-        const auto handle = deletion_queue.at(i).handle;
-        switch (deletion_queue.at(i).type)
+        const auto handle = deletion.handle;
+        switch (deletion.type)
         {
             case resources::ResourceDestroyType::BUFFER:
+                if (access_buffer(handle)->transfer_value > completed_transfer)
+                {
+                    bin.at(kept++) = deletion;
+                    continue;
+                }
                 destroy_buffer_immediate(handle);
                 break;
             case resources::ResourceDestroyType::TEXTURE:
+                if (access_texture(handle)->transfer_value > completed_transfer)
+                {
+                    bin.at(kept++) = deletion;
+                    continue;
+                }
                 destroy_texture_immediate(handle);
                 break;
             case resources::ResourceDestroyType::SHADER_STATE:
@@ -1297,11 +2464,9 @@ void VulkanDevice::destroy_pending_resources()
                 destroy_descriptor_set_layout_immediate(handle);
                 break;
         }
-
-        deletion_queue.erase(deletion_queue.begin() + i);
     }
 
-    ASSERT(deletion_queue.empty());
+    bin.resize(kept);
 }
 
 bool VulkanDevice::create_instance()
@@ -1368,6 +2533,11 @@ VulkanTexture* VulkanDevice::access_texture(resources::ResourceHandle handle)
     return static_cast<VulkanTexture*>(textures.access_resource(handle));
 }
 
+VulkanRenderPass* VulkanDevice::access_render_pass(resources::ResourceHandle handle)
+{
+    return static_cast<VulkanRenderPass*>(renderpasses.access_resource(handle));
+}
+
 VulkanDescriptorSet* VulkanDevice::access_descriptor_set(resources::ResourceHandle handle)
 {
     return static_cast<VulkanDescriptorSet*>(descriptor_sets.access_resource(handle));
@@ -1500,8 +2670,24 @@ std::vector<VkDeviceQueueCreateInfo> VulkanDevice::get_queues()
         ++i;
     }
 
+    // A transfer only family copies on its own engine while the graphics queue renders. Families
+    // with a coarser image transfer granularity would not fit the smallest mips.
+    transfer_family = graphics_family;
+    for (u32 family_index = 0; family_index < queue_family_count; ++family_index)
+    {
+        const auto& queue_family = queue_family_properties.at(family_index);
+        const auto& granularity  = queue_family.minImageTransferGranularity;
+        if (queue_family.queueCount > 0 && queue_family.queueFlags & VK_QUEUE_TRANSFER_BIT &&
+            !(queue_family.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) &&
+            granularity.width == 1 && granularity.height == 1 && granularity.depth == 1)
+        {
+            transfer_family = family_index;
+            break;
+        }
+    }
+
     std::vector<VkDeviceQueueCreateInfo> queueue_create_infos;
-    std::set<u32>                        unique_queue_families = {graphics_family, present_family};
+    std::set<u32> unique_queue_families = {graphics_family, present_family, transfer_family};
 
     f32 queue_priority = 1.0f;
     for (u32 queue_family : unique_queue_families)
@@ -1529,12 +2715,27 @@ void VulkanDevice::create_device()
       VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
       nullptr};
 
+    VkPhysicalDeviceTimelineSemaphoreFeatures timeline_features{
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES,
+      &indexing_features};
+
     VkPhysicalDeviceFeatures2 physical_features2 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
-                                                    &indexing_features};
+                                                    &timeline_features};
     vkGetPhysicalDeviceFeatures2(physical_device, &physical_features2);
 
-    bool bIs_bindless_supported =
-      indexing_features.descriptorBindingPartiallyBound && indexing_features.runtimeDescriptorArray;
+    // Uploads are tracked with a timeline semaphore.
+    if (!timeline_features.timelineSemaphore)
+    {
+        PFATAL("Timeline semaphores are not supported.");
+    }
+
+    bindless_supported = indexing_features.descriptorBindingPartiallyBound &&
+                         indexing_features.runtimeDescriptorArray &&
+                         indexing_features.shaderSampledImageArrayNonUniformIndexing &&
+                         indexing_features.descriptorBindingSampledImageUpdateAfterBind &&
+                         indexing_features.descriptorBindingStorageBufferUpdateAfterBind &&
+                         indexing_features.descriptorBindingUpdateUnusedWhilePending;
+    PINFO("Bindless descriptors %s.", bindless_supported ? "supported" : "not supported");
 
     VkDeviceCreateInfo device_create_info    = {VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
     device_create_info.queueCreateInfoCount  = static_cast<u32>(queue_create_infos.size());
@@ -1542,10 +2743,13 @@ void VulkanDevice::create_device()
     device_create_info.enabledExtensionCount = static_cast<u32>(required_device_extensions.size());
     device_create_info.ppEnabledExtensionNames = required_device_extensions.data();
 
-    if (bIs_bindless_supported)
+    // Every supported core feature is enabled, descriptor indexing only when bindless is usable.
+    physical_device_features = physical_features2.features;
+    if (!bindless_supported)
     {
-        device_create_info.pNext = &physical_features2;
+        timeline_features.pNext = nullptr;
     }
+    device_create_info.pNext = &physical_features2;
 
     if (enable_validation_layers)
     {
@@ -1563,6 +2767,7 @@ void VulkanDevice::create_device()
 
     vkGetDeviceQueue(device, graphics_family, 0, &graphics_queue);
     vkGetDeviceQueue(device, present_family, 0, &present_queue);
+    vkGetDeviceQueue(device, transfer_family, 0, &transfer_queue);
 }
 
 void VulkanDevice::create_surface(void* window)
@@ -1639,6 +2844,9 @@ void VulkanDevice::recreate_swapchain()
 {
     vkDeviceWaitIdle(device);
 
+    // The clocks drift apart over time, the device is idle anyway.
+    calibrate_timestamps();
+
     if (!minimized)
     {
         // Window closing.
@@ -1736,6 +2944,8 @@ void VulkanDevice::create_vulkan_buffer(const u32             size,
       find_memory_type(memory_requirements.memoryTypeBits, memory_property_flags);
 
     VK_CHECK(vkAllocateMemory(device, &allocate_info, nullptr, &buffer->memory));
+    buffer->memory_size = memory_requirements.size;
+    sogas::track_allocation(sogas::MemoryTag::GPU_MEMORY, buffer->memory_size);
 
     vkBindBufferMemory(device, buffer->buffer, buffer->memory, 0);
 }
@@ -1,7 +1,9 @@
 #include "pch.hpp"
 
 #include <imgui/backends/imgui_impl_vulkan.h>
+#ifdef WIN32
 #include <imgui/backends/imgui_impl_win32.h>
+#endif
 
 #include <vulkan/vulkan_device.h>
 #include <vulkan/vulkan_imgui.h>
@@ -46,19 +48,27 @@ void init_imgui(const VulkanContext& context)
     io.DisplaySize             = ImVec2(1280.0f, 720.0f);
     io.DisplayFramebufferScale = ImVec2(1.0f, 1.0f);
 
-    if (!ImGui_ImplVulkan_Init(&imgui_vulkan_info, context.render_pass) ||
-        !ImGui_ImplWin32_Init(context.window_handle))
+    if (!ImGui_ImplVulkan_Init(&imgui_vulkan_info, context.render_pass))
     {
         PFATAL("Failed to initialize imgui for vulkan backend.");
     }
 
+#ifdef WIN32
+    if (!ImGui_ImplWin32_Init(context.window_handle))
+    {
+        PFATAL("Failed to initialize imgui for win32 platform.");
+    }
+#endif
+
     ImGui_ImplVulkan_CreateFontsTexture();
 }
 
 void start_imgui_frame()
 {
     ImGui_ImplVulkan_NewFrame();
+#ifdef WIN32
     ImGui_ImplWin32_NewFrame();
+#endif
     ImGui::NewFrame();
 }
 
@@ -74,7 +84,9 @@ void end_imgui_frame(const resources::CommandBuffer& cmd)
 void shutdown_imgui()
 {
     ImGui_ImplVulkan_Shutdown();
+#ifdef WIN32
     ImGui_ImplWin32_Shutdown();
+#endif
     ImGui::DestroyContext();
     vkDestroyDescriptorPool(state->device, state->descriptor_pool, nullptr);
     delete state;
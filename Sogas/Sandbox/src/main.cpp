@@ -1,7 +1,31 @@
+#include <cstring>
+
 #include <engine/engine.h>
 
-int main()
+int main(int argc, char** argv)
 {
+    // --frames <count> quits after that many frames and --frame-time <seconds> paces them, so batch
+    // jobs and benchmarks end on their own when there is no window to close. --capture <count>
+    // writes the profiler zones of the first frames to profile.json.
+    sogas::platform::Frame_budget budget;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--frames") == 0)
+        {
+            budget.frame_count = static_cast<u32>(strtoul(argv[i + 1], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--frame-time") == 0)
+        {
+            budget.frame_time = strtod(argv[i + 1], nullptr);
+        }
+        else if (strcmp(argv[i], "--capture") == 0)
+        {
+            sogas::profiler::start_capture(static_cast<u32>(strtoul(argv[i + 1], nullptr, 10)),
+                                           "profile.json");
+        }
+    }
+    sogas::platform::set_frame_budget(budget);
+
     std::unique_ptr<sogas::Engine> engine = std::make_unique<sogas::Engine>();
 
     engine->init();
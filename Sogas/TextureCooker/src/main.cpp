@@ -0,0 +1,218 @@
+#include <resources/cooked_texture.h>
+#include <resources/texture_compression.h>
+#include <resources/texture_utils.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN64
+#pragma warning(disable : 4615)
+#pragma warning(disable : 4389)
+#pragma warning(disable : 4244)
+#endif
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#ifdef _WIN64
+#pragma warning(enable : 4244)
+#pragma warning(enable : 4389)
+#pragma warning(enable : 4615)
+#endif
+
+// Turns a source image into a cooked texture blob: full mip chain, block compressed, ready to be
+// mapped and uploaded by the runtime without decoding.
+//
+// texture_cooker <input> <output> [--format bc1|bc3|bc5] [--srgb] [--no-mips] [--threads N]
+
+using namespace pinut::resources;
+
+namespace
+{
+using Timer = std::chrono::steady_clock;
+
+struct CookOptions
+{
+    const char*   input        = nullptr;
+    const char*   output       = nullptr;
+    TextureFormat format       = TextureFormat::BC1_RGBA_UNORM;
+    bool          srgb         = false;
+    bool          mips         = true;
+    u32           thread_count = 0;
+};
+
+f64 get_elapsed_ms(const Timer::time_point start)
+{
+    return std::chrono::duration<f64, std::milli>(Timer::now() - start).count();
+}
+
+bool parse_options(int argc, char** argv, CookOptions& out_options)
+{
+    if (argc < 3)
+    {
+        return false;
+    }
+
+    out_options.input  = argv[1];
+    out_options.output = argv[2];
+
+    for (int i = 3; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+        {
+            const char* format = argv[++i];
+            if (strcmp(format, "bc1") == 0)
+            {
+                out_options.format = TextureFormat::BC1_RGBA_UNORM;
+            }
+            else if (strcmp(format, "bc3") == 0)
+            {
+                out_options.format = TextureFormat::BC3_UNORM;
+            }
+            else if (strcmp(format, "bc5") == 0)
+            {
+                out_options.format = TextureFormat::BC5_UNORM;
+            }
+            else
+            {
+                printf("Unknown format %s.\n", format);
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "--srgb") == 0)
+        {
+            out_options.srgb = true;
+        }
+        else if (strcmp(argv[i], "--no-mips") == 0)
+        {
+            out_options.mips = false;
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            out_options.thread_count = static_cast<u32>(atoi(argv[++i]));
+        }
+        else
+        {
+            printf("Unknown option %s.\n", argv[i]);
+            return false;
+        }
+    }
+
+    if (out_options.srgb)
+    {
+        if (out_options.format == TextureFormat::BC5_UNORM)
+        {
+            printf("BC5 has no sRGB variant.\n");
+            return false;
+        }
+
+        out_options.format = out_options.format == TextureFormat::BC1_RGBA_UNORM ?
+                               TextureFormat::BC1_RGBA_SRGB :
+                               TextureFormat::BC3_SRGB;
+    }
+
+    return true;
+}
+
+// Compares what the runtime used to do, decoding the source with stb, against reading the cooked
+// blob back. Mip generation is left out of the stb side, it ran on the GPU.
+void report_load_times(const CookOptions& options)
+{
+    auto start = Timer::now();
+    i32  w, h, c;
+    auto pixels = stbi_load(options.input, &w, &h, &c, STBI_rgb_alpha);
+    stbi_image_free(pixels);
+    const f64 stb_ms = get_elapsed_ms(start);
+
+    start = Timer::now();
+    std::ifstream   file(options.output, std::ios::binary | std::ios::ate);
+    std::vector<u8> blob(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+
+    CookedTextureHeader header;
+    const u8*           data      = nullptr;
+    const bool          valid     = parse_cooked_texture(blob.data(), blob.size(), header, data);
+    const f64           cooked_ms = get_elapsed_ms(start);
+
+    if (!valid)
+    {
+        printf("Cooked texture failed to validate.\n");
+        return;
+    }
+
+    printf("Load: stb %.2f ms, cooked %.2f ms (%.1fx)\n",
+           stb_ms,
+           cooked_ms,
+           cooked_ms > 0.0 ? stb_ms / cooked_ms : 0.0);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    CookOptions options;
+    if (!parse_options(argc, argv, options))
+    {
+        printf("Usage: texture_cooker <input> <output> [--format bc1|bc3|bc5] [--srgb] "
+               "[--no-mips] [--threads N]\n");
+        return 1;
+    }
+
+    auto start = Timer::now();
+    i32  width, height, channels;
+    auto pixels = stbi_load(options.input, &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels)
+    {
+        printf("Failed to load %s: %s\n", options.input, stbi_failure_reason());
+        return 1;
+    }
+    const f64 decode_ms = get_elapsed_ms(start);
+
+    const u32 mip_levels =
+      options.mips ? std::min(get_mip_count(width, height), MAX_TEXTURE_MIPS) : 1;
+
+    start = Timer::now();
+    std::vector<u8> rgba_chain;
+    generate_mip_chain_rgba8(pixels, width, height, mip_levels, rgba_chain);
+    stbi_image_free(pixels);
+    const f64 mips_ms = get_elapsed_ms(start);
+
+    start = Timer::now();
+    std::vector<u8> compressed_chain;
+    if (!compress_mip_chain(options.format,
+                            rgba_chain.data(),
+                            width,
+                            height,
+                            mip_levels,
+                            compressed_chain,
+                            options.thread_count))
+    {
+        return 1;
+    }
+    const f64 compress_ms = get_elapsed_ms(start);
+
+    const auto header = make_cooked_texture_header(options.format, width, height, mip_levels);
+    if (!write_cooked_texture(options.output, header, compressed_chain.data()))
+    {
+        return 1;
+    }
+
+    const f64 texels = static_cast<f64>(rgba_chain.size() / 4);
+    printf("Cooked %s -> %s (%dx%d, %u mips, %llu bytes)\n",
+           options.input,
+           options.output,
+           width,
+           height,
+           mip_levels,
+           static_cast<unsigned long long>(sizeof(header) + header.data_size));
+    printf("Decode %.2f ms, mips %.2f ms, compress %.2f ms (%.1f MPix/s)\n",
+           decode_ms,
+           mips_ms,
+           compress_ms,
+           compress_ms > 0.0 ? texels / (compress_ms * 1000.0) : 0.0);
+
+    report_load_times(options);
+
+    return 0;
+}
@@ -0,0 +1,4 @@
+#pragma once
+#define STBI_rgb_alpha 4
+unsigned char* stbi_load(const char*, int*, int*, int*, int);
+void stbi_image_free(void*);